@@ -28,8 +28,6 @@
 #include "BaseMux.h"
 
 
-#define MUX_MAX_PINS	(1000)
-
 //////////////////////////////////////////////////////////////////////////////
 // CBaseMuxInputPin
 
@@ -39,6 +37,9 @@ CBaseMuxInputPin::CBaseMuxInputPin(LPCTSTR pObjectName,
 	: CTransformInputPin(pObjectName, pFilter, phr, pName)
 	, m_pMux(pFilter)
 	, m_bSync(bSync)
+	, m_nSlave(0)
+	, m_cBuffers(0)
+	, m_bEndOfStream(FALSE)
 {
 }
 
@@ -50,6 +51,9 @@ CBaseMuxInputPin::CBaseMuxInputPin(LPCSTR pObjectName,
 	: CTransformInputPin(pObjectName, pFilter, phr, pName)
 	, m_pMux(pFilter)
 	, m_bSync(bSync)
+	, m_nSlave(0)
+	, m_cBuffers(0)
+	, m_bEndOfStream(FALSE)
 {
 }
 #endif
@@ -67,7 +71,33 @@ STDMETHODIMP CBaseMuxInputPin::Receive(IMediaSample * pSample)
 			CAutoLock lck(&m_pMux->m_csReceive);
 			hr = m_pMux->Receive(pSample);
 		} else {
-			hr = m_pMux->ReceiveSlave(pSample);
+			// the master doesn't wait for the slaves, only Stop does
+			CAutoLock lck(&m_csSlaveReceive);
+			hr = m_pMux->ReceiveSlave(m_nSlave, pSample);
+		}
+	}
+
+	return hr;
+}
+
+
+// the master ends the stream of the filter, a slave only its own
+STDMETHODIMP CBaseMuxInputPin::EndOfStream()
+{
+	HRESULT hr;
+	if (m_bSync) {
+		CAutoLock lck(&m_pMux->m_csReceive);
+		hr = CheckStreaming();
+		if (S_OK == hr) {
+			m_bEndOfStream = TRUE;
+			hr = m_pMux->EndOfStream();
+		}
+	} else {
+		CAutoLock lck(&m_csSlaveReceive);
+		hr = CheckStreaming();
+		if (S_OK == hr) {
+			m_bEndOfStream = TRUE;
+			hr = m_pMux->EndOfStreamSlave(m_nSlave);
 		}
 	}
 
@@ -75,6 +105,68 @@ STDMETHODIMP CBaseMuxInputPin::Receive(IMediaSample * pSample)
 }
 
 
+STDMETHODIMP CBaseMuxInputPin::EndFlush()
+{
+	m_bEndOfStream = FALSE;
+	return CTransformInputPin::EndFlush();
+}
+
+
+HRESULT CBaseMuxInputPin::Inactive()
+{
+	m_bEndOfStream = FALSE;
+	return CTransformInputPin::Inactive();
+}
+
+
+HRESULT CBaseMuxInputPin::CompleteConnect(IPin *pReceivePin)
+{
+	HRESULT hr = CTransformInputPin::CompleteConnect(pReceivePin);
+
+	// a free slave pin for the next input. failing to add it doesn't
+	// fail this connection.
+	if (SUCCEEDED(hr) && !m_bSync) {
+		m_pMux->AddSlavePin();
+	}
+
+	return hr;
+}
+
+
+STDMETHODIMP CBaseMuxInputPin::NotifyAllocator(IMemAllocator *pAllocator,
+											   BOOL bReadOnly)
+{
+	HRESULT hr = CTransformInputPin::NotifyAllocator(pAllocator, bReadOnly);
+	if (SUCCEEDED(hr)) {
+		ALLOCATOR_PROPERTIES props;
+		if (SUCCEEDED(pAllocator->GetProperties(&props))) {
+			m_cBuffers = props.cBuffers;
+		} else {
+			m_cBuffers = 0;
+		}
+	}
+	return hr;
+}
+
+
+STDMETHODIMP CBaseMuxInputPin::GetAllocatorRequirements(
+											ALLOCATOR_PROPERTIES *pProps)
+{
+	CheckPointer(pProps, E_POINTER);
+
+	if (m_bSync) {
+		return CTransformInputPin::GetAllocatorRequirements(pProps);
+	}
+
+	// the upstream may not follow this
+	pProps->cBuffers = MUX_SLAVE_BUFFERS;
+	pProps->cbBuffer = 0;
+	pProps->cbAlign = 1;
+	pProps->cbPrefix = 0;
+	return S_OK;
+}
+
+
 //////////////////////////////////////////////////////////////////////////////
 // CBaseMux
 
@@ -82,7 +174,9 @@ STDMETHODIMP CBaseMuxInputPin::Receive(IMediaSample * pSample)
 CBaseMux::CBaseMux(LPCTSTR pName, LPUNKNOWN pUnk, REFCLSID clsid)
 	: CTransformFilter(pName, pUnk, clsid)
 	, m_nFrameCount(0)
+	, m_nSlaveInputs(0)
 {
+	ZeroMemory(m_pSlaveInputs, sizeof(m_pSlaveInputs));
 }
 
 
@@ -90,14 +184,30 @@ CBaseMux::CBaseMux(LPCTSTR pName, LPUNKNOWN pUnk, REFCLSID clsid)
 CBaseMux::CBaseMux(LPCSTR pName, LPUNKNOWN pUnk, REFCLSID clsid)
 	: CTransformFilter(pName, pUnk, clsid)
 	, m_nFrameCount(0)
+	, m_nSlaveInputs(0)
 {
+	ZeroMemory(m_pSlaveInputs, sizeof(m_pSlaveInputs));
 }
 #endif
 
 
 CBaseMux::~CBaseMux()
 {
-	delete m_pSlaveInput;
+	for (int i = 0; i < m_nSlaveInputs; i++) {
+		delete m_pSlaveInputs[i];
+	}
+}
+
+
+int CBaseMux::GetPinCount()
+{
+	if (m_pInput == NULL) {
+		if (BuildPins() != S_OK) {
+			return 0;
+		}
+	}
+
+	return 2 + m_nSlaveInputs;
 }
 
 
@@ -112,10 +222,12 @@ CBasePin * CBaseMux::GetPin(int n)
 		}
 	}
 
-	switch(n) {
-	case 0:	return m_pInput;
-	case 1: return m_pSlaveInput;
-	case 2: return m_pOutput;
+	if (n == 0) {
+		return m_pInput;
+	} else if (n <= m_nSlaveInputs) {
+		return m_pSlaveInputs[n - 1];
+	} else if (n == m_nSlaveInputs + 1) {
+		return m_pOutput;
 	}
 	return NULL;
 }
@@ -126,15 +238,32 @@ STDMETHODIMP CBaseMux::FindPin(LPCWSTR Id, IPin **ppPin)
 	CheckPointer(ppPin, E_POINTER);
 	ValidateReadWritePtr(ppPin, sizeof(IPin *));
 
+	// "In2" and later are the slaves
+	int nIn = 0;
 	if (0==lstrcmpW(Id,L"In") || 0==lstrcmpW(Id,L"In1")) {
 		*ppPin = GetPin(0);
-	} else if (0==lstrcmpW(Id,L"In2")) {
-		*ppPin = GetPin(1);
+	} else if (0==wcsncmp(Id,L"In",2) && (nIn = _wtoi(Id + 2)) >= 2) {
+		if (nIn - 1 > GetSlaveCount()) {
+			*ppPin = NULL;
+			return VFW_E_NOT_FOUND;
+		}
+		*ppPin = GetPin(nIn - 1);
 	} else if (0==lstrcmpW(Id,L"Out")) {
-		*ppPin = GetPin(2);
+		*ppPin = GetPin(GetPinCount() - 1);
 	} else {
+		// pin names, which QueryId returns
 		*ppPin = NULL;
-		return VFW_E_NOT_FOUND;
+		int nPins = GetPinCount();
+		for (int i = 0; i < nPins; i++) {
+			CBasePin* pPin = GetPin(i);
+			if (pPin && 0==lstrcmpW(Id, pPin->Name())) {
+				*ppPin = pPin;
+				break;
+			}
+		}
+		if (*ppPin == NULL) {
+			return VFW_E_NOT_FOUND;
+		}
 	}
 
 	HRESULT hr = NOERROR;
@@ -169,12 +298,14 @@ STDMETHODIMP CBaseMux::Stop()
 	}
 
 	ASSERT(m_pInput);
-	ASSERT(m_pSlaveInput);
+	ASSERT(m_nSlaveInputs > 0);
 	ASSERT(m_pOutput);
 
 	// decommit the input pin before locking or we can deadlock
 	m_pInput->Inactive();
-	m_pSlaveInput->Inactive();
+	for (int i = 0; i < m_nSlaveInputs; i++) {
+		m_pSlaveInputs[i]->Inactive();
+	}
 
 	// synchronize with Receive calls
 
@@ -238,19 +369,19 @@ HRESULT CBaseMux::DecideBufferSize(IMemAllocator *pAlloc,
 HRESULT CBaseMux::BuildPins()
 {
 	HRESULT hr = S_OK;
-	m_pInput = CreateInputPin(TRUE, &hr);
+	m_pInput = CreateInputPin(TRUE, 0, &hr);
 	if (m_pInput == NULL || hr != S_OK) {
 		delete m_pInput;
 		m_pInput = NULL;
 		return hr;
 	}
 
-	m_pSlaveInput = CreateInputPin(FALSE, &hr);
-	if (m_pSlaveInput == NULL || hr != S_OK) {
+	m_pSlaveInputs[0] = CreateInputPin(FALSE, 0, &hr);
+	if (m_pSlaveInputs[0] == NULL || hr != S_OK) {
 		delete m_pInput;
 		m_pInput = NULL;
-		delete m_pSlaveInput;
-		m_pSlaveInput = NULL;
+		delete m_pSlaveInputs[0];
+		m_pSlaveInputs[0] = NULL;
 		return hr;
 	}
 
@@ -258,24 +389,109 @@ HRESULT CBaseMux::BuildPins()
 	if (m_pOutput == NULL || hr != S_OK) {
 		delete m_pInput;
 		m_pInput = NULL;
-		delete m_pSlaveInput;
-		m_pSlaveInput = NULL;
+		delete m_pSlaveInputs[0];
+		m_pSlaveInputs[0] = NULL;
 		delete m_pOutput;
 		m_pOutput = NULL;
 		return hr;
 	}
 
+	m_nSlaveInputs = 1;
+
 	return hr;
 }
 
 
-CBaseMuxInputPin* CBaseMux::CreateInputPin(BOOL bMaster, HRESULT* phr)
+CBaseMuxInputPin* CBaseMux::CreateInputPin(BOOL bMaster, int nSlave,
+										   HRESULT* phr)
 {
 	LPCWSTR pMaster = L"Master In";
 	LPCWSTR pSlave = L"Slave In";
 
-	return new CBaseMuxInputPin(NAME("BaseMuxInputPin"), this, phr,
-								(bMaster ? pMaster : pSlave), bMaster);
+	// "Slave In", "Slave In 2", ...
+	WCHAR szName[32];
+	if (!bMaster && nSlave > 0) {
+		StringCchPrintfW(szName, NUMELMS(szName), L"Slave In %d",
+						 nSlave + 1);
+		pSlave = szName;
+	}
+
+	CBaseMuxInputPin* pPin = new CBaseMuxInputPin(NAME("BaseMuxInputPin"),
+								this, phr, (bMaster ? pMaster : pSlave),
+								bMaster);
+	if (pPin) {
+		pPin->m_nSlave = nSlave;
+	}
+	return pPin;
+}
+
+
+int CBaseMux::GetConnectedSlaveCount()
+{
+	int nCount = 0;
+	for (int i = 0; i < m_nSlaveInputs; i++) {
+		if (m_pSlaveInputs[i]->IsConnected()) {
+			nCount++;
+		}
+	}
+	return nCount;
+}
+
+
+HRESULT CBaseMux::AddSlavePin()
+{
+	CAutoLock lck(&m_csFilter);
+
+	// there is a free pin yet
+	for (int i = 0; i < m_nSlaveInputs; i++) {
+		if (!m_pSlaveInputs[i]->IsConnected()) {
+			return S_FALSE;
+		}
+	}
+
+	if (m_nSlaveInputs >= min(GetMaxSlaveCount(), MUX_MAX_PINS - 2)) {
+		return S_FALSE;
+	}
+
+	HRESULT hr = S_OK;
+	CBaseMuxInputPin* pPin = CreateInputPin(FALSE, m_nSlaveInputs, &hr);
+	if (pPin == NULL || hr != S_OK) {
+		delete pPin;
+		return (hr != S_OK) ? hr : E_OUTOFMEMORY;
+	}
+
+	m_pSlaveInputs[m_nSlaveInputs++] = pPin;
+	IncrementPinVersion();
+
+	return S_OK;
+}
+
+
+void CBaseMux::TrimSlavePins()
+{
+	CAutoLock lck(&m_csFilter);
+
+	int nMax = GetMaxSlaveCount();
+	int nSlaves = m_nSlaveInputs;
+
+	// from the last pin, while it's free and over the limit or has
+	// another free pin before it
+	while (nSlaves > 1) {
+		CBaseMuxInputPin* pLast = m_pSlaveInputs[nSlaves - 1];
+		if (pLast->IsConnected()) {
+			break;
+		}
+		if (nSlaves <= nMax && m_pSlaveInputs[nSlaves - 2]->IsConnected()) {
+			break;
+		}
+		delete pLast;
+		m_pSlaveInputs[--nSlaves] = NULL;
+	}
+
+	if (nSlaves != m_nSlaveInputs) {
+		m_nSlaveInputs = nSlaves;
+		IncrementPinVersion();
+	}
 }
 
 
@@ -24,6 +24,13 @@
 #pragma once
 
 
+// pins of a mux, the master and the output pins included
+#define MUX_MAX_PINS	(1000)
+
+// buffers asked of the upstream allocator of a slave, whose sample may
+// be held until the next one arrives
+#define MUX_SLAVE_BUFFERS	(3)
+
 class CBaseMux;
 
 /////////////////////////////////////////////////////////////////////////////
@@ -48,12 +55,31 @@ public:
 #endif
 
 	STDMETHODIMP Receive(IMediaSample * pSample);
+	STDMETHODIMP EndOfStream();
+	STDMETHODIMP EndFlush();
+	HRESULT Inactive();
+	HRESULT CompleteConnect(IPin *pReceivePin);
+	STDMETHODIMP NotifyAllocator(IMemAllocator *pAllocator, BOOL bReadOnly);
+	STDMETHODIMP GetAllocatorRequirements(ALLOCATOR_PROPERTIES *pProps);
+
+	// the upstream can deliver the next sample while one is held
+	BOOL CanHoldSample() { return m_cBuffers >= 2; }
+
+	// held in ReceiveSlave, not by the master
+	CCritSec* GetSlaveLock() { return &m_csSlaveReceive; }
+
+	// the end of the stream was received, until a flush or Stop
+	BOOL IsEndOfStream() { return m_bEndOfStream; }
 
 private:
 	friend class CBaseMux;
 
 	CBaseMux* m_pMux;
 	BOOL m_bSync;
+	int m_nSlave;
+	long m_cBuffers;
+	volatile BOOL m_bEndOfStream;
+	CCritSec m_csSlaveReceive;
 
 protected:
 	BOOL IsSyncPin() { return m_bSync; }
@@ -79,7 +105,8 @@ public:
 
 public:
 	// override
-	int GetPinCount() { return 3; }
+	// the master, the slaves and the output, in this order
+	int GetPinCount();
 	CBasePin * GetPin(int n);
 	STDMETHODIMP FindPin(LPCWSTR Id, IPin **ppPin);
 
@@ -88,16 +115,32 @@ public:
 	HRESULT DecideBufferSize(IMemAllocator *pAlloc,
 							 ALLOCATOR_PROPERTIES *pProp);
 
-	virtual HRESULT ReceiveSlave(IMediaSample *pSample) PURE;
+	virtual HRESULT ReceiveSlave(int nSlave, IMediaSample *pSample) PURE;
+	// the end of a slave, which doesn't end the output by default
+	virtual HRESULT EndOfStreamSlave(int nSlave) { return S_OK; }
+
+	int GetSlaveCount() { return m_nSlaveInputs; }
+	CBaseMuxInputPin* GetSlaveInput(int nSlave)
+		{ return (nSlave < m_nSlaveInputs) ? m_pSlaveInputs[nSlave] : NULL; }
+	int GetConnectedSlaveCount();
 
 protected:
 	HRESULT BuildPins();
-	virtual CBaseMuxInputPin* CreateInputPin(BOOL bMaster, HRESULT* phr);
+	virtual CBaseMuxInputPin* CreateInputPin(BOOL bMaster, int nSlave,
+											 HRESULT* phr);
 	virtual CTransformOutputPin* CreateOutputPin(HRESULT* phr);
 	virtual HRESULT DecideBufferSize(AM_MEDIA_TYPE* pmt,
 									 ALLOCATOR_PROPERTIES* pProp) PURE;
 
+	// slave pins are added while all of them are connected, up to
+	// GetMaxSlaveCount(). TrimSlavePins removes the unconnected ones
+	// over the limit, keeping one free pin.
+	virtual int GetMaxSlaveCount() { return 1; }
+	HRESULT AddSlavePin();
+	void TrimSlavePins();
+
 protected:
 	friend class CBaseMuxInputPin;
-	CBaseMuxInputPin *m_pSlaveInput;
+	CBaseMuxInputPin* m_pSlaveInputs[MUX_MAX_PINS - 2];
+	int m_nSlaveInputs;
 };
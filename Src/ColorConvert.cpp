@@ -0,0 +1,638 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Motoharu Tsubaki.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a 
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <streams.h>
+
+#include <emmintrin.h>
+#include <tmmintrin.h>
+
+#include "Utils.h"
+#include "PixelTraits.h"
+#include "ColorConvert.h"
+
+
+// YUV to RGB matrix, 2.13 fixed point coefficients.
+// the luma is scaled from (16-235) and the chroma from (16-240).
+struct YUV_MATRIX
+{
+	short nY;		// of the luma
+	short nRV;		// of V for R
+	short nGU;		// of U for G, subtracted
+	short nGV;		// of V for G, subtracted
+	short nBU;		// of U for B
+};
+
+// ITU-R BT.601, VIDEOINFOHEADER has no colorimetry
+static const YUV_MATRIX s_BT601 = { 9539, 13075, 3209, 6660, 16525 };
+
+// the inputs are (x - offset) << 6, and the products have 3 bits of
+// fraction
+#define YUV_SHIFT			(6)
+#define YUV_FRACTION		(3)
+
+// 8.8 fixed point reciprocals of the alpha, 255 * 256 / a, which fit in
+// 16 bits. the colors are clamped to the alpha and shifted by 8 bits
+// before they are multiplied, so the products have 16 bits of fraction.
+static WORD g_Recip[256];
+
+static class CRecipTableInit
+{
+public:
+	CRecipTableInit()
+	{
+		g_Recip[0] = 0;
+		for (int a = 1; a < 256; a++) {
+			g_Recip[a] = (WORD)((255 * 256 + a / 2) / a);
+		}
+	}
+} g_RecipTableInit;
+
+
+///////////////////////////////////////////////////////////////////////////////
+// reference
+
+// RGB24 to RGB32, the unused byte is opaque
+static void ConvertRGB24ToRGB32_C(LPBYTE pDst, const BYTE* pSrc, int nCount)
+{
+	DWORD* pDstPix = (DWORD*)pDst;
+	for (int x = 0; x < nCount; x++, pSrc += 3) {
+		pDstPix[x] = pSrc[0] | (pSrc[1] << 8) | (pSrc[2] << 16) | 0xff000000;
+	}
+}
+
+
+// the high word of the product, as _mm_mulhi_epi16
+static __forceinline int MulHi(int a, int b)
+{
+	return (a * b) >> 16;
+}
+
+
+static __forceinline BYTE ClampYUV(int n)
+{
+	n = (n + (1 << (YUV_FRACTION - 1))) >> YUV_FRACTION;
+	return (BYTE)((n < 0) ? 0 : (n > 255) ? 255 : n);
+}
+
+
+// packed YUV to RGB32, 2 pixels at a time
+template <class T>
+static void ConvertYUVToRGB32_C(LPBYTE pDst, const BYTE* pSrc, int nCount)
+{
+	const YUV_MATRIX& m = s_BT601;
+
+	for (int x = 0; x < nCount; x += 2, pSrc += 4) {
+		int u = (pSrc[1 - T::Y_OFFSET] - 128) << YUV_SHIFT;
+		int v = (pSrc[3 - T::Y_OFFSET] - 128) << YUV_SHIFT;
+		int r = MulHi(v, m.nRV);
+		int g = -MulHi(u, m.nGU) - MulHi(v, m.nGV);
+		int b = MulHi(u, m.nBU);
+
+		for (int i = 0; i < 2; i++, pDst += 4) {
+			int y = MulHi((pSrc[i * 2 + T::Y_OFFSET] - 16) << YUV_SHIFT, m.nY);
+			pDst[0] = ClampYUV(y + b);
+			pDst[1] = ClampYUV(y + g);
+			pDst[2] = ClampYUV(y + r);
+			pDst[3] = 0xff;
+		}
+	}
+}
+
+
+// round(n / 255) for n up to 255 * 255, with the WORDs of the SIMD
+static __forceinline int Div255(int n)
+{
+	n += 128;
+	return (n + (n >> 8)) >> 8;
+}
+
+
+static __forceinline BYTE Premultiply(int c, int a)
+{
+	return (BYTE)Div255(c * a);
+}
+
+
+static __forceinline BYTE Unpremultiply(int c, int a)
+{
+	c = min(c, a) << 8;
+	int n = (c * g_Recip[a] + 0x8000) >> 16;
+	return (BYTE)min(n, 255);
+}
+
+
+// 5 and 4 bit channels to 8 bits and back
+static __forceinline int Expand5(int c)		{ return (c << 3) | (c >> 2); }
+static __forceinline int Expand4(int c)		{ return (c << 4) | c; }
+static __forceinline int Reduce5(int c)		{ return Div255(c * 31); }
+static __forceinline int Reduce4(int c)		{ return Div255(c * 15); }
+
+
+static void PremultiplyARGB32_C(LPBYTE pDst, const BYTE* pSrc, int nCount)
+{
+	for (int x = 0; x < nCount; x++, pSrc += 4, pDst += 4) {
+		int a = pSrc[3];
+		pDst[0] = Premultiply(pSrc[0], a);
+		pDst[1] = Premultiply(pSrc[1], a);
+		pDst[2] = Premultiply(pSrc[2], a);
+		pDst[3] = (BYTE)a;
+	}
+}
+
+
+static void UnpremultiplyARGB32_C(LPBYTE pDst, const BYTE* pSrc, int nCount)
+{
+	for (int x = 0; x < nCount; x++, pSrc += 4, pDst += 4) {
+		int a = pSrc[3];
+		pDst[0] = Unpremultiply(pSrc[0], a);
+		pDst[1] = Unpremultiply(pSrc[1], a);
+		pDst[2] = Unpremultiply(pSrc[2], a);
+		pDst[3] = (BYTE)a;
+	}
+}
+
+
+// the 1 bit alpha keeps or clears the colors
+static void PremultiplyARGB1555_C(LPBYTE pDst, const BYTE* pSrc, int nCount)
+{
+	const WORD* pSrcPix = (const WORD*)pSrc;
+	for (int x = 0; x < nCount; x++, pDst += 4) {
+		int p = (pSrcPix[x] & 0x8000) ? pSrcPix[x] : 0;
+		pDst[0] = (BYTE)Expand5(p & 0x1f);
+		pDst[1] = (BYTE)Expand5((p >> 5) & 0x1f);
+		pDst[2] = (BYTE)Expand5((p >> 10) & 0x1f);
+		pDst[3] = (BYTE)((p >> 15) * 0xff);
+	}
+}
+
+
+// the alpha is opaque from the half
+static void UnpremultiplyARGB1555_C(LPBYTE pDst, const BYTE* pSrc,
+									int nCount)
+{
+	WORD* pDstPix = (WORD*)pDst;
+	for (int x = 0; x < nCount; x++, pSrc += 4) {
+		int a = pSrc[3];
+		pDstPix[x] = (WORD)(((a >> 7) << 15)
+							| (Reduce5(Unpremultiply(pSrc[2], a)) << 10)
+							| (Reduce5(Unpremultiply(pSrc[1], a)) << 5)
+							| Reduce5(Unpremultiply(pSrc[0], a)));
+	}
+}
+
+
+static void PremultiplyARGB4444_C(LPBYTE pDst, const BYTE* pSrc, int nCount)
+{
+	const WORD* pSrcPix = (const WORD*)pSrc;
+	for (int x = 0; x < nCount; x++, pDst += 4) {
+		int p = pSrcPix[x];
+		int a = Expand4(p >> 12);
+		pDst[0] = Premultiply(Expand4(p & 0xf), a);
+		pDst[1] = Premultiply(Expand4((p >> 4) & 0xf), a);
+		pDst[2] = Premultiply(Expand4((p >> 8) & 0xf), a);
+		pDst[3] = (BYTE)a;
+	}
+}
+
+
+static void UnpremultiplyARGB4444_C(LPBYTE pDst, const BYTE* pSrc,
+									int nCount)
+{
+	WORD* pDstPix = (WORD*)pDst;
+	for (int x = 0; x < nCount; x++, pSrc += 4) {
+		int a = pSrc[3];
+		pDstPix[x] = (WORD)((Reduce4(a) << 12)
+							| (Reduce4(Unpremultiply(pSrc[2], a)) << 8)
+							| (Reduce4(Unpremultiply(pSrc[1], a)) << 4)
+							| Reduce4(Unpremultiply(pSrc[0], a)));
+	}
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SSE2 / SSSE3
+
+// 4 pixels at a time with 16 byte loads, so the last 2 pixels are left to
+// the reference
+static void ConvertRGB24ToRGB32_SSSE3(LPBYTE pDst, const BYTE* pSrc,
+									  int nCount)
+{
+	const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1,
+										  6, 7, 8, -1, 9, 10, 11, -1);
+	const __m128i alpha = _mm_set1_epi32(0xff000000);
+
+	int x = 0;
+	for (; x + 6 <= nCount; x += 4, pSrc += 12, pDst += 16) {
+		__m128i pix = _mm_loadu_si128((const __m128i*)pSrc);
+		pix = _mm_or_si128(_mm_shuffle_epi8(pix, shuffle), alpha);
+		_mm_storeu_si128((__m128i*)pDst, pix);
+	}
+
+	ConvertRGB24ToRGB32_C(pDst, pSrc, nCount - x);
+}
+
+
+// 8 pixels at a time, the rest is left to the reference
+template <class T>
+static void ConvertYUVToRGB32_SSE2(LPBYTE pDst, const BYTE* pSrc, int nCount)
+{
+	const YUV_MATRIX& m = s_BT601;
+	const __m128i coefY = _mm_set1_epi16(m.nY);
+	const __m128i coefRV = _mm_set1_epi16(m.nRV);
+	const __m128i coefGU = _mm_set1_epi16(m.nGU);
+	const __m128i coefGV = _mm_set1_epi16(m.nGV);
+	const __m128i coefBU = _mm_set1_epi16(m.nBU);
+	const __m128i lumaOffset = _mm_set1_epi16(16);
+	const __m128i chromaOffset = _mm_set1_epi16(128);
+	const __m128i round = _mm_set1_epi16(1 << (YUV_FRACTION - 1));
+	const __m128i byteMask = _mm_set1_epi16(0xff);
+	const __m128i wordMask = _mm_set1_epi32(0xffff);
+	const __m128i opaque = _mm_set1_epi8(-1);
+
+	int x = 0;
+	for (; x + 8 <= nCount; x += 8, pSrc += 16, pDst += 32) {
+		__m128i pix = _mm_loadu_si128((const __m128i*)pSrc);
+
+		// Y0 .. Y7, and U0 V0 .. U3 V3
+		__m128i y, c;
+		if (T::Y_OFFSET == 0) {
+			y = _mm_and_si128(pix, byteMask);
+			c = _mm_srli_epi16(pix, 8);
+		} else {
+			y = _mm_srli_epi16(pix, 8);
+			c = _mm_and_si128(pix, byteMask);
+		}
+
+		// the chroma of each pixel
+		__m128i u = _mm_and_si128(c, wordMask);
+		__m128i v = _mm_srli_epi32(c, 16);
+		u = _mm_or_si128(u, _mm_slli_epi32(u, 16));
+		v = _mm_or_si128(v, _mm_slli_epi32(v, 16));
+
+		y = _mm_slli_epi16(_mm_sub_epi16(y, lumaOffset), YUV_SHIFT);
+		u = _mm_slli_epi16(_mm_sub_epi16(u, chromaOffset), YUV_SHIFT);
+		v = _mm_slli_epi16(_mm_sub_epi16(v, chromaOffset), YUV_SHIFT);
+
+		y = _mm_add_epi16(_mm_mulhi_epi16(y, coefY), round);
+		__m128i r = _mm_add_epi16(y, _mm_mulhi_epi16(v, coefRV));
+		__m128i g = _mm_sub_epi16(y, _mm_add_epi16(_mm_mulhi_epi16(u, coefGU),
+												   _mm_mulhi_epi16(v, coefGV)));
+		__m128i b = _mm_add_epi16(y, _mm_mulhi_epi16(u, coefBU));
+		r = _mm_srai_epi16(r, YUV_FRACTION);
+		g = _mm_srai_epi16(g, YUV_FRACTION);
+		b = _mm_srai_epi16(b, YUV_FRACTION);
+
+		// B G R A
+		b = _mm_packus_epi16(b, b);
+		g = _mm_packus_epi16(g, g);
+		r = _mm_packus_epi16(r, r);
+		__m128i bg = _mm_unpacklo_epi8(b, g);
+		__m128i ra = _mm_unpacklo_epi8(r, opaque);
+		_mm_storeu_si128((__m128i*)pDst, _mm_unpacklo_epi16(bg, ra));
+		_mm_storeu_si128((__m128i*)(pDst + 16), _mm_unpackhi_epi16(bg, ra));
+	}
+
+	ConvertYUVToRGB32_C<T>(pDst, pSrc, nCount - x);
+}
+
+
+// premultiplied alpha, the same arithmetic as the reference in WORDs
+
+static __forceinline __m128i Div255_SSE2(__m128i n)
+{
+	n = _mm_add_epi16(n, _mm_set1_epi16(128));
+	return _mm_srli_epi16(_mm_add_epi16(n, _mm_srli_epi16(n, 8)), 8);
+}
+
+
+// 2 pixels of B G R A WORDs. the alpha lanes are multiplied by 255 to be
+// kept as they are.
+static __forceinline __m128i Premultiply2(__m128i pix)
+{
+	const __m128i colorMask = _mm_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0);
+	const __m128i alpha255 = _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255);
+
+	__m128i a = _mm_shufflelo_epi16(pix, _MM_SHUFFLE(3, 3, 3, 3));
+	a = _mm_shufflehi_epi16(a, _MM_SHUFFLE(3, 3, 3, 3));
+	pix = _mm_or_si128(_mm_and_si128(pix, colorMask), alpha255);
+	return Div255_SSE2(_mm_mullo_epi16(pix, a));
+}
+
+
+// 2 pixels of B G R A WORDs with the alpha a0 and a1. the alpha lanes are
+// multiplied by 1.0, and the lanes of 256 are saturated by the pack.
+static __forceinline __m128i Unpremultiply2(__m128i pix, int a0, int a1)
+{
+	__m128i recip = _mm_setr_epi16((short)g_Recip[a0], (short)g_Recip[a0],
+								   (short)g_Recip[a0], 256,
+								   (short)g_Recip[a1], (short)g_Recip[a1],
+								   (short)g_Recip[a1], 256);
+	__m128i a = _mm_shufflelo_epi16(pix, _MM_SHUFFLE(3, 3, 3, 3));
+	a = _mm_shufflehi_epi16(a, _MM_SHUFFLE(3, 3, 3, 3));
+	pix = _mm_slli_epi16(_mm_min_epi16(pix, a), 8);
+	__m128i hi = _mm_mulhi_epu16(pix, recip);
+	__m128i lo = _mm_mullo_epi16(pix, recip);
+	return _mm_add_epi16(hi, _mm_srli_epi16(lo, 15));
+}
+
+
+// 4 pixels of premultiplied ARGB32 to straight
+static __forceinline __m128i Unpremultiply4(const BYTE* pSrc)
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i pix = _mm_loadu_si128((const __m128i*)pSrc);
+	__m128i lo = Unpremultiply2(_mm_unpacklo_epi8(pix, zero),
+								pSrc[3], pSrc[7]);
+	__m128i hi = Unpremultiply2(_mm_unpackhi_epi8(pix, zero),
+								pSrc[11], pSrc[15]);
+	return _mm_packus_epi16(lo, hi);
+}
+
+
+// 8 pixels of premultiplied ARGB32 to the straight channels in WORDs
+static __forceinline void LoadStraight8(const BYTE* pSrc, __m128i* pb,
+										__m128i* pg, __m128i* pr,
+										__m128i* pa)
+{
+	const __m128i byteMask = _mm_set1_epi32(0xff);
+	__m128i p0 = Unpremultiply4(pSrc);
+	__m128i p1 = Unpremultiply4(pSrc + 16);
+	*pb = _mm_packs_epi32(_mm_and_si128(p0, byteMask),
+						  _mm_and_si128(p1, byteMask));
+	*pg = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p0, 8), byteMask),
+						  _mm_and_si128(_mm_srli_epi32(p1, 8), byteMask));
+	*pr = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p0, 16), byteMask),
+						  _mm_and_si128(_mm_srli_epi32(p1, 16), byteMask));
+	*pa = _mm_packs_epi32(_mm_srli_epi32(p0, 24), _mm_srli_epi32(p1, 24));
+}
+
+
+// 8 pixels of B G R A bytes from the channels in WORDs
+static __forceinline void StoreARGB8(LPBYTE pDst, __m128i b, __m128i g,
+									 __m128i r, __m128i a)
+{
+	__m128i bg = _mm_or_si128(b, _mm_slli_epi16(g, 8));
+	__m128i ra = _mm_or_si128(r, _mm_slli_epi16(a, 8));
+	_mm_storeu_si128((__m128i*)pDst, _mm_unpacklo_epi16(bg, ra));
+	_mm_storeu_si128((__m128i*)(pDst + 16), _mm_unpackhi_epi16(bg, ra));
+}
+
+
+static void PremultiplyARGB32_SSE2(LPBYTE pDst, const BYTE* pSrc, int nCount)
+{
+	const __m128i zero = _mm_setzero_si128();
+
+	int x = 0;
+	for (; x + 4 <= nCount; x += 4, pSrc += 16, pDst += 16) {
+		__m128i pix = _mm_loadu_si128((const __m128i*)pSrc);
+		__m128i lo = Premultiply2(_mm_unpacklo_epi8(pix, zero));
+		__m128i hi = Premultiply2(_mm_unpackhi_epi8(pix, zero));
+		_mm_storeu_si128((__m128i*)pDst, _mm_packus_epi16(lo, hi));
+	}
+
+	PremultiplyARGB32_C(pDst, pSrc, nCount - x);
+}
+
+
+static void UnpremultiplyARGB32_SSE2(LPBYTE pDst, const BYTE* pSrc,
+									 int nCount)
+{
+	int x = 0;
+	for (; x + 4 <= nCount; x += 4, pSrc += 16, pDst += 16) {
+		_mm_storeu_si128((__m128i*)pDst, Unpremultiply4(pSrc));
+	}
+
+	UnpremultiplyARGB32_C(pDst, pSrc, nCount - x);
+}
+
+
+static void PremultiplyARGB1555_SSE2(LPBYTE pDst, const BYTE* pSrc,
+									 int nCount)
+{
+	const __m128i mask5 = _mm_set1_epi16(0x1f);
+
+	int x = 0;
+	for (; x + 8 <= nCount; x += 8, pSrc += 16, pDst += 32) {
+		__m128i pix = _mm_loadu_si128((const __m128i*)pSrc);
+		__m128i a = _mm_srai_epi16(pix, 15);
+		pix = _mm_and_si128(pix, a);
+		__m128i b = _mm_and_si128(pix, mask5);
+		__m128i g = _mm_and_si128(_mm_srli_epi16(pix, 5), mask5);
+		__m128i r = _mm_and_si128(_mm_srli_epi16(pix, 10), mask5);
+		b = _mm_or_si128(_mm_slli_epi16(b, 3), _mm_srli_epi16(b, 2));
+		g = _mm_or_si128(_mm_slli_epi16(g, 3), _mm_srli_epi16(g, 2));
+		r = _mm_or_si128(_mm_slli_epi16(r, 3), _mm_srli_epi16(r, 2));
+		StoreARGB8(pDst, b, g, r, _mm_srli_epi16(a, 8));
+	}
+
+	PremultiplyARGB1555_C(pDst, pSrc, nCount - x);
+}
+
+
+static void UnpremultiplyARGB1555_SSE2(LPBYTE pDst, const BYTE* pSrc,
+									   int nCount)
+{
+	const __m128i n31 = _mm_set1_epi16(31);
+
+	int x = 0;
+	for (; x + 8 <= nCount; x += 8, pSrc += 32, pDst += 16) {
+		__m128i b, g, r, a;
+		LoadStraight8(pSrc, &b, &g, &r, &a);
+		b = Div255_SSE2(_mm_mullo_epi16(b, n31));
+		g = Div255_SSE2(_mm_mullo_epi16(g, n31));
+		r = Div255_SSE2(_mm_mullo_epi16(r, n31));
+		a = _mm_slli_epi16(_mm_srli_epi16(a, 7), 15);
+		__m128i pix = _mm_or_si128(_mm_or_si128(a, _mm_slli_epi16(r, 10)),
+								   _mm_or_si128(_mm_slli_epi16(g, 5), b));
+		_mm_storeu_si128((__m128i*)pDst, pix);
+	}
+
+	UnpremultiplyARGB1555_C(pDst, pSrc, nCount - x);
+}
+
+
+static void PremultiplyARGB4444_SSE2(LPBYTE pDst, const BYTE* pSrc,
+									 int nCount)
+{
+	const __m128i mask4 = _mm_set1_epi16(0xf);
+
+	int x = 0;
+	for (; x + 8 <= nCount; x += 8, pSrc += 16, pDst += 32) {
+		__m128i pix = _mm_loadu_si128((const __m128i*)pSrc);
+		__m128i a = _mm_srli_epi16(pix, 12);
+		__m128i b = _mm_and_si128(pix, mask4);
+		__m128i g = _mm_and_si128(_mm_srli_epi16(pix, 4), mask4);
+		__m128i r = _mm_and_si128(_mm_srli_epi16(pix, 8), mask4);
+		a = _mm_or_si128(_mm_slli_epi16(a, 4), a);
+		b = _mm_or_si128(_mm_slli_epi16(b, 4), b);
+		g = _mm_or_si128(_mm_slli_epi16(g, 4), g);
+		r = _mm_or_si128(_mm_slli_epi16(r, 4), r);
+		b = Div255_SSE2(_mm_mullo_epi16(b, a));
+		g = Div255_SSE2(_mm_mullo_epi16(g, a));
+		r = Div255_SSE2(_mm_mullo_epi16(r, a));
+		StoreARGB8(pDst, b, g, r, a);
+	}
+
+	PremultiplyARGB4444_C(pDst, pSrc, nCount - x);
+}
+
+
+static void UnpremultiplyARGB4444_SSE2(LPBYTE pDst, const BYTE* pSrc,
+									   int nCount)
+{
+	const __m128i n15 = _mm_set1_epi16(15);
+
+	int x = 0;
+	for (; x + 8 <= nCount; x += 8, pSrc += 32, pDst += 16) {
+		__m128i b, g, r, a;
+		LoadStraight8(pSrc, &b, &g, &r, &a);
+		b = Div255_SSE2(_mm_mullo_epi16(b, n15));
+		g = Div255_SSE2(_mm_mullo_epi16(g, n15));
+		r = Div255_SSE2(_mm_mullo_epi16(r, n15));
+		a = Div255_SSE2(_mm_mullo_epi16(a, n15));
+		__m128i pix = _mm_or_si128(
+						_mm_or_si128(_mm_slli_epi16(a, 12), _mm_slli_epi16(r, 8)),
+						_mm_or_si128(_mm_slli_epi16(g, 4), b));
+		_mm_storeu_si128((__m128i*)pDst, pix);
+	}
+
+	UnpremultiplyARGB4444_C(pDst, pSrc, nCount - x);
+}
+
+
+// copies with non-temporal stores from the first aligned byte, and with
+// the cached stores before and after it
+static __forceinline void StreamBytes(LPBYTE pDst, const BYTE* pSrc, int cb)
+{
+	int cbHead = min((int)(-(INT_PTR)pDst & 15), cb);
+	::CopyMemory(pDst, pSrc, cbHead);
+	pDst += cbHead;
+	pSrc += cbHead;
+	cb -= cbHead;
+
+	for (; cb >= 16; cb -= 16, pSrc += 16, pDst += 16) {
+		_mm_stream_si128((__m128i*)pDst,
+						 _mm_loadu_si128((const __m128i*)pSrc));
+	}
+
+	::CopyMemory(pDst, pSrc, cb);
+}
+
+
+template <int SIZE>
+static void StreamLine_SSE2(LPBYTE pDst, const BYTE* pSrc, int nCount)
+{
+	StreamBytes(pDst, pSrc, nCount * SIZE);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+HRESULT GetConvertLine(const GUID* pFromSubtype, const GUID* pToSubtype,
+					   DWORD dwSimdFlags, PFN_CONVERT_LINE* ppfnConvert)
+{
+	CheckPointer(pFromSubtype, E_POINTER);
+	CheckPointer(pToSubtype, E_POINTER);
+	CheckPointer(ppfnConvert, E_POINTER);
+
+	*ppfnConvert = NULL;
+	if (*pToSubtype != MEDIASUBTYPE_RGB32) {
+		return E_NOTIMPL;
+	}
+
+	if (*pFromSubtype == MEDIASUBTYPE_RGB24) {
+		*ppfnConvert = (dwSimdFlags & SIMD_SSSE3)
+							? ConvertRGB24ToRGB32_SSSE3
+							: ConvertRGB24ToRGB32_C;
+	} else if (*pFromSubtype == MEDIASUBTYPE_YUY2) {
+		*ppfnConvert = (dwSimdFlags & SIMD_SSE2)
+							? ConvertYUVToRGB32_SSE2<PixelYUY2>
+							: ConvertYUVToRGB32_C<PixelYUY2>;
+	} else if (*pFromSubtype == MEDIASUBTYPE_UYVY) {
+		*ppfnConvert = (dwSimdFlags & SIMD_SSE2)
+							? ConvertYUVToRGB32_SSE2<PixelUYVY>
+							: ConvertYUVToRGB32_C<PixelUYVY>;
+	} else {
+		return E_NOTIMPL;
+	}
+
+	return S_OK;
+}
+
+
+HRESULT GetPremultiplyLine(const GUID* pSubtype, DWORD dwSimdFlags,
+						   PFN_CONVERT_LINE* ppfnPremultiply,
+						   PFN_CONVERT_LINE* ppfnUnpremultiply)
+{
+	CheckPointer(pSubtype, E_POINTER);
+	CheckPointer(ppfnPremultiply, E_POINTER);
+	CheckPointer(ppfnUnpremultiply, E_POINTER);
+
+	*ppfnPremultiply = NULL;
+	*ppfnUnpremultiply = NULL;
+
+	BOOL bSSE2 = (dwSimdFlags & SIMD_SSE2) != 0;
+	if (*pSubtype == MEDIASUBTYPE_ARGB32) {
+		*ppfnPremultiply = bSSE2 ? PremultiplyARGB32_SSE2
+								 : PremultiplyARGB32_C;
+		*ppfnUnpremultiply = bSSE2 ? UnpremultiplyARGB32_SSE2
+								   : UnpremultiplyARGB32_C;
+	} else if (*pSubtype == MEDIASUBTYPE_ARGB1555) {
+		*ppfnPremultiply = bSSE2 ? PremultiplyARGB1555_SSE2
+								 : PremultiplyARGB1555_C;
+		*ppfnUnpremultiply = bSSE2 ? UnpremultiplyARGB1555_SSE2
+								   : UnpremultiplyARGB1555_C;
+	} else if (*pSubtype == MEDIASUBTYPE_ARGB4444) {
+		*ppfnPremultiply = bSSE2 ? PremultiplyARGB4444_SSE2
+								 : PremultiplyARGB4444_C;
+		*ppfnUnpremultiply = bSSE2 ? UnpremultiplyARGB4444_SSE2
+								   : UnpremultiplyARGB4444_C;
+	} else {
+		return E_NOTIMPL;
+	}
+
+	return S_OK;
+}
+
+
+HRESULT GetStreamLine(int nBytesPerPixel, DWORD dwSimdFlags,
+					  PFN_CONVERT_LINE* ppfnStream)
+{
+	CheckPointer(ppfnStream, E_POINTER);
+
+	*ppfnStream = NULL;
+	if ((dwSimdFlags & SIMD_SSE2) == 0) {
+		return E_NOTIMPL;
+	}
+
+	switch (nBytesPerPixel) {
+	case 1:	*ppfnStream = StreamLine_SSE2<1>;	break;
+	case 2:	*ppfnStream = StreamLine_SSE2<2>;	break;
+	case 3:	*ppfnStream = StreamLine_SSE2<3>;	break;
+	case 4:	*ppfnStream = StreamLine_SSE2<4>;	break;
+	default:
+		return E_NOTIMPL;
+	}
+
+	return S_OK;
+}
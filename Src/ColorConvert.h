@@ -0,0 +1,49 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Motoharu Tsubaki.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a 
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+// color conversion of an output line, fused into the resize so that only
+// the resized lines are converted.
+//  pDst     : output line
+//  pSrc     : resized line in the input format
+//  nCount   : number of pixels, even for packed YUV
+typedef void (*PFN_CONVERT_LINE)(LPBYTE pDst, const BYTE* pSrc, int nCount);
+
+// converter from the sub type to the other for the given SIMD_XXX flags,
+// E_NOTIMPL if there is none.
+HRESULT GetConvertLine(const GUID* pFromSubtype, const GUID* pToSubtype,
+					   DWORD dwSimdFlags, PFN_CONVERT_LINE* ppfnConvert);
+
+// the alpha formats to premultiplied ARGB32 and back, for the kernels that
+// interpolate the pixels. the colors are clamped to the alpha on the way
+// back. E_NOTIMPL for the formats without alpha.
+HRESULT GetPremultiplyLine(const GUID* pSubtype, DWORD dwSimdFlags,
+						   PFN_CONVERT_LINE* ppfnPremultiply,
+						   PFN_CONVERT_LINE* ppfnUnpremultiply);
+
+// copier of the pixel size with non-temporal stores, which bypass the
+// cache for the frames that don't fit in it. E_NOTIMPL without SSE2.
+// _mm_sfence() after the lines are copied.
+HRESULT GetStreamLine(int nBytesPerPixel, DWORD dwSimdFlags,
+					  PFN_CONVERT_LINE* ppfnStream);
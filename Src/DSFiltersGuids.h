@@ -25,6 +25,15 @@
 #define __DSFILTERS_GUIDS_H__
 
 
+///////////////////////////////////////////////////////////////////////////////
+// Media sub types
+
+// I420, which isn't in uuids.h
+// {30323449-0000-0010-8000-00AA00389B71}
+DEFINE_GUID(MEDIASUBTYPE_I420,
+0x30323449, 0x0000, 0x0010, 0x80, 0x00, 0x00, 0xaa, 0x00, 0x38, 0x9b, 0x71);
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // Debug/Monitor
 
@@ -42,12 +51,33 @@ DEFINE_GUID(CLSID_MediaSampleMonitor,
 DEFINE_GUID(CLSID_VideoResizer,
 0xd115e8ce, 0xc27d, 0x4cf8, 0xaf, 0x94, 0x10, 0x27, 0x16, 0xf0, 0x67, 0x72);
 
+// IVideoResizerConfig
+// {DE024825-9877-48D4-BE0A-C9DD3D235690}
+DEFINE_GUID(IID_IVideoResizerConfig,
+0xde024825, 0x9877, 0x48d4, 0xbe, 0xa, 0xc9, 0xdd, 0x3d, 0x23, 0x56, 0x90);
+
+
+// Video Pyramid
+// {25165D43-6BAF-43FF-ABA2-A8933938C983}
+DEFINE_GUID(CLSID_VideoPyramid,
+0x25165d43, 0x6baf, 0x43ff, 0xab, 0xa2, 0xa8, 0x93, 0x39, 0x38, 0xc9, 0x83);
+
+// IVideoPyramidConfig
+// {AEBA1BDF-E8DB-453A-993B-49885CB718C9}
+DEFINE_GUID(IID_IVideoPyramidConfig,
+0xaeba1bdf, 0xe8db, 0x453a, 0x99, 0x3b, 0x49, 0x88, 0x5c, 0xb7, 0x18, 0xc9);
+
 
 // Video Mux
 // {7ABCCD4B-ACDF-450e-84C7-D60C97FA31A2}
 DEFINE_GUID(CLSID_VideoMux, 
 0x7abccd4b, 0xacdf, 0x450e, 0x84, 0xc7, 0xd6, 0xc, 0x97, 0xfa, 0x31, 0xa2);
 
+// IVideoMuxConfig
+// {AE3BAF70-9DA9-47F9-B63F-E022E10F962E}
+DEFINE_GUID(IID_IVideoMuxConfig,
+0xae3baf70, 0x9da9, 0x47f9, 0xb6, 0x3f, 0xe0, 0x22, 0xe1, 0xf, 0x96, 0x2e);
+
 
 
 ///////////////////////////////////////////////////////////////////////////////
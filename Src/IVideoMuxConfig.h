@@ -0,0 +1,86 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Motoharu Tsubaki.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a 
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+// IVideoMuxConfig
+// layout of the Video Mux. the inputs are tiled in nColumns x nRows
+// cells of nWidth x nHeight, the master in the top left cell and the
+// slaves from left to right, top to bottom. a slave pin is added when all
+// of them are connected, up to nColumns * nRows - 1, and the cells
+// without input are black.
+// the grid can be changed only while the filter is stopped and no pin is
+// connected. the default is 2 x 1, and the cells are MUX_MAX_PINS - 1 at
+// most.
+// SetCellSize sets the size of the cells, which every input must have.
+// it can be changed only while the filter is stopped and no pin is
+// connected, and is 320 x 240 by default.
+// SetMaxSlaveLatency sets how long a slave frame may be kept waiting for
+// the master frame of the nearest time, in 100ns units. by default 0,
+// the master takes the latest frame of each slave. it can be changed only
+// while the filter is stopped, and is VIDEOMUX_MAX_SLAVE_LATENCY at most.
+// GetSlaveStats returns the counters of a slave since the filter started.
+// each counter is read atomically while the streams run, but they are not
+// a snapshot of the same moment.
+// the slaves hand their latest frames to the master without locks, and
+// each of the overlaps is a wait that the threads would have had on a
+// lock. the frames kept for the max latency are handed over under a lock.
+// SetFrameTime sets the output frame time in 100ns units. by default 0,
+// a frame is output for each master sample. otherwise the output pin
+// composes the latest frames of all the inputs on its own thread at
+// this rate, stamped with the stream time, and stripes the cells of the
+// inputs that are stale, which have had no frame for
+// VIDEOMUX_STALE_FRAMES frame times. the output ends when all the
+// connected inputs have ended, and a flush of the inputs pauses it.
+// it can be changed only while the filter is stopped and the output pin
+// is not connected, and is between VIDEOMUX_MIN_FRAME_TIME and
+// VIDEOMUX_MAX_FRAME_TIME.
+// IsInputStale tells if an input is stale, the master being 0 and the
+// slaves from 1.
+#define VIDEOMUX_MAX_SLAVE_LATENCY	(UNITS)
+#define VIDEOMUX_MIN_FRAME_TIME		(UNITS / 1000)
+#define VIDEOMUX_MAX_FRAME_TIME		(UNITS * 10)
+
+typedef struct
+{
+	LONG nReceived;			// samples received
+	LONG nSlaveOverlaps;	// received while the master read the frame
+	LONG nMasterOverlaps;	// read while the slave received a frame
+	LONG nRepeated;			// frames composed again
+	LONG nDropped;			// frames never composed
+} VIDEOMUX_SLAVE_STATS;
+
+DECLARE_INTERFACE_(IVideoMuxConfig, IUnknown)
+{
+	STDMETHOD(SetGrid)(THIS_ int nColumns, int nRows) PURE;
+	STDMETHOD(GetGrid)(THIS_ int* pnColumns, int* pnRows) PURE;
+	STDMETHOD(SetCellSize)(THIS_ int nWidth, int nHeight) PURE;
+	STDMETHOD(GetCellSize)(THIS_ int* pnWidth, int* pnHeight) PURE;
+	STDMETHOD(SetMaxSlaveLatency)(THIS_ REFERENCE_TIME rtLatency) PURE;
+	STDMETHOD(GetMaxSlaveLatency)(THIS_ REFERENCE_TIME* prtLatency) PURE;
+	STDMETHOD(GetSlaveStats)(THIS_ int nSlave, VIDEOMUX_SLAVE_STATS* pStats)
+		PURE;
+	STDMETHOD(SetFrameTime)(THIS_ REFERENCE_TIME rtFrame) PURE;
+	STDMETHOD(GetFrameTime)(THIS_ REFERENCE_TIME* prtFrame) PURE;
+	STDMETHOD(IsInputStale)(THIS_ int nInput, BOOL* pbStale) PURE;
+};
@@ -0,0 +1,42 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Motoharu Tsubaki.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a 
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+// number of the outputs of the Video Pyramid
+#define PYRAMID_LEVELS		(3)
+
+// IVideoPyramidConfig
+// output size of each level of the Video Pyramid.
+// level 0 is the output size of IVideoResizerConfig, whose algorithm,
+// threads and tiling apply to all the levels. each level is scaled from
+// the smallest larger level that isn't converted, or from the input.
+// the size can be changed only while the filter is stopped, and a
+// connected output pin is reconnected with the new size.
+DECLARE_INTERFACE_(IVideoPyramidConfig, IUnknown)
+{
+	STDMETHOD(GetLevelCount)(THIS_ int* pnLevels) PURE;
+	STDMETHOD(SetLevelSize)(THIS_ int nLevel, int nWidth, int nHeight) PURE;
+	STDMETHOD(GetLevelSize)(THIS_ int nLevel, int* pnWidth, int* pnHeight)
+		PURE;
+};
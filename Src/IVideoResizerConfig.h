@@ -0,0 +1,67 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Motoharu Tsubaki.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a 
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+// scaling algorithm
+#define RESIZE_NEAREST		(0)
+#define RESIZE_BILINEAR		(1)
+#define RESIZE_BICUBIC		(2)
+#define RESIZE_LANCZOS2		(3)
+#define RESIZE_LANCZOS3		(4)
+
+// processing order of the output, RESIZE_TILING_ROWS by default
+#define RESIZE_TILING_AUTO		(0)	// tiles and non-temporal stores for
+									// the frames that exceed the cache
+#define RESIZE_TILING_ROWS		(1)	// whole lines in order
+#define RESIZE_TILING_TILES		(2)	// tiles of any frame
+#define RESIZE_TILING_STREAM	(3)	// tiles and non-temporal stores of
+									// any frame
+
+// IVideoResizerConfig
+// output size and scaling of the Video Resizer.
+// the size can be changed only while the filter is stopped, and a
+// connected output pin is reconnected with the new size.
+DECLARE_INTERFACE_(IVideoResizerConfig, IUnknown)
+{
+	STDMETHOD(SetOutputSize)(THIS_ int nWidth, int nHeight) PURE;
+	STDMETHOD(GetOutputSize)(THIS_ int* pnWidth, int* pnHeight) PURE;
+
+	// RESIZE_XXX
+	STDMETHOD(SetAlgorithm)(THIS_ int nAlgorithm) PURE;
+	STDMETHOD(GetAlgorithm)(THIS_ int* pnAlgorithm) PURE;
+
+	// number of worker threads, 0 for one for each processor
+	STDMETHOD(SetThreadCount)(THIS_ int nThreads) PURE;
+	STDMETHOD(GetThreadCount)(THIS_ int* pnThreads) PURE;
+
+	// RESIZE_TILING_XXX
+	STDMETHOD(SetTiling)(THIS_ int nTiling) PURE;
+	STDMETHOD(GetTiling)(THIS_ int* pnTiling) PURE;
+
+	// rect of the input to scale, in top-down coordinates of the input.
+	// NULL or an empty rect for the rcSource of the input type, or the
+	// whole frame. it can be changed between the frames while running.
+	STDMETHOD(SetSourceRect)(THIS_ const RECT* prcSource) PURE;
+	STDMETHOD(GetSourceRect)(THIS_ RECT* prcSource) PURE;
+};
@@ -0,0 +1,173 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Motoharu Tsubaki.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a 
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <streams.h>
+
+#include "RingBuffer.h"
+#include "JitterBuffer.h"
+
+
+// ܂ꂽt[CRingBufferɃ^CX^vtŗ߂āA
+// ǂݍݑ̎Ɉԋ߂t[IԃNXB
+// ubN̏CRingBuffer̃CfbNXƓʒuɎB
+// ubN(nBlockCount)2̏搔łKvB
+
+CJitterBuffer::CJitterBuffer(int cbBlockSize, int nBlockCount)
+	: m_pInfo(NULL)
+	, m_nReading(-1)
+{
+	m_pRing = new CRingBuffer(cbBlockSize, nBlockCount);
+	if (m_pRing && m_pRing->IsValid()) {
+		m_pInfo = new FRAME_INFO[nBlockCount];
+	}
+}
+
+
+CJitterBuffer::~CJitterBuffer()
+{
+	delete m_pRing;
+	delete [] m_pInfo;
+}
+
+
+BOOL CJitterBuffer::IsValid()
+{
+	return m_pRing && m_pRing->IsValid() && m_pInfo;
+}
+
+
+int CJitterBuffer::GetBlockSize()
+{
+	return m_pRing->GetBloskSize();
+}
+
+
+// 擪̃t[̂ĂBI΂Ȃt[Ȃ1Ԃ
+int CJitterBuffer::DropFront()
+{
+	int nIndex = m_pRing->GetDataIndex();
+	ASSERT(nIndex >= 0);
+
+	BYTE* pBuf;
+	m_pRing->Dequeue(&pBuf);
+
+	return m_pInfo[nIndex].bSelected ? 0 : 1;
+}
+
+
+int CJitterBuffer::Write(const BYTE* pBuf, int cbSize, BOOL bTime,
+						 REFERENCE_TIME rtTime, REFERENCE_TIME rtMaxLatency)
+{
+	ASSERT(pBuf);
+
+	CAutoLock lock(&m_csLock);
+
+	int nDropped = 0;
+
+	// ^CX^v߂Ƃ͗߂t[SĎ̂Ă
+	BOOL bFlush = !bTime;
+	if (!bFlush && !m_pRing->IsEmpty()) {
+		int nLast = m_pRing->GetDataIndex(m_pRing->GetDataCount() - 1);
+		bFlush = !m_pInfo[nLast].bTime || m_pInfo[nLast].rtTime > rtTime;
+	}
+
+	while (!m_pRing->IsEmpty()) {
+		int nIndex = m_pRing->GetDataIndex();
+		if (!bFlush && !m_pRing->IsFull() && m_pInfo[nIndex].bTime
+				&& m_pInfo[nIndex].rtTime >= rtTime - rtMaxLatency) {
+			break;
+		}
+		nDropped += DropFront();
+	}
+
+	// ǂݍݒ̃ubN͎̂ĂĂ㏑AVt[̂Ă
+	int nIndex = m_pRing->GetBufferIndex();
+	ASSERT(nIndex >= 0);
+	if (nIndex == m_nReading) {
+		return nDropped + 1;
+	}
+	if (!m_pRing->Enqueue(const_cast<BYTE*>(pBuf), cbSize)) {
+		return nDropped + 1;
+	}
+	m_pInfo[nIndex].bTime = bTime;
+	m_pInfo[nIndex].rtTime = rtTime;
+	m_pInfo[nIndex].bSelected = FALSE;
+
+	return nDropped;
+}
+
+
+// ̃t[̕߂Ԃ͐擪̃t[̂ĂāAc擪IԁB
+// Ƃ͍ŐṼt[IԁB
+// I񂾃t[EndRead܂ŃbNɓǂ߂B
+const BYTE* CJitterBuffer::Select(BOOL bTime, REFERENCE_TIME rtTime,
+								  int* pnDropped, BOOL* pbRepeated)
+{
+	ASSERT(pnDropped && pbRepeated);
+
+	CAutoLock lock(&m_csLock);
+
+	*pnDropped = 0;
+	*pbRepeated = FALSE;
+
+	if (m_pRing->IsEmpty()) {
+		return NULL;
+	}
+
+	while (m_pRing->GetDataCount() >= 2) {
+		const FRAME_INFO& front = m_pInfo[m_pRing->GetDataIndex(0)];
+		const FRAME_INFO& next = m_pInfo[m_pRing->GetDataIndex(1)];
+		if (bTime && front.bTime && next.bTime) {
+			REFERENCE_TIME rtFront = front.rtTime - rtTime;
+			REFERENCE_TIME rtNext = next.rtTime - rtTime;
+			if ((rtNext < 0 ? -rtNext : rtNext)
+					> (rtFront < 0 ? -rtFront : rtFront)) {
+				break;
+			}
+		}
+		*pnDropped += DropFront();
+	}
+
+	m_nReading = m_pRing->GetDataIndex();
+	FRAME_INFO& info = m_pInfo[m_nReading];
+	*pbRepeated = info.bSelected;
+	info.bSelected = TRUE;
+
+	return m_pRing->Peek();
+}
+
+
+// SelectőI񂾃t[̓ǂݍ݂̏I
+void CJitterBuffer::EndRead()
+{
+	CAutoLock lock(&m_csLock);
+	m_nReading = -1;
+}
+
+
+void CJitterBuffer::Clear()
+{
+	CAutoLock lock(&m_csLock);
+	m_pRing->Clear();
+	m_nReading = -1;
+}
@@ -0,0 +1,73 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Motoharu Tsubaki.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a 
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+class CRingBuffer;
+
+// queue of timestamped frames of a writer thread, from which a reader
+// thread picks the frame nearest to its own time. a frame is kept until
+// a newer one is nearer, or it is older than the newest frame by more
+// than the max latency.
+// the reader copies the frame from Select without the lock and calls
+// EndRead after it, and Write doesn't overwrite the frame until then.
+class CJitterBuffer
+{
+public:
+	CJitterBuffer(int cbBlockSize, int nBlockCount);
+	virtual ~CJitterBuffer();
+
+	BOOL IsValid();
+
+	int GetBlockSize();
+
+	// writer
+	// returns the number of frames dropped without being selected
+	int Write(const BYTE* pBuf, int cbSize, BOOL bTime, REFERENCE_TIME rtTime,
+			  REFERENCE_TIME rtMaxLatency);
+
+	// reader
+	// returns NULL until the first frame is written
+	const BYTE* Select(BOOL bTime, REFERENCE_TIME rtTime, int* pnDropped,
+					   BOOL* pbRepeated);
+	void EndRead();
+
+	// while neither the writer nor the reader runs
+	void Clear();
+
+private:
+	int DropFront();
+
+private:
+	struct FRAME_INFO
+	{
+		BOOL bTime;
+		REFERENCE_TIME rtTime;
+		BOOL bSelected;
+	};
+
+	CCritSec m_csLock;
+	CRingBuffer* m_pRing;
+	FRAME_INFO* m_pInfo;
+	int m_nReading;			// block being read, -1 for none
+};
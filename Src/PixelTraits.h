@@ -0,0 +1,267 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Motoharu Tsubaki.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a 
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+// pixel formats of the bitmaps, for the kernels templated on them.
+//  PIXEL          : type of a pixel, copied as a whole
+//  SIZE           : bytes per pixel
+//  CHANNELS       : number of channels
+//  BYTE_CHANNELS  : each channel is a byte, and can be interpolated
+//                   byte by byte
+//  ALPHA          : one of the channels is alpha
+//  X_MASK         : bitfields of the packed pixels, 0 for byte channels
+//
+// packed YUV have 2 pixels of luma and a shared pair of chroma in 4 bytes.
+//  FOURCC         : biCompression
+//  Y_OFFSET       : byte of the luma in each 2 bytes, the chroma are in
+//                   the others
+//
+// planar YUV 4:2:0 have a plane of the luma, and the chroma planes of half
+// the width and height after it.
+//  PLANES         : number of planes
+//  CHROMA_SIZE    : bytes per pixel of the chroma planes
+
+// MEDIASUBTYPE_RGB8
+struct PixelRGB8
+{
+	typedef BYTE PIXEL;
+	static const int SIZE = 1;
+	static const int CHANNELS = 1;
+	static const BOOL BYTE_CHANNELS = FALSE;
+	static const BOOL ALPHA = FALSE;
+	static const DWORD R_MASK = 0;
+	static const DWORD G_MASK = 0;
+	static const DWORD B_MASK = 0;
+	static const DWORD A_MASK = 0;
+};
+
+// MEDIASUBTYPE_RGB565
+struct PixelRGB565
+{
+	typedef WORD PIXEL;
+	static const int SIZE = 2;
+	static const int CHANNELS = 3;
+	static const BOOL BYTE_CHANNELS = FALSE;
+	static const BOOL ALPHA = FALSE;
+	static const DWORD R_MASK = 0xf800;
+	static const DWORD G_MASK = 0x07e0;
+	static const DWORD B_MASK = 0x001f;
+	static const DWORD A_MASK = 0;
+};
+
+// MEDIASUBTYPE_RGB555
+struct PixelRGB555
+{
+	typedef WORD PIXEL;
+	static const int SIZE = 2;
+	static const int CHANNELS = 3;
+	static const BOOL BYTE_CHANNELS = FALSE;
+	static const BOOL ALPHA = FALSE;
+	static const DWORD R_MASK = 0x7c00;
+	static const DWORD G_MASK = 0x03e0;
+	static const DWORD B_MASK = 0x001f;
+	static const DWORD A_MASK = 0;
+};
+
+// MEDIASUBTYPE_ARGB1555
+struct PixelARGB1555
+{
+	typedef WORD PIXEL;
+	static const int SIZE = 2;
+	static const int CHANNELS = 4;
+	static const BOOL BYTE_CHANNELS = FALSE;
+	static const BOOL ALPHA = TRUE;
+	static const DWORD R_MASK = 0x7c00;
+	static const DWORD G_MASK = 0x03e0;
+	static const DWORD B_MASK = 0x001f;
+	static const DWORD A_MASK = 0x8000;
+};
+
+// MEDIASUBTYPE_ARGB4444
+struct PixelARGB4444
+{
+	typedef WORD PIXEL;
+	static const int SIZE = 2;
+	static const int CHANNELS = 4;
+	static const BOOL BYTE_CHANNELS = FALSE;
+	static const BOOL ALPHA = TRUE;
+	static const DWORD R_MASK = 0x0f00;
+	static const DWORD G_MASK = 0x00f0;
+	static const DWORD B_MASK = 0x000f;
+	static const DWORD A_MASK = 0xf000;
+};
+
+// MEDIASUBTYPE_RGB24
+struct PixelRGB24
+{
+	typedef RGBTRIPLE PIXEL;
+	static const int SIZE = 3;
+	static const int CHANNELS = 3;
+	static const BOOL BYTE_CHANNELS = TRUE;
+	static const BOOL ALPHA = FALSE;
+	static const DWORD R_MASK = 0;
+	static const DWORD G_MASK = 0;
+	static const DWORD B_MASK = 0;
+	static const DWORD A_MASK = 0;
+};
+
+// MEDIASUBTYPE_RGB32
+struct PixelRGB32
+{
+	typedef DWORD PIXEL;
+	static const int SIZE = 4;
+	static const int CHANNELS = 4;
+	static const BOOL BYTE_CHANNELS = TRUE;
+	static const BOOL ALPHA = FALSE;
+	static const DWORD R_MASK = 0;
+	static const DWORD G_MASK = 0;
+	static const DWORD B_MASK = 0;
+	static const DWORD A_MASK = 0;
+};
+
+// MEDIASUBTYPE_ARGB32
+struct PixelARGB32
+{
+	typedef DWORD PIXEL;
+	static const int SIZE = 4;
+	static const int CHANNELS = 4;
+	static const BOOL BYTE_CHANNELS = TRUE;
+	static const BOOL ALPHA = TRUE;
+	static const DWORD R_MASK = 0;
+	static const DWORD G_MASK = 0;
+	static const DWORD B_MASK = 0;
+	static const DWORD A_MASK = 0;
+};
+
+// MEDIASUBTYPE_A2R10G10B10
+struct PixelA2R10G10B10
+{
+	typedef DWORD PIXEL;
+	static const int SIZE = 4;
+	static const int CHANNELS = 4;
+	static const BOOL BYTE_CHANNELS = FALSE;
+	static const BOOL ALPHA = TRUE;
+	static const DWORD R_MASK = 0x3ff00000;
+	static const DWORD G_MASK = 0x000ffc00;
+	static const DWORD B_MASK = 0x000003ff;
+	static const DWORD A_MASK = 0xc0000000;
+};
+
+// MEDIASUBTYPE_A2B10G10R10
+struct PixelA2B10G10R10
+{
+	typedef DWORD PIXEL;
+	static const int SIZE = 4;
+	static const int CHANNELS = 4;
+	static const BOOL BYTE_CHANNELS = FALSE;
+	static const BOOL ALPHA = TRUE;
+	static const DWORD R_MASK = 0x000003ff;
+	static const DWORD G_MASK = 0x000ffc00;
+	static const DWORD B_MASK = 0x3ff00000;
+	static const DWORD A_MASK = 0xc0000000;
+};
+
+// MEDIASUBTYPE_YUY2, Y0 U Y1 V
+struct PixelYUY2
+{
+	typedef WORD PIXEL;
+	static const int SIZE = 2;
+	static const int CHANNELS = 3;
+	static const BOOL BYTE_CHANNELS = TRUE;
+	static const BOOL ALPHA = FALSE;
+	static const DWORD FOURCC = MAKEFOURCC('Y', 'U', 'Y', '2');
+	static const int Y_OFFSET = 0;
+};
+
+// MEDIASUBTYPE_UYVY, U Y0 V Y1
+struct PixelUYVY
+{
+	typedef WORD PIXEL;
+	static const int SIZE = 2;
+	static const int CHANNELS = 3;
+	static const BOOL BYTE_CHANNELS = TRUE;
+	static const BOOL ALPHA = FALSE;
+	static const DWORD FOURCC = MAKEFOURCC('U', 'Y', 'V', 'Y');
+	static const int Y_OFFSET = 1;
+};
+
+// MEDIASUBTYPE_NV12, Y plane and interleaved U V plane
+struct PixelNV12
+{
+	static const DWORD FOURCC = MAKEFOURCC('N', 'V', '1', '2');
+	static const int PLANES = 2;
+	static const int CHROMA_SIZE = 2;
+};
+
+// MEDIASUBTYPE_I420, Y U V planes
+struct PixelI420
+{
+	static const DWORD FOURCC = MAKEFOURCC('I', '4', '2', '0');
+	static const int PLANES = 3;
+	static const int CHROMA_SIZE = 1;
+};
+
+// MEDIASUBTYPE_IYUV, same as I420
+struct PixelIYUV
+{
+	static const DWORD FOURCC = MAKEFOURCC('I', 'Y', 'U', 'V');
+	static const int PLANES = 3;
+	static const int CHROMA_SIZE = 1;
+};
+
+// MEDIASUBTYPE_YV12, Y V U planes
+struct PixelYV12
+{
+	static const DWORD FOURCC = MAKEFOURCC('Y', 'V', '1', '2');
+	static const int PLANES = 3;
+	static const int CHROMA_SIZE = 1;
+};
+
+// a plane of the luma, or of U or V
+struct PixelY8
+{
+	typedef BYTE PIXEL;
+	static const int SIZE = 1;
+	static const int CHANNELS = 1;
+	static const BOOL BYTE_CHANNELS = TRUE;
+	static const BOOL ALPHA = FALSE;
+	static const DWORD R_MASK = 0;
+	static const DWORD G_MASK = 0;
+	static const DWORD B_MASK = 0;
+	static const DWORD A_MASK = 0;
+};
+
+// a plane of interleaved U and V
+struct PixelUV88
+{
+	typedef WORD PIXEL;
+	static const int SIZE = 2;
+	static const int CHANNELS = 2;
+	static const BOOL BYTE_CHANNELS = TRUE;
+	static const BOOL ALPHA = FALSE;
+	static const DWORD R_MASK = 0;
+	static const DWORD G_MASK = 0;
+	static const DWORD B_MASK = 0;
+	static const DWORD A_MASK = 0;
+};
@@ -0,0 +1,241 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Motoharu Tsubaki.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a 
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <streams.h>
+
+#include "Utils.h"
+#include "PolyphaseFilter.h"
+
+
+CPolyphaseFilter::CPolyphaseFilter()
+	: m_pTable(NULL)
+	, m_nWorkers(0)
+	, m_pRowCache(NULL)
+	, m_pRowLine(NULL)
+	, m_ppRows(NULL)
+	, m_pfnGetLine(NULL)
+	, m_nInBytesPerPixel(0)
+	, m_pSrcLineBuf(NULL)
+	, m_pfnPutLine(NULL)
+	, m_nOutBytesPerPixel(0)
+	, m_pLineBuf(NULL)
+	, m_bPrefetch(FALSE)
+	, m_pfnH(NULL)
+	, m_pfnHC(NULL)
+	, m_pfnV(NULL)
+{
+}
+
+
+CPolyphaseFilter::~CPolyphaseFilter()
+{
+	FreeCache();
+}
+
+
+void CPolyphaseFilter::FreeCache()
+{
+	delete [] m_pRowCache;
+	delete [] m_pRowLine;
+	delete [] m_ppRows;
+	delete [] m_pSrcLineBuf;
+	delete [] m_pLineBuf;
+	m_pRowCache = NULL;
+	m_pRowLine = NULL;
+	m_ppRows = NULL;
+	m_pSrcLineBuf = NULL;
+	m_pLineBuf = NULL;
+
+	m_pTable = NULL;
+}
+
+
+HRESULT CPolyphaseFilter::Setup(const CScaleTable* pTable,
+								const RESIZE_KERNELS* pKernels,
+								PFN_CONVERT_LINE pfnGetLine,
+								int nInBytesPerPixel,
+								PFN_CONVERT_LINE pfnPutLine,
+								int nOutBytesPerPixel, BOOL bPrefetch,
+								int nWorkers)
+{
+	ASSERT(pTable);
+	ASSERT(pKernels);
+	ASSERT(nWorkers > 0);
+
+	FreeCache();
+
+	const SCALE_TABLE_KEY& key = pTable->m_Key;
+	m_pfnH = pKernels->pfnPolyphaseH;
+	m_pfnHC = pKernels->pfnPolyphaseHC;
+	m_pfnHYUV = pKernels->pfnPolyphaseHYUV;
+	m_pfnV = pKernels->pfnPolyphaseV;
+	if ((m_pfnHC == NULL && m_pfnHYUV == NULL) || m_pfnV == NULL) {
+		return E_INVALIDARG;
+	}
+
+	// a spare value for the SIMD
+	int nCacheLines = pTable->m_nHTaps * nWorkers;
+	m_pRowCache = new short[(key.nDstWidth * key.nBytesPerPixel + 1)
+															* nCacheLines];
+	m_pRowLine = new int[nCacheLines];
+	m_ppRows = new const short*[nCacheLines];
+	if (m_pRowCache == NULL || m_pRowLine == NULL || m_ppRows == NULL) {
+		FreeCache();
+		return E_OUTOFMEMORY;
+	}
+
+	m_pfnGetLine = pfnGetLine;
+	m_nInBytesPerPixel = nInBytesPerPixel;
+	if (pfnGetLine) {
+		m_pSrcLineBuf = new BYTE[key.nSrcWidth * key.nBytesPerPixel
+															* nWorkers];
+		if (m_pSrcLineBuf == NULL) {
+			FreeCache();
+			return E_OUTOFMEMORY;
+		}
+	}
+
+	m_pfnPutLine = pfnPutLine;
+	m_nOutBytesPerPixel = pfnPutLine ? nOutBytesPerPixel : key.nBytesPerPixel;
+	if (pfnPutLine) {
+		m_pLineBuf = new BYTE[key.nDstWidth * key.nBytesPerPixel * nWorkers];
+		if (m_pLineBuf == NULL) {
+			FreeCache();
+			return E_OUTOFMEMORY;
+		}
+	}
+
+	m_pTable = pTable;
+	m_bPrefetch = bPrefetch;
+	m_nWorkers = nWorkers;
+
+	return S_OK;
+}
+
+
+void CPolyphaseFilter::Scale(LPBYTE pDstBuf, int nDstStride,
+							 const BYTE* pSrcBuf, int nSrcStride,
+							 int nWorker, int nStartLine, int nEndLine,
+							 int nStartX, int nEndX)
+{
+	ASSERT(m_pTable);
+	ASSERT(m_pfnHC || m_pfnHYUV);
+	ASSERT(m_pfnV);
+	ASSERT(nWorker < m_nWorkers);
+	ASSERT(0 <= nStartX && nStartX < nEndX);
+
+	const CScaleTable* pTable = m_pTable;
+	int nBytesPerPixel = pTable->m_Key.nBytesPerPixel;
+	int nToWidth = pTable->m_Key.nDstWidth;
+	int nWTaps = pTable->m_nWTaps;
+	int nHTaps = pTable->m_nHTaps;
+	int nCount = nToWidth * nBytesPerPixel;
+	int cbRow = nCount + 1;
+
+	// the columns, the entries of a pixel are 2 for packed YUV
+	int nEntries = pTable->m_nWEntries / nToWidth;
+	const ULONG* pWStart = pTable->m_pWScale + nStartX * nEntries;
+	const short* pWCoef = pTable->m_pWCoef + nStartX * nEntries * nWTaps;
+	int nWidth = nEndX - nStartX;
+	int nOffset = nStartX * nBytesPerPixel;
+	int nSimdCount = m_pfnH ? min(pTable->m_nSimdCount, nEndX) - nStartX : 0;
+	nSimdCount = max(nSimdCount, 0);
+
+	// the source bytes of the columns, the chroma of packed YUV are 4 bytes
+	// apart
+	int nSpanStart = pWStart[0];
+	int cbSpan = pWStart[nWidth * nEntries - 1] - nSpanStart
+									+ nWTaps * max(nBytesPerPixel, 4);
+
+	// the source pixels of the span, converted on load
+	int nLoadStart = nSpanStart / nBytesPerPixel;
+	int nLoadEnd = min((nSpanStart + cbSpan + nBytesPerPixel - 1)
+							/ nBytesPerPixel, pTable->m_Key.nSrcWidth);
+	int cbSrcLine = pTable->m_Key.nSrcWidth * nBytesPerPixel;
+	LPBYTE pSrcLineBuf = m_pSrcLineBuf ? m_pSrcLineBuf + cbSrcLine * nWorker
+									   : NULL;
+
+	// cache of the worker
+	short* pRowCache = m_pRowCache + cbRow * nHTaps * nWorker;
+	int* pRowLine = m_pRowLine + nHTaps * nWorker;
+	const short** ppRows = m_ppRows + nHTaps * nWorker;
+	LPBYTE pLineBuf = m_pLineBuf ? m_pLineBuf + nCount * nWorker + nOffset
+								 : NULL;
+
+	for (int i = 0; i < nHTaps; i++) {
+		pRowLine[i] = -1;
+	}
+
+	const short* pHCoef = pTable->m_pHCoef + nHTaps * nStartLine;
+	for (int y = nStartLine; y < nEndLine; y++, pHCoef += nHTaps) {
+		// the first lines only go down, so the lines of one output line
+		// never share a slot
+		for (int t = 0; t < nHTaps; t++) {
+			int nLine = pTable->m_pHScale[y] + t;
+			int i = nLine % nHTaps;
+			short* pRow = pRowCache + cbRow * i + nOffset;
+
+			if (pRowLine[i] != nLine) {
+				const BYTE* pSrcLine = pSrcBuf + nSrcStride * nLine;
+				if (pSrcLineBuf) {
+					m_pfnGetLine(pSrcLineBuf + nLoadStart * nBytesPerPixel,
+								 pSrcLine + nLoadStart * m_nInBytesPerPixel,
+								 nLoadEnd - nLoadStart);
+					pSrcLine = pSrcLineBuf;
+				}
+				if (nSimdCount > 0) {
+					m_pfnH(pRow, pSrcLine, pWStart, pWCoef, nWTaps,
+						   nSimdCount);
+				}
+				if (m_pfnHYUV) {
+					m_pfnHYUV(pRow, pSrcLine, pWStart, pWCoef, nWTaps,
+							  pTable->m_nWChromaTaps, nWidth);
+				} else {
+					m_pfnHC(pRow + nSimdCount * nBytesPerPixel, pSrcLine,
+							pWStart + nSimdCount * nEntries,
+							pWCoef + nSimdCount * nEntries * nWTaps, nWTaps,
+							nWidth - nSimdCount);
+				}
+				pRowLine[i] = nLine;
+			}
+			ppRows[t] = pRow;
+		}
+
+		// the last line of the next output line is the new one
+		if (m_bPrefetch && y + 1 < nEndLine) {
+			int nLine = pTable->m_pHScale[y + 1] + nHTaps - 1;
+			if (pRowLine[nLine % nHTaps] != nLine) {
+				PrefetchSpan(pSrcBuf + nSrcStride * nLine + nSpanStart,
+							 cbSpan);
+			}
+		}
+
+		LPBYTE pDstLine = pDstBuf + nDstStride * y
+							+ nStartX * m_nOutBytesPerPixel;
+		m_pfnV(pLineBuf ? pLineBuf : pDstLine, ppRows, pHCoef, nHTaps,
+			   nWidth * nBytesPerPixel);
+		if (pLineBuf) {
+			m_pfnPutLine(pDstLine, pLineBuf, nWidth);
+		}
+	}
+}
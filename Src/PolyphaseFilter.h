@@ -0,0 +1,87 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Motoharu Tsubaki.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a 
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "ResizeKernels.h"
+#include "ScaleTable.h"
+#include "ColorConvert.h"
+
+// separable polyphase scaler for 8 bit channels.
+// each output pixel (line) has its own phase, i.e. a set of coefficients
+// for the source pixels (lines) around it. the sets are in the scale table
+// of the kernel, source size and destination size.
+// the output lines can be split into bands, and each worker has its own
+// line cache. the output lines can be converted to another format or
+// streamed to the output on the way out.
+class CPolyphaseFilter
+{
+public:
+	CPolyphaseFilter();
+	virtual ~CPolyphaseFilter();
+
+	// the table is referenced until the next Setup(), which is called
+	// again on the change of the table or the workers
+	HRESULT Setup(const CScaleTable* pTable, const RESIZE_KERNELS* pKernels,
+				  PFN_CONVERT_LINE pfnGetLine, int nInBytesPerPixel,
+				  PFN_CONVERT_LINE pfnPutLine, int nOutBytesPerPixel,
+				  BOOL bPrefetch, int nWorkers);
+	// the output columns (nStartX - nEndX) of the lines, a tile
+	void Scale(LPBYTE pDstBuf, int nDstStride,
+			   const BYTE* pSrcBuf, int nSrcStride,
+			   int nWorker, int nStartLine, int nEndLine,
+			   int nStartX, int nEndX);
+
+private:
+	void FreeCache();
+
+private:
+	const CScaleTable* m_pTable;
+	int m_nWorkers;
+
+	// horizontal pass of the vertical taps lines for each worker,
+	// the line n is in (n % taps)
+	short* m_pRowCache;
+	int* m_pRowLine;
+	const short** m_ppRows;
+
+	// a source line of each worker, the span of the columns is converted
+	// from the pixels of nInBytesPerPixel on load
+	PFN_CONVERT_LINE m_pfnGetLine;
+	int m_nInBytesPerPixel;
+	LPBYTE m_pSrcLineBuf;
+
+	// a line of each worker to convert or stream from, to the pixels of
+	// nOutBytesPerPixel
+	PFN_CONVERT_LINE m_pfnPutLine;
+	int m_nOutBytesPerPixel;
+	LPBYTE m_pLineBuf;
+
+	// prefetch of the source lines of the next output line
+	BOOL m_bPrefetch;
+
+	PFN_POLYPHASE_H m_pfnH;
+	PFN_POLYPHASE_H m_pfnHC;
+	PFN_POLYPHASE_H_YUV m_pfnHYUV;
+	PFN_POLYPHASE_V m_pfnV;
+};
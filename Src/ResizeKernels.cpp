@@ -0,0 +1,1570 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Motoharu Tsubaki.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a 
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <streams.h>
+
+#include <emmintrin.h>
+#include <tmmintrin.h>
+
+#include "Utils.h"
+#include "DSFiltersGuids.h"
+#include "PixelTraits.h"
+#include "ResizeKernels.h"
+
+#ifdef USE_AVX2
+#include <immintrin.h>
+#endif
+
+
+#define LOAD_DWORD(p)	(*(const int*)(p))
+#define LOAD_WORD(p)	(*(const WORD*)(p))
+
+
+///////////////////////////////////////////////////////////////////////////////
+// reference
+
+// one pixel at a time, as a whole
+template <class T>
+static void ScaleLine_C(LPBYTE pDst, const BYTE* pSrcLine,
+						const ULONG* pWScale, int nCount)
+{
+	typedef typename T::PIXEL PIXEL;
+
+	PIXEL* pDstPix = (PIXEL*)pDst;
+	for (int x = 0; x < nCount; x++) {
+		pDstPix[x] = *(const PIXEL*)(pSrcLine + pWScale[x]);
+	}
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SSE2 / SSSE3
+
+static __forceinline __m128i Gather4(const BYTE* pSrcLine,
+									 const ULONG* pWScale)
+{
+	return _mm_setr_epi32(LOAD_DWORD(pSrcLine + pWScale[0]),
+						  LOAD_DWORD(pSrcLine + pWScale[1]),
+						  LOAD_DWORD(pSrcLine + pWScale[2]),
+						  LOAD_DWORD(pSrcLine + pWScale[3]));
+}
+
+
+static __forceinline __m128i Gather8W(const BYTE* pSrcLine,
+									  const ULONG* pWScale)
+{
+	__m128i v = _mm_cvtsi32_si128(LOAD_WORD(pSrcLine + pWScale[0]));
+	v = _mm_insert_epi16(v, LOAD_WORD(pSrcLine + pWScale[1]), 1);
+	v = _mm_insert_epi16(v, LOAD_WORD(pSrcLine + pWScale[2]), 2);
+	v = _mm_insert_epi16(v, LOAD_WORD(pSrcLine + pWScale[3]), 3);
+	v = _mm_insert_epi16(v, LOAD_WORD(pSrcLine + pWScale[4]), 4);
+	v = _mm_insert_epi16(v, LOAD_WORD(pSrcLine + pWScale[5]), 5);
+	v = _mm_insert_epi16(v, LOAD_WORD(pSrcLine + pWScale[6]), 6);
+	v = _mm_insert_epi16(v, LOAD_WORD(pSrcLine + pWScale[7]), 7);
+	return v;
+}
+
+
+// pack 4 x 12 bytes (low 12 bytes of each register) into 48 bytes
+static __forceinline void Store48(LPBYTE pDst, __m128i a, __m128i b,
+								  __m128i c, __m128i d)
+{
+	_mm_storeu_si128((__m128i*)(pDst),
+					 _mm_or_si128(a, _mm_slli_si128(b, 12)));
+	_mm_storeu_si128((__m128i*)(pDst + 16),
+					 _mm_or_si128(_mm_srli_si128(b, 4), _mm_slli_si128(c, 8)));
+	_mm_storeu_si128((__m128i*)(pDst + 32),
+					 _mm_or_si128(_mm_srli_si128(c, 8), _mm_slli_si128(d, 4)));
+}
+
+
+static void ScaleLine1_SSE2(LPBYTE pDst, const BYTE* pSrcLine,
+							const ULONG* pWScale, int nCount)
+{
+	int x = 0;
+	for (; x + 16 <= nCount; x += 16) {
+		const ULONG* pW = pWScale + x;
+		__m128i v = _mm_cvtsi32_si128(
+						pSrcLine[pW[0]] | (pSrcLine[pW[1]] << 8));
+		v = _mm_insert_epi16(v, pSrcLine[pW[2]] | (pSrcLine[pW[3]] << 8), 1);
+		v = _mm_insert_epi16(v, pSrcLine[pW[4]] | (pSrcLine[pW[5]] << 8), 2);
+		v = _mm_insert_epi16(v, pSrcLine[pW[6]] | (pSrcLine[pW[7]] << 8), 3);
+		v = _mm_insert_epi16(v, pSrcLine[pW[8]] | (pSrcLine[pW[9]] << 8), 4);
+		v = _mm_insert_epi16(v, pSrcLine[pW[10]] | (pSrcLine[pW[11]] << 8), 5);
+		v = _mm_insert_epi16(v, pSrcLine[pW[12]] | (pSrcLine[pW[13]] << 8), 6);
+		v = _mm_insert_epi16(v, pSrcLine[pW[14]] | (pSrcLine[pW[15]] << 8), 7);
+		_mm_storeu_si128((__m128i*)(pDst + x), v);
+	}
+	ScaleLine_C<PixelRGB8>(pDst + x, pSrcLine, pWScale + x, nCount - x);
+}
+
+
+static void ScaleLine2_SSE2(LPBYTE pDst, const BYTE* pSrcLine,
+							const ULONG* pWScale, int nCount)
+{
+	int x = 0;
+	for (; x + 8 <= nCount; x += 8) {
+		_mm_storeu_si128((__m128i*)(pDst + x * 2),
+						 Gather8W(pSrcLine, pWScale + x));
+	}
+	ScaleLine_C<PixelRGB565>(pDst + x * 2, pSrcLine, pWScale + x, nCount - x);
+}
+
+
+static void ScaleLine3_SSE2(LPBYTE pDst, const BYTE* pSrcLine,
+							const ULONG* pWScale, int nCount)
+{
+	// no byte shuffle before SSSE3, so pack 4 pixels into 3 DWORDs
+	int x = 0;
+	for (; x + 4 <= nCount; x += 4) {
+		const ULONG* pW = pWScale + x;
+		DWORD p0 = LOAD_DWORD(pSrcLine + pW[0]) & 0x00ffffff;
+		DWORD p1 = LOAD_DWORD(pSrcLine + pW[1]) & 0x00ffffff;
+		DWORD p2 = LOAD_DWORD(pSrcLine + pW[2]) & 0x00ffffff;
+		DWORD p3 = LOAD_DWORD(pSrcLine + pW[3]);
+		DWORD* pOut = (DWORD*)(pDst + x * 3);
+		pOut[0] = p0 | (p1 << 24);
+		pOut[1] = (p1 >> 8) | (p2 << 16);
+		pOut[2] = (p2 >> 16) | (p3 << 8);
+	}
+	ScaleLine_C<PixelRGB24>(pDst + x * 3, pSrcLine, pWScale + x, nCount - x);
+}
+
+
+static void ScaleLine3_SSSE3(LPBYTE pDst, const BYTE* pSrcLine,
+							 const ULONG* pWScale, int nCount)
+{
+	const __m128i mask = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10,
+									   12, 13, 14, -1, -1, -1, -1);
+	int x = 0;
+	for (; x + 16 <= nCount; x += 16) {
+		const ULONG* pW = pWScale + x;
+		__m128i a = _mm_shuffle_epi8(Gather4(pSrcLine, pW), mask);
+		__m128i b = _mm_shuffle_epi8(Gather4(pSrcLine, pW + 4), mask);
+		__m128i c = _mm_shuffle_epi8(Gather4(pSrcLine, pW + 8), mask);
+		__m128i d = _mm_shuffle_epi8(Gather4(pSrcLine, pW + 12), mask);
+		Store48(pDst + x * 3, a, b, c, d);
+	}
+	ScaleLine3_SSE2(pDst + x * 3, pSrcLine, pWScale + x, nCount - x);
+}
+
+
+static void ScaleLine4_SSE2(LPBYTE pDst, const BYTE* pSrcLine,
+							const ULONG* pWScale, int nCount)
+{
+	int x = 0;
+	for (; x + 4 <= nCount; x += 4) {
+		_mm_storeu_si128((__m128i*)(pDst + x * 4),
+						 Gather4(pSrcLine, pWScale + x));
+	}
+	ScaleLine_C<PixelRGB32>(pDst + x * 4, pSrcLine, pWScale + x, nCount - x);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// AVX2
+
+#ifdef USE_AVX2
+
+static __forceinline __m256i Gather8(const BYTE* pSrcLine,
+									 const ULONG* pWScale)
+{
+	__m256i idx = _mm256_loadu_si256((const __m256i*)pWScale);
+	return _mm256_i32gather_epi32((const int*)pSrcLine, idx, 1);
+}
+
+
+// low 16 bits of 2 x 8 DWORDs, in order
+static __forceinline __m256i PackLowWords(__m256i a, __m256i b)
+{
+	const __m256i mask = _mm256_set1_epi32(0xffff);
+	__m256i v = _mm256_packus_epi32(_mm256_and_si256(a, mask),
+									_mm256_and_si256(b, mask));
+	return _mm256_permute4x64_epi64(v, 0xd8);
+}
+
+
+static void ScaleLine1_AVX2(LPBYTE pDst, const BYTE* pSrcLine,
+							const ULONG* pWScale, int nCount)
+{
+	const __m256i mask = _mm256_set1_epi32(0xff);
+	int x = 0;
+	for (; x + 16 <= nCount; x += 16) {
+		__m256i a = _mm256_and_si256(Gather8(pSrcLine, pWScale + x), mask);
+		__m256i b = _mm256_and_si256(Gather8(pSrcLine, pWScale + x + 8), mask);
+		__m256i w = _mm256_permute4x64_epi64(_mm256_packus_epi32(a, b), 0xd8);
+		__m128i v = _mm_packus_epi16(_mm256_castsi256_si128(w),
+									 _mm256_extracti128_si256(w, 1));
+		_mm_storeu_si128((__m128i*)(pDst + x), v);
+	}
+	ScaleLine1_SSE2(pDst + x, pSrcLine, pWScale + x, nCount - x);
+}
+
+
+static void ScaleLine2_AVX2(LPBYTE pDst, const BYTE* pSrcLine,
+							const ULONG* pWScale, int nCount)
+{
+	int x = 0;
+	for (; x + 16 <= nCount; x += 16) {
+		__m256i v = PackLowWords(Gather8(pSrcLine, pWScale + x),
+								 Gather8(pSrcLine, pWScale + x + 8));
+		_mm256_storeu_si256((__m256i*)(pDst + x * 2), v);
+	}
+	ScaleLine2_SSE2(pDst + x * 2, pSrcLine, pWScale + x, nCount - x);
+}
+
+
+static void ScaleLine3_AVX2(LPBYTE pDst, const BYTE* pSrcLine,
+							const ULONG* pWScale, int nCount)
+{
+	const __m256i mask = _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10,
+										  12, 13, 14, -1, -1, -1, -1,
+										  0, 1, 2, 4, 5, 6, 8, 9, 10,
+										  12, 13, 14, -1, -1, -1, -1);
+	int x = 0;
+	for (; x + 16 <= nCount; x += 16) {
+		__m256i ab = _mm256_shuffle_epi8(Gather8(pSrcLine, pWScale + x), mask);
+		__m256i cd = _mm256_shuffle_epi8(Gather8(pSrcLine, pWScale + x + 8),
+										 mask);
+		Store48(pDst + x * 3,
+				_mm256_castsi256_si128(ab), _mm256_extracti128_si256(ab, 1),
+				_mm256_castsi256_si128(cd), _mm256_extracti128_si256(cd, 1));
+	}
+	ScaleLine3_SSE2(pDst + x * 3, pSrcLine, pWScale + x, nCount - x);
+}
+
+
+static void ScaleLine4_AVX2(LPBYTE pDst, const BYTE* pSrcLine,
+							const ULONG* pWScale, int nCount)
+{
+	int x = 0;
+	for (; x + 8 <= nCount; x += 8) {
+		_mm256_storeu_si256((__m256i*)(pDst + x * 4),
+							Gather8(pSrcLine, pWScale + x));
+	}
+	ScaleLine4_SSE2(pDst + x * 4, pSrcLine, pWScale + x, nCount - x);
+}
+
+#endif // USE_AVX2
+
+
+///////////////////////////////////////////////////////////////////////////////
+// bilinear
+
+template <class T>
+static void BilinearH_C(short* pDst, const BYTE* pSrcLine,
+						const ULONG* pWScale, const ULONG* pWWeight,
+						int nNext, int nCount)
+{
+	for (int x = 0; x < nCount; x++) {
+		const BYTE* pSrcPtr = pSrcLine + pWScale[x];
+		int w = BILINEAR_WEIGHT(pWWeight[x]);
+		for (int i = 0; i < T::SIZE; i++) {
+			*pDst++ = (short)(pSrcPtr[i] * (128 - w) + pSrcPtr[i + nNext] * w);
+		}
+	}
+}
+
+
+static void BilinearV_C(LPBYTE pDst, const short* pRow0, const short* pRow1,
+						ULONG nWeight, int nCount)
+{
+	int w = BILINEAR_WEIGHT(nWeight);
+	for (int i = 0; i < nCount; i++) {
+		pDst[i] = (BYTE)((pRow0[i] * (128 - w) + pRow1[i] * w + 8192) >> 14);
+	}
+}
+
+
+// one output pixel: the left and right pixels are unpacked to WORDs,
+// multiplied by (128 - w) and w, and the right half is added to the left.
+static __forceinline __m128i BilinearH1(const BYTE* pSrcPtr, int w,
+										__m128i sign, __m128i base)
+{
+	__m128i v = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)pSrcPtr),
+								  _mm_setzero_si128());
+	__m128i weight = _mm_add_epi16(
+						_mm_mullo_epi16(_mm_set1_epi16((short)w), sign), base);
+	return _mm_mullo_epi16(v, weight);
+}
+
+
+static void BilinearH3_SSE2(short* pDst, const BYTE* pSrcLine,
+							const ULONG* pWScale, const ULONG* pWWeight,
+							int nNext, int nCount)
+{
+	const __m128i sign = _mm_setr_epi16(-1, -1, -1, 1, 1, 1, 0, 0);
+	const __m128i base = _mm_setr_epi16(128, 128, 128, 0, 0, 0, 0, 0);
+	for (int x = 0; x < nCount; x++) {
+		__m128i m = BilinearH1(pSrcLine + pWScale[x],
+							   BILINEAR_WEIGHT(pWWeight[x]), sign, base);
+		// 3 values and one more, overwritten by the next pixel
+		_mm_storel_epi64((__m128i*)(pDst + x * 3),
+						 _mm_add_epi16(m, _mm_srli_si128(m, 6)));
+	}
+}
+
+
+static void BilinearH4_SSE2(short* pDst, const BYTE* pSrcLine,
+							const ULONG* pWScale, const ULONG* pWWeight,
+							int nNext, int nCount)
+{
+	const __m128i sign = _mm_setr_epi16(-1, -1, -1, -1, 1, 1, 1, 1);
+	const __m128i base = _mm_setr_epi16(128, 128, 128, 128, 0, 0, 0, 0);
+	for (int x = 0; x < nCount; x++) {
+		__m128i m = BilinearH1(pSrcLine + pWScale[x],
+							   BILINEAR_WEIGHT(pWWeight[x]), sign, base);
+		_mm_storel_epi64((__m128i*)(pDst + x * 4),
+						 _mm_add_epi16(m, _mm_srli_si128(m, 8)));
+	}
+}
+
+
+static __forceinline __m128i BilinearV8(const short* pRow0,
+										const short* pRow1, __m128i w)
+{
+	const __m128i round = _mm_set1_epi32(8192);
+	__m128i a = _mm_loadu_si128((const __m128i*)pRow0);
+	__m128i b = _mm_loadu_si128((const __m128i*)pRow1);
+	__m128i lo = _mm_madd_epi16(_mm_unpacklo_epi16(a, b), w);
+	__m128i hi = _mm_madd_epi16(_mm_unpackhi_epi16(a, b), w);
+	lo = _mm_srai_epi32(_mm_add_epi32(lo, round), 14);
+	hi = _mm_srai_epi32(_mm_add_epi32(hi, round), 14);
+	return _mm_packs_epi32(lo, hi);
+}
+
+
+static void BilinearV_SSE2(LPBYTE pDst, const short* pRow0,
+						   const short* pRow1, ULONG nWeight, int nCount)
+{
+	int w = BILINEAR_WEIGHT(nWeight);
+	const __m128i weight = _mm_set1_epi32((w << 16) | (128 - w));
+	int i = 0;
+	for (; i + 16 <= nCount; i += 16) {
+		__m128i lo = BilinearV8(pRow0 + i, pRow1 + i, weight);
+		__m128i hi = BilinearV8(pRow0 + i + 8, pRow1 + i + 8, weight);
+		_mm_storeu_si128((__m128i*)(pDst + i), _mm_packus_epi16(lo, hi));
+	}
+	BilinearV_C(pDst + i, pRow0 + i, pRow1 + i, nWeight, nCount - i);
+}
+
+
+// pmaddubsw takes unsigned bytes and signed bytes. the weights (0 - 128)
+// are the unsigned side, and the pixels are made signed by subtracting 128,
+// which is added back as 128 * 128 after the sum.
+
+// 4 weights to (128 - w, w) byte pairs in the low WORD of each DWORD
+static __forceinline __m128i BilinearWeight4(const ULONG* pWWeight)
+{
+	__m128i w = _mm_loadu_si128((const __m128i*)pWWeight);
+	w = _mm_srli_epi32(_mm_add_epi32(w, _mm_set1_epi32(0x100)), 9);
+	return _mm_or_si128(_mm_slli_epi32(w, 8),
+						_mm_sub_epi32(_mm_set1_epi32(128), w));
+}
+
+
+// left and right pixels of 2 output pixels, as signed bytes
+static __forceinline __m128i LoadPair2(const BYTE* pSrcLine,
+									   const ULONG* pWScale)
+{
+	__m128i v = _mm_unpacklo_epi64(
+				_mm_loadl_epi64((const __m128i*)(pSrcLine + pWScale[0])),
+				_mm_loadl_epi64((const __m128i*)(pSrcLine + pWScale[1])));
+	return _mm_xor_si128(v, _mm_set1_epi8((char)0x80));
+}
+
+
+static __forceinline __m128i BilinearMadd(__m128i weight, __m128i pix)
+{
+	return _mm_add_epi16(_mm_maddubs_epi16(weight, pix),
+						 _mm_set1_epi16(128 * 128));
+}
+
+
+static void BilinearH3_SSSE3(short* pDst, const BYTE* pSrcLine,
+							 const ULONG* pWScale, const ULONG* pWWeight,
+							 int nNext, int nCount)
+{
+	const __m128i pix = _mm_setr_epi8(0, 3, 1, 4, 2, 5, 8, 11, 9, 12, 10, 13,
+									  -1, -1, -1, -1);
+	const __m128i wlo = _mm_setr_epi8(0, 1, 0, 1, 0, 1, 4, 5, 4, 5, 4, 5,
+									  -1, -1, -1, -1);
+	const __m128i whi = _mm_setr_epi8(8, 9, 8, 9, 8, 9, 12, 13, 12, 13,
+									  12, 13, -1, -1, -1, -1);
+	int x = 0;
+	// the second store writes 2 values past the 4th pixel, so a block is
+	// taken only if another pixel follows it. the last pixel is always left
+	// to SSE2, which writes one value past as the other kernels do.
+	for (; x + 4 < nCount; x += 4) {
+		__m128i w = BilinearWeight4(pWWeight + x);
+		__m128i a = _mm_shuffle_epi8(LoadPair2(pSrcLine, pWScale + x), pix);
+		__m128i b = _mm_shuffle_epi8(LoadPair2(pSrcLine, pWScale + x + 2),
+									 pix);
+		// 6 values each, the last 2 are overwritten by the next store
+		_mm_storeu_si128((__m128i*)(pDst + x * 3),
+						 BilinearMadd(_mm_shuffle_epi8(w, wlo), a));
+		_mm_storeu_si128((__m128i*)(pDst + x * 3 + 6),
+						 BilinearMadd(_mm_shuffle_epi8(w, whi), b));
+	}
+	BilinearH3_SSE2(pDst + x * 3, pSrcLine, pWScale + x, pWWeight + x,
+					nNext, nCount - x);
+}
+
+
+static void BilinearH4_SSSE3(short* pDst, const BYTE* pSrcLine,
+							 const ULONG* pWScale, const ULONG* pWWeight,
+							 int nNext, int nCount)
+{
+	const __m128i pix = _mm_setr_epi8(0, 4, 1, 5, 2, 6, 3, 7,
+									  8, 12, 9, 13, 10, 14, 11, 15);
+	const __m128i wlo = _mm_setr_epi8(0, 1, 0, 1, 0, 1, 0, 1,
+									  4, 5, 4, 5, 4, 5, 4, 5);
+	const __m128i whi = _mm_setr_epi8(8, 9, 8, 9, 8, 9, 8, 9,
+									  12, 13, 12, 13, 12, 13, 12, 13);
+	int x = 0;
+	for (; x + 4 <= nCount; x += 4) {
+		__m128i w = BilinearWeight4(pWWeight + x);
+		__m128i a = _mm_shuffle_epi8(LoadPair2(pSrcLine, pWScale + x), pix);
+		__m128i b = _mm_shuffle_epi8(LoadPair2(pSrcLine, pWScale + x + 2),
+									 pix);
+		_mm_storeu_si128((__m128i*)(pDst + x * 4),
+						 BilinearMadd(_mm_shuffle_epi8(w, wlo), a));
+		_mm_storeu_si128((__m128i*)(pDst + x * 4 + 8),
+						 BilinearMadd(_mm_shuffle_epi8(w, whi), b));
+	}
+	BilinearH4_SSE2(pDst + x * 4, pSrcLine, pWScale + x, pWWeight + x,
+					nNext, nCount - x);
+}
+
+
+// planes of one channel: 8 output pixels, the left and right pixels of
+// each are gathered as a WORD.
+static void BilinearH1_SSSE3(short* pDst, const BYTE* pSrcLine,
+							 const ULONG* pWScale, const ULONG* pWWeight,
+							 int nNext, int nCount)
+{
+	const __m128i wpack = _mm_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13,
+										-1, -1, -1, -1, -1, -1, -1, -1);
+	int x = 0;
+	for (; x + 8 <= nCount; x += 8) {
+		const ULONG* pW = pWScale + x;
+		__m128i v = _mm_cvtsi32_si128(*(const WORD*)(pSrcLine + pW[0]));
+		v = _mm_insert_epi16(v, *(const WORD*)(pSrcLine + pW[1]), 1);
+		v = _mm_insert_epi16(v, *(const WORD*)(pSrcLine + pW[2]), 2);
+		v = _mm_insert_epi16(v, *(const WORD*)(pSrcLine + pW[3]), 3);
+		v = _mm_insert_epi16(v, *(const WORD*)(pSrcLine + pW[4]), 4);
+		v = _mm_insert_epi16(v, *(const WORD*)(pSrcLine + pW[5]), 5);
+		v = _mm_insert_epi16(v, *(const WORD*)(pSrcLine + pW[6]), 6);
+		v = _mm_insert_epi16(v, *(const WORD*)(pSrcLine + pW[7]), 7);
+		v = _mm_xor_si128(v, _mm_set1_epi8((char)0x80));
+		__m128i w = _mm_unpacklo_epi64(
+					_mm_shuffle_epi8(BilinearWeight4(pWWeight + x), wpack),
+					_mm_shuffle_epi8(BilinearWeight4(pWWeight + x + 4), wpack));
+		_mm_storeu_si128((__m128i*)(pDst + x), BilinearMadd(w, v));
+	}
+	BilinearH_C<PixelY8>(pDst + x, pSrcLine, pWScale + x, pWWeight + x,
+						 nNext, nCount - x);
+}
+
+
+// planes of 2 channels: 4 output pixels, the 2 pixels of each are
+// gathered as a DWORD and the channels are paired.
+static void BilinearH2_SSSE3(short* pDst, const BYTE* pSrcLine,
+							 const ULONG* pWScale, const ULONG* pWWeight,
+							 int nNext, int nCount)
+{
+	const __m128i pix = _mm_setr_epi8(0, 2, 1, 3, 4, 6, 5, 7,
+									  8, 10, 9, 11, 12, 14, 13, 15);
+	const __m128i wdup = _mm_setr_epi8(0, 1, 0, 1, 4, 5, 4, 5,
+									   8, 9, 8, 9, 12, 13, 12, 13);
+	int x = 0;
+	for (; x + 4 <= nCount; x += 4) {
+		const ULONG* pW = pWScale + x;
+		__m128i v = _mm_setr_epi32(LOAD_DWORD(pSrcLine + pW[0]),
+								   LOAD_DWORD(pSrcLine + pW[1]),
+								   LOAD_DWORD(pSrcLine + pW[2]),
+								   LOAD_DWORD(pSrcLine + pW[3]));
+		v = _mm_xor_si128(_mm_shuffle_epi8(v, pix),
+						  _mm_set1_epi8((char)0x80));
+		__m128i w = _mm_shuffle_epi8(BilinearWeight4(pWWeight + x), wdup);
+		_mm_storeu_si128((__m128i*)(pDst + x * 2), BilinearMadd(w, v));
+	}
+	BilinearH_C<PixelUV88>(pDst + x * 2, pSrcLine, pWScale + x, pWWeight + x,
+						   nNext, nCount - x);
+}
+
+
+#ifdef USE_AVX2
+
+static __forceinline __m256i BilinearV16(const short* pRow0,
+										 const short* pRow1, __m256i w)
+{
+	const __m256i round = _mm256_set1_epi32(8192);
+	__m256i a = _mm256_loadu_si256((const __m256i*)pRow0);
+	__m256i b = _mm256_loadu_si256((const __m256i*)pRow1);
+	__m256i lo = _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), w);
+	__m256i hi = _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), w);
+	lo = _mm256_srai_epi32(_mm256_add_epi32(lo, round), 14);
+	hi = _mm256_srai_epi32(_mm256_add_epi32(hi, round), 14);
+	return _mm256_packs_epi32(lo, hi);
+}
+
+
+static void BilinearV_AVX2(LPBYTE pDst, const short* pRow0,
+						   const short* pRow1, ULONG nWeight, int nCount)
+{
+	int w = BILINEAR_WEIGHT(nWeight);
+	const __m256i weight = _mm256_set1_epi32((w << 16) | (128 - w));
+	int i = 0;
+	for (; i + 32 <= nCount; i += 32) {
+		// unpack and pack work in 128 bit lanes, so the order is kept
+		__m256i lo = BilinearV16(pRow0 + i, pRow1 + i, weight);
+		__m256i hi = BilinearV16(pRow0 + i + 16, pRow1 + i + 16, weight);
+		__m256i v = _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi),
+											 0xd8);
+		_mm256_storeu_si256((__m256i*)(pDst + i), v);
+	}
+	BilinearV_SSE2(pDst + i, pRow0 + i, pRow1 + i, nWeight, nCount - i);
+}
+
+#endif // USE_AVX2
+
+
+///////////////////////////////////////////////////////////////////////////////
+// polyphase
+
+template <class T>
+static void PolyphaseH_C(short* pDst, const BYTE* pSrcLine,
+						 const ULONG* pWStart, const short* pWCoef,
+						 int nTaps, int nCount)
+{
+	for (int x = 0; x < nCount; x++, pWCoef += nTaps) {
+		const BYTE* pSrcPtr = pSrcLine + pWStart[x];
+		for (int c = 0; c < T::SIZE; c++) {
+			int sum = 0;
+			for (int t = 0; t < nTaps; t++) {
+				sum += pSrcPtr[t * T::SIZE + c] * pWCoef[t];
+			}
+			*pDst++ = (short)((sum + 128) >> 8);
+		}
+	}
+}
+
+
+static __forceinline BYTE PolyphaseV1(const short* const* ppRows,
+									  const short* pHCoef, int nTaps, int i)
+{
+	int sum = 1 << 19;
+	for (int t = 0; t < nTaps; t++) {
+		sum += ppRows[t][i] * pHCoef[t];
+	}
+	sum >>= 20;
+	return (BYTE)((sum < 0) ? 0 : (sum > 255) ? 255 : sum);
+}
+
+
+static void PolyphaseV_C(LPBYTE pDst, const short* const* ppRows,
+						 const short* pHCoef, int nTaps, int nCount)
+{
+	for (int i = 0; i < nCount; i++) {
+		pDst[i] = PolyphaseV1(ppRows, pHCoef, nTaps, i);
+	}
+}
+
+
+// 2 taps of one output pixel. the pixels are unpacked to WORDs and
+// interleaved by channel, then multiplied by the coefficient pair.
+template <int nPixBytes>
+static __forceinline void PolyphaseH_SSE2(short* pDst, const BYTE* pSrcLine,
+										  const ULONG* pWStart,
+										  const short* pWCoef, int nTaps,
+										  int nCount)
+{
+	const __m128i zero = _mm_setzero_si128();
+	for (int x = 0; x < nCount; x++, pWCoef += nTaps) {
+		const BYTE* pSrcPtr = pSrcLine + pWStart[x];
+		__m128i sum = _mm_set1_epi32(128);
+		for (int t = 0; t < nTaps; t += 2) {
+			__m128i v = _mm_unpacklo_epi8(
+				_mm_loadl_epi64((const __m128i*)(pSrcPtr + t * nPixBytes)),
+				zero);
+			v = _mm_unpacklo_epi16(v, _mm_srli_si128(v, nPixBytes * 2));
+			sum = _mm_add_epi32(sum, _mm_madd_epi16(v,
+							_mm_set1_epi32(LOAD_DWORD(pWCoef + t))));
+		}
+		sum = _mm_srai_epi32(sum, 8);
+		_mm_storel_epi64((__m128i*)(pDst + x * nPixBytes),
+						 _mm_packs_epi32(sum, sum));
+	}
+}
+
+
+static void PolyphaseH3_SSE2(short* pDst, const BYTE* pSrcLine,
+							 const ULONG* pWStart, const short* pWCoef,
+							 int nTaps, int nCount)
+{
+	// the 4th value is overwritten by the next pixel
+	PolyphaseH_SSE2<3>(pDst, pSrcLine, pWStart, pWCoef, nTaps, nCount);
+}
+
+
+static void PolyphaseH4_SSE2(short* pDst, const BYTE* pSrcLine,
+							 const ULONG* pWStart, const short* pWCoef,
+							 int nTaps, int nCount)
+{
+	PolyphaseH_SSE2<4>(pDst, pSrcLine, pWStart, pWCoef, nTaps, nCount);
+}
+
+
+// planes of one channel: the taps are consecutive pixels, so 8 taps are
+// multiplied at a time without interleaving. the rest is done by 4 and 2,
+// nothing is read past the taps or the coefficients.
+static void PolyphaseH1_SSE2(short* pDst, const BYTE* pSrcLine,
+							 const ULONG* pWStart, const short* pWCoef,
+							 int nTaps, int nCount)
+{
+	const __m128i zero = _mm_setzero_si128();
+	for (int x = 0; x < nCount; x++, pWCoef += nTaps) {
+		const BYTE* pSrcPtr = pSrcLine + pWStart[x];
+		__m128i sum = zero;
+		int t = 0;
+		for (; t + 8 <= nTaps; t += 8) {
+			__m128i v = _mm_unpacklo_epi8(
+						_mm_loadl_epi64((const __m128i*)(pSrcPtr + t)), zero);
+			sum = _mm_add_epi32(sum, _mm_madd_epi16(v,
+						_mm_loadu_si128((const __m128i*)(pWCoef + t))));
+		}
+		if (t + 4 <= nTaps) {
+			__m128i v = _mm_unpacklo_epi8(
+						_mm_cvtsi32_si128(LOAD_DWORD(pSrcPtr + t)), zero);
+			sum = _mm_add_epi32(sum, _mm_madd_epi16(v,
+						_mm_loadl_epi64((const __m128i*)(pWCoef + t))));
+			t += 4;
+		}
+		if (t < nTaps) {
+			__m128i v = _mm_unpacklo_epi8(
+						_mm_cvtsi32_si128(*(const WORD*)(pSrcPtr + t)), zero);
+			sum = _mm_add_epi32(sum, _mm_madd_epi16(v,
+						_mm_cvtsi32_si128(LOAD_DWORD(pWCoef + t))));
+		}
+		sum = _mm_add_epi32(sum, _mm_srli_si128(sum, 8));
+		sum = _mm_add_epi32(sum, _mm_srli_si128(sum, 4));
+		pDst[x] = (short)((_mm_cvtsi128_si32(sum) + 128) >> 8);
+	}
+}
+
+
+// planes of 2 channels: 4 taps at a time, the channels are paired by
+// pshuflw/pshufhw and the coefficient pairs are repeated for each channel.
+static void PolyphaseH2_SSE2(short* pDst, const BYTE* pSrcLine,
+							 const ULONG* pWStart, const short* pWCoef,
+							 int nTaps, int nCount)
+{
+	const __m128i zero = _mm_setzero_si128();
+	for (int x = 0; x < nCount; x++, pWCoef += nTaps) {
+		const BYTE* pSrcPtr = pSrcLine + pWStart[x];
+		__m128i sum = zero;
+		int t = 0;
+		for (; t + 4 <= nTaps; t += 4) {
+			__m128i v = _mm_unpacklo_epi8(
+						_mm_loadl_epi64((const __m128i*)(pSrcPtr + t * 2)),
+						zero);
+			v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0xd8), 0xd8);
+			__m128i c = _mm_loadl_epi64((const __m128i*)(pWCoef + t));
+			sum = _mm_add_epi32(sum,
+						_mm_madd_epi16(v, _mm_unpacklo_epi32(c, c)));
+		}
+		if (t < nTaps) {
+			__m128i v = _mm_unpacklo_epi8(
+						_mm_cvtsi32_si128(LOAD_DWORD(pSrcPtr + t * 2)), zero);
+			v = _mm_shufflelo_epi16(v, 0xd8);
+			__m128i c = _mm_cvtsi32_si128(LOAD_DWORD(pWCoef + t));
+			sum = _mm_add_epi32(sum,
+						_mm_madd_epi16(v, _mm_unpacklo_epi32(c, c)));
+		}
+		sum = _mm_add_epi32(sum, _mm_srli_si128(sum, 8));
+		sum = _mm_srai_epi32(_mm_add_epi32(sum, _mm_set1_epi32(128)), 8);
+		sum = _mm_packs_epi32(sum, sum);
+		*(int*)(pDst + x * 2) = _mm_cvtsi128_si32(sum);
+	}
+}
+
+
+static void PolyphaseV_SSE2(LPBYTE pDst, const short* const* ppRows,
+							const short* pHCoef, int nTaps, int nCount)
+{
+	const __m128i round = _mm_set1_epi32(1 << 19);
+	int i = 0;
+	for (; i + 8 <= nCount; i += 8) {
+		__m128i lo = round;
+		__m128i hi = round;
+		int t = 0;
+		for (; t + 2 <= nTaps; t += 2) {
+			__m128i a = _mm_loadu_si128((const __m128i*)(ppRows[t] + i));
+			__m128i b = _mm_loadu_si128((const __m128i*)(ppRows[t + 1] + i));
+			__m128i c = _mm_set1_epi32(LOAD_DWORD(pHCoef + t));
+			lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), c));
+			hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), c));
+		}
+		if (t < nTaps) {
+			// odd number of taps, paired with 0
+			__m128i a = _mm_loadu_si128((const __m128i*)(ppRows[t] + i));
+			__m128i b = _mm_setzero_si128();
+			__m128i c = _mm_set1_epi32((WORD)pHCoef[t]);
+			lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), c));
+			hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), c));
+		}
+		__m128i v = _mm_packs_epi32(_mm_srai_epi32(lo, 20),
+									_mm_srai_epi32(hi, 20));
+		_mm_storel_epi64((__m128i*)(pDst + i), _mm_packus_epi16(v, v));
+	}
+	for (; i < nCount; i++) {
+		pDst[i] = PolyphaseV1(ppRows, pHCoef, nTaps, i);
+	}
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// area average
+
+static void AreaV_C(WORD* pAcc, const BYTE* pSrcLine, int nCount)
+{
+	for (int i = 0; i < nCount; i++) {
+		pAcc[i] = (WORD)(pAcc[i] + pSrcLine[i]);
+	}
+}
+
+
+template <class T>
+static void AreaH_C(DWORD* pSum, const WORD* pAcc, const ULONG* pWStart,
+					const ULONG* pWCount, int nCount)
+{
+	for (int x = 0; x < nCount; x++) {
+		const WORD* pAccPtr = pAcc + pWStart[x];
+		int n = pWCount[x];
+		for (int c = 0; c < T::SIZE; c++) {
+			DWORD sum = 0;
+			for (int i = 0; i < n; i++) {
+				sum += pAccPtr[i * T::SIZE + c];
+			}
+			*pSum++ += sum;
+		}
+	}
+}
+
+
+template <class T>
+static void AreaOut_C(LPBYTE pDst, const DWORD* pSum, const ULONG* pRecip,
+					  int nCount)
+{
+	for (int x = 0; x < nCount; x++) {
+		for (int c = 0; c < T::SIZE; c++) {
+			*pDst++ = (BYTE)((UInt32x32To64(*pSum++, pRecip[x])
+												+ 0x80000000) >> 32);
+		}
+	}
+}
+
+
+static void AreaV_SSE2(WORD* pAcc, const BYTE* pSrcLine, int nCount)
+{
+	const __m128i zero = _mm_setzero_si128();
+	int i = 0;
+	for (; i + 16 <= nCount; i += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i*)(pSrcLine + i));
+		__m128i lo = _mm_loadu_si128((const __m128i*)(pAcc + i));
+		__m128i hi = _mm_loadu_si128((const __m128i*)(pAcc + i + 8));
+		lo = _mm_add_epi16(lo, _mm_unpacklo_epi8(v, zero));
+		hi = _mm_add_epi16(hi, _mm_unpackhi_epi8(v, zero));
+		_mm_storeu_si128((__m128i*)(pAcc + i), lo);
+		_mm_storeu_si128((__m128i*)(pAcc + i + 8), hi);
+	}
+	AreaV_C(pAcc + i, pSrcLine + i, nCount - i);
+}
+
+
+// sums of the pixels of one output pixel, 2 pixels at a time.
+// the channels of the second pixel start at nPixBytes WORDs.
+template <int nPixBytes>
+static __forceinline void AreaH_SSE2(DWORD* pSum, const WORD* pAcc,
+									 const ULONG* pWStart,
+									 const ULONG* pWCount, int nCount)
+{
+	const __m128i zero = _mm_setzero_si128();
+	// only the channels are added to the sums
+	const __m128i mask = (nPixBytes == 3)
+						? _mm_setr_epi32(-1, -1, -1, 0)
+						: _mm_set1_epi32(-1);
+
+	for (int x = 0; x < nCount; x++) {
+		const WORD* pAccPtr = pAcc + pWStart[x];
+		int n = pWCount[x];
+		__m128i sum = zero;
+		int i = 0;
+		for (; i + 2 <= n; i += 2) {
+			__m128i v = _mm_loadu_si128(
+							(const __m128i*)(pAccPtr + i * nPixBytes));
+			sum = _mm_add_epi32(sum, _mm_unpacklo_epi16(v, zero));
+			sum = _mm_add_epi32(sum, _mm_unpacklo_epi16(
+							_mm_srli_si128(v, nPixBytes * 2), zero));
+		}
+		if (i < n) {
+			__m128i v = _mm_loadl_epi64(
+							(const __m128i*)(pAccPtr + i * nPixBytes));
+			sum = _mm_add_epi32(sum, _mm_unpacklo_epi16(v, zero));
+		}
+		__m128i* pSumPtr = (__m128i*)(pSum + x * nPixBytes);
+		sum = _mm_and_si128(sum, mask);
+		_mm_storeu_si128(pSumPtr,
+						 _mm_add_epi32(_mm_loadu_si128(pSumPtr), sum));
+	}
+}
+
+
+static void AreaH3_SSE2(DWORD* pSum, const WORD* pAcc, const ULONG* pWStart,
+						const ULONG* pWCount, int nCount)
+{
+	AreaH_SSE2<3>(pSum, pAcc, pWStart, pWCount, nCount);
+}
+
+
+static void AreaH4_SSE2(DWORD* pSum, const WORD* pAcc, const ULONG* pWStart,
+						const ULONG* pWCount, int nCount)
+{
+	AreaH_SSE2<4>(pSum, pAcc, pWStart, pWCount, nCount);
+}
+
+
+#ifdef USE_AVX2
+
+static void AreaV_AVX2(WORD* pAcc, const BYTE* pSrcLine, int nCount)
+{
+	int i = 0;
+	for (; i + 32 <= nCount; i += 32) {
+		__m256i lo = _mm256_loadu_si256((const __m256i*)(pAcc + i));
+		__m256i hi = _mm256_loadu_si256((const __m256i*)(pAcc + i + 16));
+		lo = _mm256_add_epi16(lo, _mm256_cvtepu8_epi16(
+				_mm_loadu_si128((const __m128i*)(pSrcLine + i))));
+		hi = _mm256_add_epi16(hi, _mm256_cvtepu8_epi16(
+				_mm_loadu_si128((const __m128i*)(pSrcLine + i + 16))));
+		_mm256_storeu_si256((__m256i*)(pAcc + i), lo);
+		_mm256_storeu_si256((__m256i*)(pAcc + i + 16), hi);
+	}
+	AreaV_SSE2(pAcc + i, pSrcLine + i, nCount - i);
+}
+
+#endif // USE_AVX2
+
+
+///////////////////////////////////////////////////////////////////////////////
+// packed YUV
+//
+// the horizontal tables have an entry for each output byte, i.e. 2 for
+// each pixel, with the source byte of the luma or chroma. the luma are
+// 2 bytes apart, and the chroma of the same kind are nNext (4) bytes apart.
+// the vertical passes are the same as the others.
+
+static void ScaleLineYUV_C(LPBYTE pDst, const BYTE* pSrcLine,
+						   const ULONG* pWScale, int nCount)
+{
+	for (int i = 0; i < nCount * 2; i++) {
+		pDst[i] = pSrcLine[pWScale[i]];
+	}
+}
+
+
+template <class T>
+static void BilinearHYUV_C(short* pDst, const BYTE* pSrcLine,
+						   const ULONG* pWScale, const ULONG* pWWeight,
+						   int nNext, int nCount)
+{
+	for (int i = 0; i < nCount * 2; i++) {
+		const BYTE* pSrcPtr = pSrcLine + pWScale[i];
+		int nStep = ((i & 1) == T::Y_OFFSET) ? 2 : nNext;
+		int w = BILINEAR_WEIGHT(pWWeight[i]);
+		pDst[i] = (short)(pSrcPtr[0] * (128 - w) + pSrcPtr[nStep] * w);
+	}
+}
+
+
+template <class T>
+static void PolyphaseHYUV_C(short* pDst, const BYTE* pSrcLine,
+							const ULONG* pWStart, const short* pWCoef,
+							int nLumaTaps, int nChromaTaps, int nCount)
+{
+	for (int i = 0; i < nCount * 2; i++, pWCoef += nLumaTaps) {
+		const BYTE* pSrcPtr = pSrcLine + pWStart[i];
+		BOOL bLuma = ((i & 1) == T::Y_OFFSET);
+		int nStep = bLuma ? 2 : 4;
+		int nTaps = bLuma ? nLumaTaps : nChromaTaps;
+		int sum = 0;
+		for (int t = 0; t < nTaps; t++) {
+			sum += pSrcPtr[t * nStep] * pWCoef[t];
+		}
+		pDst[i] = (short)((sum + 128) >> 8);
+	}
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// 2:10:10:10
+//
+// the channels are unpacked to WORDs in the order of the bits, with the
+// 2 bit alpha repeated to 10 bits, and filtered at 10 bits. the row caches
+// have 4 bits of fraction, and the vertical passes pack the lines back.
+// the layouts differ only in the order of R and B, so both have the same
+// kernels. the offsets of the values in the row caches and the bytes of
+// the lines are the same, 4 for each pixel.
+
+static __forceinline int Unpack10(DWORD p, int c)
+{
+	return (c < 3) ? (p >> (c * 10)) & 0x3ff : (p >> 30) * 0x155;
+}
+
+
+static __forceinline DWORD Pack10(int c0, int c1, int c2, int a)
+{
+	return c0 | (c1 << 10) | (c2 << 20) | ((DWORD)((a * 3 + 512) >> 10) << 30);
+}
+
+
+static __forceinline int Clamp10(int n)
+{
+	return (n < 0) ? 0 : (n > 1023) ? 1023 : n;
+}
+
+
+static void BilinearH10_C(short* pDst, const BYTE* pSrcLine,
+						  const ULONG* pWScale, const ULONG* pWWeight,
+						  int nNext, int nCount)
+{
+	for (int x = 0; x < nCount; x++) {
+		DWORD p0 = *(const DWORD*)(pSrcLine + pWScale[x]);
+		DWORD p1 = *(const DWORD*)(pSrcLine + pWScale[x] + nNext);
+		int w = BILINEAR_WEIGHT(pWWeight[x]);
+		for (int c = 0; c < 4; c++) {
+			*pDst++ = (short)((Unpack10(p0, c) * (128 - w)
+							   + Unpack10(p1, c) * w + 4) >> 3);
+		}
+	}
+}
+
+
+static void BilinearV10_C(LPBYTE pDst, const short* pRow0,
+						  const short* pRow1, ULONG nWeight, int nCount)
+{
+	int w = BILINEAR_WEIGHT(nWeight);
+	DWORD* pDstPix = (DWORD*)pDst;
+	for (int i = 0; i < nCount; i += 4) {
+		int v[4];
+		for (int c = 0; c < 4; c++) {
+			v[c] = (pRow0[i + c] * (128 - w) + pRow1[i + c] * w + 1024) >> 11;
+		}
+		*pDstPix++ = Pack10(v[0], v[1], v[2], v[3]);
+	}
+}
+
+
+static void PolyphaseH10_C(short* pDst, const BYTE* pSrcLine,
+						   const ULONG* pWStart, const short* pWCoef,
+						   int nTaps, int nCount)
+{
+	for (int x = 0; x < nCount; x++, pWCoef += nTaps) {
+		const DWORD* pSrcPix = (const DWORD*)(pSrcLine + pWStart[x]);
+		for (int c = 0; c < 4; c++) {
+			int sum = 0;
+			for (int t = 0; t < nTaps; t++) {
+				sum += Unpack10(pSrcPix[t], c) * pWCoef[t];
+			}
+			*pDst++ = (short)((sum + 512) >> 10);
+		}
+	}
+}
+
+
+static __forceinline DWORD PolyphaseV10Pixel(const short* const* ppRows,
+											 const short* pHCoef, int nTaps,
+											 int i)
+{
+	int v[4];
+	for (int c = 0; c < 4; c++) {
+		int sum = 1 << 17;
+		for (int t = 0; t < nTaps; t++) {
+			sum += ppRows[t][i + c] * pHCoef[t];
+		}
+		v[c] = Clamp10(sum >> 18);
+	}
+	return Pack10(v[0], v[1], v[2], v[3]);
+}
+
+
+static void PolyphaseV10_C(LPBYTE pDst, const short* const* ppRows,
+						   const short* pHCoef, int nTaps, int nCount)
+{
+	for (int i = 0; i < nCount; i += 4) {
+		*(DWORD*)(pDst + i) = PolyphaseV10Pixel(ppRows, pHCoef, nTaps, i);
+	}
+}
+
+
+static void AreaV10_C(WORD* pAcc, const BYTE* pSrcLine, int nCount)
+{
+	for (int i = 0; i < nCount; i += 4) {
+		DWORD p = *(const DWORD*)(pSrcLine + i);
+		for (int c = 0; c < 4; c++) {
+			pAcc[i + c] = (WORD)(pAcc[i + c] + Unpack10(p, c));
+		}
+	}
+}
+
+
+static void AreaOut10_C(LPBYTE pDst, const DWORD* pSum, const ULONG* pRecip,
+						int nCount)
+{
+	DWORD* pDstPix = (DWORD*)pDst;
+	for (int x = 0; x < nCount; x++, pSum += 4) {
+		int v[4];
+		for (int c = 0; c < 4; c++) {
+			v[c] = (int)((UInt32x32To64(pSum[c], pRecip[x])
+												+ 0x80000000) >> 32);
+		}
+		pDstPix[x] = Pack10(v[0], v[1], v[2], v[3]);
+	}
+}
+
+
+// 4 pixels to the WORDs of the channels, 2 pixels in each of the halves
+static __forceinline void Unpack10x4(__m128i pix, __m128i* pLo,
+									 __m128i* pHi)
+{
+	const __m128i mask = _mm_set1_epi32(0x3ff);
+	const __m128i alpha = _mm_set1_epi32(0x155 << 16);
+
+	__m128i c0 = _mm_and_si128(pix, mask);
+	__m128i c1 = _mm_and_si128(_mm_srli_epi32(pix, 10), mask);
+	__m128i c2 = _mm_and_si128(_mm_srli_epi32(pix, 20), mask);
+	__m128i a = _mm_mullo_epi16(_mm_slli_epi32(_mm_srli_epi32(pix, 30), 16),
+								alpha);
+	__m128i c01 = _mm_or_si128(c0, _mm_slli_epi32(c1, 16));
+	__m128i c2a = _mm_or_si128(c2, a);
+	*pLo = _mm_unpacklo_epi32(c01, c2a);
+	*pHi = _mm_unpackhi_epi32(c01, c2a);
+}
+
+
+// 4 pixels of the channels in DWORDs, a pixel in each register, are
+// transposed to the channels and packed
+static __forceinline __m128i Pack10x4(__m128i p0, __m128i p1, __m128i p2,
+									  __m128i p3)
+{
+	__m128i t0 = _mm_unpacklo_epi32(p0, p1);
+	__m128i t1 = _mm_unpacklo_epi32(p2, p3);
+	__m128i t2 = _mm_unpackhi_epi32(p0, p1);
+	__m128i t3 = _mm_unpackhi_epi32(p2, p3);
+	__m128i c0 = _mm_unpacklo_epi64(t0, t1);
+	__m128i c1 = _mm_unpackhi_epi64(t0, t1);
+	__m128i c2 = _mm_unpacklo_epi64(t2, t3);
+	__m128i a = _mm_unpackhi_epi64(t2, t3);
+
+	// (a * 3 + 512) >> 10
+	a = _mm_add_epi32(_mm_add_epi32(a, _mm_slli_epi32(a, 1)),
+					  _mm_set1_epi32(512));
+	a = _mm_srli_epi32(a, 10);
+
+	return _mm_or_si128(_mm_or_si128(c0, _mm_slli_epi32(c1, 10)),
+						_mm_or_si128(_mm_slli_epi32(c2, 20),
+									 _mm_slli_epi32(a, 30)));
+}
+
+
+static __forceinline __m128i Clamp10_SSE2(__m128i v)
+{
+	const __m128i max = _mm_set1_epi32(1023);
+	v = _mm_andnot_si128(_mm_srai_epi32(v, 31), v);
+	__m128i over = _mm_cmpgt_epi32(v, max);
+	return _mm_or_si128(_mm_andnot_si128(over, v), _mm_and_si128(over, max));
+}
+
+
+// 4 pixels at a time, the left and right pixels are interleaved by channel
+// and multiplied by the weight pair of each pixel
+static void BilinearH10_SSE2(short* pDst, const BYTE* pSrcLine,
+							 const ULONG* pWScale, const ULONG* pWWeight,
+							 int nNext, int nCount)
+{
+	const __m128i round = _mm_set1_epi32(4);
+
+	int x = 0;
+	for (; x + 4 <= nCount; x += 4) {
+		__m128i l0, l1, r0, r1;
+		Unpack10x4(Gather4(pSrcLine, pWScale + x), &l0, &l1);
+		Unpack10x4(Gather4(pSrcLine + nNext, pWScale + x), &r0, &r1);
+
+		// (128 - w, w) WORD pairs
+		__m128i w = _mm_loadu_si128((const __m128i*)(pWWeight + x));
+		w = _mm_srli_epi32(_mm_add_epi32(w, _mm_set1_epi32(0x100)), 9);
+		w = _mm_or_si128(_mm_slli_epi32(w, 16),
+						 _mm_sub_epi32(_mm_set1_epi32(128), w));
+
+		__m128i p0 = _mm_madd_epi16(_mm_unpacklo_epi16(l0, r0),
+									_mm_shuffle_epi32(w, 0x00));
+		__m128i p1 = _mm_madd_epi16(_mm_unpackhi_epi16(l0, r0),
+									_mm_shuffle_epi32(w, 0x55));
+		__m128i p2 = _mm_madd_epi16(_mm_unpacklo_epi16(l1, r1),
+									_mm_shuffle_epi32(w, 0xaa));
+		__m128i p3 = _mm_madd_epi16(_mm_unpackhi_epi16(l1, r1),
+									_mm_shuffle_epi32(w, 0xff));
+		p0 = _mm_srai_epi32(_mm_add_epi32(p0, round), 3);
+		p1 = _mm_srai_epi32(_mm_add_epi32(p1, round), 3);
+		p2 = _mm_srai_epi32(_mm_add_epi32(p2, round), 3);
+		p3 = _mm_srai_epi32(_mm_add_epi32(p3, round), 3);
+		_mm_storeu_si128((__m128i*)(pDst + x * 4), _mm_packs_epi32(p0, p1));
+		_mm_storeu_si128((__m128i*)(pDst + x * 4 + 8),
+						 _mm_packs_epi32(p2, p3));
+	}
+
+	BilinearH10_C(pDst + x * 4, pSrcLine, pWScale + x, pWWeight + x, nNext,
+				  nCount - x);
+}
+
+
+static void BilinearV10_SSE2(LPBYTE pDst, const short* pRow0,
+							 const short* pRow1, ULONG nWeight, int nCount)
+{
+	int w = BILINEAR_WEIGHT(nWeight);
+	const __m128i weight = _mm_set1_epi32((w << 16) | (128 - w));
+	const __m128i round = _mm_set1_epi32(1024);
+
+	int i = 0;
+	for (; i + 16 <= nCount; i += 16) {
+		__m128i a0 = _mm_loadu_si128((const __m128i*)(pRow0 + i));
+		__m128i b0 = _mm_loadu_si128((const __m128i*)(pRow1 + i));
+		__m128i a1 = _mm_loadu_si128((const __m128i*)(pRow0 + i + 8));
+		__m128i b1 = _mm_loadu_si128((const __m128i*)(pRow1 + i + 8));
+		__m128i p0 = _mm_madd_epi16(_mm_unpacklo_epi16(a0, b0), weight);
+		__m128i p1 = _mm_madd_epi16(_mm_unpackhi_epi16(a0, b0), weight);
+		__m128i p2 = _mm_madd_epi16(_mm_unpacklo_epi16(a1, b1), weight);
+		__m128i p3 = _mm_madd_epi16(_mm_unpackhi_epi16(a1, b1), weight);
+		p0 = _mm_srai_epi32(_mm_add_epi32(p0, round), 11);
+		p1 = _mm_srai_epi32(_mm_add_epi32(p1, round), 11);
+		p2 = _mm_srai_epi32(_mm_add_epi32(p2, round), 11);
+		p3 = _mm_srai_epi32(_mm_add_epi32(p3, round), 11);
+		_mm_storeu_si128((__m128i*)(pDst + i), Pack10x4(p0, p1, p2, p3));
+	}
+
+	BilinearV10_C(pDst + i, pRow0 + i, pRow1 + i, nWeight, nCount - i);
+}
+
+
+// 2 taps of one output pixel at a time, as the other pixel sizes
+static void PolyphaseH10_SSE2(short* pDst, const BYTE* pSrcLine,
+							  const ULONG* pWStart, const short* pWCoef,
+							  int nTaps, int nCount)
+{
+	for (int x = 0; x < nCount; x++, pWCoef += nTaps) {
+		const BYTE* pSrcPtr = pSrcLine + pWStart[x];
+		__m128i sum = _mm_set1_epi32(512);
+		for (int t = 0; t < nTaps; t += 2) {
+			__m128i v, unused;
+			Unpack10x4(_mm_loadl_epi64((const __m128i*)(pSrcPtr + t * 4)),
+					   &v, &unused);
+			v = _mm_unpacklo_epi16(v, _mm_srli_si128(v, 8));
+			sum = _mm_add_epi32(sum, _mm_madd_epi16(v,
+							_mm_set1_epi32(LOAD_DWORD(pWCoef + t))));
+		}
+		sum = _mm_srai_epi32(sum, 10);
+		_mm_storel_epi64((__m128i*)(pDst + x * 4), _mm_packs_epi32(sum, sum));
+	}
+}
+
+
+static void PolyphaseV10_SSE2(LPBYTE pDst, const short* const* ppRows,
+							  const short* pHCoef, int nTaps, int nCount)
+{
+	const __m128i round = _mm_set1_epi32(1 << 17);
+
+	int i = 0;
+	for (; i + 16 <= nCount; i += 16) {
+		__m128i p[4] = { round, round, round, round };
+		int t = 0;
+		for (; t < nTaps; t += 2) {
+			// odd number of taps, the last one paired with 0
+			BOOL bPair = t + 1 < nTaps;
+			__m128i c = bPair ? _mm_set1_epi32(LOAD_DWORD(pHCoef + t))
+							  : _mm_set1_epi32((WORD)pHCoef[t]);
+			for (int k = 0; k < 2; k++) {
+				__m128i a = _mm_loadu_si128(
+								(const __m128i*)(ppRows[t] + i + k * 8));
+				__m128i b = bPair ? _mm_loadu_si128(
+								(const __m128i*)(ppRows[t + 1] + i + k * 8))
+								  : _mm_setzero_si128();
+				p[k * 2] = _mm_add_epi32(p[k * 2],
+							_mm_madd_epi16(_mm_unpacklo_epi16(a, b), c));
+				p[k * 2 + 1] = _mm_add_epi32(p[k * 2 + 1],
+							_mm_madd_epi16(_mm_unpackhi_epi16(a, b), c));
+			}
+		}
+		for (int k = 0; k < 4; k++) {
+			p[k] = Clamp10_SSE2(_mm_srai_epi32(p[k], 18));
+		}
+		_mm_storeu_si128((__m128i*)(pDst + i),
+						 Pack10x4(p[0], p[1], p[2], p[3]));
+	}
+
+	for (; i < nCount; i += 4) {
+		*(DWORD*)(pDst + i) = PolyphaseV10Pixel(ppRows, pHCoef, nTaps, i);
+	}
+}
+
+
+static void AreaV10_SSE2(WORD* pAcc, const BYTE* pSrcLine, int nCount)
+{
+	int i = 0;
+	for (; i + 16 <= nCount; i += 16) {
+		__m128i lo, hi;
+		Unpack10x4(_mm_loadu_si128((const __m128i*)(pSrcLine + i)), &lo, &hi);
+		__m128i* pAccPtr = (__m128i*)(pAcc + i);
+		_mm_storeu_si128(pAccPtr,
+						 _mm_add_epi16(_mm_loadu_si128(pAccPtr), lo));
+		_mm_storeu_si128(pAccPtr + 1,
+						 _mm_add_epi16(_mm_loadu_si128(pAccPtr + 1), hi));
+	}
+
+	AreaV10_C(pAcc + i, pSrcLine + i, nCount - i);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SIMD implementations by the pixel size
+
+static PFN_SCALE_LINE GetScaleLineSimd(int nBytesPerPixel, DWORD dwSimdFlags)
+{
+#ifdef USE_AVX2
+	if (dwSimdFlags & SIMD_AVX2) {
+		switch (nBytesPerPixel) {
+		case 1:	return ScaleLine1_AVX2;
+		case 2:	return ScaleLine2_AVX2;
+		case 3:	return ScaleLine3_AVX2;
+		case 4:	return ScaleLine4_AVX2;
+		}
+		return NULL;
+	}
+#endif
+
+	if (dwSimdFlags & SIMD_SSE2) {
+		switch (nBytesPerPixel) {
+		case 1:	return ScaleLine1_SSE2;
+		case 2:	return ScaleLine2_SSE2;
+		case 3:
+			return (dwSimdFlags & SIMD_SSSE3)
+						? ScaleLine3_SSSE3 : ScaleLine3_SSE2;
+		case 4:	return ScaleLine4_SSE2;
+		}
+	}
+
+	return NULL;
+}
+
+
+static PFN_BILINEAR_H GetBilinearHSimd(int nBytesPerPixel, DWORD dwSimdFlags)
+{
+	if (dwSimdFlags & SIMD_SSSE3) {
+		switch (nBytesPerPixel) {
+		case 1:	return BilinearH1_SSSE3;
+		case 2:	return BilinearH2_SSSE3;
+		case 3:	return BilinearH3_SSSE3;
+		case 4:	return BilinearH4_SSSE3;
+		}
+	}
+
+	if (dwSimdFlags & SIMD_SSE2) {
+		switch (nBytesPerPixel) {
+		case 3:	return BilinearH3_SSE2;
+		case 4:	return BilinearH4_SSE2;
+		}
+	}
+	return NULL;
+}
+
+
+static PFN_BILINEAR_V GetBilinearVSimd(DWORD dwSimdFlags)
+{
+#ifdef USE_AVX2
+	if (dwSimdFlags & SIMD_AVX2) {
+		return BilinearV_AVX2;
+	}
+#endif
+
+	return (dwSimdFlags & SIMD_SSE2) ? BilinearV_SSE2 : BilinearV_C;
+}
+
+
+static PFN_POLYPHASE_H GetPolyphaseHSimd(int nBytesPerPixel,
+										 DWORD dwSimdFlags)
+{
+	if (dwSimdFlags & SIMD_SSE2) {
+		switch (nBytesPerPixel) {
+		case 1:	return PolyphaseH1_SSE2;
+		case 2:	return PolyphaseH2_SSE2;
+		case 3:	return PolyphaseH3_SSE2;
+		case 4:	return PolyphaseH4_SSE2;
+		}
+	}
+	return NULL;
+}
+
+
+static PFN_POLYPHASE_V GetPolyphaseVSimd(DWORD dwSimdFlags)
+{
+	return (dwSimdFlags & SIMD_SSE2) ? PolyphaseV_SSE2 : PolyphaseV_C;
+}
+
+
+static PFN_AREA_V GetAreaVSimd(DWORD dwSimdFlags)
+{
+#ifdef USE_AVX2
+	if (dwSimdFlags & SIMD_AVX2) {
+		return AreaV_AVX2;
+	}
+#endif
+
+	return (dwSimdFlags & SIMD_SSE2) ? AreaV_SSE2 : AreaV_C;
+}
+
+
+static PFN_AREA_H GetAreaHSimd(int nBytesPerPixel, DWORD dwSimdFlags)
+{
+	if (dwSimdFlags & SIMD_SSE2) {
+		switch (nBytesPerPixel) {
+		case 3:	return AreaH3_SSE2;
+		case 4:	return AreaH4_SSE2;
+		}
+	}
+	return NULL;
+}
+
+
+// kernels of the pixel format T
+template <class T>
+static void SelectKernels(DWORD dwSimdFlags, RESIZE_KERNELS* pKernels)
+{
+	::ZeroMemory(pKernels, sizeof(RESIZE_KERNELS));
+
+	pKernels->nBytesPerPixel = T::SIZE;
+	pKernels->nBitCount = T::SIZE * 8;
+	pKernels->dwCompression = BI_RGB;
+	pKernels->nBlockWidth = 1;
+	pKernels->nBlockHeight = 1;
+	pKernels->nLumaOffset = -1;
+	pKernels->nPlanes = 1;
+	pKernels->bByteChannels = T::BYTE_CHANNELS;
+	pKernels->pfnScaleLine = GetScaleLineSimd(T::SIZE, dwSimdFlags);
+	pKernels->pfnScaleLineC = ScaleLine_C<T>;
+
+	if (T::BYTE_CHANNELS) {
+		pKernels->pfnBilinearH = GetBilinearHSimd(T::SIZE, dwSimdFlags);
+		pKernels->pfnBilinearHC = BilinearH_C<T>;
+		pKernels->pfnBilinearV = GetBilinearVSimd(dwSimdFlags);
+		pKernels->pfnPolyphaseH = GetPolyphaseHSimd(T::SIZE, dwSimdFlags);
+		pKernels->pfnPolyphaseHC = PolyphaseH_C<T>;
+		pKernels->pfnPolyphaseV = GetPolyphaseVSimd(dwSimdFlags);
+		pKernels->pfnAreaV = GetAreaVSimd(dwSimdFlags);
+		pKernels->pfnAreaH = GetAreaHSimd(T::SIZE, dwSimdFlags);
+		if (pKernels->pfnAreaH == NULL) {
+			pKernels->pfnAreaH = AreaH_C<T>;
+		}
+		pKernels->pfnAreaOut = AreaOut_C<T>;
+		pKernels->nAreaMaxLines = AREA_MAX_LINES;
+	}
+}
+
+
+// kernels of the 2:10:10:10 format T. nearest-neighbor copies the pixels,
+// and the others filter the channels unpacked to WORDs.
+template <class T>
+static void Select10Kernels(DWORD dwSimdFlags, RESIZE_KERNELS* pKernels)
+{
+	SelectKernels<T>(dwSimdFlags, pKernels);
+
+	BOOL bSSE2 = (dwSimdFlags & SIMD_SSE2) != 0;
+	pKernels->pfnBilinearH = bSSE2 ? BilinearH10_SSE2 : NULL;
+	pKernels->pfnBilinearHC = BilinearH10_C;
+	pKernels->pfnBilinearV = bSSE2 ? BilinearV10_SSE2 : BilinearV10_C;
+	pKernels->pfnPolyphaseH = bSSE2 ? PolyphaseH10_SSE2 : NULL;
+	pKernels->pfnPolyphaseHC = PolyphaseH10_C;
+	pKernels->pfnPolyphaseV = bSSE2 ? PolyphaseV10_SSE2 : PolyphaseV10_C;
+	pKernels->pfnAreaV = bSSE2 ? AreaV10_SSE2 : AreaV10_C;
+	pKernels->pfnAreaH = GetAreaHSimd(T::SIZE, dwSimdFlags);
+	if (pKernels->pfnAreaH == NULL) {
+		pKernels->pfnAreaH = AreaH_C<T>;
+	}
+	pKernels->pfnAreaOut = AreaOut10_C;
+	pKernels->nAreaMaxLines = AREA_MAX_LINES_10;
+}
+
+
+// alpha formats are interpolated with the kernels of ARGB32 on the lines
+// premultiplied to it
+static void SelectAlphaKernels(const GUID* pSubtype, DWORD dwSimdFlags,
+							   RESIZE_KERNELS* pKernels)
+{
+	if (FAILED(GetPremultiplyLine(pSubtype, dwSimdFlags,
+								  &pKernels->pfnPremultiply,
+								  &pKernels->pfnUnpremultiply))) {
+		return;
+	}
+
+	RESIZE_KERNELS argb;
+	SelectKernels<PixelARGB32>(dwSimdFlags, &argb);
+	pKernels->pfnBilinearH = argb.pfnBilinearH;
+	pKernels->pfnBilinearHC = argb.pfnBilinearHC;
+	pKernels->pfnBilinearV = argb.pfnBilinearV;
+	pKernels->pfnPolyphaseH = argb.pfnPolyphaseH;
+	pKernels->pfnPolyphaseHC = argb.pfnPolyphaseHC;
+	pKernels->pfnPolyphaseV = argb.pfnPolyphaseV;
+	pKernels->pfnAreaV = argb.pfnAreaV;
+	pKernels->pfnAreaH = argb.pfnAreaH;
+	pKernels->pfnAreaOut = argb.pfnAreaOut;
+	pKernels->nAreaMaxLines = argb.nAreaMaxLines;
+}
+
+
+// kernels of the packed YUV format T.
+// the vertical passes are shared with the others, the area average isn't
+// supported.
+template <class T>
+static void SelectYUVKernels(DWORD dwSimdFlags, RESIZE_KERNELS* pKernels)
+{
+	::ZeroMemory(pKernels, sizeof(RESIZE_KERNELS));
+
+	pKernels->nBytesPerPixel = T::SIZE;
+	pKernels->nBitCount = T::SIZE * 8;
+	pKernels->dwCompression = T::FOURCC;
+	pKernels->nBlockWidth = 2;
+	pKernels->nBlockHeight = 1;
+	pKernels->nLumaOffset = T::Y_OFFSET;
+	pKernels->nPlanes = 1;
+	pKernels->bByteChannels = T::BYTE_CHANNELS;
+	pKernels->pfnScaleLineC = ScaleLineYUV_C;
+	pKernels->pfnBilinearHC = BilinearHYUV_C<T>;
+	pKernels->pfnBilinearV = GetBilinearVSimd(dwSimdFlags);
+	pKernels->pfnPolyphaseHYUV = PolyphaseHYUV_C<T>;
+	pKernels->pfnPolyphaseV = GetPolyphaseVSimd(dwSimdFlags);
+}
+
+
+// kernels of the luma plane of the planar YUV format T.
+// the chroma planes are scaled separately by GetPlaneKernels().
+template <class T>
+static void SelectPlanarKernels(DWORD dwSimdFlags, RESIZE_KERNELS* pKernels)
+{
+	SelectKernels<PixelY8>(dwSimdFlags, pKernels);
+
+	pKernels->nBitCount = 12;
+	pKernels->dwCompression = T::FOURCC;
+	pKernels->nBlockWidth = 2;
+	pKernels->nBlockHeight = 2;
+	pKernels->nPlanes = T::PLANES;
+	pKernels->nChromaBytes = T::CHROMA_SIZE;
+}
+
+
+HRESULT GetResizeKernels(const GUID* pSubtype, DWORD dwSimdFlags,
+						 RESIZE_KERNELS* pKernels)
+{
+	CheckPointer(pSubtype, E_POINTER);
+	CheckPointer(pKernels, E_POINTER);
+
+	const GUID& subtype = *pSubtype;
+	if (subtype == MEDIASUBTYPE_RGB8) {
+		SelectKernels<PixelRGB8>(dwSimdFlags, pKernels);
+	} else if (subtype == MEDIASUBTYPE_RGB565) {
+		SelectKernels<PixelRGB565>(dwSimdFlags, pKernels);
+	} else if (subtype == MEDIASUBTYPE_RGB555) {
+		SelectKernels<PixelRGB555>(dwSimdFlags, pKernels);
+	} else if (subtype == MEDIASUBTYPE_ARGB1555) {
+		SelectKernels<PixelARGB1555>(dwSimdFlags, pKernels);
+		SelectAlphaKernels(pSubtype, dwSimdFlags, pKernels);
+	} else if (subtype == MEDIASUBTYPE_ARGB4444) {
+		SelectKernels<PixelARGB4444>(dwSimdFlags, pKernels);
+		SelectAlphaKernels(pSubtype, dwSimdFlags, pKernels);
+	} else if (subtype == MEDIASUBTYPE_RGB24) {
+		SelectKernels<PixelRGB24>(dwSimdFlags, pKernels);
+	} else if (subtype == MEDIASUBTYPE_RGB32) {
+		SelectKernels<PixelRGB32>(dwSimdFlags, pKernels);
+	} else if (subtype == MEDIASUBTYPE_ARGB32) {
+		SelectKernels<PixelARGB32>(dwSimdFlags, pKernels);
+		SelectAlphaKernels(pSubtype, dwSimdFlags, pKernels);
+	} else if (subtype == MEDIASUBTYPE_A2R10G10B10) {
+		Select10Kernels<PixelA2R10G10B10>(dwSimdFlags, pKernels);
+	} else if (subtype == MEDIASUBTYPE_A2B10G10R10) {
+		Select10Kernels<PixelA2B10G10R10>(dwSimdFlags, pKernels);
+	} else if (subtype == MEDIASUBTYPE_YUY2) {
+		SelectYUVKernels<PixelYUY2>(dwSimdFlags, pKernels);
+	} else if (subtype == MEDIASUBTYPE_UYVY) {
+		SelectYUVKernels<PixelUYVY>(dwSimdFlags, pKernels);
+	} else if (subtype == MEDIASUBTYPE_NV12) {
+		SelectPlanarKernels<PixelNV12>(dwSimdFlags, pKernels);
+	} else if (subtype == MEDIASUBTYPE_I420) {
+		SelectPlanarKernels<PixelI420>(dwSimdFlags, pKernels);
+	} else if (subtype == MEDIASUBTYPE_IYUV) {
+		SelectPlanarKernels<PixelIYUV>(dwSimdFlags, pKernels);
+	} else if (subtype == MEDIASUBTYPE_YV12) {
+		SelectPlanarKernels<PixelYV12>(dwSimdFlags, pKernels);
+	} else {
+		::ZeroMemory(pKernels, sizeof(RESIZE_KERNELS));
+		pKernels->nLumaOffset = -1;
+		return E_INVALIDARG;
+	}
+
+	return S_OK;
+}
+
+
+HRESULT GetPlaneKernels(int nBytesPerPixel, DWORD dwSimdFlags,
+						RESIZE_KERNELS* pKernels)
+{
+	CheckPointer(pKernels, E_POINTER);
+
+	switch (nBytesPerPixel) {
+	case 1:
+		SelectKernels<PixelY8>(dwSimdFlags, pKernels);
+		break;
+	case 2:
+		SelectKernels<PixelUV88>(dwSimdFlags, pKernels);
+		break;
+	default:
+		return E_INVALIDARG;
+	}
+
+	return S_OK;
+}
+
+
+// a cache line at a time
+void PrefetchSpan(const BYTE* p, int cb)
+{
+	for (int i = 0; i < cb; i += 64) {
+		_mm_prefetch((const char*)p + i, _MM_HINT_T0);
+	}
+}
@@ -0,0 +1,179 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Motoharu Tsubaki.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a 
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "ColorConvert.h"
+
+// nearest-neighbor line scaler
+//  pDst     : top of the output line
+//  pSrcLine : top of the input line
+//  pWScale  : byte offsets into the input line (CVideoResizeBase::m_pWScale)
+//  nCount   : number of output pixels
+typedef void (*PFN_SCALE_LINE)(LPBYTE pDst, const BYTE* pSrcLine,
+							   const ULONG* pWScale, int nCount);
+
+
+
+// bilinear, horizontal pass
+//  pDst     : row cache, nCount * nBytesPerPixel values of
+//             (left * (128 - w) + right * w)
+//  pWScale  : byte offsets of the left pixels
+//  pWWeight : 16.16 weights of the right pixels
+//  nNext    : byte distance to the right pixel (0 for 1 pixel wide input)
+typedef void (*PFN_BILINEAR_H)(short* pDst, const BYTE* pSrcLine,
+							   const ULONG* pWScale, const ULONG* pWWeight,
+							   int nNext, int nCount);
+
+// bilinear, vertical pass
+//  pDst     : output line
+//  pRow0    : horizontal pass of the upper line
+//  pRow1    : horizontal pass of the lower line
+//  nWeight  : 16.16 weight of the lower line
+//  nCount   : number of values (pixels * bytes per pixel)
+typedef void (*PFN_BILINEAR_V)(LPBYTE pDst, const short* pRow0,
+							   const short* pRow1, ULONG nWeight, int nCount);
+
+// 7 bit weight from 16.16
+#define BILINEAR_WEIGHT(w)	((int)(((w) + 0x100) >> 9))
+
+
+
+// polyphase, horizontal pass
+//  pDst     : row cache, nCount * nBytesPerPixel values of the sums >> 8
+//  pWStart  : byte offsets of the first taps
+//  pWCoef   : nTaps coefficients (1.14 fixed point) per output pixel
+typedef void (*PFN_POLYPHASE_H)(short* pDst, const BYTE* pSrcLine,
+								const ULONG* pWStart, const short* pWCoef,
+								int nTaps, int nCount);
+
+// polyphase, horizontal pass of packed YUV
+//  the luma and the chroma have their own taps, and the coefficients of
+//  every output byte are nLumaTaps apart
+typedef void (*PFN_POLYPHASE_H_YUV)(short* pDst, const BYTE* pSrcLine,
+									const ULONG* pWStart, const short* pWCoef,
+									int nLumaTaps, int nChromaTaps,
+									int nCount);
+
+// polyphase, vertical pass
+//  pDst     : output line
+//  ppRows   : horizontal pass of nTaps lines
+//  pHCoef   : nTaps coefficients (1.14 fixed point)
+//  nCount   : number of values (pixels * bytes per pixel)
+typedef void (*PFN_POLYPHASE_V)(LPBYTE pDst, const short* const* ppRows,
+								const short* pHCoef, int nTaps, int nCount);
+
+#define POLYPHASE_BITS		(14)
+
+
+
+// area average, vertical pass: adds a line to the accumulators
+//  pAcc     : nCount WORD accumulators, nAreaMaxLines lines at most
+//  nCount   : number of values (pixels * bytes per pixel)
+typedef void (*PFN_AREA_V)(WORD* pAcc, const BYTE* pSrcLine, int nCount);
+
+// area average, horizontal pass: adds the sums of the accumulators of
+// each output pixel to pSum
+//  pSum     : nCount * nBytesPerPixel sums
+//  pWStart  : offsets of the first pixels in the accumulators
+//  pWCount  : number of pixels of each output pixel
+typedef void (*PFN_AREA_H)(DWORD* pSum, const WORD* pAcc,
+						   const ULONG* pWStart, const ULONG* pWCount,
+						   int nCount);
+
+// area average, output: the sums divided by the number of the pixels
+//  pDst     : output line
+//  pSum     : nCount * nBytesPerPixel sums
+//  pRecip   : 0.32 reciprocals of the number of pixels of each output pixel
+typedef void (*PFN_AREA_OUT)(LPBYTE pDst, const DWORD* pSum,
+							 const ULONG* pRecip, int nCount);
+
+#define AREA_MAX_LINES		(0xffff / 0xff)
+#define AREA_MAX_LINES_10	(0xffff / 0x3ff)
+
+
+
+// kernels of a pixel format for the given SIMD_XXX flags.
+// the functions are NULL where the format has no implementation.
+struct RESIZE_KERNELS
+{
+	int nBytesPerPixel;		// of the first plane
+	int nBitCount;			// biBitCount
+	DWORD dwCompression;	// biCompression of the output
+	int nBlockWidth;		// pixels sharing the chroma, the sizes are
+	int nBlockHeight;		// multiples of them
+	int nLumaOffset;		// packed YUV (see PixelTraits.h), -1 for others
+	int nPlanes;			// planar YUV, 1 for others
+	int nChromaBytes;		// bytes per pixel of the chroma planes
+	BOOL bByteChannels;		// bilinear, polyphase and area average
+
+	// SIMD, reads the input in 4 byte units, so use it only for pixels
+	// that start at least 4 bytes before the end of the input line.
+	PFN_SCALE_LINE pfnScaleLine;
+	// reference, copies one pixel at a time
+	PFN_SCALE_LINE pfnScaleLineC;
+
+	// SIMD, reads 8 bytes from the left pixel and writes one value past
+	// the pixel, so use it only for pixels that start at least 8 bytes
+	// before the end of the input line, and leave one spare value in the
+	// row cache.
+	PFN_BILINEAR_H pfnBilinearH;
+	PFN_BILINEAR_H pfnBilinearHC;
+	PFN_BILINEAR_V pfnBilinearV;
+
+	// SIMD, takes 2 taps at a time with 8 byte loads and writes one value
+	// past the pixel, so use it only for an even number of taps and for
+	// pixels whose last load ends within the input line, and leave one
+	// spare value in the row cache.
+	PFN_POLYPHASE_H pfnPolyphaseH;
+	PFN_POLYPHASE_H pfnPolyphaseHC;
+	PFN_POLYPHASE_V pfnPolyphaseV;
+	// packed YUV, in place of pfnPolyphaseHC
+	PFN_POLYPHASE_H_YUV pfnPolyphaseHYUV;
+
+	// reads up to 4 WORDs past the last pixel and writes one value past
+	// the output pixel, so leave spares in both of the buffers.
+	PFN_AREA_V pfnAreaV;
+	PFN_AREA_H pfnAreaH;
+	PFN_AREA_OUT pfnAreaOut;
+	int nAreaMaxLines;		// lines of the WORD accumulators
+
+	// alpha formats: the colors are interpolated premultiplied by the
+	// alpha, so bilinear, polyphase and area average are those of ARGB32
+	// for the lines premultiplied to it, which are unpremultiplied back to
+	// the format after the scale. NULL for the others.
+	PFN_CONVERT_LINE pfnPremultiply;
+	PFN_CONVERT_LINE pfnUnpremultiply;
+};
+
+// the kernels are instantiated from the pixel traits of the sub type.
+// those of planar YUV are of the luma plane.
+HRESULT GetResizeKernels(const GUID* pSubtype, DWORD dwSimdFlags,
+						 RESIZE_KERNELS* pKernels);
+
+// kernels of a chroma plane of planar YUV
+HRESULT GetPlaneKernels(int nBytesPerPixel, DWORD dwSimdFlags,
+						RESIZE_KERNELS* pKernels);
+
+// loads the bytes of a source line to the cache ahead of the kernels
+void PrefetchSpan(const BYTE* p, int cb);
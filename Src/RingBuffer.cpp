@@ -40,10 +40,10 @@ CRingBuffer::CRingBuffer(int cbBlockSize, int nBlockCount)
 	ASSERT(cbBlockSize > 0);
 	ASSERT(nBlockCount > 0);
 
-	if ((cbBlockSize & (cbBlockSize-1)) == 0) {
-		// nSize2̏搔ł邱
+	if ((nBlockCount & (nBlockCount-1)) == 0) {
+		// nBlockCount2̏搔ł邱
 		m_cbBlockSize = cbBlockSize;
-		m_nMask = cbBlockSize - 1;
+		m_nMask = nBlockCount - 1;
 		m_nBlockCount = nBlockCount;
 
 		// ubNTCYƌŘÄm
@@ -83,10 +83,14 @@ BOOL CRingBuffer::IsFull()
 }
 
 
-int CRingBuffer::GetDataIndex()
+// 擪nPosԖڂ̃f[^̃CfbNX
+int CRingBuffer::GetDataIndex(int nPos)
 {
 	CAutoLock lock(&m_csLock);
-	return IsEmpty() ? -1 : m_nStart;
+	if (nPos < 0 || nPos >= m_nDataCount) {
+		return -1;
+	}
+	return (m_nStart + nPos) & m_nMask;
 }
 
 
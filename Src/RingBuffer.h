@@ -36,7 +36,7 @@ public:
 
 	int GetBloskSize() { return m_cbBlockSize; }
 	int GetBlockCount() { return m_nBlockCount; }
-	int GetDataIndex();
+	int GetDataIndex(int nPos = 0);
 	int GetBufferIndex();
 	int GetDataCount() { return m_nDataCount; }
 
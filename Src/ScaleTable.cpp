@@ -0,0 +1,596 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Motoharu Tsubaki.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a 
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <streams.h>
+#include <math.h>
+
+#include "ResizeKernels.h"
+#include "ScaleTable.h"
+
+
+static const double PI = 3.14159265358979323846;
+
+
+///////////////////////////////////////////////////////////////////////////////
+// process-wide cache
+
+static CCritSec g_csScaleTables;
+static CScaleTable* g_pScaleTables = NULL;
+static DWORD g_dwScaleTableUse = 0;
+
+// frees the cached tables on unload
+static class CScaleTableCleanup
+{
+public:
+	~CScaleTableCleanup() { CScaleTable::FreeCache(); }
+} g_ScaleTableCleanup;
+
+
+///////////////////////////////////////////////////////////////////////////////
+// tables
+
+// the first source pixels (lines) of nDst spans in nUnit bytes, and the
+// number of them. integer DDA of floor(i * nSrc / nDst).
+static void SetupSpanTable(ULONG* pScale, ULONG* pCount,
+						   int nSrc, int nDst, int nUnit)
+{
+	int q = nSrc / nDst;
+	int r = nSrc % nDst;
+	int n = 0;
+	int e = 0;
+
+	for (int i = 0; i < nDst; i++) {
+		int n0 = n;
+		n += q;
+		e += r;
+		if (e >= nDst) {
+			e -= nDst;
+			n++;
+		}
+
+		pScale[i] = n0 * nUnit;
+		if (pCount) {
+			pCount[i] = n - n0;
+		}
+	}
+}
+
+
+// table for bilinear scaling.
+// offsets of the left (upper) pixels and 16.16 weights of the right (lower)
+// pixels, at the centers of the output pixels.
+static void SetupBilinearTable(ULONG* pScale, ULONG* pWeight,
+							   int nSrc, int nDst, int nUnit)
+{
+	LONGLONG step = ((LONGLONG)nSrc << 16) / nDst;
+	LONGLONG pos = step / 2 - 0x8000;
+
+	for (int i = 0; i < nDst; i++, pos += step) {
+		LONGLONG p = (pos < 0) ? 0 : pos;
+		int n = (int)(p >> 16);
+		ULONG w = (ULONG)(p & 0xffff);
+
+		if (n >= nSrc - 1) {
+			// the last pixel
+			n = (nSrc > 1) ? nSrc - 2 : 0;
+			w = (nSrc > 1) ? 0x10000 : 0;
+		}
+
+		pScale[i] = n * nUnit;
+		pWeight[i] = w;
+	}
+}
+
+
+static double Sinc(double x)
+{
+	if (x == 0.0) {
+		return 1.0;
+	}
+	x *= PI;
+	return sin(x) / x;
+}
+
+
+static double KernelRadius(int nAlgorithm)
+{
+	return (nAlgorithm == RESIZE_LANCZOS3) ? 3.0 : 2.0;
+}
+
+
+static double KernelWeight(int nAlgorithm, double x)
+{
+	x = fabs(x);
+
+	switch (nAlgorithm) {
+	case RESIZE_BICUBIC:
+		// Catmull-Rom (a = -0.5)
+		if (x < 1.0) {
+			return (1.5 * x - 2.5) * x * x + 1.0;
+		} else if (x < 2.0) {
+			return ((-0.5 * x + 2.5) * x - 4.0) * x + 2.0;
+		}
+		break;
+	case RESIZE_LANCZOS2:
+		if (x < 2.0) {
+			return Sinc(x) * Sinc(x / 2.0);
+		}
+		break;
+	case RESIZE_LANCZOS3:
+		if (x < 3.0) {
+			return Sinc(x) * Sinc(x / 3.0);
+		}
+		break;
+	}
+
+	return 0.0;
+}
+
+
+// the kernel is stretched by the reduction ratio on downscale
+static double FilterScale(int nSrc, int nDst)
+{
+	return max(1.0, (double)nSrc / nDst);
+}
+
+
+static int CalcTaps(int nAlgorithm, int nSrc, int nDst)
+{
+	int nTaps = (int)ceil(KernelRadius(nAlgorithm) * FilterScale(nSrc, nDst))
+																		* 2;
+	return min(nTaps, nSrc);
+}
+
+
+// nDst sets of nTaps coefficients, and the first source pixels of them in
+// nUnit bytes. taps out of the source are folded into the edge pixels, and
+// taps out of nTaps into the edge taps.
+static void SetupBank(ULONG* pStart, short* pCoef, double* pWork, int nTaps,
+					  int nAlgorithm, int nSrc, int nDst, int nUnit)
+{
+	double step = (double)nSrc / nDst;
+	double scale = FilterScale(nSrc, nDst);
+	int nHalf = (int)ceil(KernelRadius(nAlgorithm) * scale);
+
+	for (int i = 0; i < nDst; i++, pCoef += nTaps) {
+		double center = (i + 0.5) * step - 0.5;
+		int n = (int)floor(center);
+		int nStart = min(max(n - nHalf + 1, 0), nSrc - nTaps);
+
+		for (int t = 0; t < nTaps; t++) {
+			pWork[t] = 0.0;
+		}
+
+		double total = 0.0;
+		for (int s = n - nHalf + 1; s <= n + nHalf; s++) {
+			double w = KernelWeight(nAlgorithm, (s - center) / scale);
+			int t = min(max(s, 0), nSrc - 1) - nStart;
+			pWork[min(max(t, 0), nTaps - 1)] += w;
+			total += w;
+		}
+
+		// the rounding error goes to the largest tap
+		int sum = 0;
+		int nMax = 0;
+		for (int t = 0; t < nTaps; t++) {
+			int c = (int)floor(pWork[t] / total * (1 << POLYPHASE_BITS) + 0.5);
+			pCoef[t] = (short)c;
+			sum += c;
+			if (pWork[t] > pWork[nMax]) {
+				nMax = t;
+			}
+		}
+		pCoef[nMax] = (short)(pCoef[nMax] + (1 << POLYPHASE_BITS) - sum);
+
+		pStart[i] = nStart * nUnit;
+	}
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// CScaleTable
+
+HRESULT CScaleTable::Get(const SCALE_TABLE_KEY* pKey, CScaleTable** ppTable)
+{
+	CheckPointer(pKey, E_POINTER);
+	CheckPointer(ppTable, E_POINTER);
+	ASSERT(pKey->nSrcWidth > 0 && pKey->nSrcHeight > 0);
+	ASSERT(pKey->nDstWidth > 0 && pKey->nDstHeight > 0);
+
+	CAutoLock lock(&g_csScaleTables);
+	g_dwScaleTableUse++;
+
+	CScaleTable* pTable;
+	for (pTable = g_pScaleTables; pTable; pTable = pTable->m_pNext) {
+		if (memcmp(&pTable->m_Key, pKey, sizeof(SCALE_TABLE_KEY)) == 0) {
+			pTable->m_cRef++;
+			pTable->m_dwLastUse = g_dwScaleTableUse;
+			*ppTable = pTable;
+			return S_OK;
+		}
+	}
+
+	pTable = new CScaleTable(pKey);
+	if (pTable == NULL) {
+		return E_OUTOFMEMORY;
+	}
+
+	HRESULT hr = pTable->Build();
+	if (FAILED(hr)) {
+		delete pTable;
+		return hr;
+	}
+
+	pTable->m_cRef = 1;
+	pTable->m_dwLastUse = g_dwScaleTableUse;
+	pTable->m_pNext = g_pScaleTables;
+	g_pScaleTables = pTable;
+
+	*ppTable = pTable;
+	return S_OK;
+}
+
+
+void CScaleTable::Release()
+{
+	CAutoLock lock(&g_csScaleTables);
+
+	ASSERT(m_cRef > 0);
+	if (--m_cRef == 0) {
+		TrimCache();
+	}
+}
+
+
+void CScaleTable::FreeCache()
+{
+	CAutoLock lock(&g_csScaleTables);
+
+	while (g_pScaleTables) {
+		CScaleTable* pTable = g_pScaleTables;
+		g_pScaleTables = pTable->m_pNext;
+		ASSERT(pTable->m_cRef == 0);
+		delete pTable;
+	}
+}
+
+
+// frees the least recently used tables over SCALE_TABLE_CACHE unused ones
+void CScaleTable::TrimCache()
+{
+	for (;;) {
+		int nUnused = 0;
+		CScaleTable** ppOldest = NULL;
+		for (CScaleTable** pp = &g_pScaleTables; *pp; pp = &(*pp)->m_pNext) {
+			if ((*pp)->m_cRef == 0) {
+				nUnused++;
+				if (ppOldest == NULL
+						|| (*pp)->m_dwLastUse < (*ppOldest)->m_dwLastUse) {
+					ppOldest = pp;
+				}
+			}
+		}
+
+		if (nUnused <= SCALE_TABLE_CACHE) {
+			break;
+		}
+
+		CScaleTable* pTable = *ppOldest;
+		*ppOldest = pTable->m_pNext;
+		delete pTable;
+	}
+}
+
+
+CScaleTable::CScaleTable(const SCALE_TABLE_KEY* pKey)
+	: m_Key(*pKey)
+	, m_nWEntries(pKey->nDstWidth)
+	, m_cRef(0)
+	, m_dwLastUse(0)
+	, m_pNext(NULL)
+	, m_pWScale(NULL)
+	, m_pHScale(NULL)
+	, m_pHRepeat(NULL)
+	, m_pWWeight(NULL)
+	, m_pHWeight(NULL)
+	, m_nWNext(0)
+	, m_nHNext(0)
+	, m_pWCount(NULL)
+	, m_pHCount(NULL)
+	, m_pAreaRecip(NULL)
+	, m_nAreaLines(0)
+	, m_nWTaps(0)
+	, m_nWChromaTaps(0)
+	, m_nHTaps(0)
+	, m_pWCoef(NULL)
+	, m_pHCoef(NULL)
+	, m_nSimdCount(0)
+{
+}
+
+
+CScaleTable::~CScaleTable()
+{
+	delete [] m_pWScale;
+	delete [] m_pHScale;
+	delete [] m_pHRepeat;
+	delete [] m_pWWeight;
+	delete [] m_pHWeight;
+	delete [] m_pWCount;
+	delete [] m_pHCount;
+	delete [] m_pAreaRecip;
+	delete [] m_pWCoef;
+	delete [] m_pHCoef;
+}
+
+
+HRESULT CScaleTable::Build()
+{
+	if (m_Key.nLumaOffset >= 0) {
+		// the chroma of 2 pixels, area average isn't supported
+		if ((m_Key.nSrcWidth & 1) || (m_Key.nDstWidth & 1)
+				|| m_Key.nAlgorithm == SCALE_AREA) {
+			return E_INVALIDARG;
+		}
+		m_nWEntries = m_Key.nDstWidth * 2;
+	}
+
+	m_pWScale = new ULONG[m_nWEntries];
+	m_pHScale = new ULONG[m_Key.nDstHeight];
+	if (m_pWScale == NULL || m_pHScale == NULL) {
+		return E_OUTOFMEMORY;
+	}
+
+	switch (m_Key.nAlgorithm) {
+	case RESIZE_NEAREST:	return BuildNearest();
+	case RESIZE_BILINEAR:	return BuildBilinear();
+	case SCALE_AREA:		return BuildArea();
+	case RESIZE_BICUBIC:
+	case RESIZE_LANCZOS2:
+	case RESIZE_LANCZOS3:	return BuildPolyphase();
+	}
+
+	return E_INVALIDARG;
+}
+
+
+HRESULT CScaleTable::BuildNearest()
+{
+	m_pHRepeat = new BYTE[m_Key.nDstHeight];
+	if (m_pHRepeat == NULL) {
+		return E_OUTOFMEMORY;
+	}
+
+	if (m_Key.nLumaOffset >= 0) {
+		int nDstWidth = m_Key.nDstWidth;
+		ULONG* pLuma = new ULONG[nDstWidth + nDstWidth / 2];
+		if (pLuma == NULL) {
+			return E_OUTOFMEMORY;
+		}
+		ULONG* pChroma = pLuma + nDstWidth;
+
+		SetupSpanTable(pLuma, NULL, m_Key.nSrcWidth, nDstWidth, 2);
+		SetupSpanTable(pChroma, NULL, m_Key.nSrcWidth / 2, nDstWidth / 2, 4);
+		InterleaveYUV(m_pWScale, pLuma, pChroma, TRUE);
+		delete [] pLuma;
+	} else {
+		SetupSpanTable(m_pWScale, NULL, m_Key.nSrcWidth, m_Key.nDstWidth,
+					   m_Key.nBytesPerPixel);
+	}
+	SetupSpanTable(m_pHScale, NULL, m_Key.nSrcHeight, m_Key.nDstHeight, 1);
+
+	// the lines repeated on vertical upscale
+	m_pHRepeat[0] = FALSE;
+	for (int y = 1; y < m_Key.nDstHeight; y++) {
+		m_pHRepeat[y] = (m_pHScale[y] == m_pHScale[y - 1]);
+	}
+
+	// 4 byte loads
+	CountSimd(4);
+	return S_OK;
+}
+
+
+HRESULT CScaleTable::BuildBilinear()
+{
+	m_pWWeight = new ULONG[m_nWEntries];
+	m_pHWeight = new ULONG[m_Key.nDstHeight];
+	if (m_pWWeight == NULL || m_pHWeight == NULL) {
+		return E_OUTOFMEMORY;
+	}
+
+	if (m_Key.nLumaOffset >= 0) {
+		// the luma are 2 bytes apart in the source of 2 pixels at least
+		int nDstWidth = m_Key.nDstWidth;
+		int nChroma = nDstWidth / 2;
+		ULONG* pLuma = new ULONG[(nDstWidth + nChroma) * 2];
+		if (pLuma == NULL) {
+			return E_OUTOFMEMORY;
+		}
+		ULONG* pChroma = pLuma + nDstWidth;
+		ULONG* pLumaWeight = pChroma + nChroma;
+		ULONG* pChromaWeight = pLumaWeight + nDstWidth;
+
+		SetupBilinearTable(pLuma, pLumaWeight, m_Key.nSrcWidth, nDstWidth, 2);
+		SetupBilinearTable(pChroma, pChromaWeight, m_Key.nSrcWidth / 2,
+						   nChroma, 4);
+		InterleaveYUV(m_pWScale, pLuma, pChroma, TRUE);
+		InterleaveYUV(m_pWWeight, pLumaWeight, pChromaWeight, FALSE);
+		delete [] pLuma;
+
+		m_nWNext = (m_Key.nSrcWidth > 2) ? 4 : 0;
+	} else {
+		SetupBilinearTable(m_pWScale, m_pWWeight, m_Key.nSrcWidth,
+						   m_Key.nDstWidth, m_Key.nBytesPerPixel);
+		m_nWNext = (m_Key.nSrcWidth > 1) ? m_Key.nBytesPerPixel : 0;
+	}
+	SetupBilinearTable(m_pHScale, m_pHWeight, m_Key.nSrcHeight,
+					   m_Key.nDstHeight, 1);
+	m_nHNext = (m_Key.nSrcHeight > 1) ? 1 : 0;
+
+	// 8 byte loads
+	CountSimd(8);
+	return S_OK;
+}
+
+
+HRESULT CScaleTable::BuildArea()
+{
+	int nDstWidth = m_Key.nDstWidth;
+
+	m_pWCount = new ULONG[nDstWidth];
+	m_pHCount = new ULONG[m_Key.nDstHeight];
+	m_pAreaRecip = new ULONG[nDstWidth * 2];
+	if (m_pWCount == NULL || m_pHCount == NULL || m_pAreaRecip == NULL) {
+		return E_OUTOFMEMORY;
+	}
+
+	SetupSpanTable(m_pWScale, m_pWCount, m_Key.nSrcWidth, nDstWidth,
+				   m_Key.nBytesPerPixel);
+	SetupSpanTable(m_pHScale, m_pHCount, m_Key.nSrcHeight,
+				   m_Key.nDstHeight, 1);
+
+	// the lines are (nSrcHeight / nDstHeight) or one more.
+	m_nAreaLines = m_Key.nSrcHeight / m_Key.nDstHeight;
+	for (int i = 0; i < 2; i++) {
+		for (int x = 0; x < nDstWidth; x++) {
+			ULONGLONG area = m_pWCount[x] * (m_nAreaLines + i);
+			m_pAreaRecip[nDstWidth * i + x] =
+							(ULONG)((((ULONGLONG)1 << 32) + area / 2) / area);
+		}
+	}
+
+	return S_OK;
+}
+
+
+HRESULT CScaleTable::BuildPolyphase()
+{
+	int nAlgorithm = m_Key.nAlgorithm;
+	int nBytesPerPixel = m_Key.nBytesPerPixel;
+
+	m_nWTaps = CalcTaps(nAlgorithm, m_Key.nSrcWidth, m_Key.nDstWidth);
+	m_nHTaps = CalcTaps(nAlgorithm, m_Key.nSrcHeight, m_Key.nDstHeight);
+	m_nWChromaTaps = m_nWTaps;
+	if (m_Key.nLumaOffset >= 0) {
+		// the same ratio as the luma, so only the narrow source of the
+		// chroma has fewer taps
+		m_nWChromaTaps = CalcTaps(nAlgorithm, m_Key.nSrcWidth / 2,
+								  m_Key.nDstWidth / 2);
+		ASSERT(m_nWChromaTaps <= m_nWTaps);
+	}
+
+	m_pWCoef = new short[m_nWEntries * m_nWTaps];
+	m_pHCoef = new short[m_Key.nDstHeight * m_nHTaps];
+	double* pWork = new double[max(m_nWTaps, m_nHTaps)];
+	if (m_pWCoef == NULL || m_pHCoef == NULL || pWork == NULL) {
+		delete [] pWork;
+		return E_OUTOFMEMORY;
+	}
+
+	if (m_Key.nLumaOffset >= 0) {
+		int nDstWidth = m_Key.nDstWidth;
+		int nChroma = nDstWidth / 2;
+		int nTaps = m_nWTaps;
+		int nChromaTaps = m_nWChromaTaps;
+		ULONG* pLuma = new ULONG[nDstWidth + nChroma];
+		short* pLumaCoef = new short[(nDstWidth + nChroma) * nTaps];
+		if (pLuma == NULL || pLumaCoef == NULL) {
+			delete [] pLuma;
+			delete [] pLumaCoef;
+			delete [] pWork;
+			return E_OUTOFMEMORY;
+		}
+		ULONG* pChroma = pLuma + nDstWidth;
+		short* pChromaCoef = pLumaCoef + nDstWidth * nTaps;
+
+		SetupBank(pLuma, pLumaCoef, pWork, nTaps, nAlgorithm,
+				  m_Key.nSrcWidth, nDstWidth, 2);
+		SetupBank(pChroma, pChromaCoef, pWork, nChromaTaps, nAlgorithm,
+				  m_Key.nSrcWidth / 2, nChroma, 4);
+		InterleaveYUV(m_pWScale, pLuma, pChroma, TRUE);
+
+		// the coefficients of the chroma are padded to the luma taps
+		::ZeroMemory(m_pWCoef, m_nWEntries * nTaps * sizeof(short));
+		for (int i = 0; i < m_nWEntries; i++) {
+			if ((i & 1) == m_Key.nLumaOffset) {
+				::CopyMemory(m_pWCoef + i * nTaps,
+							 pLumaCoef + (i >> 1) * nTaps,
+							 nTaps * sizeof(short));
+			} else {
+				::CopyMemory(m_pWCoef + i * nTaps,
+							 pChromaCoef + (i >> 2) * nChromaTaps,
+							 nChromaTaps * sizeof(short));
+			}
+		}
+		delete [] pLuma;
+		delete [] pLumaCoef;
+	} else {
+		SetupBank(m_pWScale, m_pWCoef, pWork, m_nWTaps, nAlgorithm,
+				  m_Key.nSrcWidth, m_Key.nDstWidth, nBytesPerPixel);
+	}
+	SetupBank(m_pHScale, m_pHCoef, pWork, m_nHTaps, nAlgorithm,
+			  m_Key.nSrcHeight, m_Key.nDstHeight, 1);
+	delete [] pWork;
+
+	// 2 taps at a time with 8 byte loads
+	if ((m_nWTaps & 1) == 0) {
+		CountSimd((m_nWTaps - 2) * nBytesPerPixel + 8);
+	}
+
+	return S_OK;
+}
+
+
+// entries of the output bytes of packed YUV from the tables of the luma
+// and the chroma. bBytes adds the bytes of them in the source pixels.
+void CScaleTable::InterleaveYUV(ULONG* pTable, const ULONG* pLuma,
+								const ULONG* pChroma, BOOL bBytes)
+{
+	int nLumaOffset = m_Key.nLumaOffset;
+	for (int i = 0; i < m_nWEntries; i++) {
+		if ((i & 1) == nLumaOffset) {
+			pTable[i] = pLuma[i >> 1] + (bBytes ? nLumaOffset : 0);
+		} else {
+			pTable[i] = pChroma[i >> 2] + (bBytes ? (i & 3) : 0);
+		}
+	}
+}
+
+
+// output pixels whose cbLoad bytes from the first source pixel are in the
+// source line. packed YUV have no SIMD for the horizontal passes.
+void CScaleTable::CountSimd(int cbLoad)
+{
+	if (m_Key.nLumaOffset >= 0) {
+		m_nSimdCount = 0;
+		return;
+	}
+
+	int cbLine = m_Key.nSrcWidth * m_Key.nBytesPerPixel;
+	m_nSimdCount = 0;
+	while (m_nSimdCount < m_Key.nDstWidth
+			&& (int)m_pWScale[m_nSimdCount] + cbLoad <= cbLine) {
+		m_nSimdCount++;
+	}
+}
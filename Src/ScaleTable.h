@@ -0,0 +1,118 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Motoharu Tsubaki.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a 
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "IVideoResizerConfig.h"
+
+// tables of the area average, in addition to RESIZE_XXX
+#define SCALE_AREA				(-1)
+
+// unused tables kept in the cache
+#define SCALE_TABLE_CACHE		(8)
+
+struct SCALE_TABLE_KEY
+{
+	int nSrcWidth;
+	int nSrcHeight;
+	int nDstWidth;
+	int nDstHeight;
+	int nBytesPerPixel;
+	int nAlgorithm;			// RESIZE_XXX or SCALE_AREA
+	int nLumaOffset;		// packed YUV, -1 for RGB
+};
+
+// scale tables of one source size, output size, pixel size and algorithm.
+// the tables are built once in the process and shared by the resizers,
+// and never change while they are referenced.
+// the horizontal tables of packed YUV have an entry for each output byte,
+// of the luma or the chroma.
+class CScaleTable
+{
+private:
+	friend class CVideoResizeBase;
+	friend class CPolyphaseFilter;
+
+public:
+	// a table of the key, from the cache or built. Release() it after use.
+	static HRESULT Get(const SCALE_TABLE_KEY* pKey, CScaleTable** ppTable);
+	void Release();
+
+	// frees the tables in the cache, none of them must be referenced
+	static void FreeCache();
+
+private:
+	CScaleTable(const SCALE_TABLE_KEY* pKey);
+	~CScaleTable();
+
+	HRESULT Build();
+	HRESULT BuildNearest();
+	HRESULT BuildBilinear();
+	HRESULT BuildArea();
+	HRESULT BuildPolyphase();
+	void InterleaveYUV(ULONG* pTable, const ULONG* pLuma,
+					   const ULONG* pChroma, BOOL bBytes);
+	void CountSimd(int cbLoad);
+
+	static void TrimCache();
+
+private:
+	SCALE_TABLE_KEY m_Key;
+	int m_nWEntries;		// of the horizontal tables
+	LONG m_cRef;
+	DWORD m_dwLastUse;
+	CScaleTable* m_pNext;
+
+	// first source pixels in bytes, and first source lines
+	ULONG* m_pWScale;
+	ULONG* m_pHScale;
+
+	// nearest-neighbor: TRUE for the lines of the same source line as the
+	// previous lines
+	BYTE* m_pHRepeat;
+
+	// bilinear: weights of the next pixels (lines) in 0.16 fixed point
+	ULONG* m_pWWeight;
+	ULONG* m_pHWeight;
+	int m_nWNext;			// in bytes, of the chroma for packed YUV
+	int m_nHNext;			// in lines
+
+	// area average: pixels (lines) of the spans, and 1 / (pixels * lines)
+	// for 2 line counts in 0.32 fixed point
+	ULONG* m_pWCount;
+	ULONG* m_pHCount;
+	ULONG* m_pAreaRecip;
+	int m_nAreaLines;
+
+	// bicubic, lanczos: coefficients of the taps from the first pixels.
+	// packed YUV have the taps of the luma in m_nWTaps, and fewer for
+	// the chroma when the source chroma is narrow
+	int m_nWTaps;
+	int m_nWChromaTaps;
+	int m_nHTaps;
+	short* m_pWCoef;
+	short* m_pHCoef;
+
+	// output pixels that SIMD can read from the source line
+	int m_nSimdCount;
+};
@@ -0,0 +1,92 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Motoharu Tsubaki.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a 
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <streams.h>
+
+#include "TripleBuffer.h"
+
+
+// Ԃ̃ubN܂Ă܂ǂ܂ĂȂ
+#define TRIPLE_BUFFER_NEW	(0x4)
+
+
+// ŒTCỸobt@3쐬AݗpAǂݍݗpAԂ̃ubNƂ
+// ǗNXBubN̎󂯓n͒Ԃ̃ubNƂ̌ōsB
+
+CTripleBuffer::CTripleBuffer(int cbBlockSize)
+	: m_cbBlockSize(cbBlockSize)
+	, m_nWrite(0)
+	, m_nRead(1)
+	, m_nMiddle(2)
+{
+	ASSERT(cbBlockSize > 0);
+
+	m_pBuf = new BYTE[cbBlockSize * 3];
+	if (m_pBuf == NULL) {
+		m_cbBlockSize = 0;
+	}
+}
+
+
+CTripleBuffer::~CTripleBuffer()
+{
+	delete [] m_pBuf;
+}
+
+
+// 񂾃ubN𒆊Ԃ̃ubNƌ
+void CTripleBuffer::Publish()
+{
+	LONG nOld = InterlockedExchange(&m_nMiddle, m_nWrite | TRIPLE_BUFFER_NEW);
+	m_nWrite = nOld & ~TRIPLE_BUFFER_NEW;
+}
+
+
+void CTripleBuffer::Write(const BYTE* pBuf, int cbSize)
+{
+	ASSERT(pBuf);
+	ASSERT(cbSize <= m_cbBlockSize);
+
+	::CopyMemory(GetWriteBuffer(), pBuf, min(cbSize, m_cbBlockSize));
+	Publish();
+}
+
+
+// Ԃ̃ubNVΓǂݍݗp̃ubNƌ
+BYTE* CTripleBuffer::GetReadBuffer()
+{
+	if (m_nMiddle & TRIPLE_BUFFER_NEW) {
+		LONG nOld = InterlockedExchange(&m_nMiddle, m_nRead);
+		m_nRead = nOld & ~TRIPLE_BUFFER_NEW;
+	}
+	return GetPointer(m_nRead);
+}
+
+
+void CTripleBuffer::Clear()
+{
+	memset(m_pBuf, 0x00, m_cbBlockSize * 3);
+	m_nWrite = 0;
+	m_nRead = 1;
+	m_nMiddle = 2;
+}
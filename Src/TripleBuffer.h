@@ -0,0 +1,61 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Motoharu Tsubaki.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a 
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+// latest block handed from a writer thread to a reader thread without
+// locks. the writer fills its own block and swaps it with the middle
+// one, and the reader swaps its block with the middle one when that is
+// newer, so neither waits for the other.
+class CTripleBuffer
+{
+public:
+	CTripleBuffer(int cbBlockSize);
+	virtual ~CTripleBuffer();
+
+	BOOL IsValid() { return m_pBuf != NULL; }
+
+	int GetBlockSize() { return m_cbBlockSize; }
+
+	// writer
+	BYTE* GetWriteBuffer() { return GetPointer(m_nWrite); }
+	void Publish();
+	void Write(const BYTE* pBuf, int cbSize);
+
+	// reader
+	BYTE* GetReadBuffer();
+
+	// while neither the writer nor the reader runs
+	void Clear();
+
+private:
+	BYTE* GetPointer(int i) { return m_pBuf + m_cbBlockSize * i; }
+
+private:
+	BYTE* m_pBuf;
+	int m_cbBlockSize;
+
+	int m_nWrite;
+	int m_nRead;
+	volatile LONG m_nMiddle;	// index | TRIPLE_BUFFER_NEW
+};
@@ -27,6 +27,7 @@
 #include <initguid.h>
 
 #include <Dvdmedia.h>
+#include <intrin.h>
 
 #include "Utils.h"
 
@@ -332,6 +333,48 @@ int GetBmpBits(const GUID* pSubtype)
 }
 
 
+DWORD GetSimdFlags()
+{
+	static volatile LONG s_nFlags = -1;
+
+	if (s_nFlags < 0) {
+		DWORD dwFlags = 0;
+		int info[4];
+
+		__cpuid(info, 0);
+		int nMaxId = info[0];
+
+		if (nMaxId >= 1) {
+			__cpuid(info, 1);
+			if (info[3] & (1 << 26)) {
+				dwFlags |= SIMD_SSE2;
+			}
+			if (info[2] & (1 << 9)) {
+				dwFlags |= SIMD_SSSE3;
+			}
+			if (info[2] & (1 << 19)) {
+				dwFlags |= SIMD_SSE41;
+			}
+
+#ifdef USE_AVX2
+			// OSXSAVE and AVX, and the OS saves the YMM registers
+			if ((info[2] & (1 << 27)) && (info[2] & (1 << 28))
+					&& (_xgetbv(0) & 0x6) == 0x6 && nMaxId >= 7) {
+				__cpuidex(info, 7, 0);
+				if (info[1] & (1 << 5)) {
+					dwFlags |= SIMD_AVX2;
+				}
+			}
+#endif
+		}
+
+		s_nFlags = (LONG)dwFlags;
+	}
+
+	return (DWORD)s_nFlags;
+}
+
+
 #ifdef DEBUG
 
 void DbgLogMediaTypeInfo(DWORD type, DWORD level, const CMediaType* pmt)
@@ -28,6 +28,17 @@
 
 #define sign(n)		((n) < 0 ? -1 : 1)
 
+// SIMD support flags (GetSimdFlags)
+#define SIMD_SSE2		0x00000001
+#define SIMD_SSSE3		0x00000002
+#define SIMD_SSE41		0x00000004
+#define SIMD_AVX2		0x00000008
+
+// AVX2 intrinsics need Visual Studio 2012 or later
+#if (defined(_MSC_VER) && _MSC_VER >= 1700) || defined(__AVX2__)
+#define USE_AVX2
+#endif
+
 void DbgWndDisplay(CDbgWnd* pWnd, CBaseFilter* pFilter,
 				IMediaSample* pSample, long nFrame, REFERENCE_TIME rtStart);
 
@@ -35,6 +46,7 @@ HRESULT GetMediaTypeName(LPTSTR pszString, int cchBuf, const GUID *pGUID);
 HRESULT GetMediaSubTypeName(LPTSTR pszString, int cchBuf, const GUID *pGUID);
 HRESULT GetFormatName(LPTSTR pszString, int cchBuf, const GUID *pGUID);
 int GetBmpBits(const GUID* pSubtype);
+DWORD GetSimdFlags();
 
 #ifdef DEBUG
 
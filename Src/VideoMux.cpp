@@ -30,7 +30,8 @@
 #include "DSFiltersGuids.h"
 #include "Utils.h"
 #include "VideoMux.h"
-#include "ToggleBuffer.h"
+#include "TripleBuffer.h"
+#include "JitterBuffer.h"
 
 
 const AMOVIESETUP_MEDIATYPE sudOpPinTypes[] =
@@ -59,7 +60,7 @@ const AMOVIESETUP_PIN sudOpPin[] =
 		FALSE,					// Is it rendered
 		FALSE,					// Is it an output
 		FALSE,					// Allowed none
-		FALSE,					// Allowed many
+		TRUE,					// Allowed many
 		&GUID_NULL,				// Connects to filter
 		NULL,					// Connects to pin
 		1,						// Number of types
@@ -88,6 +89,320 @@ extern const AMOVIESETUP_FILTER sudVideoMux =
 };
 
 
+//////////////////////////////////////////////////////////////////////////////
+// CVideoMuxOutputPin
+
+
+CVideoMuxOutputPin::CVideoMuxOutputPin(LPCTSTR pObjectName,
+									   CVideoMux *pFilter,
+									   HRESULT * phr,
+									   LPCWSTR pName)
+	: CTransformOutputPin(pObjectName, pFilter, phr, pName)
+	, m_pMux(pFilter)
+	, m_nFlushing(0)
+	, m_pClock(NULL)
+	, m_rtStart(0)
+	, m_State(State_Stopped)
+{
+	m_hWake = ::CreateEvent(NULL, FALSE, FALSE, NULL);
+	m_hStop = ::CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (m_hWake == NULL || m_hStop == NULL) {
+		*phr = E_OUTOFMEMORY;
+	}
+}
+
+
+CVideoMuxOutputPin::~CVideoMuxOutputPin()
+{
+	if (m_hWake) {
+		::CloseHandle(m_hWake);
+	}
+	if (m_hStop) {
+		::CloseHandle(m_hStop);
+	}
+}
+
+
+// t[ԂΏo͂̃XbhJn
+HRESULT CVideoMuxOutputPin::Active()
+{
+	HRESULT hr = CTransformOutputPin::Active();
+	if (FAILED(hr) || m_pMux->m_rtFrameTime == 0) {
+		return hr;
+	}
+
+	{
+		CAutoLock lock(&m_csTime);
+		m_pClock = m_pMux->m_pClock;
+		if (m_pClock) {
+			m_pClock->AddRef();
+		}
+		m_rtStart = 0;
+		m_State = State_Paused;
+	}
+	m_nFlushing = 0;
+
+	::ResetEvent(m_hStop);
+	if (!Create()) {
+		return E_FAIL;
+	}
+
+	return (HRESULT)CallWorker(CMD_RUN);
+}
+
+
+// ҂ĂXbhNăAP[^fR~bgĂ~߂B
+// fR~bgŎsGetDeliveryBuffer~悤ɐɋNB
+HRESULT CVideoMuxOutputPin::Inactive()
+{
+	::SetEvent(m_hStop);
+	HRESULT hr = CTransformOutputPin::Inactive();
+
+	if (ThreadExists()) {
+		CallWorker(CMD_EXIT);
+		Close();
+	}
+
+	CAutoLock lock(&m_csTime);
+	if (m_pClock) {
+		m_pClock->Release();
+		m_pClock = NULL;
+	}
+	m_State = State_Stopped;
+
+	return hr;
+}
+
+
+HRESULT CVideoMuxOutputPin::Run(REFERENCE_TIME tStart)
+{
+	{
+		CAutoLock lock(&m_csTime);
+		m_rtStart = tStart;
+	}
+
+	return CTransformOutputPin::Run(tStart);
+}
+
+
+// tB^̏ԂςĂʂċN
+void CVideoMuxOutputPin::SetState(FILTER_STATE State)
+{
+	{
+		CAutoLock lock(&m_csTime);
+		m_State = State;
+	}
+	Wake();
+}
+
+
+// ͂IƂȂǂɋN
+void CVideoMuxOutputPin::Wake()
+{
+	::SetEvent(m_hWake);
+}
+
+
+// tbVDeliverGetDeliveryBuffer߂ĂA
+// o͂~߂B
+// ͂̃sƂɌĂ΂̂ŁASẴsI܂Ŏ~߂ĂB
+void CVideoMuxOutputPin::BeginFlush()
+{
+	DeliverBeginFlush();
+	if (m_nFlushing++ == 0 && ThreadExists()) {
+		Wake();
+		CallWorker(CMD_PAUSE);
+	}
+}
+
+
+void CVideoMuxOutputPin::EndFlush()
+{
+	DeliverEndFlush();
+	if (m_nFlushing > 0 && --m_nFlushing == 0 && ThreadExists()) {
+		CallWorker(CMD_RUN);
+	}
+}
+
+
+// ~̗v܂őBtbV̊Ԃ͏o͂~߂Ă
+DWORD CVideoMuxOutputPin::ThreadProc()
+{
+	Command com;
+	do {
+		com = (Command)GetRequest();
+		Reply(NOERROR);
+		if (com == CMD_RUN) {
+			DoBufferProcessingLoop();
+		}
+	} while (com != CMD_EXIT);
+
+	return 0;
+}
+
+
+// NbNɍ킹đSĂ̓͂̍ŐṼt[ďo͂B
+// ꎞ~͍ŏ1t[Ȃŏo͂B
+// SĂ̓͂IƏI𑗂AG[̂Ƃ͒fʒmāA
+// ǂtbV~܂ő҂B
+HRESULT CVideoMuxOutputPin::DoBufferProcessingLoop()
+{
+	REFERENCE_TIME rtFrame = m_pMux->m_rtFrameTime;
+	REFERENCE_TIME rtNext = 0;
+	BOOL bDelivered = FALSE;
+	BOOL bDiscontinuity = TRUE;
+	BOOL bEndOfStream = FALSE;
+
+	// ~tbV̗v܂ŁB~͗v҂
+	while (!CheckRequest(NULL)
+			&& ::WaitForSingleObject(m_hStop, 0) != WAIT_OBJECT_0) {
+		if (!bEndOfStream && m_pMux->IsEndOfStream()) {
+			DeliverEndOfStream();
+			bEndOfStream = TRUE;
+		}
+		if (bEndOfStream) {
+			Wait(INFINITE);
+			continue;
+		}
+
+		BOOL bTime = FALSE;
+		if (IsRunning()) {
+			REFERENCE_TIME rtStream;
+			if (GetStreamTime(&rtStream) == S_OK) {
+				if (rtStream < rtNext) {
+					WaitForFrameTime(rtNext, rtFrame);
+					continue;
+				}
+				// xꂽ̃t[͔΂
+				if (rtStream >= rtNext + rtFrame) {
+					rtNext = rtStream - rtStream % rtFrame;
+					bDiscontinuity = TRUE;
+				}
+				bTime = TRUE;
+			} else if (bDelivered) {
+				// NbN΃t[ԂƂɎȂŏo͂
+				Wait((DWORD)(rtFrame / (UNITS / 1000)));
+			}
+		} else if (bDelivered) {
+			// Đ邩~܂ő҂
+			Wait(INFINITE);
+			continue;
+		}
+
+		IMediaSample *pSample;
+		HRESULT hr = GetDeliveryBuffer(&pSample, NULL, NULL, 0);
+		if (FAILED(hr)) {
+			// fR~bgĂΒ~̗v҂
+			if (::WaitForSingleObject(m_hStop, 0) == WAIT_OBJECT_0) {
+				return S_OK;
+			}
+			DbgLog((LOG_ERROR, 1,
+					TEXT("Error %08lX from GetDeliveryBuffer"), hr));
+			DeliverEndOfStream();
+			m_pMux->NotifyEvent(EC_ERRORABORT, hr, 0);
+			bEndOfStream = TRUE;
+			continue;
+		}
+
+		hr = m_pMux->ComposeFrame(pSample, bTime, rtNext);
+		if (SUCCEEDED(hr)) {
+			if (bTime) {
+				REFERENCE_TIME rtStart = rtNext;
+				REFERENCE_TIME rtStop = rtNext + rtFrame;
+				pSample->SetTime(&rtStart, &rtStop);
+			} else {
+				pSample->SetTime(NULL, NULL);
+			}
+			pSample->SetSyncPoint(TRUE);
+			pSample->SetDiscontinuity(bDiscontinuity);
+			hr = Deliver(pSample);
+		}
+		pSample->Release();
+
+		// downstream filter returns S_FALSE if it wants us to stop, which
+		// is the flush or the end of its stream, and the flush or Stop
+		// follows. an error is reported and stops the output.
+		if (FAILED(hr)) {
+			DbgLog((LOG_ERROR, 1,
+					TEXT("Deliver() returned %08x; aborting"), hr));
+			DeliverEndOfStream();
+			m_pMux->NotifyEvent(EC_ERRORABORT, hr, 0);
+			bEndOfStream = TRUE;
+			continue;
+		}
+
+		bDelivered = TRUE;
+		bDiscontinuity = FALSE;
+		if (bTime) {
+			rtNext += rtFrame;
+		}
+	}
+
+	return S_OK;
+}
+
+
+BOOL CVideoMuxOutputPin::IsRunning()
+{
+	CAutoLock lock(&m_csTime);
+	return m_State == State_Running;
+}
+
+
+HRESULT CVideoMuxOutputPin::GetStreamTime(REFERENCE_TIME* prtStream)
+{
+	CAutoLock lock(&m_csTime);
+
+	if (m_pClock == NULL) {
+		return VFW_E_NO_CLOCK;
+	}
+
+	REFERENCE_TIME rtNow;
+	HRESULT hr = m_pClock->GetTime(&rtNow);
+	if (FAILED(hr)) {
+		return hr;
+	}
+
+	*prtStream = rtNow - m_rtStart;
+	return S_OK;
+}
+
+
+// Xg[rtTime܂ő҂B
+// ʒmȂƂ̂߂Ƀt[Ԃ2{Ŗ߂B
+void CVideoMuxOutputPin::WaitForFrameTime(REFERENCE_TIME rtTime,
+										  REFERENCE_TIME rtFrame)
+{
+	DWORD_PTR dwCookie = 0;
+	{
+		CAutoLock lock(&m_csTime);
+		if (m_pClock == NULL || m_pClock->AdviseTime(m_rtStart, rtTime,
+								(HEVENT)m_hWake, &dwCookie) != S_OK) {
+			dwCookie = 0;
+		}
+	}
+
+	Wait((DWORD)(rtFrame * 2 / (UNITS / 1000)) + 1);
+
+	// NbN͎~߂܂ŉȂ
+	if (dwCookie) {
+		m_pClock->Unadvise(dwCookie);
+	}
+}
+
+
+// ʒmԂ̕ῶ̏I肩tbV~ŋN܂ő҂
+void CVideoMuxOutputPin::Wait(DWORD dwMilliseconds)
+{
+	HANDLE hEvents[2] = { m_hWake, m_hStop };
+	::WaitForMultipleObjects(2, hEvents, FALSE, dwMilliseconds);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+// CVideoMux
+
+
 CUnknown* WINAPI CVideoMux::CreateInstance(LPUNKNOWN punk, HRESULT* phr)
 {
 	CVideoMux* pMux = new CVideoMux(punk, phr, 320, 240);
@@ -102,23 +417,370 @@ CVideoMux::CVideoMux(LPUNKNOWN punk, HRESULT* phr, int nWidth, int nHeight)
 	: CBaseMux(NAME("Video Mux"), punk, CLSID_VideoMux)
 	, m_nWidth(nWidth)
 	, m_nHeight(nHeight)
-	, m_pBuf(NULL)
 	, m_nPixelPerBytes(0)
+	, m_nColumns(2)
+	, m_nRows(1)
+	, m_rtMaxSlaveLatency(0)
+	, m_rtFrameTime(0)
+	, m_dwStartTick(0)
+	, m_pSlaveFrames(NULL)
+	, m_nSlaveFrames(0)
 {
 	ASSERT(nWidth > 0);
 	ASSERT(nHeight > 0);
 
+	ZeroMemory(&m_MasterFrame, sizeof(INPUT_FRAME));
+
 	*phr = S_OK;
 }
 
 
 CVideoMux::~CVideoMux()
 {
-	delete m_pBuf;
+	DeleteBuffers();
 	DBGWND_DESTROY;
 }
 
 
+STDMETHODIMP CVideoMux::NonDelegatingQueryInterface(REFIID riid, void** ppv)
+{
+	CheckPointer(ppv, E_POINTER);
+
+	if (riid == IID_IVideoMuxConfig) {
+		return GetInterface((IVideoMuxConfig*)(this), ppv);
+	}
+
+	return CBaseMux::NonDelegatingQueryInterface(riid, ppv);
+}
+
+
+// Z̕т̕ύX
+// ~SẴsڑ̂Ƃ̂
+STDMETHODIMP CVideoMux::SetGrid(int nColumns, int nRows)
+{
+	if (nColumns <= 0 || nRows <= 0 || nColumns * nRows < 2
+			|| nColumns * nRows > MUX_MAX_PINS - 1) {
+		return E_INVALIDARG;
+	}
+
+	CAutoLock lock(&m_csFilter);
+
+	if (m_State != State_Stopped) {
+		return VFW_E_NOT_STOPPED;
+	}
+
+	if (IsInputConnected() || (m_pOutput && m_pOutput->IsConnected())) {
+		return VFW_E_ALREADY_CONNECTED;
+	}
+
+	m_nColumns = nColumns;
+	m_nRows = nRows;
+
+	// ̃X[us͐ڑɒǉ
+	TrimSlavePins();
+
+	return S_OK;
+}
+
+
+STDMETHODIMP CVideoMux::GetGrid(int* pnColumns, int* pnRows)
+{
+	CheckPointer(pnColumns, E_POINTER);
+	CheckPointer(pnRows, E_POINTER);
+
+	CAutoLock lock(&m_csFilter);
+	*pnColumns = m_nColumns;
+	*pnRows = m_nRows;
+
+	return S_OK;
+}
+
+
+// Z̃TCY̕ύX
+// ~SẴsڑ̂Ƃ̂
+STDMETHODIMP CVideoMux::SetCellSize(int nWidth, int nHeight)
+{
+	if (nWidth <= 0 || nHeight <= 0) {
+		return E_INVALIDARG;
+	}
+
+	CAutoLock lock(&m_csFilter);
+
+	if (m_State != State_Stopped) {
+		return VFW_E_NOT_STOPPED;
+	}
+
+	if (IsInputConnected() || (m_pOutput && m_pOutput->IsConnected())) {
+		return VFW_E_ALREADY_CONNECTED;
+	}
+
+	m_nWidth = nWidth;
+	m_nHeight = nHeight;
+
+	return S_OK;
+}
+
+
+STDMETHODIMP CVideoMux::GetCellSize(int* pnWidth, int* pnHeight)
+{
+	CheckPointer(pnWidth, E_POINTER);
+	CheckPointer(pnHeight, E_POINTER);
+
+	CAutoLock lock(&m_csFilter);
+	*pnWidth = m_nWidth;
+	*pnHeight = m_nHeight;
+
+	return S_OK;
+}
+
+
+// X[ũt[҂ő厞Ԃ̕ύX
+// ~̂Ƃ̂
+STDMETHODIMP CVideoMux::SetMaxSlaveLatency(REFERENCE_TIME rtLatency)
+{
+	if (rtLatency < 0 || rtLatency > VIDEOMUX_MAX_SLAVE_LATENCY) {
+		return E_INVALIDARG;
+	}
+
+	CAutoLock lock(&m_csFilter);
+
+	if (m_State != State_Stopped) {
+		return VFW_E_NOT_STOPPED;
+	}
+
+	m_rtMaxSlaveLatency = rtLatency;
+
+	return S_OK;
+}
+
+
+STDMETHODIMP CVideoMux::GetMaxSlaveLatency(REFERENCE_TIME* prtLatency)
+{
+	CheckPointer(prtLatency, E_POINTER);
+
+	CAutoLock lock(&m_csFilter);
+
+	*prtLatency = m_rtMaxSlaveLatency;
+
+	return S_OK;
+}
+
+
+STDMETHODIMP CVideoMux::GetSlaveStats(int nSlave,
+									  VIDEOMUX_SLAVE_STATS* pStats)
+{
+	CheckPointer(pStats, E_POINTER);
+
+	CAutoLock lock(&m_csFilter);
+
+	if (nSlave < 0 || nSlave >= GetMaxSlaveCount()) {
+		return E_INVALIDARG;
+	}
+
+	// X[uƏo͂̊eXbhĂ̂ŁA1ǂ
+	if (nSlave < m_nSlaveFrames) {
+		VIDEOMUX_SLAVE_STATS* pSrc = &m_pSlaveFrames[nSlave].stats;
+		pStats->nReceived = InterlockedExchangeAdd(&pSrc->nReceived, 0);
+		pStats->nSlaveOverlaps = InterlockedExchangeAdd(
+											&pSrc->nSlaveOverlaps, 0);
+		pStats->nMasterOverlaps = InterlockedExchangeAdd(
+											&pSrc->nMasterOverlaps, 0);
+		pStats->nRepeated = InterlockedExchangeAdd(&pSrc->nRepeated, 0);
+		pStats->nDropped = InterlockedExchangeAdd(&pSrc->nDropped, 0);
+	} else {
+		ZeroMemory(pStats, sizeof(VIDEOMUX_SLAVE_STATS));
+	}
+
+	return S_OK;
+}
+
+
+// o͂̃t[Ԃ̕ύX
+// ~o̓sڑ̂Ƃ̂
+STDMETHODIMP CVideoMux::SetFrameTime(REFERENCE_TIME rtFrame)
+{
+	if (rtFrame != 0 && (rtFrame < VIDEOMUX_MIN_FRAME_TIME
+							|| rtFrame > VIDEOMUX_MAX_FRAME_TIME)) {
+		return E_INVALIDARG;
+	}
+
+	CAutoLock lock(&m_csFilter);
+
+	if (m_State != State_Stopped) {
+		return VFW_E_NOT_STOPPED;
+	}
+
+	if (m_pOutput && m_pOutput->IsConnected()) {
+		return VFW_E_ALREADY_CONNECTED;
+	}
+
+	m_rtFrameTime = rtFrame;
+
+	return S_OK;
+}
+
+
+STDMETHODIMP CVideoMux::GetFrameTime(REFERENCE_TIME* prtFrame)
+{
+	CheckPointer(prtFrame, E_POINTER);
+
+	CAutoLock lock(&m_csFilter);
+
+	*prtFrame = m_rtFrameTime;
+
+	return S_OK;
+}
+
+
+STDMETHODIMP CVideoMux::IsInputStale(int nInput, BOOL* pbStale)
+{
+	CheckPointer(pbStale, E_POINTER);
+
+	CAutoLock lock(&m_csFilter);
+
+	if (nInput < 0 || nInput > GetMaxSlaveCount()) {
+		return E_INVALIDARG;
+	}
+
+	*pbStale = FALSE;
+	if (m_State == State_Stopped) {
+		return S_OK;
+	}
+
+	if (nInput == 0) {
+		*pbStale = IsStale(&m_MasterFrame, (CBaseMuxInputPin*)m_pInput);
+	} else if (nInput - 1 < m_nSlaveFrames) {
+		*pbStale = IsStale(&m_pSlaveFrames[nInput - 1],
+						   GetSlaveInput(nInput - 1));
+	}
+
+	return S_OK;
+}
+
+
+BOOL CVideoMux::IsInputConnected()
+{
+	if (m_pInput && m_pInput->IsConnected()) {
+		return TRUE;
+	}
+	return GetConnectedSlaveCount() > 0;
+}
+
+
+HRESULT CVideoMux::CreateBuffers(int cbSize)
+{
+	DeleteBuffers();
+
+	int nFrames = GetMaxSlaveCount();
+	m_pSlaveFrames = new INPUT_FRAME[nFrames];
+	if (!m_pSlaveFrames) {
+		return E_OUTOFMEMORY;
+	}
+	ZeroMemory(m_pSlaveFrames, sizeof(INPUT_FRAME) * nFrames);
+	m_nSlaveFrames = nFrames;
+
+	for (int i = 0; i < nFrames; i++) {
+		CTripleBuffer* pBuf = new CTripleBuffer(cbSize);
+		m_pSlaveFrames[i].pBuf = pBuf;
+		if (!pBuf || !pBuf->IsValid()) {
+			DeleteBuffers();
+			return E_OUTOFMEMORY;
+		}
+		// t[͂܂ł͍
+		pBuf->Clear();
+	}
+
+	// }X^[̓t[ԂƂ獇
+	m_MasterFrame.pBuf = new CTripleBuffer(cbSize);
+	if (!m_MasterFrame.pBuf || !m_MasterFrame.pBuf->IsValid()) {
+		DeleteBuffers();
+		return E_OUTOFMEMORY;
+	}
+	m_MasterFrame.pBuf->Clear();
+
+	return S_OK;
+}
+
+
+void CVideoMux::DeleteBuffers()
+{
+	ReleaseSamples();
+	for (int i = 0; i < m_nSlaveFrames; i++) {
+		delete m_pSlaveFrames[i].pBuf;
+		delete m_pSlaveFrames[i].pJitter;
+	}
+	delete [] m_pSlaveFrames;
+	m_pSlaveFrames = NULL;
+	m_nSlaveFrames = 0;
+
+	delete m_MasterFrame.pBuf;
+	ZeroMemory(&m_MasterFrame, sizeof(INPUT_FRAME));
+}
+
+
+void CVideoMux::ReleaseSamples()
+{
+	for (int i = 0; i < m_nSlaveFrames; i++) {
+		IMediaSample* pSample = m_pSlaveFrames[i].pSample;
+		if (pSample) {
+			pSample->Release();
+			m_pSlaveFrames[i].pSample = NULL;
+		}
+	}
+
+	if (m_MasterFrame.pSample) {
+		m_MasterFrame.pSample->Release();
+		m_MasterFrame.pSample = NULL;
+	}
+}
+
+
+// őx0łȂ΁AڑĂX[uɂ̊Ԃ̃t[
+// ߂obt@B
+HRESULT CVideoMux::CreateJitterBuffers()
+{
+	REFERENCE_TIME rtMasterFrame = 0;
+	if (m_pInput->IsConnected()) {
+		rtMasterFrame = ((VIDEOINFOHEADER*)m_pInput->CurrentMediaType()
+							.Format())->AvgTimePerFrame;
+	}
+
+	for (int i = 0; i < m_nSlaveFrames; i++) {
+		INPUT_FRAME* pFrame = &m_pSlaveFrames[i];
+		delete pFrame->pJitter;
+		pFrame->pJitter = NULL;
+
+		CBaseMuxInputPin* pPin = GetSlaveInput(i);
+		if (m_rtMaxSlaveLatency == 0 || !pPin || !pPin->IsConnected()) {
+			continue;
+		}
+
+		// \ƍŐṼt[̕𑫂āA2̏搔ɐ؂グ
+		REFERENCE_TIME rtFrame = ((VIDEOINFOHEADER*)pPin->CurrentMediaType()
+									.Format())->AvgTimePerFrame;
+		if (rtFrame <= 0) {
+			rtFrame = (rtMasterFrame > 0) ? rtMasterFrame : UNITS / 30;
+		}
+		REFERENCE_TIME rtBlocks = (m_rtMaxSlaveLatency + rtFrame - 1) / rtFrame
+									+ 2;
+		int nBlocks = 2;
+		while (nBlocks < rtBlocks && nBlocks < VIDEOMUX_MAX_JITTER_BLOCKS) {
+			nBlocks *= 2;
+		}
+
+		pFrame->pJitter = new CJitterBuffer(pFrame->pBuf->GetBlockSize(),
+											nBlocks);
+		if (!pFrame->pJitter || !pFrame->pJitter->IsValid()) {
+			delete pFrame->pJitter;
+			pFrame->pJitter = NULL;
+			return E_OUTOFMEMORY;
+		}
+	}
+
+	return S_OK;
+}
+
+
 HRESULT CVideoMux::CheckInputType(const CMediaType *mtIn)
 {
 	if (mtIn->majortype != MEDIATYPE_Video
@@ -129,13 +791,20 @@ HRESULT CVideoMux::CheckInputType(const CMediaType *mtIn)
 
 	VIDEOINFOHEADER *pVih = reinterpret_cast<VIDEOINFOHEADER*>(mtIn->pbFormat);
 
+	// SĂ͓̓͂tH[}bg
 	const GUID* pConnectedGuid = NULL;
 	if (m_pInput->IsConnected()) {
 		CMediaType& mt = m_pInput->CurrentMediaType();
 		pConnectedGuid = mt.Subtype();
-	} else if (m_pSlaveInput->IsConnected()) {
-		CMediaType& mt = m_pSlaveInput->CurrentMediaType();
-		pConnectedGuid = mt.Subtype();
+	} else {
+		for (int i = 0; i < GetSlaveCount(); i++) {
+			CBaseMuxInputPin* pPin = GetSlaveInput(i);
+			if (pPin->IsConnected()) {
+				CMediaType& mt = pPin->CurrentMediaType();
+				pConnectedGuid = mt.Subtype();
+				break;
+			}
+		}
 	}
 
 	int bits;
@@ -180,7 +849,8 @@ HRESULT CVideoMux::GetMediaType(int iPosition, CMediaType *pMediaType)
 	VIDEOINFOHEADER *pInVih = (VIDEOINFOHEADER*)pMtIn->Format();
 
 	int bits = GetBmpBits(&pMtIn->subtype);
-	DWORD cbSize = CalcStride(m_nWidth * 2, bits/8) * m_nHeight;
+	DWORD cbSize = CalcStride(m_nWidth * m_nColumns, bits/8)
+										* m_nHeight * m_nRows;
 
 	pMediaType->SetType(&MEDIATYPE_Video);
 	pMediaType->SetSubtype(&pMtIn->subtype);
@@ -194,28 +864,23 @@ HRESULT CVideoMux::GetMediaType(int iPosition, CMediaType *pMediaType)
 	if (!pVih) {
 		return E_OUTOFMEMORY;
 	}
-	
-	CToggleBuffer* pTglBuf = new CToggleBuffer(cbSize);
-	if (!pTglBuf) {
-		return E_OUTOFMEMORY;
-	}
-	delete m_pBuf;
-	m_pBuf = pTglBuf;
-	m_nPixelPerBytes = bits/8;
+
+	int nCells = m_nColumns * m_nRows;
 
 	ZeroMemory(pVih, sizeof(VIDEOINFOHEADER));
 	pVih->bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
-	pVih->bmiHeader.biWidth = m_nWidth * 2;
-	pVih->bmiHeader.biHeight = m_nHeight;
+	pVih->bmiHeader.biWidth = m_nWidth * m_nColumns;
+	pVih->bmiHeader.biHeight = m_nHeight * m_nRows;
 	pVih->bmiHeader.biPlanes = 1;
 	pVih->bmiHeader.biBitCount = bits;
 	pVih->bmiHeader.biCompression = BI_RGB;
 	pVih->bmiHeader.biSizeImage = cbSize;
 	pVih->bmiHeader.biClrImportant = 0;
 
-	pVih->dwBitRate = pInVih->dwBitRate * 2;
-	pVih->dwBitErrorRate = pInVih->dwBitErrorRate * 2;
-	pVih->AvgTimePerFrame = pInVih->AvgTimePerFrame;
+	pVih->dwBitRate = pInVih->dwBitRate * nCells;
+	pVih->dwBitErrorRate = pInVih->dwBitErrorRate * nCells;
+	pVih->AvgTimePerFrame = (m_rtFrameTime != 0) ? m_rtFrameTime
+												  : pInVih->AvgTimePerFrame;
 
 	SetRectEmpty(&(pVih->rcSource));
 	SetRectEmpty(&(pVih->rcTarget));
@@ -246,8 +911,8 @@ HRESULT CVideoMux::CheckTransform(const CMediaType *mtIn,
 	BITMAPINFOHEADER *pBmiIn = HEADER(mtIn->pbFormat);
 	if (pBmiOut->biPlanes != pBmiIn->biPlanes
 			|| pBmiOut->biCompression != pBmiIn->biCompression
-			|| pBmiOut->biWidth != pBmiIn->biWidth * 2
-			|| pBmiOut->biHeight != pBmiIn->biHeight) {
+			|| pBmiOut->biWidth != pBmiIn->biWidth * m_nColumns
+			|| pBmiOut->biHeight != pBmiIn->biHeight * m_nRows) {
 		return VFW_E_TYPE_NOT_ACCEPTED;
 	}
 
@@ -282,59 +947,368 @@ HRESULT CVideoMux::Transform(IMediaSample *pSource, IMediaSample *pDest)
 	if (FAILED(hr))
 		return hr;
 
+	// X[u̓}X^[̎Ɉԋ߂t[g
+	REFERENCE_TIME rtStart, rtStop;
+	BOOL bTime = SUCCEEDED(pSource->GetTime(&rtStart, &rtStop));
+
+	Compose(pDstBuf, pSrcBuf, bTime, rtStart);
+
+	pDest->SetActualDataLength(CalcStride(m_nWidth * m_nColumns,
+										  m_nPixelPerBytes)
+								* m_nHeight * m_nRows);
+
+#ifdef DEBUG
+	m_nFrameCount++;
+	DbgWndDisplay(&DBGWND, this, pDest, m_nFrameCount, m_tStart);
+#endif
+
+	return hr;
+}
+
+
+// o̓s̃XbhASĂ̓͂̎󂯎t[B
+// tB^̃bNƒ~Ƒ҂̂ŁADbgWndɂ͕\ȂB
+HRESULT CVideoMux::ComposeFrame(IMediaSample* pDest, BOOL bTime,
+								REFERENCE_TIME rtTime)
+{
+	BYTE* pDstBuf;
+	HRESULT hr = pDest->GetPointer(&pDstBuf);
+	if (FAILED(hr))
+		return hr;
+
+	Compose(pDstBuf, NULL, bTime, rtTime);
+
+	pDest->SetActualDataLength(CalcStride(m_nWidth * m_nColumns,
+										  m_nPixelPerBytes)
+								* m_nHeight * m_nRows);
+
+	return S_OK;
+}
+
+
+// eZɈxށB
+// }X^[AX[u͍EAォ牺̏B
+// {gAbvDIBȂ̂ŁA̍s̃Zقǃobt@̌ɂB
+// pMasterBufNULLȂ}X^[󂯎t[gAÂ͂
+// ZɎȂtB
+void CVideoMux::Compose(BYTE* pDstBuf, const BYTE* pMasterBuf, BOOL bTime,
+						REFERENCE_TIME rtTime)
+{
 	int nSrcLineBytes = m_nWidth * m_nPixelPerBytes;
 	int nSrcStride = CalcStride(m_nWidth, m_nPixelPerBytes);
-	int nDstStride = CalcStride(m_nWidth * 2, m_nPixelPerBytes);
-	int cbSrcSize = nSrcStride * m_nHeight;
-	int cbDstSize = nDstStride * m_nHeight;
+	int nDstStride = CalcStride(m_nWidth * m_nColumns, m_nPixelPerBytes);
+
+	int nCells = m_nColumns * m_nRows;
+	for (int i = 0; i < nCells; i++) {
+		int nRow = m_nRows - 1 - i / m_nColumns;
+		BYTE* pDst = pDstBuf + nDstStride * m_nHeight * nRow
+									+ nSrcLineBytes * (i % m_nColumns);
+		if (i == 0 && pMasterBuf) {
+			CopyTile(pDst, nDstStride, pMasterBuf, nSrcStride);
+			continue;
+		}
+
+		INPUT_FRAME* pFrame;
+		CBaseMuxInputPin* pPin;
+		if (i == 0) {
+			pFrame = &m_MasterFrame;
+			pPin = (CBaseMuxInputPin*)m_pInput;
+		} else {
+			int nSlave = i - 1;
+			pFrame = (nSlave < m_nSlaveFrames) ? &m_pSlaveFrames[nSlave]
+											   : NULL;
+			pPin = GetSlaveInput(nSlave);
+		}
+
+		// ڑ̓͂̃Z͍
+		if (pFrame && pPin && pPin->IsConnected()) {
+			CopyFrameTile(pFrame, pPin, pDst, nDstStride, bTime, rtTime);
+			if (!pMasterBuf && IsStale(pFrame, pPin)) {
+				MarkStaleTile(pDst, nDstStride);
+			}
+		} else {
+			CopyTile(pDst, nDstStride, NULL, 0);
+		}
+	}
+}
 
-	BYTE* pSrc = pSrcBuf;
-	BYTE* pDst = pDstBuf;
+
+// pSrcNULLȂ獕Ŗ߂
+void CVideoMux::CopyTile(BYTE* pDst, int nDstStride, const BYTE* pSrc,
+						 int nSrcStride)
+{
+	int nLineBytes = m_nWidth * m_nPixelPerBytes;
 	for (int y = 0; y < m_nHeight; y++) {
-		::CopyMemory(pDst, pSrc, nSrcLineBytes);
-		pSrc += nSrcStride;
+		if (pSrc) {
+			::CopyMemory(pDst, pSrc, nLineBytes);
+			pSrc += nSrcStride;
+		} else {
+			::ZeroMemory(pDst, nLineBytes);
+		}
 		pDst += nDstStride;
 	}
+}
 
-	if (m_pSlaveInput->IsConnected()) {
-		CAutoLock lock(m_pBuf->GetLock());
-		ASSERT(m_pBuf->GetBloskSize() >= cbSrcSize);
-		pSrc = m_pBuf->GetData();
-		pDst = pDstBuf + nSrcLineBytes;
-		for (int y = 0; y < m_nHeight; y++) {
-			::CopyMemory(pDst, pSrc, nSrcLineBytes);
-			pSrc += nSrcStride;
-			pDst += nDstStride;
+
+// Â͂̃Z1sɍ
+void CVideoMux::MarkStaleTile(BYTE* pDst, int nDstStride)
+{
+	int nLineBytes = m_nWidth * m_nPixelPerBytes;
+	for (int y = 0; y < m_nHeight; y += 2) {
+		::ZeroMemory(pDst, nLineBytes);
+		pDst += nDstStride * 2;
+	}
+}
+
+
+// ͂̃t[bNɎ󂯎ăRs[B
+// ێĂTv͎oăRs[ÅԂɎ̃Tv
+// ͂ĂȂΖ߂B͂ĂΉB
+// őxƂ͗߂t[玞ԋ߂̂Rs[B
+// Rs[̊Ԃ̓X[ũubNɏȂ̂ŁAbNȂB
+void CVideoMux::CopyFrameTile(INPUT_FRAME* pFrame, CBaseMuxInputPin* pPin,
+							  BYTE* pDst, int nDstStride, BOOL bTime,
+							  REFERENCE_TIME rtTime)
+{
+	int nSrcStride = CalcStride(m_nWidth, m_nPixelPerBytes);
+
+	InterlockedExchange(&pFrame->nComposing, 1);
+	if (pFrame->nReceiving) {
+		InterlockedIncrement(&pFrame->stats.nMasterOverlaps);
+	}
+
+	if (pFrame->pJitter) {
+		int nDropped;
+		BOOL bRepeated;
+		const BYTE* pSrcBuf = pFrame->pJitter->Select(bTime, rtTime,
+												&nDropped, &bRepeated);
+		CopyTile(pDst, nDstStride, pSrcBuf, nSrcStride);
+		pFrame->pJitter->EndRead();
+		InterlockedExchangeAdd(&pFrame->stats.nDropped, nDropped);
+		if (bRepeated) {
+			InterlockedIncrement(&pFrame->stats.nRepeated);
+		}
+	} else if (pPin->CanHoldSample()) {
+		IMediaSample* pSample = (IMediaSample*)InterlockedExchangePointer(
+									(PVOID*)&pFrame->pSample, NULL);
+		CountComposed(pFrame, pFrame->nSeq);
+		BYTE* pSrcBuf;
+		if (pSample && pSample->GetPointer(&pSrcBuf) == S_OK) {
+			CopyTile(pDst, nDstStride, pSrcBuf, nSrcStride);
+		} else {
+			CopyTile(pDst, nDstStride, NULL, 0);
 		}
+		if (pSample && InterlockedCompareExchangePointer(
+					(PVOID*)&pFrame->pSample, pSample, NULL) != NULL) {
+			pSample->Release();
+		}
+	} else {
+		BYTE* pSrcBuf = pFrame->pBuf->GetReadBuffer();
+		CountComposed(pFrame, pFrame->nSeq);
+		CopyTile(pDst, nDstStride, pSrcBuf, nSrcStride);
 	}
 
-	pDest->SetActualDataLength(cbDstSize);
+	InterlockedExchange(&pFrame->nComposing, 0);
+}
 
-#ifdef DEBUG
-	m_nFrameCount++;
-	DbgWndDisplay(&DBGWND, this, pDest, m_nFrameCount, m_tStart);
-#endif
 
-	return hr;
+// OɍĂnꂽt[̐ŌJԂƎ̂Ăt[𐔂B
+// 󂯎ƏdȂƂ1邱ƂB
+void CVideoMux::CountComposed(INPUT_FRAME* pFrame, LONG nSeq)
+{
+	// ܂t[͂ĂȂ
+	if (nSeq == 0) {
+		return;
+	}
+
+	if (nSeq == pFrame->nComposedSeq) {
+		InterlockedIncrement(&pFrame->stats.nRepeated);
+	} else if (nSeq - pFrame->nComposedSeq > 1) {
+		InterlockedExchangeAdd(&pFrame->stats.nDropped,
+							   nSeq - pFrame->nComposedSeq - 1);
+	}
+	pFrame->nComposedSeq = nSeq;
+}
+
+
+// ͂̃t[ԂVIDEOMUX_STALE_FRAMES{̊ԃt[͂Ȃ
+// ÂBo͂̃t[Ԃ̕΂ŐB
+BOOL CVideoMux::IsStale(INPUT_FRAME* pFrame, CBaseMuxInputPin* pPin)
+{
+	if (!pPin || !pPin->IsConnected()) {
+		return FALSE;
+	}
+
+	REFERENCE_TIME rtFrame = ((VIDEOINFOHEADER*)pPin->CurrentMediaType()
+								.Format())->AvgTimePerFrame;
+	rtFrame = max(rtFrame, m_rtFrameTime);
+	if (rtFrame <= 0) {
+		rtFrame = UNITS / 30;
+	}
+	DWORD dwStale = (DWORD)(rtFrame * VIDEOMUX_STALE_FRAMES / (UNITS / 1000));
+
+	DWORD dwLast = pFrame->nSeq ? pFrame->dwReceived : m_dwStartTick;
+	return ::GetTickCount() - dwLast > dwStale;
 }
 
 
-HRESULT CVideoMux::ReceiveSlave(IMediaSample *pSample)
+HRESULT CVideoMux::ReceiveSlave(int nSlave, IMediaSample *pSample)
 {
-	ASSERT(m_pBuf);
 	ASSERT(pSample);
 
-	CAutoLock lock(&m_csReceive);
+	// o͂ڑ
+	if (nSlave >= m_nSlaveFrames) {
+		return S_OK;
+	}
+
+	return StoreFrame(&m_pSlaveFrames[nSlave], GetSlaveInput(nSlave),
+					  pSample);
+}
+
 
-	BYTE* pBuf;
-	HRESULT hr = pSample->GetPointer(&pBuf);
-	if (hr == S_OK && pBuf) {
-		long cbSize = pSample->GetActualDataLength();
-		if (cbSize <= m_pBuf->GetBloskSize()) {
-			m_pBuf->Toggle(pBuf, cbSize);
+// t[ԂƂ̓}X^[̃t[o̓s̃Xbh
+HRESULT CVideoMux::Receive(IMediaSample *pSample)
+{
+	ASSERT(pSample);
+
+	if (m_rtFrameTime == 0) {
+		return CBaseMux::Receive(pSample);
+	}
+
+	// o͂ڑ
+	if (m_MasterFrame.pBuf == NULL) {
+		return S_OK;
+	}
+
+	return StoreFrame(&m_MasterFrame, (CBaseMuxInputPin*)m_pInput, pSample);
+}
+
+
+// t[ԂƂ͑SĂ̓͂IĂo̓s̃Xbh
+// I𑗂
+HRESULT CVideoMux::EndOfStream()
+{
+	if (m_rtFrameTime != 0) {
+		((CVideoMuxOutputPin*)m_pOutput)->Wake();
+		return S_OK;
+	}
+
+	return CBaseMux::EndOfStream();
+}
+
+
+HRESULT CVideoMux::EndOfStreamSlave(int nSlave)
+{
+	if (m_rtFrameTime != 0) {
+		((CVideoMuxOutputPin*)m_pOutput)->Wake();
+	}
+
+	return S_OK;
+}
+
+
+// ڑĂSĂ̓͂I
+BOOL CVideoMux::IsEndOfStream()
+{
+	if (!((CBaseMuxInputPin*)m_pInput)->IsEndOfStream()) {
+		return FALSE;
+	}
+
+	for (int i = 0; i < GetSlaveCount(); i++) {
+		CBaseMuxInputPin* pPin = GetSlaveInput(i);
+		if (pPin->IsConnected() && !pPin->IsEndOfStream()) {
+			return FALSE;
 		}
 	}
 
+	return TRUE;
+}
+
+
+// t[ԂƂ͏o̓s̃Xbh~߂ĂtbV
+HRESULT CVideoMux::BeginFlush()
+{
+	if (m_rtFrameTime == 0) {
+		return CBaseMux::BeginFlush();
+	}
+
+	((CVideoMuxOutputPin*)m_pOutput)->BeginFlush();
+	return S_OK;
+}
+
+
+HRESULT CVideoMux::EndFlush()
+{
+	if (m_rtFrameTime == 0) {
+		return CBaseMux::EndFlush();
+	}
+
+	((CVideoMuxOutputPin*)m_pOutput)->EndFlush();
+	return S_OK;
+}
+
+
+HRESULT CVideoMux::StoreFrame(INPUT_FRAME* pFrame, CBaseMuxInputPin* pPin,
+							  IMediaSample* pSample)
+{
+	HRESULT hr = S_OK;
+
+	InterlockedExchange(&pFrame->nReceiving, 1);
+	InterlockedIncrement(&pFrame->stats.nReceived);
+	if (pFrame->nComposing) {
+		InterlockedIncrement(&pFrame->stats.nSlaveOverlaps);
+	}
+
+	// ̃Tv͂܂ŏ㗬̃TvێB
+	// 㗬̃AP[^̃obt@1ƕێĂԂ͎̃Tv
+	// ͂Ȃ̂ŁÂƂ̓Rs[B
+	// ǂɂ邩͐ڑ͕ςȂB
+	// őxƂ̓^CX^vtŃRs[ė߂B
+	int cbTile = CalcStride(m_nWidth, m_nPixelPerBytes) * m_nHeight;
+	if (pFrame->pJitter) {
+		BYTE* pBuf;
+		hr = pSample->GetPointer(&pBuf);
+		if (hr == S_OK && pBuf) {
+			long cbSize = pSample->GetActualDataLength();
+			if (cbSize <= pFrame->pJitter->GetBlockSize()) {
+				REFERENCE_TIME rtStart, rtStop;
+				BOOL bTime = SUCCEEDED(pSample->GetTime(&rtStart, &rtStop));
+				int nDropped = pFrame->pJitter->Write(pBuf, cbSize, bTime,
+											rtStart, m_rtMaxSlaveLatency);
+				InterlockedExchangeAdd(&pFrame->stats.nDropped, nDropped);
+				pFrame->dwReceived = ::GetTickCount();
+				InterlockedIncrement(&pFrame->nSeq);
+			}
+		}
+	} else if (pPin->CanHoldSample()) {
+		// ^C菬Tv͎̂Ă
+		if (pSample->GetActualDataLength() >= cbTile) {
+			pFrame->dwReceived = ::GetTickCount();
+			pSample->AddRef();
+			IMediaSample* pOld = (IMediaSample*)InterlockedExchangePointer(
+										(PVOID*)&pFrame->pSample, pSample);
+			InterlockedIncrement(&pFrame->nSeq);
+			if (pOld) {
+				pOld->Release();
+			}
+		} else {
+			InterlockedIncrement(&pFrame->stats.nDropped);
+		}
+	} else {
+		BYTE* pBuf;
+		hr = pSample->GetPointer(&pBuf);
+		if (hr == S_OK && pBuf) {
+			long cbSize = pSample->GetActualDataLength();
+			if (cbSize <= pFrame->pBuf->GetBlockSize()) {
+				pFrame->pBuf->Write(pBuf, cbSize);
+				pFrame->dwReceived = ::GetTickCount();
+				InterlockedIncrement(&pFrame->nSeq);
+			}
+		}
+	}
+
+	InterlockedExchange(&pFrame->nReceiving, 0);
+
 	return hr;
 }
 
@@ -346,6 +1320,18 @@ HRESULT CVideoMux::CompleteConnect(PIN_DIRECTION direction, IPin *pReceivePin)
 		DBGWND_CREATE;
 	}
 
+	// ͂̃t[̃obt@͏o͂ȂƂɒ~ɍ
+	// GetMediaTypeōƍĐɂ蒼邱Ƃ
+	if (direction == PINDIR_OUTPUT) {
+		CAutoLock lock(&m_csFilter);
+		int bits = GetBmpBits(m_pOutput->CurrentMediaType().Subtype());
+		HRESULT hr = CreateBuffers(CalcStride(m_nWidth, bits/8) * m_nHeight);
+		if (FAILED(hr)) {
+			return hr;
+		}
+		m_nPixelPerBytes = bits/8;
+	}
+
 	return CBaseMux::CompleteConnect(direction, pReceivePin);
 }
 
@@ -359,9 +1345,30 @@ STDMETHODIMP CVideoMux::Stop()
 	m_nFrameCount = 0;
 #endif
 
-	m_pBuf->Clear();
+	HRESULT hr = CBaseMux::Stop();
+
+	// M̃X[u҂ĂA㗬̃AP[^ɃTvԂ
+	CAutoLock lock(&m_csReceive);
+	for (int i = 0; i < GetSlaveCount(); i++) {
+		CAutoLock lckSlave(GetSlaveInput(i)->GetSlaveLock());
+	}
+	ReleaseSamples();
+	for (int i = 0; i < m_nSlaveFrames; i++) {
+		INPUT_FRAME* pFrame = &m_pSlaveFrames[i];
+		pFrame->pBuf->Clear();
+		if (pFrame->pJitter) {
+			pFrame->pJitter->Clear();
+		}
+		pFrame->nSeq = 0;
+		pFrame->nComposedSeq = 0;
+	}
+	if (m_MasterFrame.pBuf) {
+		m_MasterFrame.pBuf->Clear();
+		m_MasterFrame.nSeq = 0;
+		m_MasterFrame.nComposedSeq = 0;
+	}
 
-	return CBaseMux::Stop();
+	return hr;
 }
 
 
@@ -373,18 +1380,62 @@ STDMETHODIMP CVideoMux::Pause()
 	DBGWND_RESET_RGB;
 #endif
 
-	return CBaseMux::Pause();
+	{
+		// Jn̓v
+		CAutoLock lock(&m_csFilter);
+		if (m_State == State_Stopped) {
+			for (int i = 0; i < m_nSlaveFrames; i++) {
+				ZeroMemory(&m_pSlaveFrames[i].stats,
+						   sizeof(VIDEOMUX_SLAVE_STATS));
+			}
+
+			HRESULT hr = CreateJitterBuffers();
+			if (FAILED(hr)) {
+				return hr;
+			}
+
+			// t[͂Ȃ͂͊JnÂȂ
+			m_dwStartTick = ::GetTickCount();
+		}
+	}
+
+	HRESULT hr = CBaseMux::Pause();
+	if (SUCCEEDED(hr) && m_rtFrameTime != 0) {
+		((CVideoMuxOutputPin*)m_pOutput)->SetState(State_Paused);
+	}
+
+	return hr;
+}
+
+
+// o̓s̃Xbhɂ͏ԂςĂʂ
+STDMETHODIMP CVideoMux::Run(REFERENCE_TIME tStart)
+{
+	HRESULT hr = CBaseMux::Run(tStart);
+	if (SUCCEEDED(hr) && m_rtFrameTime != 0) {
+		((CVideoMuxOutputPin*)m_pOutput)->SetState(State_Running);
+	}
+
+	return hr;
 }
 
 
 HRESULT CVideoMux::DecideBufferSize(AM_MEDIA_TYPE* pmt,
 									ALLOCATOR_PROPERTIES* pProp)
 {
-	ASSERT(m_pBuf);
+	ASSERT(m_pSlaveFrames);
 	ASSERT(m_nPixelPerBytes > 0);
 
-	pProp->cbBuffer = CalcStride(m_nWidth * 2, m_nPixelPerBytes) * m_nHeight;
+	pProp->cbBuffer = CalcStride(m_nWidth * m_nColumns, m_nPixelPerBytes)
+										* m_nHeight * m_nRows;
 	pProp->cbAlign = 4;
 
 	return S_OK;
 }
+
+
+CTransformOutputPin* CVideoMux::CreateOutputPin(HRESULT* phr)
+{
+	return new CVideoMuxOutputPin(NAME("Video Mux Output Pin"), this, phr,
+								  L"XForm Out");
+}
@@ -25,23 +25,122 @@
 
 #include "DbgWnd.h"
 #include "BaseMux.h"
+#include "IVideoMuxConfig.h"
 
 
 extern const AMOVIESETUP_FILTER sudVideoMux;
 
-class CToggleBuffer;
+// blocks of the frames kept for the max latency of a slave
+#define VIDEOMUX_MAX_JITTER_BLOCKS	(64)
+
+// frame times an input may go without a frame before it is stale
+#define VIDEOMUX_STALE_FRAMES	(4)
+
+class CTripleBuffer;
+class CJitterBuffer;
+class CVideoMux;
+
+/////////////////////////////////////////////////////////////////////////////
+// CVideoMuxOutputPin
+// with a frame time, delivers the composed inputs from its own thread,
+// paced by the clock, instead of on each master sample
+
+class CVideoMuxOutputPin : public CTransformOutputPin
+						 , public CAMThread
+{
+public:
+	CVideoMuxOutputPin(
+		LPCTSTR pObjectName,
+		CVideoMux *pFilter,
+		HRESULT * phr,
+		LPCWSTR pName);
+	virtual ~CVideoMuxOutputPin();
+
+	HRESULT Active();
+	HRESULT Inactive();
+	HRESULT Run(REFERENCE_TIME tStart);
+	void SetState(FILTER_STATE State);
+	void Wake();
+	void BeginFlush();
+	void EndFlush();
+
+protected:
+	enum Command { CMD_RUN, CMD_PAUSE, CMD_EXIT };
+
+	DWORD ThreadProc();
+	HRESULT DoBufferProcessingLoop();
+	BOOL IsRunning();
+	HRESULT GetStreamTime(REFERENCE_TIME* prtStream);
+	void WaitForFrameTime(REFERENCE_TIME rtTime, REFERENCE_TIME rtFrame);
+	void Wait(DWORD dwMilliseconds);
+
+private:
+	CVideoMux* m_pMux;
+	HANDLE m_hWake;		// the clock, a state, an end or a flush
+	HANDLE m_hStop;		// Inactive
+	int m_nFlushing;	// input pins in a flush, under the filter lock
+
+	// copies for the thread, which can't take the filter lock that Stop
+	// holds while it waits for the thread
+	CCritSec m_csTime;
+	IReferenceClock* m_pClock;
+	REFERENCE_TIME m_rtStart;
+	FILTER_STATE m_State;
+};
+
+
+/////////////////////////////////////////////////////////////////////////////
+// CVideoMux
 
 class CVideoMux : public CBaseMux
+				, public IVideoMuxConfig
 {
-	int const m_nWidth;
-	int const m_nHeight;
+	int m_nWidth;
+	int m_nHeight;
 	int m_nPixelPerBytes;
+	int m_nColumns;
+	int m_nRows;
+	REFERENCE_TIME m_rtMaxSlaveLatency;
+	REFERENCE_TIME m_rtFrameTime;
+	DWORD m_dwStartTick;
 
-	CToggleBuffer* m_pBuf;
+	// latest frame of an input, handed to the composer without locks: the
+	// upstream sample held if possible, or else a copy.
+	// with a max latency, the copies of a slave kept in pJitter instead
+	struct INPUT_FRAME
+	{
+		IMediaSample* volatile pSample;
+		CTripleBuffer* pBuf;
+		CJitterBuffer* pJitter;
+		volatile LONG nSeq;			// frames handed to the composer
+		LONG nComposedSeq;
+		volatile DWORD dwReceived;	// tick count of the last frame
+		volatile LONG nReceiving;
+		volatile LONG nComposing;
+		VIDEOMUX_SLAVE_STATS stats;
+	};
+	INPUT_FRAME* m_pSlaveFrames;
+	int m_nSlaveFrames;
+	// the master, composed from here only with a frame time
+	INPUT_FRAME m_MasterFrame;
 public:
 	DECLARE_IUNKNOWN;
 	static CUnknown* WINAPI CreateInstance(LPUNKNOWN punk, HRESULT* phr);
 
+	STDMETHODIMP NonDelegatingQueryInterface(REFIID riid, void** ppv);
+
+	// IVideoMuxConfig
+	STDMETHODIMP SetGrid(int nColumns, int nRows);
+	STDMETHODIMP GetGrid(int* pnColumns, int* pnRows);
+	STDMETHODIMP SetCellSize(int nWidth, int nHeight);
+	STDMETHODIMP GetCellSize(int* pnWidth, int* pnHeight);
+	STDMETHODIMP SetMaxSlaveLatency(REFERENCE_TIME rtLatency);
+	STDMETHODIMP GetMaxSlaveLatency(REFERENCE_TIME* prtLatency);
+	STDMETHODIMP GetSlaveStats(int nSlave, VIDEOMUX_SLAVE_STATS* pStats);
+	STDMETHODIMP SetFrameTime(REFERENCE_TIME rtFrame);
+	STDMETHODIMP GetFrameTime(REFERENCE_TIME* prtFrame);
+	STDMETHODIMP IsInputStale(int nInput, BOOL* pbStale);
+
 protected:
 	CVideoMux(LPUNKNOWN punk, HRESULT* phr, int nWidth, int hHeight);
 	~CVideoMux();
@@ -52,20 +151,50 @@ public:
 	HRESULT CheckTransform(const CMediaType *mtIn, const CMediaType *mtOut);
 	HRESULT Transform(IMediaSample *pSource, IMediaSample *pDest);
 
-	HRESULT ReceiveSlave(IMediaSample *pSample);
+	HRESULT Receive(IMediaSample *pSample);
+	HRESULT EndOfStream();
+	HRESULT BeginFlush();
+	HRESULT EndFlush();
+	HRESULT ReceiveSlave(int nSlave, IMediaSample *pSample);
+	HRESULT EndOfStreamSlave(int nSlave);
 
 	HRESULT CompleteConnect(PIN_DIRECTION direction, IPin *pReceivePin);
 
 	STDMETHODIMP Stop();
 	STDMETHODIMP Pause();
+	STDMETHODIMP Run(REFERENCE_TIME tStart);
 
 protected:
 	HRESULT DecideBufferSize(AM_MEDIA_TYPE* pmt, ALLOCATOR_PROPERTIES* pProp);
+	int GetMaxSlaveCount() { return m_nColumns * m_nRows - 1; }
+	CTransformOutputPin* CreateOutputPin(HRESULT* phr);
 
 protected:
 	int CalcStride(int w, int nPixelPerBytes) {
 		return ((w * nPixelPerBytes) + 3) & 0xfffffffc;
 	};
+	BOOL IsInputConnected();
+	HRESULT CreateBuffers(int cbSize);
+	void DeleteBuffers();
+	void ReleaseSamples();
+	HRESULT CreateJitterBuffers();
+	HRESULT ComposeFrame(IMediaSample* pDest, BOOL bTime,
+						 REFERENCE_TIME rtTime);
+	void Compose(BYTE* pDstBuf, const BYTE* pMasterBuf, BOOL bTime,
+				 REFERENCE_TIME rtTime);
+	HRESULT StoreFrame(INPUT_FRAME* pFrame, CBaseMuxInputPin* pPin,
+					   IMediaSample* pSample);
+	void CopyFrameTile(INPUT_FRAME* pFrame, CBaseMuxInputPin* pPin,
+					   BYTE* pDst, int nDstStride, BOOL bTime,
+					   REFERENCE_TIME rtTime);
+	void CountComposed(INPUT_FRAME* pFrame, LONG nSeq);
+	BOOL IsStale(INPUT_FRAME* pFrame, CBaseMuxInputPin* pPin);
+	BOOL IsEndOfStream();
+	void MarkStaleTile(BYTE* pDst, int nDstStride);
+	void CopyTile(BYTE* pDst, int nDstStride, const BYTE* pSrc,
+				  int nSrcStride);
 
 	DECLARE_DBGWND;
+
+	friend class CVideoMuxOutputPin;
 };
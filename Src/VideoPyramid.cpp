@@ -0,0 +1,702 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Motoharu Tsubaki.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a 
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <streams.h>
+#include <olectl.h>
+#include <initguid.h>
+
+#include <Strsafe.h>
+#include "VideoResizeBase.h"
+#include "VideoPyramid.h"
+#include "DSFiltersGuids.h"
+
+// 1̓͂畡̃TCYo͂tB^[
+// ̓s
+//	Videoñrbg}bvn
+// o̓s
+//	xƂVideoñrbg}bvn
+//  x0Video ResizerƓBx1ȍ~͊ex̃TCY
+//  TCYďo͂
+//  ex͑Õx̏o͂kA͂ǂݒȂ
+//  Xg[~Oɂ̓x0̏o͂̐ڑKv
+
+const AMOVIESETUP_MEDIATYPE sudOpPinTypes[] =
+{
+	{
+		&MEDIATYPE_Video,		// Major type
+		&MEDIASUBTYPE_NULL		// Minor type
+	}
+};
+
+// ́Ax0̏óAx1ȍ~̏o
+// x1ȍ~̏o͂͐ڑȂĂ悢
+const AMOVIESETUP_PIN sudOpPin[1 + PYRAMID_LEVELS] =
+{
+	{
+		L"",					// Pin string name
+		FALSE,					// Is it rendered
+		FALSE,					// Is it an output
+		FALSE,					// Allowed none
+		FALSE,					// Allowed many
+		&GUID_NULL,				// Connects to filter
+		NULL,					// Connects to pin
+		1,						// Number of types
+		sudOpPinTypes			// Pin information
+	},
+	{
+		L"",					// Pin string name
+		FALSE,					// Is it rendered
+		TRUE,					// Is it an output
+		FALSE,					// Allowed none
+		FALSE,					// Allowed many
+		&GUID_NULL,				// Connects to filter
+		NULL,					// Connects to pin
+		1,						// Number of types
+		sudOpPinTypes			// Pin information
+	},
+	{
+		L"",					// Pin string name
+		FALSE,					// Is it rendered
+		TRUE,					// Is it an output
+		TRUE,					// Allowed none
+		FALSE,					// Allowed many
+		&GUID_NULL,				// Connects to filter
+		NULL,					// Connects to pin
+		1,						// Number of types
+		sudOpPinTypes			// Pin information
+	},
+	{
+		L"",					// Pin string name
+		FALSE,					// Is it rendered
+		TRUE,					// Is it an output
+		TRUE,					// Allowed none
+		FALSE,					// Allowed many
+		&GUID_NULL,				// Connects to filter
+		NULL,					// Connects to pin
+		1,						// Number of types
+		sudOpPinTypes			// Pin information
+	},
+};
+
+extern const AMOVIESETUP_FILTER sudVideoPyramid =
+{
+	&CLSID_VideoPyramid,		// Filter CLSID
+	L"Video Pyramid",			// String name
+	MERIT_DO_NOT_USE,			// Filter merit
+	1 + PYRAMID_LEVELS,			// Number pins
+	sudOpPin					// Pin details
+};
+
+// ex̏TCY
+static const SIZE s_LevelSizes[PYRAMID_LEVELS] =
+{
+	{ 1280, 720 },
+	{ 640, 360 },
+	{ 320, 180 },
+};
+
+
+// ͂̃Tv̎ƃtOx̏o͂
+static void CopySampleProps(IMediaSample *pSource, IMediaSample *pDest,
+							BOOL bDiscontinuity)
+{
+	REFERENCE_TIME tStart, tStop;
+	HRESULT hr = pSource->GetTime(&tStart, &tStop);
+	if (hr == S_OK)
+	{
+		pDest->SetTime(&tStart, &tStop);
+	}
+	else if (hr == VFW_S_NO_STOP_TIME)
+	{
+		pDest->SetTime(&tStart, NULL);
+	}
+
+	LONGLONG tMediaStart, tMediaStop;
+	if (pSource->GetMediaTime(&tMediaStart, &tMediaStop) == S_OK)
+	{
+		pDest->SetMediaTime(&tMediaStart, &tMediaStop);
+	}
+
+	pDest->SetSyncPoint(pSource->IsSyncPoint() == S_OK);
+	pDest->SetPreroll(pSource->IsPreroll() == S_OK);
+	pDest->SetDiscontinuity(bDiscontinuity
+							|| pSource->IsDiscontinuity() == S_OK);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+// CVideoPyramidOutputPin
+
+CVideoPyramidOutputPin::CVideoPyramidOutputPin(LPCTSTR pObjectName,
+											   CVideoPyramid *pFilter,
+											   HRESULT* phr,
+											   LPCWSTR pName, int nLevel)
+	: CTransformOutputPin(pObjectName, pFilter, phr, pName)
+	, m_pPyramid(pFilter)
+	, m_nLevel(nLevel)
+{
+}
+
+
+// NX̓x0̃TCU[ŃlSVG[V̂ŁA
+// ̃x̃TCU[ōs
+HRESULT CVideoPyramidOutputPin::CheckMediaType(const CMediaType *pmt)
+{
+	if (!m_pPyramid->m_pInput->IsConnected())
+	{
+		return E_INVALIDARG;
+	}
+
+	return m_pPyramid->CheckOutputType(m_pPyramid->m_pLevels[m_nLevel],
+						&m_pPyramid->m_pInput->CurrentMediaType(), pmt);
+}
+
+
+HRESULT CVideoPyramidOutputPin::SetMediaType(const CMediaType *pmt)
+{
+	CAutoLock lock(m_pLock);
+
+	HRESULT hr = CBasePin::SetMediaType(pmt);
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+
+	return m_pPyramid->SetOutputMediaType(m_pPyramid->m_pLevels[m_nLevel],
+										  pmt);
+}
+
+
+HRESULT CVideoPyramidOutputPin::GetMediaType(int iPosition,
+											 CMediaType *pMediaType)
+{
+	if (!m_pPyramid->m_pInput->IsConnected())
+	{
+		return VFW_S_NO_MORE_ITEMS;
+	}
+
+	return m_pPyramid->GetOutputMediaType(m_pPyramid->m_pLevels[m_nLevel],
+										  iPosition, pMediaType);
+}
+
+
+HRESULT CVideoPyramidOutputPin::DecideBufferSize(IMemAllocator *pAlloc,
+												 ALLOCATOR_PROPERTIES *pProp)
+{
+	return m_pPyramid->DecideOutputBufferSize(this,
+									m_pPyramid->m_pLevels[m_nLevel],
+									pAlloc, pProp);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+// CVideoPyramid
+
+CUnknown * WINAPI CVideoPyramid::CreateInstance(LPUNKNOWN punk,
+		HRESULT *phr)
+{
+	CVideoPyramid *pFilter = new CVideoPyramid(punk);
+	
+	if (pFilter == NULL || pFilter->m_pResizer == NULL)
+	{
+		*phr = E_OUTOFMEMORY;
+		return pFilter;
+	}
+
+	for (int i = 1; i < PYRAMID_LEVELS; i++)
+	{
+		if (pFilter->m_pLevels[i] == NULL)
+		{
+			*phr = E_OUTOFMEMORY;
+			return pFilter;
+		}
+	}
+
+	*phr = S_OK;
+	return pFilter;
+}
+
+
+// ex̓x0Ɠ[J[ŏ
+CVideoPyramid::CVideoPyramid(LPUNKNOWN punk)
+	: CVideoResizer(punk, NAME("VideoPyramid"), CLSID_VideoPyramid)
+{
+	ZeroMemory(m_pLevels, sizeof(m_pLevels));
+	ZeroMemory(m_pLevelPins, sizeof(m_pLevelPins));
+
+	if (m_pResizer == NULL)
+	{
+		return;
+	}
+	m_pResizer->SetOutputSize(s_LevelSizes[0].cx, s_LevelSizes[0].cy);
+
+	for (int i = 1; i < PYRAMID_LEVELS; i++)
+	{
+		HRESULT hr;
+		CVideoResizeBase* pResizer = new CVideoResizeBase(
+					s_LevelSizes[i].cx, s_LevelSizes[i].cy, &hr);
+		if (hr != S_OK)
+		{
+			pResizer->NonDelegatingRelease();
+			return;
+		}
+
+		pResizer->SetAlgorithm(m_nAlgorithm);
+		pResizer->SetTiling(m_nTiling);
+		pResizer->SetWorkerPool(&m_WorkerPool);
+		m_pLevels[i] = pResizer;
+	}
+}
+
+
+CVideoPyramid::~CVideoPyramid()
+{
+	for (int i = 1; i < PYRAMID_LEVELS; i++)
+	{
+		delete m_pLevelPins[i];
+		delete m_pLevels[i];
+	}
+}
+
+
+STDMETHODIMP CVideoPyramid::NonDelegatingQueryInterface(REFIID riid,
+														void** ppv)
+{
+	CheckPointer(ppv, E_POINTER);
+
+	if (riid == IID_IVideoPyramidConfig)
+	{
+		return GetInterface((IVideoPyramidConfig*)(this), ppv);
+	}
+
+	return CVideoResizer::NonDelegatingQueryInterface(riid, ppv);
+}
+
+
+STDMETHODIMP CVideoPyramid::GetLevelCount(int* pnLevels)
+{
+	CheckPointer(pnLevels, E_POINTER);
+
+	*pnLevels = PYRAMID_LEVELS;
+
+	return S_OK;
+}
+
+
+// x̏o̓TCY̕ύX
+// ~̂݁Bo̓sڑς݂ȂVTCYōĐڑ
+STDMETHODIMP CVideoPyramid::SetLevelSize(int nLevel, int nWidth, int nHeight)
+{
+	if (nLevel < 0 || nLevel >= PYRAMID_LEVELS)
+	{
+		return E_INVALIDARG;
+	}
+
+	if (nLevel == 0)
+	{
+		return SetOutputSize(nWidth, nHeight);
+	}
+
+	CAutoLock lock(&m_csFilter);
+
+	if (m_State != State_Stopped)
+	{
+		return VFW_E_NOT_STOPPED;
+	}
+
+	CVideoResizeBase* pResizer = m_pLevels[nLevel];
+	if (nWidth == pResizer->GetToWidth()
+		&& nHeight == pResizer->GetToHeight())
+	{
+		return S_OK;
+	}
+
+	// YUV̓͂͐FLsNZ̔{̂
+	if (m_pInput != NULL && m_pInput->IsConnected()
+		&& !pResizer->IsAlignedSize(nWidth, nHeight))
+	{
+		return E_INVALIDARG;
+	}
+
+	HRESULT hr = pResizer->SetOutputSize(nWidth, nHeight);
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+
+	CVideoPyramidOutputPin* pPin = m_pLevelPins[nLevel];
+	if (pPin != NULL && pPin->IsConnected())
+	{
+		hr = ReconnectPin(pPin, NULL);
+	}
+
+	return hr;
+}
+
+
+STDMETHODIMP CVideoPyramid::GetLevelSize(int nLevel, int* pnWidth,
+										 int* pnHeight)
+{
+	CheckPointer(pnWidth, E_POINTER);
+	CheckPointer(pnHeight, E_POINTER);
+
+	if (nLevel < 0 || nLevel >= PYRAMID_LEVELS)
+	{
+		return E_INVALIDARG;
+	}
+
+	CAutoLock lock(&m_csFilter);
+	CVideoResizeBase* pResizer = GetLevelResizer(nLevel);
+	*pnWidth = pResizer->GetToWidth();
+	*pnHeight = pResizer->GetToHeight();
+
+	return S_OK;
+}
+
+
+// 0: , 1: x0̏o, 2ȍ~: x1ȍ~̏o
+CBasePin * CVideoPyramid::GetPin(int n)
+{
+	if (n < 2)
+	{
+		return CVideoResizer::GetPin(n);
+	}
+
+	if (n >= GetPinCount())
+	{
+		return NULL;
+	}
+
+	if (m_pLevelPins[1] == NULL)
+	{
+		if (BuildLevelPins() != S_OK)
+		{
+			return NULL;
+		}
+	}
+
+	return m_pLevelPins[n - 1];
+}
+
+
+STDMETHODIMP CVideoPyramid::FindPin(LPCWSTR Id, IPin **ppPin)
+{
+	CheckPointer(ppPin, E_POINTER);
+	ValidateReadWritePtr(ppPin, sizeof(IPin *));
+
+	for (int i = 1; i < PYRAMID_LEVELS; i++)
+	{
+		CBasePin* pPin = GetPin(i + 1);
+		if (pPin != NULL && 0 == lstrcmpW(Id, pPin->Name()))
+		{
+			*ppPin = pPin;
+			pPin->AddRef();
+			return S_OK;
+		}
+	}
+
+	return CVideoResizer::FindPin(Id, ppPin);
+}
+
+
+HRESULT CVideoPyramid::BuildLevelPins()
+{
+	for (int i = 1; i < PYRAMID_LEVELS; i++)
+	{
+		WCHAR szName[16];
+		StringCchPrintfW(szName, 16, L"Level %d", i);
+
+		HRESULT hr = S_OK;
+		m_pLevelPins[i] = new CVideoPyramidOutputPin(
+							NAME("VideoPyramidOutputPin"), this, &hr,
+							szName, i);
+		if (m_pLevelPins[i] == NULL || hr != S_OK)
+		{
+			for (int j = 1; j <= i; j++)
+			{
+				delete m_pLevelPins[j];
+				m_pLevelPins[j] = NULL;
+			}
+			return (hr != S_OK) ? hr : E_OUTOFMEMORY;
+		}
+	}
+
+	return S_OK;
+}
+
+
+// ex͓͂Ɠ^CvŁAFLsNZ̔{̃TCŶ
+HRESULT CVideoPyramid::CheckInputType(const CMediaType *mtIn)
+{
+	HRESULT hr = CVideoResizer::CheckInputType(mtIn);
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+
+	RESIZE_KERNELS kernels;
+	hr = m_pResizer->IsSupportMediaSubType(mtIn->Subtype(), &kernels);
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+
+	for (int i = 1; i < PYRAMID_LEVELS; i++)
+	{
+		CVideoResizeBase* pResizer = m_pLevels[i];
+		if (pResizer->GetToWidth() % kernels.nBlockWidth != 0
+			|| pResizer->GetToHeight() % kernels.nBlockHeight != 0)
+		{
+			DbgLog((LOG_TRACE, 1, TEXT(" => NOT ACCEPTED")));
+			return VFW_E_TYPE_NOT_ACCEPTED;
+		}
+	}
+
+	return S_OK;
+}
+
+
+// ex̃TCU[ڑ͂̃^Cvɂ
+HRESULT CVideoPyramid::SetMediaType(PIN_DIRECTION direction,
+									const CMediaType *pmt)
+{
+	HRESULT hr = CVideoResizer::SetMediaType(direction, pmt);
+	if (FAILED(hr) || direction != PINDIR_INPUT)
+	{
+		return hr;
+	}
+
+	for (int i = 1; i < PYRAMID_LEVELS; i++)
+	{
+		hr = m_pLevels[i]->SetMediaSubType(pmt->Subtype());
+		if (FAILED(hr))
+		{
+			return hr;
+		}
+	}
+
+	return S_OK;
+}
+
+
+// x0̏o͂͑OȂ̂ŁAx1ȍ~̏kɎg
+HRESULT CVideoPyramid::Transform(IMediaSample *pSource, IMediaSample *pDest)
+{
+	HRESULT hr = CVideoResizer::Transform(pSource, pDest);
+	if (hr != S_OK)
+	{
+		return hr;
+	}
+
+	DeliverLevels(pSource, pDest);
+	return S_OK;
+}
+
+
+// x0͓͂̂
+HRESULT CVideoPyramid::DeliverPassThrough(IMediaSample *pSample)
+{
+	DeliverLevels(pSample, pSample);
+	return CVideoResizer::DeliverPassThrough(pSample);
+}
+
+
+// x1ȍ~kđ
+// ex́AϊĂȂÕx̂̃xȏ̃TCY
+// ło͂kBȂΓ͂k
+// Õxkɂ̂ŁASxkĂ瑗
+// ex̏k̓[J[ŕɍs
+// sx͑炸AkɂgȂBx0Ə㗬͎~߂Ȃ
+void CVideoPyramid::DeliverLevels(IMediaSample *pSource,
+								  IMediaSample *pLevel0)
+{
+	IMediaSample* pSamples[PYRAMID_LEVELS] = { pLevel0 };
+
+	// x0̕ԁAʐϕςƏɍ킹
+	int nAlgorithm;
+	BOOL bAreaAverage;
+	{
+		CAutoLock lock(&m_csQuality);
+		nAlgorithm = GetQualityAlgorithm(m_nQualityLevel);
+		bAreaAverage = IsQualityAreaAverage(m_nQualityLevel);
+	}
+
+	for (int i = 1; i < PYRAMID_LEVELS; i++)
+	{
+		CVideoPyramidOutputPin* pPin = m_pLevelPins[i];
+		if (pPin == NULL || !pPin->IsConnected())
+		{
+			continue;
+		}
+
+		CVideoResizeBase* pResizer = m_pLevels[i];
+		if (pResizer->GetAlgorithm() != nAlgorithm)
+		{
+			pResizer->SetAlgorithm(nAlgorithm);
+		}
+		if (pResizer->GetTiling() != m_nTiling)
+		{
+			pResizer->SetTiling(m_nTiling);
+		}
+		if (pResizer->GetAreaAverage() != bAreaAverage)
+		{
+			pResizer->SetAreaAverage(bAreaAverage);
+		}
+
+		// k
+		// ͂kƂ̓x0Ɠ`؂o
+		RECT rc;
+		m_pResizer->GetSourceRect(m_nSrcWidth, abs(m_nSrcHeight), &rc);
+		IMediaSample* pFrom = pSource;
+		int nFromWidth = m_nSrcWidth;
+		int nFromHeight = m_nSrcHeight;
+		int nFromArea = (rc.right - rc.left) * (rc.bottom - rc.top);
+		for (int j = 0; j < i; j++)
+		{
+			CVideoResizeBase* pLevel = GetLevelResizer(j);
+			int nWidth = pLevel->GetToWidth();
+			int nHeight = pLevel->GetToHeight();
+			if (pSamples[j] == NULL || pLevel->IsConverting()
+				|| nWidth < pResizer->GetToWidth()
+				|| nHeight < pResizer->GetToHeight()
+				|| nWidth * nHeight >= nFromArea)
+			{
+				continue;
+			}
+
+			pFrom = pSamples[j];
+			nFromWidth = nWidth;
+			nFromHeight = pLevel->IsTopDown() ? -nHeight : nHeight;
+			nFromArea = nWidth * nHeight;
+		}
+		pResizer->SetSourceRect((pFrom == pSource)
+								? &m_pResizer->m_rcSource : NULL);
+
+		IMediaSample* pOut = NULL;
+		HRESULT hr = pPin->GetDeliveryBuffer(&pOut, NULL, NULL, 0);
+		if (FAILED(hr))
+		{
+			DbgLog((LOG_ERROR, 1, TEXT("level %d: no buffer %08x"), i, hr));
+			continue;
+		}
+
+		CopySampleProps(pSource, pOut, m_bSampleSkipped);
+		hr = pResizer->Transform(pFrom, nFromWidth, nFromHeight, pOut);
+		if (hr != S_OK)
+		{
+			DbgLog((LOG_ERROR, 1, TEXT("level %d: transform %08x"), i, hr));
+			pOut->Release();
+			continue;
+		}
+		pSamples[i] = pOut;
+	}
+
+	// 1̏o͂̎ső̏o͂~߂Ȃ
+	for (int i = 1; i < PYRAMID_LEVELS; i++)
+	{
+		if (pSamples[i] == NULL)
+		{
+			continue;
+		}
+
+		m_pLevelPins[i]->Deliver(pSamples[i]);
+		pSamples[i]->Release();
+	}
+}
+
+
+HRESULT CVideoPyramid::EndOfStream()
+{
+	for (int i = 1; i < PYRAMID_LEVELS; i++)
+	{
+		if (m_pLevelPins[i] != NULL)
+		{
+			m_pLevelPins[i]->DeliverEndOfStream();
+		}
+	}
+
+	return CVideoResizer::EndOfStream();
+}
+
+
+HRESULT CVideoPyramid::BeginFlush()
+{
+	for (int i = 1; i < PYRAMID_LEVELS; i++)
+	{
+		if (m_pLevelPins[i] != NULL)
+		{
+			m_pLevelPins[i]->DeliverBeginFlush();
+		}
+	}
+
+	return CVideoResizer::BeginFlush();
+}
+
+
+HRESULT CVideoPyramid::EndFlush()
+{
+	for (int i = 1; i < PYRAMID_LEVELS; i++)
+	{
+		if (m_pLevelPins[i] != NULL)
+		{
+			m_pLevelPins[i]->DeliverEndFlush();
+		}
+	}
+
+	return CVideoResizer::EndFlush();
+}
+
+
+HRESULT CVideoPyramid::NewSegment(REFERENCE_TIME tStart,
+								  REFERENCE_TIME tStop, double dRate)
+{
+	for (int i = 1; i < PYRAMID_LEVELS; i++)
+	{
+		if (m_pLevelPins[i] != NULL)
+		{
+			m_pLevelPins[i]->DeliverNewSegment(tStart, tStop, dRate);
+		}
+	}
+
+	return CVideoResizer::NewSegment(tStart, tStop, dRate);
+}
+
+
+// NX̓x0̏o͂̂ݎ~߂̂ŁAMIĂ
+// x1ȍ~̏o͂~߂
+STDMETHODIMP CVideoPyramid::Stop()
+{
+	HRESULT hr = CVideoResizer::Stop();
+
+	CAutoLock lock1(&m_csFilter);
+	CAutoLock lock2(&m_csReceive);
+	for (int i = 1; i < PYRAMID_LEVELS; i++)
+	{
+		if (m_pLevelPins[i] != NULL && m_pLevelPins[i]->IsConnected())
+		{
+			m_pLevelPins[i]->Inactive();
+		}
+	}
+
+	return hr;
+}
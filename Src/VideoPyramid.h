@@ -0,0 +1,110 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Motoharu Tsubaki.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a 
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "VideoResizer.h"
+#include "IVideoPyramidConfig.h"
+
+extern const AMOVIESETUP_FILTER sudVideoPyramid;
+
+class CVideoPyramid;
+
+/////////////////////////////////////////////////////////////////////////////
+// CVideoPyramidOutputPin
+// output of a level after level 0, negotiated with the resizer of the level
+
+class CVideoPyramidOutputPin : public CTransformOutputPin
+{
+public:
+	CVideoPyramidOutputPin(
+		LPCTSTR pObjectName,
+		CVideoPyramid *pFilter,
+		HRESULT * phr,
+		LPCWSTR pName,
+		int nLevel);
+
+	HRESULT CheckMediaType(const CMediaType *pmt);
+	HRESULT SetMediaType(const CMediaType *pmt);
+	HRESULT GetMediaType(int iPosition, CMediaType *pMediaType);
+	HRESULT DecideBufferSize(IMemAllocator *pAlloc,
+							 ALLOCATOR_PROPERTIES *pProp);
+
+private:
+	CVideoPyramid* m_pPyramid;
+	int m_nLevel;
+};
+
+
+/////////////////////////////////////////////////////////////////////////////
+// CVideoPyramid
+// the Video Resizer with an output for each level, scaled in cascade
+
+class CVideoPyramid : public CVideoResizer
+					, public IVideoPyramidConfig
+{
+public:
+	DECLARE_IUNKNOWN;
+	static CUnknown * WINAPI CreateInstance(LPUNKNOWN punk, HRESULT *phr);
+
+	CVideoPyramid(LPUNKNOWN punk);
+	virtual ~CVideoPyramid();
+
+	STDMETHODIMP NonDelegatingQueryInterface(REFIID riid, void** ppv);
+
+	// IVideoPyramidConfig
+	STDMETHODIMP GetLevelCount(int* pnLevels);
+	STDMETHODIMP SetLevelSize(int nLevel, int nWidth, int nHeight);
+	STDMETHODIMP GetLevelSize(int nLevel, int* pnWidth, int* pnHeight);
+
+	// override
+	int GetPinCount() { return 1 + PYRAMID_LEVELS; }
+	CBasePin * GetPin(int n);
+	STDMETHODIMP FindPin(LPCWSTR Id, IPin **ppPin);
+
+	HRESULT CheckInputType(const CMediaType *mtIn);
+	HRESULT SetMediaType(PIN_DIRECTION direction, const CMediaType *pmt);
+	HRESULT Transform(IMediaSample *pSource, IMediaSample *pDest);
+
+	HRESULT EndOfStream();
+	HRESULT BeginFlush();
+	HRESULT EndFlush();
+	HRESULT NewSegment(REFERENCE_TIME tStart, REFERENCE_TIME tStop,
+					   double dRate);
+
+	STDMETHODIMP Stop();
+
+protected:
+	HRESULT DeliverPassThrough(IMediaSample *pSample);
+	void DeliverLevels(IMediaSample *pSource, IMediaSample *pLevel0);
+	HRESULT BuildLevelPins();
+	CVideoResizeBase* GetLevelResizer(int nLevel)
+		{ return (nLevel == 0) ? m_pResizer : m_pLevels[nLevel]; }
+
+protected:
+	friend class CVideoPyramidOutputPin;
+
+	// level 0 is m_pResizer and m_pOutput
+	CVideoResizeBase* m_pLevels[PYRAMID_LEVELS];
+	CVideoPyramidOutputPin* m_pLevelPins[PYRAMID_LEVELS];
+};
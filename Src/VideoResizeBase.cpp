@@ -27,9 +27,34 @@
 #include <olectl.h>
 #include <initguid.h>
 
+#include <emmintrin.h>
+
 #include "Utils.h"
 #include "VideoResizeBase.h"
 
+// output lines of a band, from the source and output bytes of a line
+#define BAND_CACHE_SIZE		(256 * 1024)
+#define BAND_MIN_LINES		(8)
+
+// frames smaller than this are scaled on the caller's thread
+#define INLINE_FRAME_SIZE	(256 * 1024)
+
+// tiles of the output columns, whose source spans and row caches fit in
+// the cache of a worker, in multiples of the pixels
+#define TILE_CACHE_SIZE		(128 * 1024)
+#define TILE_ALIGN			(64)
+
+// output frames larger than this are left out of the cache by
+// RESIZE_TILING_AUTO
+#define STREAM_FRAME_SIZE	(8 * 1024 * 1024)
+
+
+static BOOL IsPolyphase(int nAlgorithm)
+{
+	return nAlgorithm == RESIZE_BICUBIC || nAlgorithm == RESIZE_LANCZOS2
+			|| nAlgorithm == RESIZE_LANCZOS3;
+}
+
 
 CVideoResizeBase::CVideoResizeBase(int toWidth, int toHeight, HRESULT* phr)
 	: CUnknown(NAME("Video Resize Base"), NULL)
@@ -37,47 +62,106 @@ CVideoResizeBase::CVideoResizeBase(int toWidth, int toHeight, HRESULT* phr)
 	, m_nToHeight(toHeight)
 	, m_MediaSubType(GUID_NULL)
 	, m_nBytesPerPixel(0)
+	, m_nAlgorithm(RESIZE_NEAREST)
+	, m_nScaleMode(RESIZE_NEAREST)
+	, m_bTopDown(FALSE)
 	, m_nSrcWidth(0)
 	, m_nSrcHeight(0)
+	, m_pTable(NULL)
+	, m_bPremultiply(FALSE)
+	, m_pLoadBuf(NULL)
+	, m_pRowCache(NULL)
+	, m_bAllowAreaAverage(TRUE)
+	, m_bAreaAverage(FALSE)
+	, m_pAreaAcc(NULL)
+	, m_pAreaSum(NULL)
+	, m_nTiling(RESIZE_TILING_ROWS)
+	, m_bTiled(FALSE)
+	, m_nTileWidth(toWidth)
+	, m_bStreamStores(FALSE)
+	, m_pWorkerPool(NULL)
+	, m_nWorkers(1)
+	, m_nBandLines(toHeight)
+	, m_bInline(TRUE)
+	, m_pSrcBuf(NULL)
+	, m_pDstBuf(NULL)
+	, m_nSrcStride(0)
+	, m_nDstStride(0)
+	, m_OutputSubType(GUID_NULL)
+	, m_nOutBytesPerPixel(0)
+	, m_pfnConvertLine(NULL)
+	, m_pfnPutLine(NULL)
+	, m_pLineBuf(NULL)
 {
 	ASSERT(phr);
 
-	m_pWScale = new ULONG[toWidth];
-	m_pHScale = new ULONG[toHeight];
+	::ZeroMemory(&m_Kernels, sizeof(m_Kernels));
+	m_Kernels.nLumaOffset = -1;
+	::ZeroMemory(m_pPlanes, sizeof(m_pPlanes));
+	::SetRectEmpty(&m_rcSource);
 
-	if (m_pWScale == NULL || m_pHScale == NULL) {
-		*phr = E_OUTOFMEMORY;
-		delete [] m_pWScale;
-		delete [] m_pHScale;
-		m_pWScale = NULL;
-		m_pHScale = NULL;
-	} else {
-		*phr = S_OK;
-	}
+	*phr = S_OK;
 }
 
 
 CVideoResizeBase::~CVideoResizeBase()
 {
-	delete [] m_pWScale;
-	delete [] m_pHScale;
+	FreePlanes();
+	if (m_pTable) {
+		m_pTable->Release();
+	}
+	delete [] m_pLoadBuf;
+	delete [] m_pRowCache;
+	delete [] m_pAreaAcc;
+	delete [] m_pAreaSum;
+	delete [] m_pLineBuf;
 }
 
 
+// the sub types that have the kernels, and the format of them
 STDMETHODIMP CVideoResizeBase::IsSupportMediaSubType(const GUID* pMediaSubType,
-													 int* pBits)
+													 RESIZE_KERNELS* pKernels)
 {
 	CheckPointer(pMediaSubType, E_POINTER);
-	CheckPointer(pBits, E_POINTER);
+	CheckPointer(pKernels, E_POINTER);
 
-	int bits = GetBmpBits(pMediaSubType);
-	if ((bits & 0x7) == 0) {
-		*pBits = bits;
-	} else {
-		return E_INVALIDARG;
+	return GetResizeKernels(pMediaSubType, 0, pKernels);
+}
+
+
+// the output sub types that an input sub type is converted to
+STDMETHODIMP CVideoResizeBase::IsSupportConversion(const GUID* pInputSubType,
+												   const GUID* pOutputSubType)
+{
+	CheckPointer(pInputSubType, E_POINTER);
+	CheckPointer(pOutputSubType, E_POINTER);
+
+	PFN_CONVERT_LINE pfnConvert;
+	return GetConvertLine(pInputSubType, pOutputSubType, 0, &pfnConvert);
+}
+
+
+// the size of the output frame in the sub type
+STDMETHODIMP_(int) CVideoResizeBase::GetOutputSize(const GUID* pOutputSubType)
+{
+	if (*pOutputSubType != m_MediaSubType) {
+		RESIZE_KERNELS kernels;
+		if (FAILED(GetResizeKernels(pOutputSubType, 0, &kernels))) {
+			return 0;
+		}
+		return ((m_nToWidth * kernels.nBytesPerPixel) + 3) / 4 * 4
+													* abs(m_nToHeight);
 	}
 
-	return S_OK;
+	int cbSize = CalcStride(m_nToWidth) * abs(m_nToHeight);
+
+	// the chroma planes of 1/4 pixels
+	if (m_Kernels.nPlanes > 1) {
+		cbSize += cbSize / 4 * m_Kernels.nChromaBytes
+											* (m_Kernels.nPlanes - 1);
+	}
+
+	return cbSize;
 }
 
 
@@ -97,117 +181,431 @@ STDMETHODIMP CVideoResizeBase::Transform(IMediaSample* pSrcSample,
 		return hr;
 	}
 
-	if (nWidth == m_nToWidth && abs(nHeight) == abs(m_nToHeight)) {
-		if (nHeight == m_nToHeight) {
+	// ͂Əo͂̌ႤƂ͏o͂̍ŏIC畉̃XgCh
+	// A㉺]gEkƓɍs
+	// YUV͍łォ牺
+	int nSrcStride = CalcStride(nWidth);
+	int nDstStride = CalcOutputStride(m_nToWidth);
+	BOOL bSrcTopDown = (nHeight < 0) || IsYUV();
+	BOOL bDstTopDown = m_bTopDown || (IsYUV() && !IsConverting());
+	if (bSrcTopDown != bDstTopDown) {
+		pDstBuf += nDstStride * (m_nToHeight - 1);
+		nDstStride = -nDstStride;
+	}
+
+	// ͂̋`́A̍ォ͂̃XgChŋ`̃TCY
+	// t[ƂēǂށBXP[e[u͋`̃TCŶ
+	// `͏ォ牺̍WŁA͉̓͂[̃Cǂ
+	RECT rc;
+	GetSourceRect(nWidth, abs(nHeight), &rc);
+	BOOL bCrop = IsCropping(nWidth, abs(nHeight));
+	int nFrameHeight = abs(nHeight);
+	LPBYTE pSrcFrame = pSrcBuf;
+	pSrcBuf += nSrcStride * (bSrcTopDown ? rc.top : nFrameHeight - rc.bottom)
+				+ rc.left * m_Kernels.nBytesPerPixel;
+	nWidth = rc.right - rc.left;
+	nHeight = (nHeight < 0) ? rc.top - rc.bottom : rc.bottom - rc.top;
+
+	if (!bCrop && nWidth == m_nToWidth && abs(nHeight) == m_nToHeight) {
+		if (nDstStride > 0 && m_pfnConvertLine == NULL) {
 			// PRs[
-			::CopyMemory(pDstBuf, pSrcBuf, pSrcSample->GetSize());
+			::CopyMemory(pDstBuf, pSrcBuf, GetSize());
 		} else {
-			// ㉺ւRs[
-			int nStride = CalcStride(m_nToWidth);
-			int h = abs(m_nToHeight);
-			for (int y = 1; y <= m_nToHeight; y++) {
-				BYTE* pSrcLine = pSrcBuf + nStride * (h - y);
-				::CopyMemory(pDstBuf, pSrcLine, nStride);
+			// ㉺ւEFϊȂRs[
+			LPBYTE pSrcLine = pSrcBuf;
+			LPBYTE pDstLine = pDstBuf;
+			for (int y = 0; y < m_nToHeight; y++) {
+				if (m_pfnConvertLine) {
+					m_pfnConvertLine(pDstLine, pSrcLine, m_nToWidth);
+				} else {
+					::CopyMemory(pDstLine, pSrcLine, nSrcStride);
+				}
+				pSrcLine += nSrcStride;
+				pDstLine += nDstStride;
 			}
 		}
 
-		pDstSample->SetActualDataLength(pSrcSample->GetSize());
+		pDstSample->SetActualDataLength(GetSize());
 	} else {
 		// gEk
-		SetupScaleTable(nWidth, nHeight);
+		int nWorkers = m_pWorkerPool ? m_pWorkerPool->GetThreadCount() : 1;
+		if (m_nWorkers != nWorkers) {
+			// reset the work buffers
+			m_nWorkers = nWorkers;
+			m_nSrcWidth = 0;
+			m_nSrcHeight = 0;
+		}
 
-		int nStride = CalcStride(m_nToWidth);
-		switch (m_nBytesPerPixel) {
-		case 1:
-			// MEDIASUBTYPE_RGB8
-			for (int y = 0; y < m_nToHeight; y++) {
-				LPBYTE pSrcLine = pSrcBuf + m_pHScale[y];
-				LPBYTE pDstPtr = pDstBuf + nStride * y;
-				for (int x = 0; x < m_nToWidth; x++) {
-					LPBYTE pSrcPtr = pSrcLine + m_pWScale[x];
-					*pDstPtr++ = *pSrcPtr;
-				}
-			}
-			break;
+		hr = SetupScaleTable(nWidth, nHeight);
+		if (SUCCEEDED(hr)) {
+			hr = SetupPlaneTables(nWidth, nHeight);
+		}
+		if (FAILED(hr)) {
+			return hr;
+		}
 
-		case 2:
-			// MEDIASUBTYPE_RGB565
-			// MEDIASUBTYPE_RGB555
-			// MEDIASUBTYPE_ARGB1555
-			// MEDIASUBTYPE_ARGB4444
-			for (int y = 0; y < m_nToHeight; y++) {
-				LPBYTE pSrcLine = pSrcBuf + m_pHScale[y];
-				LPBYTE pDstPtr = pDstBuf + nStride * y;
-				for (int x = 0; x < m_nToWidth; x++) {
-					LPBYTE pSrcPtr = pSrcLine + m_pWScale[x];
-					*pDstPtr++ = *pSrcPtr++;
-					*pDstPtr++ = *pSrcPtr;
-				}
-			}
-			break;
+		if (m_nScaleMode == RESIZE_NEAREST && !m_bAreaAverage
+				&& m_Kernels.pfnScaleLineC == NULL) {
+			return E_FAIL;
+		}
 
-		case 3:
-			// MEDIASUBTYPE_RGB24
-			for (int y = 0; y < m_nToHeight; y++) {
-				LPBYTE pSrcLine = pSrcBuf + m_pHScale[y];
-				LPBYTE pDstPtr = pDstBuf + nStride * y;
-				for (int x = 0; x < m_nToWidth; x++) {
-					LPBYTE pSrcPtr = pSrcLine + m_pWScale[x];
-					*pDstPtr++ = *pSrcPtr++;
-					*pDstPtr++ = *pSrcPtr++;
-					*pDstPtr++ = *pSrcPtr;
-				}
-			}
-			break;
+		m_pSrcBuf = pSrcBuf;
+		m_pDstBuf = pDstBuf;
+		m_nSrcStride = nSrcStride;
+		m_nDstStride = nDstStride;
 
-		case 4:
-			// MEDIASUBTYPE_RGB32
-			// MEDIASUBTYPE_ARGB32
-			// MEDIASUBTYPE_A2R10G10B10
-			// MEDIASUBTYPE_A2B10G10R10
-			for (int y = 0; y < m_nToHeight; y++) {
-				LPBYTE pSrcLine = pSrcBuf + m_pHScale[y];
-				LPBYTE pDstPtr = pDstBuf + nStride * y;
-				for (int x = 0; x < m_nToWidth; x++) {
-					LPBYTE pSrcPtr = pSrcLine + m_pWScale[x];
-					*pDstPtr++ = *pSrcPtr++;
-					*pDstPtr++ = *pSrcPtr++;
-					*pDstPtr++ = *pSrcPtr++;
-					*pDstPtr++ = *pSrcPtr;
-				}
-			}
-			break;
+		// the chroma planes follow the luma plane
+		int nPlanes = m_Kernels.nPlanes - 1;
+		for (int i = 0; i < nPlanes; i++) {
+			CVideoResizeBase* pPlane = m_pPlanes[i];
+			int nSrcPitch = nSrcStride / 2 * m_Kernels.nChromaBytes;
+			int nDstPitch = nDstStride / 2 * m_Kernels.nChromaBytes;
+			pPlane->m_pSrcBuf = pSrcFrame + nSrcStride * nFrameHeight
+								+ nSrcPitch * (nFrameHeight / 2) * i
+								+ nSrcPitch * (rc.top / 2)
+								+ rc.left / 2 * m_Kernels.nChromaBytes;
+			pPlane->m_pDstBuf = pDstBuf + nDstStride * m_nToHeight
+								+ nDstPitch * (m_nToHeight / 2) * i;
+			pPlane->m_nSrcStride = nSrcPitch;
+			pPlane->m_nDstStride = nDstPitch;
+		}
 
-		default:
-			return E_FAIL;
+		if (m_bInline || m_pWorkerPool == NULL) {
+			ScaleBand(0, 0, m_nToHeight);
+			for (int i = 0; i < nPlanes; i++) {
+				m_pPlanes[i]->ScaleBand(0, 0, m_pPlanes[i]->m_nToHeight);
+			}
+		} else {
+			// the bands of all the planes at once
+			int nBands = GetBandCount();
+			for (int i = 0; i < nPlanes; i++) {
+				nBands += m_pPlanes[i]->GetBandCount();
+			}
+			hr = m_pWorkerPool->Run(ScaleBandProc, this, nBands, m_nWorkers);
+			if (FAILED(hr)) {
+				return hr;
+			}
 		}
 
-		pDstSample->SetActualDataLength(CalcStride(m_nToWidth) * m_nToHeight);
+		// all the bands are done
+		pDstSample->SetActualDataLength(GetSize());
 	}
 
 	return S_OK;
 }
 
 
+// the source rect in the frame, aligned to the pixels that share the chroma.
+// the whole frame when it isn't set or is out of the frame.
+STDMETHODIMP_(void) CVideoResizeBase::GetSourceRect(int nWidth, int nHeight,
+													RECT* prc)
+{
+	RECT rcFrame;
+	::SetRect(&rcFrame, 0, 0, nWidth, nHeight);
+	if (m_Kernels.nBlockWidth == 0
+			|| !::IntersectRect(prc, &m_rcSource, &rcFrame)) {
+		*prc = rcFrame;
+		return;
+	}
+
+	int nBlockWidth = m_Kernels.nBlockWidth;
+	int nBlockHeight = m_Kernels.nBlockHeight;
+	prc->left -= prc->left % nBlockWidth;
+	prc->top -= prc->top % nBlockHeight;
+	prc->right += (nBlockWidth - prc->right % nBlockWidth) % nBlockWidth;
+	prc->bottom += (nBlockHeight - prc->bottom % nBlockHeight)
+															% nBlockHeight;
+}
+
+
+STDMETHODIMP_(BOOL) CVideoResizeBase::IsCropping(int nWidth, int nHeight)
+{
+	RECT rc;
+	GetSourceRect(nWidth, nHeight, &rc);
+	return rc.left != 0 || rc.top != 0
+			|| rc.right != nWidth || rc.bottom != nHeight;
+}
+
+
 STDMETHODIMP CVideoResizeBase::SetMediaSubType(const GUID* pMediaSubType)
 {
 	if (m_MediaSubType != *pMediaSubType) {
-		int nLastPixBytes = m_nBytesPerPixel;
+		RESIZE_KERNELS kernels;
+		HRESULT hr = GetResizeKernels(pMediaSubType, GetSimdFlags(),
+									  &kernels);
+		if (SUCCEEDED(hr)) {
+			hr = SetupPlanes(&kernels);
+		}
+		if (FAILED(hr)) {
+			return hr;
+		}
+
+		m_Kernels = kernels;
+		m_nBytesPerPixel = kernels.nBytesPerPixel;
+
+		// reset scale table, the tables differ by the format even for the
+		// same pixel size
+		m_nSrcWidth = 0;
+		m_nSrcHeight = 0;
 
-		int bits = GetBmpBits(pMediaSubType);
-		if (bits & 0x7) {
-			return E_INVALIDARG;
+		m_MediaSubType = *pMediaSubType;
+		SetupScaleMode();
+
+		// the output is of the input format until it is set, but keeps
+		// the conversion if the new format has one
+		GUID outputSubType = m_OutputSubType;
+		m_OutputSubType = *pMediaSubType;
+		m_nOutBytesPerPixel = m_nBytesPerPixel;
+		m_pfnConvertLine = NULL;
+		if (outputSubType != GUID_NULL) {
+			SetOutputSubType(&outputSubType);
 		}
+	}
 
-		m_nBytesPerPixel = bits / 8;;
+	return S_OK;
+}
 
-		if (nLastPixBytes != m_nBytesPerPixel) {
-			// reset scale table
-			m_nSrcWidth = 0;
-			m_nSrcHeight = 0;
+
+STDMETHODIMP CVideoResizeBase::SetOutputSubType(const GUID* pOutputSubType)
+{
+	CheckPointer(pOutputSubType, E_POINTER);
+
+	if (m_OutputSubType == *pOutputSubType) {
+		return S_OK;
+	}
+
+	PFN_CONVERT_LINE pfnConvert = NULL;
+	int nOutBytesPerPixel = m_Kernels.nBytesPerPixel;
+	if (*pOutputSubType != m_MediaSubType) {
+		HRESULT hr = GetConvertLine(&m_MediaSubType, pOutputSubType,
+									GetSimdFlags(), &pfnConvert);
+		RESIZE_KERNELS kernels;
+		if (SUCCEEDED(hr)) {
+			hr = GetResizeKernels(pOutputSubType, 0, &kernels);
+		}
+		if (FAILED(hr)) {
+			return hr;
 		}
+		nOutBytesPerPixel = kernels.nBytesPerPixel;
+	}
 
-		m_MediaSubType = *pMediaSubType;
+	m_OutputSubType = *pOutputSubType;
+	m_nOutBytesPerPixel = nOutBytesPerPixel;
+	m_pfnConvertLine = pfnConvert;
+
+	// reset the work buffers
+	m_nSrcWidth = 0;
+	m_nSrcHeight = 0;
+
+	return S_OK;
+}
+
+
+STDMETHODIMP CVideoResizeBase::SetAlgorithm(int nAlgorithm)
+{
+	if (nAlgorithm != RESIZE_NEAREST && nAlgorithm != RESIZE_BILINEAR
+			&& !IsPolyphase(nAlgorithm)) {
+		return E_INVALIDARG;
+	}
+
+	if (m_nAlgorithm != nAlgorithm) {
+		m_nAlgorithm = nAlgorithm;
+		SetupScaleMode();
+	}
+
+	for (int i = 0; i < m_Kernels.nPlanes - 1; i++) {
+		m_pPlanes[i]->SetAlgorithm(nAlgorithm);
+	}
+
+	return S_OK;
+}
+
+
+// the resizers of the chroma planes of planar YUV, with the algorithm,
+// the tiling and the workers of the luma plane.
+// the current ones are kept on failure.
+HRESULT CVideoResizeBase::SetupPlanes(const RESIZE_KERNELS* pKernels)
+{
+	CVideoResizeBase* pPlanes[MAX_CHROMA_PLANES] = { NULL };
+	int nPlanes = pKernels->nPlanes - 1;
+	ASSERT(nPlanes <= MAX_CHROMA_PLANES);
+
+	HRESULT hr = S_OK;
+	for (int i = 0; i < nPlanes && SUCCEEDED(hr); i++) {
+		pPlanes[i] = new CVideoResizeBase(max(m_nToWidth / 2, 1),
+										  max(m_nToHeight / 2, 1), &hr);
+		if (pPlanes[i] == NULL) {
+			hr = E_OUTOFMEMORY;
+			break;
+		}
+
+		CVideoResizeBase* pPlane = pPlanes[i];
+		hr = GetPlaneKernels(pKernels->nChromaBytes, GetSimdFlags(),
+							 &pPlane->m_Kernels);
+		pPlane->m_nBytesPerPixel = pPlane->m_Kernels.nBytesPerPixel;
+		pPlane->m_nOutBytesPerPixel = pPlane->m_nBytesPerPixel;
+		pPlane->m_nAlgorithm = m_nAlgorithm;
+		pPlane->m_nTiling = m_nTiling;
+		pPlane->m_bAllowAreaAverage = m_bAllowAreaAverage;
+		pPlane->m_pWorkerPool = m_pWorkerPool;
+		pPlane->m_nWorkers = m_nWorkers;
+		pPlane->SetupScaleMode();
+	}
+
+	if (FAILED(hr)) {
+		for (int i = 0; i < nPlanes; i++) {
+			delete pPlanes[i];
+		}
+		return hr;
+	}
+
+	FreePlanes();
+	::CopyMemory(m_pPlanes, pPlanes, sizeof(m_pPlanes));
+
+	return S_OK;
+}
+
+
+void CVideoResizeBase::FreePlanes()
+{
+	for (int i = 0; i < MAX_CHROMA_PLANES; i++) {
+		delete m_pPlanes[i];
+		m_pPlanes[i] = NULL;
+	}
+}
+
+
+// the chroma planes have half the width and height, and the workers of
+// the luma plane
+HRESULT CVideoResizeBase::SetupPlaneTables(int nWidth, int nHeight)
+{
+	for (int i = 0; i < m_Kernels.nPlanes - 1; i++) {
+		CVideoResizeBase* pPlane = m_pPlanes[i];
+		if (pPlane->m_nWorkers != m_nWorkers) {
+			pPlane->m_nWorkers = m_nWorkers;
+			pPlane->m_nSrcWidth = 0;
+			pPlane->m_nSrcHeight = 0;
+		}
+
+		HRESULT hr = pPlane->SetupScaleTable(nWidth / 2, nHeight / 2);
+		if (FAILED(hr)) {
+			return hr;
+		}
+	}
+
+	return S_OK;
+}
+
+
+void CVideoResizeBase::SetupScaleMode()
+{
+	int nLastMode = m_nScaleMode;
+
+	// bilinear and polyphase need 8 bit channels, others are scaled by
+	// nearest-neighbor.
+	// palette indexes and 16 bit pixels can't be interpolated byte by
+	// byte, but the alpha formats are as premultiplied ARGB32, and the
+	// 10 bit pixels are unpacked by their own kernels.
+	BOOL bInterpolate = CanInterpolate();
+
+	if (m_nAlgorithm == RESIZE_BILINEAR && bInterpolate
+			&& m_Kernels.pfnBilinearHC != NULL) {
+		m_nScaleMode = RESIZE_BILINEAR;
+	} else if (IsPolyphase(m_nAlgorithm) && bInterpolate) {
+		m_nScaleMode = m_nAlgorithm;
+	} else {
+		m_nScaleMode = RESIZE_NEAREST;
+	}
+
+	if (nLastMode != m_nScaleMode) {
+		// reset scale table
+		m_nSrcWidth = 0;
+		m_nSrcHeight = 0;
+	}
+}
+
+
+STDMETHODIMP CVideoResizeBase::SetOutputSize(int nWidth, int nHeight)
+{
+	if (nWidth <= 0 || nHeight <= 0) {
+		return E_INVALIDARG;
+	}
+
+	if (nWidth != m_nToWidth || nHeight != m_nToHeight) {
+		m_nToWidth = nWidth;
+		m_nToHeight = nHeight;
+
+		// reset scale table
+		m_nSrcWidth = 0;
+		m_nSrcHeight = 0;
+	}
+
+	for (int i = 0; i < m_Kernels.nPlanes - 1; i++) {
+		m_pPlanes[i]->SetOutputSize(max(nWidth / 2, 1), max(nHeight / 2, 1));
+	}
+
+	return S_OK;
+}
+
+
+STDMETHODIMP CVideoResizeBase::SetTopDown(BOOL bTopDown)
+{
+	m_bTopDown = bTopDown;
+	return S_OK;
+}
+
+
+STDMETHODIMP CVideoResizeBase::SetTiling(int nTiling)
+{
+	if (nTiling < RESIZE_TILING_AUTO || nTiling > RESIZE_TILING_STREAM) {
+		return E_INVALIDARG;
+	}
+
+	if (m_nTiling != nTiling) {
+		m_nTiling = nTiling;
+
+		// reset the tiles
+		m_nSrcWidth = 0;
+		m_nSrcHeight = 0;
+	}
+
+	for (int i = 0; i < m_Kernels.nPlanes - 1; i++) {
+		m_pPlanes[i]->SetTiling(nTiling);
+	}
+
+	return S_OK;
+}
+
+
+// nearest-neighbor without the area average skips the source pixels, but
+// is the cheapest on large reductions.
+STDMETHODIMP CVideoResizeBase::SetAreaAverage(BOOL bAreaAverage)
+{
+	bAreaAverage = bAreaAverage ? TRUE : FALSE;
+	if (m_bAllowAreaAverage != bAreaAverage) {
+		m_bAllowAreaAverage = bAreaAverage;
+
+		// reset scale table
+		m_nSrcWidth = 0;
+		m_nSrcHeight = 0;
+	}
+
+	for (int i = 0; i < m_Kernels.nPlanes - 1; i++) {
+		m_pPlanes[i]->SetAreaAverage(bAreaAverage);
+	}
+
+	return S_OK;
+}
+
+
+// only the pointer to the source moves while the size of the rect is the
+// same. the tables of each size are cached.
+STDMETHODIMP CVideoResizeBase::SetSourceRect(const RECT* prcSource)
+{
+	if (prcSource == NULL) {
+		::SetRectEmpty(&m_rcSource);
+	} else {
+		m_rcSource = *prcSource;
 	}
 
 	return S_OK;
@@ -216,29 +614,476 @@ STDMETHODIMP CVideoResizeBase::SetMediaSubType(const GUID* pMediaSubType)
 
 STDMETHODIMP CVideoResizeBase::SetupScaleTable(int nWidth, int nHeight)
 {
-	ASSERT(m_pWScale);
-	ASSERT(m_pHScale);
 	ASSERT(nWidth > 0);
-	ASSERT(nHeight > 0);
+	ASSERT(nHeight != 0);
 
 	if (m_nSrcWidth != nWidth || m_nSrcHeight != nHeight) {
+		// nearest-neighbor and bilinear skip source pixels on 2x or more
+		// reduction, so the pixels are averaged by area instead.
+		m_bAreaAverage = m_bAllowAreaAverage && CanInterpolate()
+							&& m_Kernels.pfnAreaH != NULL
+							&& !IsPolyphase(m_nScaleMode)
+							&& nWidth >= m_nToWidth * 2
+							&& abs(nHeight) >= m_nToHeight * 2;
+
+		// the alpha formats are copied as they are by nearest-neighbor,
+		// and premultiplied to ARGB32 to be interpolated
+		m_bPremultiply = m_Kernels.pfnPremultiply != NULL
+							&& (m_bAreaAverage
+								|| m_nScaleMode != RESIZE_NEAREST);
+		m_nBytesPerPixel = m_bPremultiply ? 4 : m_Kernels.nBytesPerPixel;
+
+		// the vertical tables are in lines, which are scaled by the signed
+		// strides of each frame
+		SCALE_TABLE_KEY key;
+		key.nSrcWidth = nWidth;
+		key.nSrcHeight = abs(nHeight);
+		key.nDstWidth = m_nToWidth;
+		key.nDstHeight = m_nToHeight;
+		key.nBytesPerPixel = m_nBytesPerPixel;
+		key.nAlgorithm = m_bAreaAverage ? SCALE_AREA : m_nScaleMode;
+		key.nLumaOffset = m_Kernels.nLumaOffset;
+
+		CScaleTable* pTable;
+		HRESULT hr = CScaleTable::Get(&key, &pTable);
+		if (FAILED(hr)) {
+			return hr;
+		}
+		if (m_pTable) {
+			m_pTable->Release();
+		}
+		m_pTable = pTable;
+
 		m_nSrcWidth = nWidth;
 		m_nSrcHeight = nHeight;
 
-		int nPixBytes = m_nBytesPerPixel;
+		SetupTiles();
 
-		for(int x = 0; x < m_nToWidth; x++) {
-			m_pWScale[x] = (int)((double)(nWidth * nPixBytes * x)
-													/ m_nToWidth);
+		if (IsPolyphase(m_nScaleMode)) {
+			hr = m_Polyphase.Setup(m_pTable, &m_Kernels,
+								   m_bPremultiply ? m_Kernels.pfnPremultiply
+												  : NULL,
+								   m_Kernels.nBytesPerPixel, m_pfnPutLine,
+								   m_nOutBytesPerPixel, m_bTiled, m_nWorkers);
 		}
-		
-		int stride = CalcStride(nWidth);
-		nHeight = abs(nHeight);
+		if (SUCCEEDED(hr)) {
+			hr = SetupWorkBuffers();
+		}
+		if (FAILED(hr)) {
+			m_nSrcWidth = 0;
+			m_nSrcHeight = 0;
+			return hr;
+		}
+
+		SetupBands();
+	}
+
+	return S_OK;
+}
+
+
+STDMETHODIMP CVideoResizeBase::SetWorkerPool(CWorkerPool* pWorkerPool)
+{
+	m_pWorkerPool = pWorkerPool;
+
+	for (int i = 0; i < m_Kernels.nPlanes - 1; i++) {
+		m_pPlanes[i]->SetWorkerPool(pWorkerPool);
+	}
+
+	return S_OK;
+}
+
+
+// the source lines and the row caches of the output lines exceed the cache
+// on large frames, and are read again for each output line. the tiles
+// keep them in the cache for the lines of a band.
+void CVideoResizeBase::SetupTiles()
+{
+	// the source lines of an output line, which are reused by the next
+	// output lines for bilinear and polyphase
+	int nLines = 1;
+	if (IsPolyphase(m_nScaleMode)) {
+		nLines = m_pTable->m_nHTaps;
+	} else if (!m_bAreaAverage && m_nScaleMode == RESIZE_BILINEAR) {
+		nLines = 2;
+	}
+	int cbLines = (m_nSrcWidth + m_nToWidth * (int)sizeof(short))
+										* m_nBytesPerPixel * nLines;
+
+	switch (m_nTiling) {
+	case RESIZE_TILING_AUTO:
+		m_bTiled = cbLines > TILE_CACHE_SIZE;
+		m_bStreamStores = GetSize() > STREAM_FRAME_SIZE;
+		break;
+	case RESIZE_TILING_ROWS:
+		m_bTiled = FALSE;
+		m_bStreamStores = FALSE;
+		break;
+	case RESIZE_TILING_TILES:
+		m_bTiled = TRUE;
+		m_bStreamStores = FALSE;
+		break;
+	default:
+		m_bTiled = TRUE;
+		m_bStreamStores = TRUE;
+		break;
+	}
+
+	m_nTileWidth = m_nToWidth;
+	if (m_bTiled && nLines > 1) {
+		int nWidth = (int)((LONGLONG)TILE_CACHE_SIZE * m_nToWidth / cbLines);
+		nWidth = max(nWidth / TILE_ALIGN * TILE_ALIGN, TILE_ALIGN);
+		m_nTileWidth = min(nWidth, m_nToWidth);
+	}
+
+	// the lines are converted, unpremultiplied or streamed from the line
+	// buffers of the workers. the converted lines are stored through the
+	// cache. the alpha formats have no conversions.
+	ASSERT(!m_bPremultiply || m_pfnConvertLine == NULL);
+	m_pfnPutLine = m_bPremultiply ? m_Kernels.pfnUnpremultiply
+								  : m_pfnConvertLine;
+	if (m_pfnPutLine != NULL) {
+		m_bStreamStores = FALSE;
+	} else if (m_bStreamStores) {
+		m_bStreamStores = SUCCEEDED(GetStreamLine(m_nBytesPerPixel,
+												  GetSimdFlags(),
+												  &m_pfnPutLine));
+	}
+}
+
+
+// buffers for each worker
+HRESULT CVideoResizeBase::SetupWorkBuffers()
+{
+	delete [] m_pLoadBuf;
+	delete [] m_pRowCache;
+	delete [] m_pAreaAcc;
+	delete [] m_pAreaSum;
+	delete [] m_pLineBuf;
+	m_pLoadBuf = NULL;
+	m_pRowCache = NULL;
+	m_pAreaAcc = NULL;
+	m_pAreaSum = NULL;
+	m_pLineBuf = NULL;
+
+	if (m_bPremultiply && !IsPolyphase(m_nScaleMode)) {
+		// a source line of premultiplied ARGB32, the polyphase filter has
+		// its own
+		m_pLoadBuf = new BYTE[m_nSrcWidth * m_nBytesPerPixel * m_nWorkers];
+		if (m_pLoadBuf == NULL) {
+			return E_OUTOFMEMORY;
+		}
+	}
+
+	if (m_pfnPutLine) {
+		// a resized line to convert, unpremultiply or stream
+		m_pLineBuf = new BYTE[m_nToWidth * m_nBytesPerPixel * m_nWorkers];
+		if (m_pLineBuf == NULL) {
+			return E_OUTOFMEMORY;
+		}
+	}
 
-		for (int y = 0; y < m_nToHeight; y++) {
-			m_pHScale[y] = (int)((double)(nHeight * y) / m_nToHeight) * stride;
+	if (m_bAreaAverage) {
+		// a line of accumulators and sums, and spares for the SIMD
+		m_pAreaAcc = new WORD[(m_nSrcWidth * m_nBytesPerPixel + 4)
+																* m_nWorkers];
+		m_pAreaSum = new DWORD[(m_nToWidth * m_nBytesPerPixel + 1)
+																* m_nWorkers];
+		if (m_pAreaAcc == NULL || m_pAreaSum == NULL) {
+			return E_OUTOFMEMORY;
+		}
+	} else if (m_nScaleMode == RESIZE_BILINEAR) {
+		// 2 lines, and a spare value for the SIMD
+		m_pRowCache = new short[(m_nToWidth * m_nBytesPerPixel + 1) * 2
+																* m_nWorkers];
+		if (m_pRowCache == NULL) {
+			return E_OUTOFMEMORY;
 		}
 	}
 
 	return S_OK;
 }
+
+
+void CVideoResizeBase::SetupBands()
+{
+	int cbSrcFrame = CalcStride(m_nSrcWidth) * abs(m_nSrcHeight);
+	int cbDstFrame = GetSize();
+	m_bInline = m_nWorkers <= 1
+				|| cbSrcFrame + cbDstFrame < INLINE_FRAME_SIZE;
+
+	// bands whose source and output lines fit in the cache,
+	// but at least one band for each worker
+	int cbLine = (cbSrcFrame + cbDstFrame) / m_nToHeight;
+	int nLines = BAND_CACHE_SIZE / max(cbLine, 1);
+	nLines = min(nLines, (m_nToHeight + m_nWorkers - 1) / m_nWorkers);
+	m_nBandLines = max(nLines, BAND_MIN_LINES);
+}
+
+
+void CVideoResizeBase::ScaleBandProc(void* pContext, int nBand, int nWorker)
+{
+	CVideoResizeBase* pThis = (CVideoResizeBase*)pContext;
+
+	// the bands of the chroma planes follow those of the luma plane
+	CVideoResizeBase* pPlane = pThis;
+	for (int i = 0; nBand >= pPlane->GetBandCount(); i++) {
+		nBand -= pPlane->GetBandCount();
+		pPlane = pThis->m_pPlanes[i];
+	}
+
+	int nStartLine = pPlane->m_nBandLines * nBand;
+	int nEndLine = min(nStartLine + pPlane->m_nBandLines, pPlane->m_nToHeight);
+	pPlane->ScaleBand(nWorker, nStartLine, nEndLine);
+}
+
+
+void CVideoResizeBase::ScaleBand(int nWorker, int nStartLine, int nEndLine)
+{
+	if (m_bAreaAverage) {
+		ScaleArea(nWorker, nStartLine, nEndLine);
+	} else if (IsPolyphase(m_nScaleMode)
+				|| m_nScaleMode == RESIZE_BILINEAR) {
+		// the tiles from left to right
+		for (int x = 0; x < m_nToWidth; x += m_nTileWidth) {
+			int nEndX = min(x + m_nTileWidth, m_nToWidth);
+			if (IsPolyphase(m_nScaleMode)) {
+				m_Polyphase.Scale(m_pDstBuf, m_nDstStride,
+								  m_pSrcBuf, m_nSrcStride,
+								  nWorker, nStartLine, nEndLine, x, nEndX);
+			} else {
+				ScaleBilinear(nWorker, nStartLine, nEndLine, x, nEndX);
+			}
+		}
+	} else {
+		ScaleNearest(nWorker, nStartLine, nEndLine);
+	}
+
+	// the streamed lines reach the memory before the band is done
+	if (m_bStreamStores) {
+		_mm_sfence();
+	}
+}
+
+
+void CVideoResizeBase::ScaleNearest(int nWorker, int nStartLine,
+									int nEndLine)
+{
+	LPBYTE pSrcBuf = m_pSrcBuf;
+	LPBYTE pDstBuf = m_pDstBuf;
+
+	const CScaleTable* pTable = m_pTable;
+	const ULONG* pWScale = pTable->m_pWScale;
+
+	// SIMD for the head of the line, reference for the rest
+	int nSimdCount = m_Kernels.pfnScaleLine ? pTable->m_nSimdCount : 0;
+	int cbSimd = nSimdCount * m_nBytesPerPixel;
+	int cbLine = m_nToWidth * m_nOutBytesPerPixel;
+	int cbSrcLine = m_nSrcWidth * m_nBytesPerPixel;
+	LPBYTE pLineBuf = GetLineBuf(nWorker);
+
+	for (int y = nStartLine; y < nEndLine; y++) {
+		LPBYTE pSrcLine = pSrcBuf + m_nSrcStride * (int)pTable->m_pHScale[y];
+		LPBYTE pDstPtr = pDstBuf + m_nDstStride * y;
+
+		// the source line of the next output line
+		if (m_bTiled && y + 1 < nEndLine && !pTable->m_pHRepeat[y + 1]) {
+			PrefetchSpan(pSrcBuf + m_nSrcStride * (int)pTable->m_pHScale[y + 1],
+						 cbSrcLine);
+		}
+
+		// a repeated line is copied from the previous line of the band,
+		// which is still in the line buffer when streamed
+		if (y > nStartLine && pTable->m_pHRepeat[y]) {
+			if (m_bStreamStores) {
+				m_pfnPutLine(pDstPtr, pLineBuf, m_nToWidth);
+			} else {
+				::CopyMemory(pDstPtr, pDstPtr - m_nDstStride, cbLine);
+			}
+			continue;
+		}
+
+		LPBYTE pLine = pLineBuf ? pLineBuf : pDstPtr;
+		if (nSimdCount > 0) {
+			m_Kernels.pfnScaleLine(pLine, pSrcLine, pWScale, nSimdCount);
+		}
+		m_Kernels.pfnScaleLineC(pLine + cbSimd, pSrcLine,
+								pWScale + nSimdCount,
+								m_nToWidth - nSimdCount);
+		if (pLineBuf) {
+			m_pfnPutLine(pDstPtr, pLineBuf, m_nToWidth);
+		}
+	}
+}
+
+
+void CVideoResizeBase::ScaleArea(int nWorker, int nStartLine, int nEndLine)
+{
+	ASSERT(m_Kernels.pfnAreaV);
+	ASSERT(m_Kernels.pfnAreaH);
+	ASSERT(m_Kernels.pfnAreaOut);
+	ASSERT(m_pAreaAcc);
+	ASSERT(nWorker < m_nWorkers);
+
+	LPBYTE pSrcBuf = m_pSrcBuf;
+	LPBYTE pDstBuf = m_pDstBuf;
+	const CScaleTable* pTable = m_pTable;
+
+	int nCount = m_nToWidth * m_nBytesPerPixel;
+	int cbLine = m_nSrcWidth * m_nBytesPerPixel;
+
+	// buffers of the worker
+	WORD* pAreaAcc = m_pAreaAcc + (cbLine + 4) * nWorker;
+	DWORD* pAreaSum = m_pAreaSum + (nCount + 1) * nWorker;
+	LPBYTE pLineBuf = GetLineBuf(nWorker);
+
+	for (int y = nStartLine; y < nEndLine; y++) {
+		::ZeroMemory(pAreaSum, nCount * sizeof(DWORD));
+
+		// sum up the lines to the accumulators, and the accumulators of
+		// each output pixel to the sums. WORD accumulators hold
+		// nAreaMaxLines lines at most.
+		LPBYTE pSrcLine = pSrcBuf + m_nSrcStride * (int)pTable->m_pHScale[y];
+		int nLines = pTable->m_pHCount[y];
+		while (nLines > 0) {
+			int n = min(nLines, m_Kernels.nAreaMaxLines);
+			::ZeroMemory(pAreaAcc, cbLine * sizeof(WORD));
+			for (int i = 0; i < n; i++, pSrcLine += m_nSrcStride) {
+				if (m_bTiled) {
+					PrefetchSpan(pSrcLine + m_nSrcStride, cbLine);
+				}
+				m_Kernels.pfnAreaV(pAreaAcc,
+								   LoadLine(nWorker, pSrcLine, 0, m_nSrcWidth),
+								   cbLine);
+			}
+			m_Kernels.pfnAreaH(pAreaSum, pAreaAcc, pTable->m_pWScale,
+							   pTable->m_pWCount, m_nToWidth);
+			nLines -= n;
+		}
+
+		const ULONG* pRecip = pTable->m_pAreaRecip;
+		if ((int)pTable->m_pHCount[y] != pTable->m_nAreaLines) {
+			pRecip += m_nToWidth;
+		}
+
+		LPBYTE pDstLine = pDstBuf + m_nDstStride * y;
+		LPBYTE pDstPtr = pLineBuf ? pLineBuf : pDstLine;
+		m_Kernels.pfnAreaOut(pDstPtr, pAreaSum, pRecip, m_nToWidth);
+		if (pLineBuf) {
+			m_pfnPutLine(pDstLine, pLineBuf, m_nToWidth);
+		}
+	}
+}
+
+
+// the alpha formats are premultiplied as they're interpolated, only the
+// pixels that the kernels read
+const BYTE* CVideoResizeBase::LoadLine(int nWorker, const BYTE* pSrcLine,
+									   int nStart, int nEnd)
+{
+	if (!m_bPremultiply) {
+		return pSrcLine;
+	}
+
+	ASSERT(m_pLoadBuf);
+	LPBYTE pLoadLine = m_pLoadBuf + m_nSrcWidth * m_nBytesPerPixel * nWorker;
+	m_Kernels.pfnPremultiply(pLoadLine + nStart * m_nBytesPerPixel,
+							 pSrcLine + nStart * m_Kernels.nBytesPerPixel,
+							 nEnd - nStart);
+	return pLoadLine;
+}
+
+
+void CVideoResizeBase::ScaleBilinear(int nWorker, int nStartLine,
+									 int nEndLine, int nStartX, int nEndX)
+{
+	ASSERT(m_Kernels.pfnBilinearHC);
+	ASSERT(m_Kernels.pfnBilinearV);
+	ASSERT(m_pRowCache);
+	ASSERT(nWorker < m_nWorkers);
+
+	LPBYTE pSrcBuf = m_pSrcBuf;
+	LPBYTE pDstBuf = m_pDstBuf;
+
+	// the columns, the entries of a pixel are 2 for packed YUV
+	const CScaleTable* pTable = m_pTable;
+	int nEntries = pTable->m_nWEntries / m_nToWidth;
+	const ULONG* pWScale = pTable->m_pWScale + nStartX * nEntries;
+	const ULONG* pWWeight = pTable->m_pWWeight + nStartX * nEntries;
+	int nWNext = pTable->m_nWNext;
+	int nWidth = nEndX - nStartX;
+	int nOffset = nStartX * m_nBytesPerPixel;
+
+	int nSimdCount = m_Kernels.pfnBilinearH
+						? min(pTable->m_nSimdCount, nEndX) - nStartX : 0;
+	nSimdCount = max(nSimdCount, 0);
+	int nCount = m_nToWidth * m_nBytesPerPixel;
+
+	// the source bytes of the columns, with the right pixels that SIMD
+	// reads 8 bytes from
+	int nSpanStart = pWScale[0];
+	int cbSpan = pWScale[nWidth * nEntries - 1] - nSpanStart + nWNext + 8;
+	int nLoadStart = nSpanStart / m_nBytesPerPixel;
+	int nLoadEnd = min((nSpanStart + cbSpan + m_nBytesPerPixel - 1)
+							/ m_nBytesPerPixel, m_nSrcWidth);
+
+	// horizontal pass of 2 input lines, in the cache of the worker
+	short* pRowCache = m_pRowCache + (nCount + 1) * 2 * nWorker + nOffset;
+	short* pRow[2] = { pRowCache, pRowCache + nCount + 1 };
+	LPBYTE pRowLine[2] = { NULL, NULL };
+	LPBYTE pLineBuf = GetLineBuf(nWorker);
+	if (pLineBuf) {
+		pLineBuf += nOffset;
+	}
+
+	for (int y = nStartLine; y < nEndLine; y++) {
+		LPBYTE pSrcLine[2];
+		pSrcLine[0] = pSrcBuf + m_nSrcStride * (int)pTable->m_pHScale[y];
+		pSrcLine[1] = pSrcLine[0] + m_nSrcStride * pTable->m_nHNext;
+
+		if (pRowLine[0] != pSrcLine[0] && pRowLine[1] == pSrcLine[0]) {
+			// the lower line moved up
+			short* pTmp = pRow[0];
+			pRow[0] = pRow[1];
+			pRow[1] = pTmp;
+			pRowLine[0] = pRowLine[1];
+			pRowLine[1] = NULL;
+		}
+
+		for (int i = 0; i < 2; i++) {
+			if (pRowLine[i] == pSrcLine[i]) {
+				continue;
+			}
+			const BYTE* pLine = LoadLine(nWorker, pSrcLine[i],
+										 nLoadStart, nLoadEnd);
+			if (nSimdCount > 0) {
+				m_Kernels.pfnBilinearH(pRow[i], pLine, pWScale,
+									   pWWeight, nWNext, nSimdCount);
+			}
+			m_Kernels.pfnBilinearHC(pRow[i] + nSimdCount * m_nBytesPerPixel,
+									pLine,
+									pWScale + nSimdCount * nEntries,
+									pWWeight + nSimdCount * nEntries, nWNext,
+									nWidth - nSimdCount);
+			pRowLine[i] = pSrcLine[i];
+		}
+
+		// the lower line of the next output line
+		if (m_bTiled && y + 1 < nEndLine) {
+			LPBYTE pNextLine = pSrcBuf + m_nSrcStride
+							* ((int)pTable->m_pHScale[y + 1] + pTable->m_nHNext);
+			if (pNextLine != pSrcLine[1]) {
+				PrefetchSpan(pNextLine + nSpanStart, cbSpan);
+			}
+		}
+
+		LPBYTE pDstLine = pDstBuf + m_nDstStride * y
+							+ nStartX * m_nOutBytesPerPixel;
+		m_Kernels.pfnBilinearV(pLineBuf ? pLineBuf : pDstLine,
+							   pRow[0], pRow[1], pTable->m_pHWeight[y],
+							   nWidth * m_nBytesPerPixel);
+		if (pLineBuf) {
+			m_pfnPutLine(pDstLine, pLineBuf, nWidth);
+		}
+	}
+}
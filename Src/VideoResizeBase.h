@@ -23,42 +23,172 @@
 
 #pragma once
 
+#include "ResizeKernels.h"
+#include "ColorConvert.h"
+#include "ScaleTable.h"
+#include "PolyphaseFilter.h"
+#include "WorkerPool.h"
+#include "IVideoResizerConfig.h"
+
+// U and V planes of planar YUV
+#define MAX_CHROMA_PLANES	(2)
+
 class CVideoResizeBase : public CUnknown
 {
 private:
 	friend class CVideoResizer;
+	friend class CVideoPyramid;
 
 private:
 	CVideoResizeBase(int toWidth, int toHeight, HRESULT* phr);
 	virtual ~CVideoResizeBase();
 
 private:
-	STDMETHODIMP IsSupportMediaSubType(const GUID* pMediaSubType, int* pBits);
+	STDMETHODIMP IsSupportMediaSubType(const GUID* pMediaSubType,
+									   RESIZE_KERNELS* pKernels);
+
+	STDMETHODIMP IsSupportConversion(const GUID* pInputSubType,
+									 const GUID* pOutputSubType);
 
 	STDMETHODIMP_(const GUID*) GetMediaSubType() { return &m_MediaSubType; }
-	STDMETHODIMP_(int) GetBitsPerPixel() { return m_nBytesPerPixel * 8; }
+	STDMETHODIMP_(const GUID*) GetOutputSubType() { return &m_OutputSubType; }
+	STDMETHODIMP_(BOOL) IsConverting() { return m_pfnConvertLine != NULL; }
+	STDMETHODIMP_(int) GetBitsPerPixel() { return m_Kernels.nBitCount; }
+	STDMETHODIMP_(DWORD) GetCompression() { return m_Kernels.dwCompression; }
+	STDMETHODIMP_(BOOL) IsYUV() { return m_Kernels.dwCompression != BI_RGB; }
+	STDMETHODIMP_(BOOL) IsAlignedSize(int nWidth, int nHeight)
+		{ return nWidth % m_Kernels.nBlockWidth == 0
+				&& nHeight % m_Kernels.nBlockHeight == 0; }
 	STDMETHODIMP_(int) GetToWidth() { return m_nToWidth; }
 	STDMETHODIMP_(int) GetToHeight() { return m_nToHeight; }
+	STDMETHODIMP_(int) GetAlgorithm() { return m_nAlgorithm; }
+	STDMETHODIMP_(int) GetTiling() { return m_nTiling; }
+	STDMETHODIMP_(BOOL) GetAreaAverage() { return m_bAllowAreaAverage; }
+	STDMETHODIMP_(BOOL) IsTopDown() { return m_bTopDown; }
+	// the luma pitch of planar YUV is the width
 	STDMETHODIMP_(int) CalcStride(int nWidth)
-		{ return ((nWidth * m_nBytesPerPixel) + 3) / 4 * 4; }
-	STDMETHODIMP_(int) GetSize()
-		{ return CalcStride(m_nToWidth) * abs(m_nToHeight); }
+		{ return (m_Kernels.nPlanes > 1)
+				? nWidth : ((nWidth * m_Kernels.nBytesPerPixel) + 3) / 4 * 4; }
+	// the output is of the input format unless converted
+	STDMETHODIMP_(int) CalcOutputStride(int nWidth)
+		{ return m_pfnConvertLine
+				? ((nWidth * m_nOutBytesPerPixel) + 3) / 4 * 4
+				: CalcStride(nWidth); }
+	STDMETHODIMP_(int) GetSize() { return GetOutputSize(&m_OutputSubType); }
+	STDMETHODIMP_(void) GetSourceRect(int nWidth, int nHeight, RECT* prc);
+	STDMETHODIMP_(BOOL) IsCropping(int nWidth, int nHeight);
+	STDMETHODIMP_(int) GetOutputSize(const GUID* pOutputSubType);
 
 	STDMETHODIMP Transform(IMediaSample* pSrcSample,
 					int nSrcWidth, int nSrcHeight, IMediaSample* pDstSample);
 
 	STDMETHODIMP SetMediaSubType(const GUID* pMediaSubType);
+	STDMETHODIMP SetOutputSubType(const GUID* pOutputSubType);
+	STDMETHODIMP SetAlgorithm(int nAlgorithm);
+	STDMETHODIMP SetTiling(int nTiling);
+	STDMETHODIMP SetAreaAverage(BOOL bAreaAverage);
+	STDMETHODIMP SetOutputSize(int nWidth, int nHeight);
+	STDMETHODIMP SetTopDown(BOOL bTopDown);
+	STDMETHODIMP SetSourceRect(const RECT* prcSource);
 	STDMETHODIMP SetupScaleTable(int nWidth, int nHeight);
+	STDMETHODIMP SetWorkerPool(CWorkerPool* pWorkerPool);
+
+	HRESULT SetupPlanes(const RESIZE_KERNELS* pKernels);
+	void FreePlanes();
+	HRESULT SetupPlaneTables(int nWidth, int nHeight);
+	void SetupScaleMode();
+	// bilinear, polyphase and area average, byte by byte, premultiplied
+	// or unpacked to 10 bit channels
+	BOOL CanInterpolate()
+		{ return m_Kernels.pfnPolyphaseHC != NULL
+				 || m_Kernels.pfnPolyphaseHYUV != NULL; }
+	void SetupTiles();
+	HRESULT SetupWorkBuffers();
+	void SetupBands();
+
+	// a band of output lines on a worker
+	STDMETHODIMP_(int) GetBandCount()
+		{ return (m_nToHeight + m_nBandLines - 1) / m_nBandLines; }
+	static void ScaleBandProc(void* pContext, int nBand, int nWorker);
+	void ScaleBand(int nWorker, int nStartLine, int nEndLine);
+	void ScaleNearest(int nWorker, int nStartLine, int nEndLine);
+	void ScaleBilinear(int nWorker, int nStartLine, int nEndLine,
+					   int nStartX, int nEndX);
+	void ScaleArea(int nWorker, int nStartLine, int nEndLine);
+	// the source pixels (nStart - nEnd) of a line to interpolate, on the
+	// line of the worker when they're premultiplied
+	const BYTE* LoadLine(int nWorker, const BYTE* pSrcLine,
+						 int nStart, int nEnd);
+	// the line of the worker to convert or stream from, NULL to scale to
+	// the output
+	LPBYTE GetLineBuf(int nWorker)
+		{ return m_pLineBuf
+				? m_pLineBuf + m_nToWidth * m_nBytesPerPixel * nWorker
+				: NULL; }
 
 private:
-	const int m_nToWidth;
-	const int m_nToHeight;
+	int m_nToWidth;
+	int m_nToHeight;
 
 	GUID m_MediaSubType;
-	int m_nBytesPerPixel;
+	int m_nBytesPerPixel;	// of the scaled pixels, 4 when premultiplied
+	int m_nAlgorithm;
+	int m_nScaleMode;
+	BOOL m_bTopDown;		// orientation of the output
+	RECT m_rcSource;		// of each frame, empty for the whole frame
 
 	int m_nSrcWidth;
 	int m_nSrcHeight;
-	ULONG* m_pWScale;
-	ULONG* m_pHScale;
+	CScaleTable* m_pTable;
+
+	// alpha formats: the source lines premultiplied to ARGB32 as they're
+	// loaded, a line for each worker
+	BOOL m_bPremultiply;
+	LPBYTE m_pLoadBuf;
+
+	// bilinear
+	short* m_pRowCache;
+
+	// area average, on 2x or more reduction unless it's turned off to
+	// lower the quality
+	BOOL m_bAllowAreaAverage;
+	BOOL m_bAreaAverage;
+	WORD* m_pAreaAcc;
+	DWORD* m_pAreaSum;
+
+	// bicubic, lanczos
+	CPolyphaseFilter m_Polyphase;
+
+	// tiles of the output columns, whose source spans and row caches fit
+	// in the cache, with prefetch of the next source lines
+	int m_nTiling;
+	BOOL m_bTiled;
+	int m_nTileWidth;
+	BOOL m_bStreamStores;	// non-temporal stores to the output
+
+	// bands of the output lines
+	CWorkerPool* m_pWorkerPool;
+	int m_nWorkers;
+	int m_nBandLines;
+	BOOL m_bInline;
+	LPBYTE m_pSrcBuf;
+	LPBYTE m_pDstBuf;
+	int m_nSrcStride;		// signed, negative to flip
+	int m_nDstStride;
+
+	// selected by the sub type
+	RESIZE_KERNELS m_Kernels;
+
+	// the output sub type, the resized lines are converted to it on each
+	// worker when it differs from the input
+	GUID m_OutputSubType;
+	int m_nOutBytesPerPixel;
+	PFN_CONVERT_LINE m_pfnConvertLine;
+
+	// the output of the lines on the line buffers, converted or streamed
+	PFN_CONVERT_LINE m_pfnPutLine;
+	LPBYTE m_pLineBuf;
+
+	// planar YUV: the resizers of the chroma planes, this is of the luma
+	CVideoResizeBase* m_pPlanes[MAX_CHROMA_PLANES];
 };
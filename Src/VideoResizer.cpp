@@ -38,6 +38,24 @@
 // o̓s
 //	Videoñrbg}bvn
 //  TCYďo͂
+//  RGB24, YUY2, UYVY̓TCYCRGB32ɕϊĂo͂ł
+//  xƕԂiKIɗƂAŌ̓t[̂Ă
+
+// i̒iK
+#define QUALITY_FULL			(0)		// ݒ肳ꂽ
+#define QUALITY_BILINEAR		(1)		// oCjA
+#define QUALITY_NEAREST			(2)		// ʐϕςȂjAXglCo[
+#define QUALITY_DROP			(3)		// 1t[Ɏ̂Ă
+
+// iKxƖ߂x (100ns)
+// Ԃ̒xł͒iKۂ
+#define QUALITY_LATE_TIME		(300000)	// 30ms
+#define QUALITY_ONTIME_TIME		(50000)		// 5ms
+
+// iKςʒm̘A
+// ̒xőĉȂ悤A߂ق𒷂
+#define QUALITY_LATE_COUNT		(4)
+#define QUALITY_ONTIME_COUNT	(60)
 
 const AMOVIESETUP_MEDIATYPE sudOpPinTypes[] =
 {
@@ -86,7 +104,8 @@ extern const AMOVIESETUP_FILTER sudVideoResizer =
 CUnknown * WINAPI CVideoResizer::CreateInstance(LPUNKNOWN punk,
 		HRESULT *phr)
 {
-	CVideoResizer *pFilter = new CVideoResizer(punk);
+	CVideoResizer *pFilter = new CVideoResizer(punk, NAME("VideoResizer"),
+											 CLSID_VideoResizer);
 	
 	if (pFilter == NULL || pFilter->m_pResizer == NULL)
 	{
@@ -101,19 +120,36 @@ CUnknown * WINAPI CVideoResizer::CreateInstance(LPUNKNOWN punk,
 }
 
 
-CVideoResizer::CVideoResizer(LPUNKNOWN punk)
-	: CTransformFilter(NAME("VideoResizer"), punk, CLSID_VideoResizer)
+CVideoResizer::CVideoResizer(LPUNKNOWN punk, LPCTSTR pName,
+							 REFCLSID clsid)
+	: CTransformFilter(pName, punk, clsid)
 	, DEST_WIDTH(320)
 	, DEST_HEIGHT(240)
+	, DEST_ALGORITHM(RESIZE_NEAREST)
+	, DEST_THREADS(0)
+	, DEST_TILING(RESIZE_TILING_ROWS)
 	, m_pResizer(NULL)
+	, m_nAlgorithm(DEST_ALGORITHM)
+	, m_nThreads(DEST_THREADS)
+	, m_nTiling(DEST_TILING)
 	, m_nSrcWidth(0)
 	, m_nSrcHeight(0)
+	, m_nQualityLevel(QUALITY_FULL)
+	, m_nLateCount(0)
+	, m_nOnTimeCount(0)
+	, m_bDropSample(FALSE)
+	, m_nAppliedAlgorithm(DEST_ALGORITHM)
+	, m_pOutputAllocator(NULL)
+	, m_bSharedAllocator(FALSE)
 {
 #ifdef _DEBUG
 	m_nFrameCount = 0;
 	DbgSetModuleLevel(LOG_TRACE, 1);
 #endif
 
+	SetRectEmpty(&m_rcSource);
+	SetRectEmpty(&m_rcInputSource);
+
 	HRESULT hr;
 	m_pResizer = new CVideoResizeBase(DEST_WIDTH, DEST_HEIGHT, &hr);
 	if (hr != S_OK)
@@ -121,6 +157,13 @@ CVideoResizer::CVideoResizer(LPUNKNOWN punk)
 		m_pResizer->NonDelegatingRelease();
 		m_pResizer = NULL;
 	}
+	else
+	{
+		m_pResizer->SetAlgorithm(m_nAlgorithm);
+		m_pResizer->SetTiling(m_nTiling);
+		m_WorkerPool.SetThreadCount(m_nThreads);
+		m_pResizer->SetWorkerPool(&m_WorkerPool);
+	}
 }
 
 
@@ -132,6 +175,204 @@ CVideoResizer::~CVideoResizer()
 }
 
 
+STDMETHODIMP CVideoResizer::NonDelegatingQueryInterface(REFIID riid,
+														void** ppv)
+{
+	CheckPointer(ppv, E_POINTER);
+
+	if (riid == IID_IVideoResizerConfig)
+	{
+		return GetInterface((IVideoResizerConfig*)(this), ppv);
+	}
+
+	return CTransformFilter::NonDelegatingQueryInterface(riid, ppv);
+}
+
+
+// o̓TCY̕ύX
+// ~̂݁Bo̓sڑς݂ȂVTCYōĐڑ
+STDMETHODIMP CVideoResizer::SetOutputSize(int nWidth, int nHeight)
+{
+	CAutoLock lock(&m_csFilter);
+
+	// 쐬ɎsTCU
+	if (m_pResizer == NULL)
+	{
+		return E_UNEXPECTED;
+	}
+
+	if (m_State != State_Stopped)
+	{
+		return VFW_E_NOT_STOPPED;
+	}
+
+	if (nWidth == m_pResizer->GetToWidth()
+		&& nHeight == m_pResizer->GetToHeight())
+	{
+		return S_OK;
+	}
+
+	// YUV̓͂͐FLsNZ̔{̂
+	if (m_pInput != NULL && m_pInput->IsConnected()
+		&& !m_pResizer->IsAlignedSize(nWidth, nHeight))
+	{
+		return E_INVALIDARG;
+	}
+
+	HRESULT hr = m_pResizer->SetOutputSize(nWidth, nHeight);
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+
+	if (m_pOutput != NULL && m_pOutput->IsConnected())
+	{
+		hr = ReconnectPin(m_pOutput, NULL);
+	}
+
+	return hr;
+}
+
+
+STDMETHODIMP CVideoResizer::GetOutputSize(int* pnWidth, int* pnHeight)
+{
+	CheckPointer(pnWidth, E_POINTER);
+	CheckPointer(pnHeight, E_POINTER);
+
+	CAutoLock lock(&m_csFilter);
+
+	if (m_pResizer == NULL)
+	{
+		return E_UNEXPECTED;
+	}
+
+	*pnWidth = m_pResizer->GetToWidth();
+	*pnHeight = m_pResizer->GetToHeight();
+
+	return S_OK;
+}
+
+
+STDMETHODIMP CVideoResizer::SetAlgorithm(int nAlgorithm)
+{
+	CAutoLock lock(&m_csReceive);
+
+	if (m_pResizer == NULL)
+	{
+		return E_UNEXPECTED;
+	}
+
+	// i𗎂ƂĂԂ͎̃TvŗƂ
+	HRESULT hr = m_pResizer->SetAlgorithm(nAlgorithm);
+	if (SUCCEEDED(hr))
+	{
+		m_nAlgorithm = nAlgorithm;
+		m_nAppliedAlgorithm = nAlgorithm;
+	}
+
+	return hr;
+}
+
+
+STDMETHODIMP CVideoResizer::GetAlgorithm(int* pnAlgorithm)
+{
+	CheckPointer(pnAlgorithm, E_POINTER);
+
+	*pnAlgorithm = m_nAlgorithm;
+
+	return S_OK;
+}
+
+
+STDMETHODIMP CVideoResizer::SetThreadCount(int nThreads)
+{
+	CAutoLock lock(&m_csReceive);
+
+	HRESULT hr = m_WorkerPool.SetThreadCount(nThreads);
+	if (SUCCEEDED(hr))
+	{
+		m_nThreads = nThreads;
+	}
+
+	return hr;
+}
+
+
+STDMETHODIMP CVideoResizer::GetThreadCount(int* pnThreads)
+{
+	CheckPointer(pnThreads, E_POINTER);
+
+	*pnThreads = m_nThreads;
+
+	return S_OK;
+}
+
+
+STDMETHODIMP CVideoResizer::SetTiling(int nTiling)
+{
+	CAutoLock lock(&m_csReceive);
+
+	if (m_pResizer == NULL)
+	{
+		return E_UNEXPECTED;
+	}
+
+	HRESULT hr = m_pResizer->SetTiling(nTiling);
+	if (SUCCEEDED(hr))
+	{
+		m_nTiling = nTiling;
+	}
+
+	return hr;
+}
+
+
+STDMETHODIMP CVideoResizer::GetTiling(int* pnTiling)
+{
+	CheckPointer(pnTiling, E_POINTER);
+
+	*pnTiling = m_nTiling;
+
+	return S_OK;
+}
+
+
+// ͂̋`̕ύX
+// Đ̃TvςBݒ肪ȂΓ͂̃^Cv̋`
+STDMETHODIMP CVideoResizer::SetSourceRect(const RECT* prcSource)
+{
+	CAutoLock lock(&m_csReceive);
+
+	if (m_pResizer == NULL)
+	{
+		return E_UNEXPECTED;
+	}
+
+	if (prcSource == NULL)
+	{
+		SetRectEmpty(&m_rcSource);
+	}
+	else
+	{
+		m_rcSource = *prcSource;
+	}
+
+	return m_pResizer->SetSourceRect(IsRectEmpty(&m_rcSource)
+									 ? &m_rcInputSource : &m_rcSource);
+}
+
+
+STDMETHODIMP CVideoResizer::GetSourceRect(RECT* prcSource)
+{
+	CheckPointer(prcSource, E_POINTER);
+
+	CAutoLock lock(&m_csReceive);
+	*prcSource = m_rcSource;
+
+	return S_OK;
+}
+
+
 HRESULT CVideoResizer::CheckInputType(const CMediaType *mtIn)
 {
 	// supported sub types
@@ -145,14 +386,20 @@ HRESULT CVideoResizer::CheckInputType(const CMediaType *mtIn)
 	// MEDIASUBTYPE_ARGB32
 	// MEDIASUBTYPE_A2R10G10B10
 	// MEDIASUBTYPE_A2B10G10R10
+	// MEDIASUBTYPE_YUY2
+	// MEDIASUBTYPE_UYVY
+	// MEDIASUBTYPE_NV12
+	// MEDIASUBTYPE_I420
+	// MEDIASUBTYPE_IYUV
+	// MEDIASUBTYPE_YV12
 
 	DbgLog((LOG_TRACE, 1, TEXT("CVideoResizer::CheckInputType")));
 	DbgLogMediaType((LOG_TRACE, 0, mtIn));
 	DbgLogMediaFormat((LOG_TRACE, 0, mtIn));
 
-	int nBits;
+	RESIZE_KERNELS kernels;
 	if (mtIn->majortype != MEDIATYPE_Video
-		|| m_pResizer->IsSupportMediaSubType(mtIn->Subtype(), &nBits) != S_OK
+		|| m_pResizer->IsSupportMediaSubType(mtIn->Subtype(), &kernels) != S_OK
 		|| mtIn->formattype != FORMAT_VideoInfo
 		|| mtIn->cbFormat < sizeof(VIDEOINFOHEADER))
 	{
@@ -161,7 +408,26 @@ HRESULT CVideoResizer::CheckInputType(const CMediaType *mtIn)
 	}
 
 	VIDEOINFOHEADER *pVih = reinterpret_cast<VIDEOINFOHEADER*>(mtIn->pbFormat);
-	if ((pVih->bmiHeader.biBitCount != nBits))
+	if ((pVih->bmiHeader.biBitCount != kernels.nBitCount))
+	{
+		DbgLog((LOG_TRACE, 1, TEXT(" => NOT ACCEPTED")));
+		return VFW_E_TYPE_NOT_ACCEPTED;
+	}
+
+	// YUVFOURCCŁAɏォ牺ō͐
+	if (kernels.dwCompression != BI_RGB
+		&& (pVih->bmiHeader.biCompression != kernels.dwCompression
+			|| pVih->bmiHeader.biHeight < 0))
+	{
+		DbgLog((LOG_TRACE, 1, TEXT(" => NOT ACCEPTED")));
+		return VFW_E_TYPE_NOT_ACCEPTED;
+	}
+
+	// FLsNZ̔{̃TCŶ
+	if (pVih->bmiHeader.biWidth % kernels.nBlockWidth != 0
+		|| pVih->bmiHeader.biHeight % kernels.nBlockHeight != 0
+		|| m_pResizer->GetToWidth() % kernels.nBlockWidth != 0
+		|| m_pResizer->GetToHeight() % kernels.nBlockHeight != 0)
 	{
 		DbgLog((LOG_TRACE, 1, TEXT(" => NOT ACCEPTED")));
 		return VFW_E_TYPE_NOT_ACCEPTED;
@@ -180,64 +446,98 @@ HRESULT CVideoResizer::CheckInputType(const CMediaType *mtIn)
 		return VFW_E_TYPE_NOT_ACCEPTED;
 	}
 
-	m_pResizer->SetMediaSubType(mtIn->Subtype());
-	m_nSrcWidth = pVih->bmiHeader.biWidth;
-	m_nSrcHeight = pVih->bmiHeader.biHeight;
-
 	DbgLog((LOG_TRACE, 1, TEXT(" => ACCEPTED !")));
 	return S_OK;
 }
 
 
 HRESULT CVideoResizer::GetMediaType(int iPosition, CMediaType *pMediaType)
+{
+	return GetOutputMediaType(m_pResizer, iPosition, pMediaType);
+}
+
+
+// TCU[̏o͂̃fBA^Cv
+HRESULT CVideoResizer::GetOutputMediaType(CVideoResizeBase* pResizer,
+										  int iPosition,
+										  CMediaType *pMediaType)
 {
 	ASSERT(m_pInput->IsConnected());
 	
 	if (iPosition < 0)
 		return E_INVALIDARG;
 	
-	if (iPosition != 0)
-		return VFW_S_NO_MORE_ITEMS;
+	// 0: top-down, 1: bottom-up
+	// YUV͌1̂
+	// RGB32ɐFϊo͂2
+	const GUID* pSubtype = pResizer->GetMediaSubType();
+	int nSameTypes = pResizer->IsYUV() ? 1 : 2;
+	if (iPosition >= nSameTypes)
+	{
+		iPosition -= nSameTypes;
+		if (iPosition > 1
+			|| pResizer->IsSupportConversion(pSubtype, &MEDIASUBTYPE_RGB32)
+				!= S_OK)
+			return VFW_S_NO_MORE_ITEMS;
+
+		pSubtype = &MEDIASUBTYPE_RGB32;
+	}
+
+	RESIZE_KERNELS kernels;
+	HRESULT hr = pResizer->IsSupportMediaSubType(pSubtype, &kernels);
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+	BOOL bYUV = (kernels.dwCompression != BI_RGB);
+	BOOL bConvert = (*pSubtype != *pResizer->GetMediaSubType());
 
 	CMediaType *pInMediaType = &m_pInput->CurrentMediaType();
 	VIDEOINFOHEADER *pInVh = (VIDEOINFOHEADER*)pInMediaType->Format();
 
 	// IndexColorƂłȂ̂ŏ𕪂
+	// Fϊo͂Ƀpbg͂Ȃ
 	ULONG nInFmtLen = pInMediaType->FormatLength();
 	if (nInFmtLen < sizeof(VIDEOINFOHEADER))
 	{
 		return E_UNEXPECTED;
 	}
+	ULONG nFmtLen = bConvert ? sizeof(VIDEOINFOHEADER) : nInFmtLen;
 	
 	VIDEOINFOHEADER* pvh =
-					(VIDEOINFOHEADER*)pMediaType->AllocFormatBuffer(nInFmtLen);
+					(VIDEOINFOHEADER*)pMediaType->AllocFormatBuffer(nFmtLen);
 	if (!pvh)
 	{
 		return E_OUTOFMEMORY;
 	}
 
-	ZeroMemory(pvh, nInFmtLen);
+	ZeroMemory(pvh, nFmtLen);
 	pvh->bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
-	pvh->bmiHeader.biWidth = m_pResizer->GetToWidth();
-	pvh->bmiHeader.biHeight = m_pResizer->GetToHeight();
+	pvh->bmiHeader.biWidth = pResizer->GetToWidth();
+	pvh->bmiHeader.biHeight = (IsTopDownOutput(pResizer, iPosition) && !bYUV)
+								? -pResizer->GetToHeight()
+								: pResizer->GetToHeight();
 	pvh->bmiHeader.biPlanes = 1;
-	pvh->bmiHeader.biBitCount = m_pResizer->GetBitsPerPixel();
-	pvh->bmiHeader.biCompression = BI_RGB;
-	pvh->bmiHeader.biSizeImage = m_pResizer->GetSize();
-	pvh->bmiHeader.biClrUsed = pInVh->bmiHeader.biClrUsed;
-	pvh->bmiHeader.biClrImportant = pInVh->bmiHeader.biClrImportant;
+	pvh->bmiHeader.biBitCount = kernels.nBitCount;
+	pvh->bmiHeader.biCompression = kernels.dwCompression;
+	pvh->bmiHeader.biSizeImage = pResizer->GetOutputSize(pSubtype);
+	if (!bConvert)
+	{
+		pvh->bmiHeader.biClrUsed = pInVh->bmiHeader.biClrUsed;
+		pvh->bmiHeader.biClrImportant = pInVh->bmiHeader.biClrImportant;
+	}
 
 	pMediaType->SetType(&MEDIATYPE_Video);
-	pMediaType->SetSubtype(m_pResizer->GetMediaSubType());
+	pMediaType->SetSubtype(pSubtype);
 	pMediaType->SetFormatType(&FORMAT_VideoInfo);
 	pMediaType->SetSampleSize(pvh->bmiHeader.biSizeImage);
 	pMediaType->SetTemporalCompression(FALSE);
 	pMediaType->bFixedSizeSamples = TRUE;
 
-	if (sizeof(VIDEOINFOHEADER) < nInFmtLen)
+	if (sizeof(VIDEOINFOHEADER) < nFmtLen)
 	{
 		// pbg̃Rs[
-		int cbPalette = nInFmtLen - sizeof(VIDEOINFOHEADER);
+		int cbPalette = nFmtLen - sizeof(VIDEOINFOHEADER);
 		LPBYTE pSrcPlt = (LPBYTE)pInVh + sizeof(VIDEOINFOHEADER);
 		LPBYTE pDstPlt = (LPBYTE)pvh + sizeof(VIDEOINFOHEADER);
 		::CopyMemory(pDstPlt, pSrcPlt, cbPalette);
@@ -259,6 +559,14 @@ HRESULT CVideoResizer::GetMediaType(int iPosition, CMediaType *pMediaType)
 
 HRESULT CVideoResizer::CheckTransform(const CMediaType *mtIn,
 										const CMediaType *mtOut)
+{
+	return CheckOutputType(m_pResizer, mtIn, mtOut);
+}
+
+
+HRESULT CVideoResizer::CheckOutputType(CVideoResizeBase* pResizer,
+									   const CMediaType *mtIn,
+									   const CMediaType *mtOut)
 {
 	DbgLog((LOG_TRACE, 1, TEXT("CVideoResizer::CheckTransform")));
 	DbgLog((LOG_TRACE, 1, TEXT(" <Media In>")));
@@ -268,8 +576,19 @@ HRESULT CVideoResizer::CheckTransform(const CMediaType *mtIn,
 	DbgLogMediaType((LOG_TRACE, 0, mtOut));
 	DbgLogMediaFormat((LOG_TRACE, 0, mtOut));
 
+	// ͂ƓAFϊł^Cv
+	// ͂̍ĐڑŊmFƂ̂ŁA͂mtInŌ
 	if (mtOut->majortype != MEDIATYPE_Video
-		|| mtOut->subtype != *m_pResizer->GetMediaSubType())
+		|| (mtOut->subtype != mtIn->subtype
+			&& pResizer->IsSupportConversion(&mtIn->subtype,
+											 &mtOut->subtype) != S_OK))
+	{
+		DbgLog((LOG_TRACE, 1, TEXT(" => NOT ACCEPTED")));
+		return VFW_E_TYPE_NOT_ACCEPTED;
+	}
+
+	RESIZE_KERNELS kernels;
+	if (pResizer->IsSupportMediaSubType(&mtOut->subtype, &kernels) != S_OK)
 	{
 		DbgLog((LOG_TRACE, 1, TEXT(" => NOT ACCEPTED")));
 		return VFW_E_TYPE_NOT_ACCEPTED;
@@ -287,10 +606,11 @@ HRESULT CVideoResizer::CheckTransform(const CMediaType *mtIn,
 	BITMAPINFOHEADER *pBmiOut = HEADER(mtOut->pbFormat);
 	BITMAPINFOHEADER *pBmiIn = HEADER(mtIn->pbFormat);
 	if (pBmiOut->biPlanes != 1
-		|| pBmiOut->biBitCount != m_pResizer->GetBitsPerPixel()
-		|| pBmiOut->biCompression != BI_RGB
-		|| pBmiOut->biWidth != m_pResizer->GetToWidth()
-		|| pBmiOut->biHeight != m_pResizer->GetToHeight())
+		|| pBmiOut->biBitCount != kernels.nBitCount
+		|| pBmiOut->biCompression != kernels.dwCompression
+		|| pBmiOut->biWidth != pResizer->GetToWidth()
+		|| abs(pBmiOut->biHeight) != pResizer->GetToHeight()
+		|| (kernels.dwCompression != BI_RGB && pBmiOut->biHeight < 0))
 	{
 		DbgLog((LOG_TRACE, 1, TEXT(" => NOT ACCEPTED")));
 		return VFW_E_TYPE_NOT_ACCEPTED;
@@ -301,11 +621,83 @@ HRESULT CVideoResizer::CheckTransform(const CMediaType *mtIn,
 }
 
 
+HRESULT CVideoResizer::SetMediaType(PIN_DIRECTION direction,
+									const CMediaType *pmt)
+{
+	// ̃^CvmF̂ŁATCY͐ڑ^Cv
+	if (direction == PINDIR_INPUT)
+	{
+		HRESULT hr = m_pResizer->SetMediaSubType(pmt->Subtype());
+		if (FAILED(hr))
+		{
+			return hr;
+		}
+		SetInputSize(&m_pInput->CurrentMediaType());
+		SetInputSourceRect(pmt);
+	}
+	else if (direction == PINDIR_OUTPUT)
+	{
+		HRESULT hr = SetOutputMediaType(m_pResizer, pmt);
+		if (FAILED(hr))
+		{
+			return hr;
+		}
+	}
+
+	return CTransformFilter::SetMediaType(direction, pmt);
+}
+
+
+HRESULT CVideoResizer::SetOutputMediaType(CVideoResizeBase* pResizer,
+										  const CMediaType *pmt)
+{
+	// Fϊ͊gEkeCɑ΂čs
+	HRESULT hr = pResizer->SetOutputSubType(pmt->Subtype());
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+
+	// ㉺]͕ϊɃXgCh̕ōs
+	BITMAPINFOHEADER *pBmi = HEADER(pmt->Format());
+	pResizer->SetTopDown(pBmi->biHeight < 0);
+
+	return S_OK;
+}
+
+
+// o͂̌
+// ォ牺D悷邪ATCY͓̓͂͂ƓD悵
+// ̂܂܉֓n悤ɂ
+BOOL CVideoResizer::IsTopDownOutput(CVideoResizeBase* pResizer,
+									 int iPosition)
+{
+	BOOL bTopDown = (iPosition == 0);
+	if (m_nSrcWidth == pResizer->GetToWidth()
+		&& m_nSrcHeight == pResizer->GetToHeight())
+	{
+		bTopDown = !bTopDown;
+	}
+
+	return bTopDown;
+}
+
+
 HRESULT CVideoResizer::DecideBufferSize(IMemAllocator *pAlloc,
 										ALLOCATOR_PROPERTIES *pAp)
+{
+	m_pOutputAllocator = pAlloc;
+	return DecideOutputBufferSize(m_pOutput, m_pResizer, pAlloc, pAp);
+}
+
+
+HRESULT CVideoResizer::DecideOutputBufferSize(CBaseOutputPin *pPin,
+											  CVideoResizeBase* pResizer,
+											  IMemAllocator *pAlloc,
+											  ALLOCATOR_PROPERTIES *pAp)
 {
 	AM_MEDIA_TYPE mt;
-	HRESULT hr = m_pOutput->ConnectionMediaType(&mt);
+	HRESULT hr = pPin->ConnectionMediaType(&mt);
 	if (FAILED(hr))
 	{
 		return hr;
@@ -315,7 +707,7 @@ HRESULT CVideoResizer::DecideBufferSize(IMemAllocator *pAlloc,
 	BITMAPINFOHEADER *pbmi = HEADER(mt.pbFormat);
 	
 	pAp->cBuffers = 1;
-	pAp->cbBuffer = m_pResizer->GetSize();
+	pAp->cbBuffer = pResizer->GetSize();
 	pAp->cbAlign = 4;
 	pAp->cbPrefix = 0;
 
@@ -342,19 +734,295 @@ HRESULT CVideoResizer::DecideBufferSize(IMemAllocator *pAlloc,
 
 HRESULT CVideoResizer::Transform(IMediaSample *pSource, IMediaSample *pDest)
 {
+	int nAlgorithm;
+	BOOL bAreaAverage;
+	{
+		CAutoLock lock(&m_csQuality);
+		nAlgorithm = GetQualityAlgorithm(m_nQualityLevel);
+		bAreaAverage = IsQualityAreaAverage(m_nQualityLevel);
+	}
+
+	// XP[e[u̓LbV̂ŁA߂Ƃ蒼Ȃ
+	if (nAlgorithm != m_nAppliedAlgorithm)
+	{
+		HRESULT hr = m_pResizer->SetAlgorithm(nAlgorithm);
+		if (FAILED(hr))
+		{
+			return hr;
+		}
+		m_nAppliedAlgorithm = nAlgorithm;
+	}
+	if (m_pResizer->GetAreaAverage() != bAreaAverage)
+	{
+		m_pResizer->SetAreaAverage(bAreaAverage);
+	}
+
 	HRESULT hr = m_pResizer->Transform(pSource, m_nSrcWidth, m_nSrcHeight,
 									   pDest);
 
 #if _DEBUG
 	m_nFrameCount++;
 	DbgWndDisplay(&DBGWND, this, pDest, m_nFrameCount, m_tStart);
-	DBGWND_TEXT(10, 110, GetSubtypeName(m_pResizer->GetMediaSubType()));
+	DBGWND_TEXT(10, 110, GetSubtypeName(m_pResizer->GetOutputSubType()));
 #endif
 
 	return hr;
 }
 
 
+// ͂Əo͂TCYEȂTv̂܂܉֓n
+HRESULT CVideoResizer::Receive(IMediaSample *pSample)
+{
+	// ̂ĂTv͏o̓obt@OɎ̂Ă
+	// ɑTv͕sAɂ
+	if (IsSkipSample())
+	{
+		m_bSampleSkipped = TRUE;
+		if (!m_bQualityChanged)
+		{
+			m_bQualityChanged = TRUE;
+			NotifyEvent(EC_QUALITY_CHANGE, 0, 0);
+		}
+		return S_OK;
+	}
+
+	// ͂̋`̓TṽfBA^Cvłς
+	// fBA^CvύXꂽTv͕ϊʂ
+	AM_MEDIA_TYPE* pmt = NULL;
+	BOOL bTypeChanged = FALSE;
+	if (pSample->GetMediaType(&pmt) == S_OK && pmt != NULL)
+	{
+		SetInputSize(pmt);
+		SetInputSourceRect(pmt);
+		DeleteMediaType(pmt);
+		bTypeChanged = TRUE;
+	}
+
+	if (bTypeChanged || !IsPassThrough())
+	{
+		return CTransformFilter::Receive(pSample);
+	}
+
+#if _DEBUG
+	m_nFrameCount++;
+	DbgWndDisplay(&DBGWND, this, pSample, m_nFrameCount, m_tStart);
+	DBGWND_TEXT(10, 110, GetSubtypeName(m_pResizer->GetMediaSubType()));
+#endif
+
+	if (m_bSampleSkipped)
+	{
+		pSample->SetDiscontinuity(TRUE);
+		m_bSampleSkipped = FALSE;
+	}
+
+	return DeliverPassThrough(pSample);
+}
+
+
+HRESULT CVideoResizer::DeliverPassThrough(IMediaSample *pSample)
+{
+	return m_pOutput->Deliver(pSample);
+}
+
+
+// ~ĐƂ͐ݒ肳ꂽԂɖ߂
+HRESULT CVideoResizer::StartStreaming()
+{
+	CAutoLock lock(&m_csQuality);
+
+	m_nQualityLevel = QUALITY_FULL;
+	m_nLateCount = 0;
+	m_nOnTimeCount = 0;
+	m_bDropSample = FALSE;
+
+	m_bSharedAllocator = FALSE;
+	IMemAllocator* pAlloc = NULL;
+	if (m_pOutputAllocator != NULL
+		&& SUCCEEDED(m_pInput->GetAllocator(&pAlloc)))
+	{
+		m_bSharedAllocator = (pAlloc == m_pOutputAllocator);
+		pAlloc->Release();
+	}
+
+	return CTransformFilter::StartStreaming();
+}
+
+
+// ̕ibZ[W
+// ߏ(Flood)łs(Famine)łAxꂪƕԂiKIɗƂA
+// xꂪԂƈi߂
+// ĂxƂ㗬֓n
+HRESULT CVideoResizer::AlterQuality(Quality q)
+{
+	CAutoLock lock(&m_csQuality);
+
+	if (q.Late > QUALITY_LATE_TIME)
+	{
+		m_nOnTimeCount = 0;
+		if (m_nQualityLevel == QUALITY_DROP)
+		{
+			m_nLateCount = 0;
+			return S_FALSE;
+		}
+		if (++m_nLateCount < QUALITY_LATE_COUNT)
+		{
+			return S_OK;
+		}
+		m_nLateCount = 0;
+
+		// ςȂiK͔΂
+		m_nQualityLevel++;
+		while (m_nQualityLevel < QUALITY_DROP
+			   && IsSameQuality(m_nQualityLevel, m_nQualityLevel - 1))
+		{
+			m_nQualityLevel++;
+		}
+
+		// ̂ĂiK͍ŏ̃Tv̂Ă
+		m_bDropSample = FALSE;
+
+		DbgLog((LOG_TRACE, 1, TEXT("CVideoResizer::AlterQuality => %d"),
+				m_nQualityLevel));
+	}
+	else if (q.Late < QUALITY_ONTIME_TIME)
+	{
+		m_nLateCount = 0;
+		if (m_nQualityLevel == QUALITY_FULL
+			|| ++m_nOnTimeCount < QUALITY_ONTIME_COUNT)
+		{
+			return S_OK;
+		}
+		m_nOnTimeCount = 0;
+
+		m_nQualityLevel--;
+		while (m_nQualityLevel > QUALITY_FULL
+			   && IsSameQuality(m_nQualityLevel, m_nQualityLevel - 1))
+		{
+			m_nQualityLevel--;
+		}
+
+		DbgLog((LOG_TRACE, 1, TEXT("CVideoResizer::AlterQuality => %d"),
+				m_nQualityLevel));
+	}
+	else
+	{
+		m_nLateCount = 0;
+		m_nOnTimeCount = 0;
+	}
+
+	return S_OK;
+}
+
+
+// i̒iK̕
+// ݒ荂Ԃɂ͂Ȃ
+int CVideoResizer::GetQualityAlgorithm(int nLevel)
+{
+	switch (nLevel)
+	{
+	case QUALITY_FULL:
+		return m_nAlgorithm;
+	case QUALITY_BILINEAR:
+		return (m_nAlgorithm < RESIZE_BILINEAR)
+				? m_nAlgorithm : RESIZE_BILINEAR;
+	default:
+		return RESIZE_NEAREST;
+	}
+}
+
+
+// i̒iK̖ʐϕ
+// 2{ȏ̏kł̓jAXglCo[ʐϕςɂȂ̂ŁA
+// jAXglCo[̒iK͖ʐϕςȂ
+BOOL CVideoResizer::IsQualityAreaAverage(int nLevel)
+{
+	return nLevel < QUALITY_NEAREST;
+}
+
+
+BOOL CVideoResizer::IsSameQuality(int nLevel1, int nLevel2)
+{
+	return GetQualityAlgorithm(nLevel1) == GetQualityAlgorithm(nLevel2)
+		&& IsQualityAreaAverage(nLevel1) == IsQualityAreaAverage(nLevel2);
+}
+
+
+// 񈳏k̃t[ׂ͂ăL[t[Ȃ̂ŁÂĂiKł
+// 1t[Ɏ̂Ă
+BOOL CVideoResizer::IsSkipSample()
+{
+	CAutoLock lock(&m_csQuality);
+
+	if (m_nQualityLevel != QUALITY_DROP)
+	{
+		return FALSE;
+	}
+
+	m_bDropSample = !m_bDropSample;
+	return m_bDropSample;
+}
+
+
+// ͂̃Tv͓͂̃^CṽXgChȂ̂ŁAAP[^
+// LĂ邩Ao͂̃^CṽXgChƍƂn
+BOOL CVideoResizer::IsPassThrough()
+{
+	int nToHeight = m_pResizer->GetToHeight();
+	if (m_pResizer->IsTopDown())
+	{
+		nToHeight = -nToHeight;
+	}
+
+	if (m_pResizer->IsConverting()
+		|| m_pResizer->IsCropping(m_nSrcWidth, abs(m_nSrcHeight))
+		|| m_nSrcWidth != m_pResizer->GetToWidth()
+		|| m_nSrcHeight != nToHeight)
+	{
+		return FALSE;
+	}
+
+	if (m_bSharedAllocator)
+	{
+		return TRUE;
+	}
+
+	BITMAPINFOHEADER *pBmi = HEADER(m_pOutput->CurrentMediaType().Format());
+	return pBmi->biWidth == m_nSrcWidth
+		&& pBmi->biHeight == m_nSrcHeight;
+}
+
+
+// ͂̃^CṽTCY
+void CVideoResizer::SetInputSize(const AM_MEDIA_TYPE* pmt)
+{
+	if (pmt->formattype == FORMAT_VideoInfo
+		&& pmt->cbFormat >= sizeof(VIDEOINFOHEADER))
+	{
+		BITMAPINFOHEADER *pBmi = HEADER(pmt->pbFormat);
+		m_nSrcWidth = pBmi->biWidth;
+		m_nSrcHeight = pBmi->biHeight;
+	}
+}
+
+
+// ͂̃^CvrcSource
+// SetSourceRect̐ݒ肪΂g
+void CVideoResizer::SetInputSourceRect(const AM_MEDIA_TYPE* pmt)
+{
+	SetRectEmpty(&m_rcInputSource);
+	if (pmt->formattype == FORMAT_VideoInfo
+		&& pmt->cbFormat >= sizeof(VIDEOINFOHEADER))
+	{
+		m_rcInputSource = ((VIDEOINFOHEADER*)pmt->pbFormat)->rcSource;
+	}
+
+	if (IsRectEmpty(&m_rcSource))
+	{
+		m_pResizer->SetSourceRect(&m_rcInputSource);
+	}
+}
+
+
 HRESULT CVideoResizer::CompleteConnect(PIN_DIRECTION direction,
 		IPin *pReceivePin)
 {
@@ -367,6 +1035,17 @@ HRESULT CVideoResizer::CompleteConnect(PIN_DIRECTION direction,
 }
 
 
+HRESULT CVideoResizer::BreakConnect(PIN_DIRECTION dir)
+{
+	if (dir == PINDIR_OUTPUT)
+	{
+		m_pOutputAllocator = NULL;
+	}
+
+	return CTransformFilter::BreakConnect(dir);
+}
+
+
 STDMETHODIMP CVideoResizer::Stop()
 {
 #ifdef _DEBUG
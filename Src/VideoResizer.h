@@ -24,12 +24,15 @@
 #pragma once
 
 #include "DbgWnd.h"
+#include "WorkerPool.h"
+#include "IVideoResizerConfig.h"
 
 class CVideoResizeBase;
 
 extern const AMOVIESETUP_FILTER sudVideoResizer;
 
 class CVideoResizer : public CTransformFilter
+					, public IVideoResizerConfig
 {
 #ifdef _DEBUG
 	long m_nFrameCount;
@@ -38,30 +41,92 @@ private:
 	// resize config
 	int const DEST_WIDTH;
 	int const DEST_HEIGHT;
+	int const DEST_ALGORITHM;
+	int const DEST_THREADS;		// 0: one for each processor
+	int const DEST_TILING;
 	
 public:
 	DECLARE_IUNKNOWN;
 	static CUnknown * WINAPI CreateInstance(LPUNKNOWN punk, HRESULT *phr);
 
-	CVideoResizer(LPUNKNOWN punk);
+	CVideoResizer(LPUNKNOWN punk, LPCTSTR pName, REFCLSID clsid);
 	virtual ~CVideoResizer();
 
+	STDMETHODIMP NonDelegatingQueryInterface(REFIID riid, void** ppv);
+
+	// IVideoResizerConfig
+	STDMETHODIMP SetOutputSize(int nWidth, int nHeight);
+	STDMETHODIMP GetOutputSize(int* pnWidth, int* pnHeight);
+	STDMETHODIMP SetAlgorithm(int nAlgorithm);
+	STDMETHODIMP GetAlgorithm(int* pnAlgorithm);
+	STDMETHODIMP SetThreadCount(int nThreads);
+	STDMETHODIMP GetThreadCount(int* pnThreads);
+	STDMETHODIMP SetTiling(int nTiling);
+	STDMETHODIMP GetTiling(int* pnTiling);
+	STDMETHODIMP SetSourceRect(const RECT* prcSource);
+	STDMETHODIMP GetSourceRect(RECT* prcSource);
+
 	HRESULT CheckInputType(const CMediaType *mtIn);
 	HRESULT GetMediaType(int iPosition, CMediaType *pMediaType);
 	HRESULT CheckTransform(const CMediaType *mtIn, const CMediaType *mtOut);
+	HRESULT SetMediaType(PIN_DIRECTION direction, const CMediaType *pmt);
 	
 	HRESULT DecideBufferSize(IMemAllocator *pAlloc, ALLOCATOR_PROPERTIES *pAp);
 	HRESULT Transform(IMediaSample *pSource, IMediaSample *pDest);
+	HRESULT Receive(IMediaSample *pSample);
+	HRESULT StartStreaming();
+	HRESULT AlterQuality(Quality q);
 
 	HRESULT CompleteConnect(PIN_DIRECTION direction, IPin *pReceivePin);
+	HRESULT BreakConnect(PIN_DIRECTION dir);
 
 	STDMETHODIMP Stop();
 	STDMETHODIMP Pause();
 
+protected:
+	BOOL IsPassThrough();
+	void SetInputSourceRect(const AM_MEDIA_TYPE* pmt);
+	void SetInputSize(const AM_MEDIA_TYPE* pmt);
+	virtual HRESULT DeliverPassThrough(IMediaSample *pSample);
+	// the output side of a resizer, for the outputs of the derived filters
+	HRESULT GetOutputMediaType(CVideoResizeBase* pResizer, int iPosition,
+							   CMediaType *pMediaType);
+	HRESULT CheckOutputType(CVideoResizeBase* pResizer,
+							const CMediaType *mtIn, const CMediaType *mtOut);
+	HRESULT SetOutputMediaType(CVideoResizeBase* pResizer,
+							   const CMediaType *pmt);
+	HRESULT DecideOutputBufferSize(CBaseOutputPin *pPin,
+								   CVideoResizeBase* pResizer,
+								   IMemAllocator *pAlloc,
+								   ALLOCATOR_PROPERTIES *pAp);
+	BOOL IsTopDownOutput(CVideoResizeBase* pResizer, int iPosition);
+	int GetQualityAlgorithm(int nLevel);
+	BOOL IsQualityAreaAverage(int nLevel);
+	BOOL IsSameQuality(int nLevel1, int nLevel2);
+	BOOL IsSkipSample();
+
 protected:
 	CVideoResizeBase* m_pResizer;
+	CWorkerPool m_WorkerPool;
+	int m_nAlgorithm;
+	int m_nThreads;
+	int m_nTiling;
 	int m_nSrcWidth;
-	int m_nSrcHeight;
+	int m_nSrcHeight;			// of the connected input type
+	RECT m_rcSource;			// set by SetSourceRect
+	RECT m_rcInputSource;		// rcSource of the input type
+
+	// quality control: the level lowered by the lateness of the downstream
+	CCritSec m_csQuality;
+	int m_nQualityLevel;
+	int m_nLateCount;
+	int m_nOnTimeCount;
+	BOOL m_bDropSample;			// the last one was dropped, on QUALITY_DROP
+	int m_nAppliedAlgorithm;	// on m_pResizer, by the streaming thread
+
+	// pass-through: the allocator given to DecideBufferSize, only compared
+	IMemAllocator* m_pOutputAllocator;
+	BOOL m_bSharedAllocator;	// with the input, set by StartStreaming
 
 	DECLARE_DBGWND;
 };
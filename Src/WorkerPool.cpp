@@ -0,0 +1,213 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Motoharu Tsubaki.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a 
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <streams.h>
+
+#include "WorkerPool.h"
+
+
+// parameter of a worker thread
+struct WORKER_PARAM
+{
+	CWorkerPool* pPool;
+	int nWorker;
+};
+
+
+CWorkerPool::CWorkerPool()
+	: m_nThreads(1)
+	, m_nStarted(0)
+	, m_hDone(NULL)
+	, m_bExit(FALSE)
+	, m_pfnTask(NULL)
+	, m_pContext(NULL)
+	, m_nTasks(0)
+	, m_nNextTask(0)
+	, m_nRunning(0)
+{
+	::ZeroMemory(m_hThreads, sizeof(m_hThreads));
+	::ZeroMemory(m_hStart, sizeof(m_hStart));
+}
+
+
+CWorkerPool::~CWorkerPool()
+{
+	StopThreads();
+}
+
+
+HRESULT CWorkerPool::SetThreadCount(int nThreads)
+{
+	if (nThreads < 0) {
+		return E_INVALIDARG;
+	}
+
+	if (nThreads == 0) {
+		SYSTEM_INFO si;
+		::GetSystemInfo(&si);
+		nThreads = (int)si.dwNumberOfProcessors;
+	}
+	nThreads = max(1, min(nThreads, WORKER_MAX_THREADS));
+
+	CAutoLock lock(&m_csRun);
+	if (m_nThreads != nThreads) {
+		// the threads start again at the next Run()
+		StopThreads();
+		m_nThreads = nThreads;
+	}
+
+	return S_OK;
+}
+
+
+HRESULT CWorkerPool::Run(PFN_TASK pfnTask, void* pContext,
+						 int nTasks, int nWorkers)
+{
+	CheckPointer(pfnTask, E_POINTER);
+
+	CAutoLock lock(&m_csRun);
+
+	nWorkers = min(min(nWorkers, nTasks), m_nThreads);
+	if (nWorkers > 1 && m_nStarted == 0) {
+		if (FAILED(StartThreads())) {
+			nWorkers = 1;
+		}
+	}
+
+	m_pfnTask = pfnTask;
+	m_pContext = pContext;
+	m_nTasks = nTasks;
+	m_nNextTask = 0;
+
+	if (nWorkers <= 1) {
+		DoTasks(0);
+		return S_OK;
+	}
+
+	m_nRunning = nWorkers - 1;
+	for (int i = 1; i < nWorkers; i++) {
+		::SetEvent(m_hStart[i]);
+	}
+
+	DoTasks(0);
+
+	// barrier, the tasks have been written out when it's signaled
+	::WaitForSingleObject(m_hDone, INFINITE);
+
+	return S_OK;
+}
+
+
+DWORD WINAPI CWorkerPool::ThreadProc(LPVOID pParam)
+{
+	WORKER_PARAM* pWorker = (WORKER_PARAM*)pParam;
+	CWorkerPool* pPool = pWorker->pPool;
+	int nWorker = pWorker->nWorker;
+	delete pWorker;
+
+	for (;;) {
+		::WaitForSingleObject(pPool->m_hStart[nWorker], INFINITE);
+		if (pPool->m_bExit) {
+			break;
+		}
+
+		pPool->DoTasks(nWorker);
+
+		if (::InterlockedDecrement(&pPool->m_nRunning) == 0) {
+			::SetEvent(pPool->m_hDone);
+		}
+	}
+
+	return 0;
+}
+
+
+HRESULT CWorkerPool::StartThreads()
+{
+	ASSERT(m_nStarted == 0);
+
+	m_bExit = FALSE;
+	m_hDone = ::CreateEvent(NULL, FALSE, FALSE, NULL);
+	if (m_hDone == NULL) {
+		return E_OUTOFMEMORY;
+	}
+
+	for (int i = 1; i < m_nThreads; i++) {
+		m_hStart[i] = ::CreateEvent(NULL, FALSE, FALSE, NULL);
+		WORKER_PARAM* pWorker = new WORKER_PARAM;
+		if (m_hStart[i] == NULL || pWorker == NULL) {
+			delete pWorker;
+			StopThreads();
+			return E_OUTOFMEMORY;
+		}
+
+		pWorker->pPool = this;
+		pWorker->nWorker = i;
+		m_hThreads[i] = ::CreateThread(NULL, 0, ThreadProc, pWorker, 0, NULL);
+		if (m_hThreads[i] == NULL) {
+			delete pWorker;
+			StopThreads();
+			return E_FAIL;
+		}
+		m_nStarted = i;
+	}
+
+	return S_OK;
+}
+
+
+void CWorkerPool::StopThreads()
+{
+	m_bExit = TRUE;
+	for (int i = 1; i < WORKER_MAX_THREADS; i++) {
+		if (m_hThreads[i] != NULL) {
+			::SetEvent(m_hStart[i]);
+			::WaitForSingleObject(m_hThreads[i], INFINITE);
+			::CloseHandle(m_hThreads[i]);
+			m_hThreads[i] = NULL;
+		}
+		if (m_hStart[i] != NULL) {
+			::CloseHandle(m_hStart[i]);
+			m_hStart[i] = NULL;
+		}
+	}
+
+	if (m_hDone != NULL) {
+		::CloseHandle(m_hDone);
+		m_hDone = NULL;
+	}
+
+	m_nStarted = 0;
+}
+
+
+void CWorkerPool::DoTasks(int nWorker)
+{
+	for (;;) {
+		int nTask = ::InterlockedIncrement(&m_nNextTask) - 1;
+		if (nTask >= m_nTasks) {
+			break;
+		}
+		m_pfnTask(m_pContext, nTask, nWorker);
+	}
+}
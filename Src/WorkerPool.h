@@ -0,0 +1,72 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Motoharu Tsubaki.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a 
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#define WORKER_MAX_THREADS		(64)
+
+// persistent worker threads that run the tasks of one job in parallel.
+// the caller of Run() works as the worker 0, and Run() returns after all
+// the tasks are done.
+class CWorkerPool
+{
+public:
+	// called for each task with the index of the worker running it
+	typedef void (*PFN_TASK)(void* pContext, int nTask, int nWorker);
+
+public:
+	CWorkerPool();
+	virtual ~CWorkerPool();
+
+	// number of workers including the caller, 0 for the processors
+	HRESULT SetThreadCount(int nThreads);
+	int GetThreadCount() { return m_nThreads; }
+
+	// runs nTasks tasks on up to nWorkers workers
+	HRESULT Run(PFN_TASK pfnTask, void* pContext, int nTasks, int nWorkers);
+
+private:
+	static DWORD WINAPI ThreadProc(LPVOID pParam);
+
+	HRESULT StartThreads();
+	void StopThreads();
+	void DoTasks(int nWorker);
+
+private:
+	CCritSec m_csRun;
+	int m_nThreads;
+
+	// threads of the workers 1 to m_nStarted
+	int m_nStarted;
+	HANDLE m_hThreads[WORKER_MAX_THREADS];
+	HANDLE m_hStart[WORKER_MAX_THREADS];
+	HANDLE m_hDone;
+	BOOL m_bExit;
+
+	// current job
+	PFN_TASK m_pfnTask;
+	void* m_pContext;
+	int m_nTasks;
+	volatile LONG m_nNextTask;
+	volatile LONG m_nRunning;
+};
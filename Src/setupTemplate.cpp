@@ -29,6 +29,7 @@
 // include filter/interface headers
 #include "MediaSampleMonitor.h"
 #include "VideoResizer.h"
+#include "VideoPyramid.h"
 #include "VideoMux.h"
 
 
@@ -49,6 +50,13 @@ CFactoryTemplate g_Templates[] = {
 		NULL,
 		&sudVideoResizer
 	},
+	{
+		L"Video Pyramid",
+		&CLSID_VideoPyramid,
+		CVideoPyramid::CreateInstance,
+		NULL,
+		&sudVideoPyramid
+	},
 	{
 		L"Video Mux",
 		&CLSID_VideoMux,
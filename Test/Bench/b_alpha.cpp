@@ -0,0 +1,20 @@
+#include "streams.h"
+#define private public
+#include "VideoResizeBase.h"
+#undef private
+#include "sample.h"
+#include <stdio.h>
+#include <time.h>
+#include <sys/time.h>
+static double now(){ timeval t; gettimeofday(&t,0); return t.tv_sec+t.tv_usec*1e-6; }
+int main(){
+ GUID* subs[]={&MEDIASUBTYPE_RGB32,&MEDIASUBTYPE_ARGB32,&MEDIASUBTYPE_ARGB4444};
+ const char* n[]={"RGB32","ARGB32","ARGB4444"};
+ for(int al=1;al<=2;al++) for(int f=0;f<3;f++){
+  HRESULT hr; CVideoResizeBase* r=new CVideoResizeBase(1280,720,&hr); r->SetMediaSubType(subs[f]); r->SetAlgorithm(al);
+  FakeSample src(1920*1080*4), dst(r->GetSize()); for(size_t i=0;i<src.buf.size();i++) src.buf[i]=rand();
+  r->Transform(&src,1920,1080,&dst);
+  double best=1e9; for(int k=0;k<5;k++){ double t=now(); for(int i=0;i<10;i++) r->Transform(&src,1920,1080,&dst); best=(best<(now()-t)/10?best:(now()-t)/10); }
+  printf("al%d %s %.2f ms\n",al,n[f],best*1e3); delete r;
+ }
+}
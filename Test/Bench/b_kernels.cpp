@@ -0,0 +1,27 @@
+#include "streams.h"
+#include "ResizeKernels.h"
+#include "Utils.h"
+#include <stdio.h>
+#include <time.h>
+// horizontal kernels of the planes, C against SIMD: 1920 -> 1280 of a luma line (1 byte)
+// and 960 -> 640 of an NV12 chroma line (2 bytes), ns per output pixel
+static double now(){timespec t; clock_gettime(CLOCK_MONOTONIC,&t); return t.tv_sec+t.tv_nsec*1e-9;}
+int main(){
+ const int N=20000;
+ for(int bpp=1;bpp<=2;bpp++){
+  int sw=1920/bpp, n=1280/bpp, taps=6;
+  RESIZE_KERNELS kc, ks; GetPlaneKernels(bpp,0,&kc); GetPlaneKernels(bpp,GetSimdFlags(),&ks);
+  std::vector<BYTE> src(sw*bpp+16); for(size_t i=0;i<src.size();i++) src[i]=(BYTE)(i*7);
+  std::vector<ULONG> sc(n), w(n), st(n); std::vector<short> coef(n*taps), row(n*bpp+8);
+  for(int i=0;i<n;i++){ sc[i]=(i*(sw-1)/n)*bpp; w[i]=(i*12345)&0xffff; st[i]=(i*(sw-taps)/n)*bpp; for(int t=0;t<taps;t++) coef[i*taps+t]=(short)(t==taps/2 ? 200 : 11); }
+  PFN_BILINEAR_H bh[2]={kc.pfnBilinearHC, ks.pfnBilinearH}; PFN_POLYPHASE_H ph[2]={kc.pfnPolyphaseHC, ks.pfnPolyphaseH};
+  double r[4];
+  for(int k=0;k<2;k++){
+   if(!bh[k]||!ph[k]){ r[k*2]=r[k*2+1]=0; continue; }
+   double t0=now(); for(int i=0;i<N;i++) bh[k](&row[0],&src[0],&sc[0],&w[0],bpp,n);
+   double t1=now(); for(int i=0;i<N;i++) ph[k](&row[0],&src[0],&st[0],&coef[0],taps,n);
+   double t2=now(); r[k*2]=(t1-t0)/N/n*1e9; r[k*2+1]=(t2-t1)/N/n*1e9;
+  }
+  printf("bpp%d bilinear H C %.2f SIMD %.2f ns/px  polyphase H (%d taps) C %.2f SIMD %.2f ns/px\n",bpp,r[0],r[2],taps,r[1],r[3]);
+ }
+}
@@ -0,0 +1,21 @@
+#include "streams.h"
+#define private public
+#include "VideoResizeBase.h"
+#undef private
+#include "sample.h"
+#include <stdio.h>
+#include <time.h>
+static double now(){timespec t; clock_gettime(CLOCK_MONOTONIC,&t); return t.tv_sec+t.tv_nsec*1e-9;}
+GUID* subs[]={&MEDIASUBTYPE_RGB8,&MEDIASUBTYPE_RGB565,&MEDIASUBTYPE_RGB24,&MEDIASUBTYPE_RGB32};
+int main(int argc,char**argv){
+ int sw=argc>1?atoi(argv[1]):1920, sh=argc>2?atoi(argv[2]):1080, dw=argc>3?atoi(argv[3]):320, dh=argc>4?atoi(argv[4]):240;
+ for(int b=0;b<4;b++){
+  HRESULT hr; CVideoResizeBase* r=new CVideoResizeBase(dw,dh,&hr);
+  r->SetMediaSubType(subs[b]); if(getenv("ALGO")) r->SetAlgorithm(atoi(getenv("ALGO")));
+  FakeSample src(r->CalcStride(sw)*sh), d(r->GetSize());
+  for(size_t i=0;i<src.buf.size();i++) src.buf[i]=rand();
+  double t0=now(); int n=200; for(int i=0;i<n;i++) r->Transform(&src,sw,sh,&d); double t1=now();
+  printf("bpp%d %.1f MPix/s\n", r->m_nBytesPerPixel, (double)dw*dh*n/(t1-t0)/1e6);
+  delete r;
+ }
+}
@@ -0,0 +1,29 @@
+#include "streams.h"
+#define private public
+#include "VideoResizeBase.h"
+#include "ScaleTable.h"
+#undef private
+#include "sample.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+// nearest-neighbor vertical upscale with and without copying the repeated lines
+static double now(){ timespec t; clock_gettime(CLOCK_MONOTONIC,&t); return t.tv_sec+t.tv_nsec*1e-9; }
+static double Best(CVideoResizeBase& r, FakeSample* src, int sw, int sh, FakeSample* d){
+ double best=1e9; for(int k=0;k<15;k++){ double t=now(); r.Transform(src,sw,sh,d); t=now()-t; if(t<best) best=t; } return best; }
+int main(){
+ int sizes[][4]={{640,480,1280,960},{1920,1080,3840,2160},{640,480,640,960}};
+ GUID* subs[]={&MEDIASUBTYPE_RGB32,&MEDIASUBTYPE_RGB24,&MEDIASUBTYPE_RGB565,&MEDIASUBTYPE_YUY2};
+ const char* sn[]={"RGB32","RGB24","RGB565","YUY2"};
+ for(int si=0;si<3;si++) for(int f=0;f<4;f++){
+  int sw=sizes[si][0],sh=sizes[si][1],dw=sizes[si][2],dh=sizes[si][3];
+  HRESULT hr; CVideoResizeBase r(dw,dh,&hr); r.SetMediaSubType(subs[f]); r.SetAlgorithm(RESIZE_NEAREST); r.SetTiling(RESIZE_TILING_ROWS);
+  int ss=r.CalcStride(sw); FakeSample src(ss*sh); for(int i=0;i<ss*sh;i++) src.buf[i]=rand();
+  FakeSample d(r.GetSize());
+  r.Transform(&src,sw,sh,&d);
+  double copy=Best(r,&src,sw,sh,&d);
+  memset(r.m_pTable->m_pHRepeat,0,dh);
+  double gather=Best(r,&src,sw,sh,&d);
+  printf("%-6s %dx%d->%dx%d  gather %.2fms  copy %.2fms  %.2fx\n",sn[f],sw,sh,dw,dh,gather*1e3,copy*1e3,gather/copy);
+ }
+}
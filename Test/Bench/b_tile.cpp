@@ -0,0 +1,30 @@
+#include "streams.h"
+#define private public
+#include "VideoResizeBase.h"
+#undef private
+#include "sample.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+static double now(){ timespec t; clock_gettime(CLOCK_MONOTONIC,&t); return t.tv_sec+t.tv_nsec*1e-9; }
+int main(){
+ int sizes[][4]={{3840,2160,1920,1080},{3840,2160,7680,4320},{7680,4320,3840,2160},{7680,4320,1280,720}};
+ const char* mn[]={"AUTO","ROWS","TILES","STREAM"};
+ int als[]={1,4};
+ GUID* subs[]={&MEDIASUBTYPE_RGB32,&MEDIASUBTYPE_RGB24};
+ for(int ai=0;ai<2;ai++) for(int b=0;b<2;b++) for(int si=0;si<4;si++){
+  int sw=sizes[si][0],sh=sizes[si][1],dw=sizes[si][2],dh=sizes[si][3];
+  printf("al%d %s %dx%d->%dx%d", als[ai], b?"RGB24":"RGB32", sw,sh,dw,dh);
+  FakeSample* src=NULL;
+  for(int m=0;m<4;m++){
+   HRESULT hr; CVideoResizeBase r(dw,dh,&hr); r.SetMediaSubType(subs[b]); r.SetAlgorithm(als[ai]); r.SetTiling(m);
+   int ss=r.CalcStride(sw);
+   if(!src){ src=new FakeSample(ss*sh); for(int i=0;i<ss*sh;i++) src->buf[i]=rand(); }
+   FakeSample d(r.GetSize());
+   r.Transform(src,sw,sh,&d);
+   double best=1e9; for(int k=0;k<9;k++){ double t=now(); r.Transform(src,sw,sh,&d); t=now()-t; if(t<best) best=t; }
+   printf("  %s %.1fms%s", mn[m], best*1e3, m==0?(r.m_bTiled?(r.m_bStreamStores?"(s)":"(t)"):"(r)"):"");
+  }
+  printf("\n"); fflush(stdout); delete src;
+ }
+}
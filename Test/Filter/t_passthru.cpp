@@ -0,0 +1,63 @@
+#include "streams.h"
+#include "DSFiltersGuids.h"
+#define protected public
+#define private public
+#include "VideoResizer.h"
+#include "VideoResizeBase.h"
+#undef protected
+#undef private
+#include "sample.h"
+#include <stdio.h>
+// pass-through only with the size of the connected input, and with a shared
+// allocator or an output type of the same stride and height
+int fails=0;
+#define CHECK(c) do{ if(!(c)){ printf("FAIL %s:%d %s\n",__FILE__,__LINE__,#c); fails++; } }while(0)
+CMediaType MakeType(int w,int h){ CMediaType mt; mt.majortype=MEDIATYPE_Video; mt.subtype=MEDIASUBTYPE_RGB32; mt.formattype=FORMAT_VideoInfo;
+ VIDEOINFOHEADER* v=(VIDEOINFOHEADER*)mt.AllocFormatBuffer(sizeof(VIDEOINFOHEADER)); memset(v,0,sizeof(*v)); v->bmiHeader.biWidth=w; v->bmiHeader.biHeight=h; v->bmiHeader.biBitCount=32; v->bmiHeader.biPlanes=1; v->AvgTimePerFrame=UNITS/30; return mt; }
+struct Sink : OutSink { std::vector<IMediaSample*> got; HRESULT Deliver(OutSample* s){ got.push_back((IMediaSample*)s); return S_OK; } };
+// sample carrying a new media type
+struct TypedSample : FakeSample { CMediaType mt;
+ TypedSample(size_t n, const CMediaType& t):FakeSample(n),mt(t){}
+ HRESULT GetMediaType(AM_MEDIA_TYPE** pp){ *pp=new AM_MEDIA_TYPE; CopyMediaType(*pp,&mt); return S_OK; } };
+const int W=16, H=8;
+CVideoResizer* Make(Sink* sink, IMemAllocator* in, IMemAllocator* out){
+ HRESULT hr; CVideoResizer* f=(CVideoResizer*)CVideoResizer::CreateInstance(0,&hr); CHECK(hr==S_OK);
+ CHECK(f->SetOutputSize(W,H)==S_OK); f->GetPin(0);
+ CHECK(f->m_pInput->MockConnectType(MakeType(W,H))==S_OK); f->m_pInput->NotifyAllocator(in,FALSE);
+ CMediaType omt; CHECK(f->GetMediaType(0,&omt)==S_OK); CHECK(HEADER(omt.Format())->biHeight==H);  // same orientation first
+ CHECK(f->m_pOutput->MockConnectAlloc(omt,out)==S_OK); f->m_pOutput->m_pSink=sink;
+ return f;
+}
+int main(){
+ IMemAllocator a1, a2;
+ // candidate types don't change the size or the format
+ { Sink sink; CVideoResizer* f=Make(&sink,&a1,&a2);
+  CMediaType big=MakeType(W*2,H*2); CHECK(f->CheckInputType(&big)==S_OK);
+  CHECK(f->m_nSrcWidth==W && f->m_nSrcHeight==H);
+  CMediaType rgb24=MakeType(W,H); rgb24.subtype=MEDIASUBTYPE_RGB24; HEADER(rgb24.Format())->biBitCount=24;
+  CHECK(f->CheckInputType(&rgb24)==S_OK); CHECK(*f->m_pResizer->GetMediaSubType()==MEDIASUBTYPE_RGB32);  // nor the format
+  CHECK(f->Pause()==S_OK); CHECK(!f->m_bSharedAllocator);
+  FakeSample s(W*4*H); s.actual=W*4*H;
+  CHECK(f->m_pInput->Receive(&s)==S_OK); CHECK(sink.got.size()==1 && sink.got[0]==&s);
+  // an output type with another stride gets the resized copy
+  HEADER(f->m_pOutput->CurrentMediaType().Format())->biWidth=W+8;
+  CHECK(!f->IsPassThrough());
+  CHECK(f->m_pInput->Receive(&s)==S_OK); CHECK(sink.got.size()==2 && sink.got[1]!=&s);
+  HEADER(f->m_pOutput->CurrentMediaType().Format())->biWidth=W;
+  // a sample with a new type changes the size
+  TypedSample t(W*4*H*4,big); t.actual=W*4*H*4;
+  CHECK(f->m_pInput->Receive(&t)==S_OK); CHECK(sink.got.size()==3 && sink.got[2]!=&t);
+  CHECK(f->m_nSrcWidth==W*2 && f->m_nSrcHeight==H*2); CHECK(!f->IsPassThrough());
+  CHECK(f->Stop()==S_OK); delete f; }
+ // a shared allocator passes the sample whatever the output type says
+ { Sink sink; CVideoResizer* f=Make(&sink,&a1,&a1);
+  CHECK(f->Pause()==S_OK); CHECK(f->m_bSharedAllocator);
+  HEADER(f->m_pOutput->CurrentMediaType().Format())->biWidth=W+8;
+  FakeSample s(W*4*H); s.actual=W*4*H;
+  CHECK(f->m_pInput->Receive(&s)==S_OK); CHECK(sink.got.size()==1 && sink.got[0]==&s);
+  CHECK(f->Stop()==S_OK);
+  f->BreakConnect(PINDIR_OUTPUT); CHECK(f->m_pOutputAllocator==NULL);
+  f->m_State=State_Stopped; f->m_pOutput->MockDisconnect(); delete f; }
+ printf("fails %d\n",fails);
+ return fails!=0;
+}
@@ -0,0 +1,67 @@
+#include "streams.h"
+#include "DSFiltersGuids.h"
+#define protected public
+#define private public
+#include "VideoPyramid.h"
+#include "VideoResizeBase.h"
+#undef protected
+#undef private
+#include "sample.h"
+#include <stdio.h>
+// every connected level is delivered; a level that fails is skipped without
+// failing level 0, the other levels or the upstream Receive
+int fails=0;
+#define CHECK(c) do{ if(!(c)){ printf("FAIL %s:%d %s\n",__FILE__,__LINE__,#c); fails++; } }while(0)
+CMediaType MakeType(int w,int h){ CMediaType mt; mt.majortype=MEDIATYPE_Video; mt.subtype=MEDIASUBTYPE_RGB32; mt.formattype=FORMAT_VideoInfo;
+ VIDEOINFOHEADER* v=(VIDEOINFOHEADER*)mt.AllocFormatBuffer(sizeof(VIDEOINFOHEADER)); memset(v,0,sizeof(*v)); v->bmiHeader.biWidth=w; v->bmiHeader.biHeight=h; v->bmiHeader.biBitCount=32; v->bmiHeader.biPlanes=1; v->AvgTimePerFrame=UNITS/30; return mt; }
+// frames delivered to a level and the first pixel of the last one
+struct Sink : OutSink { int n; DWORD px; Sink():n(0),px(0){} HRESULT Deliver(OutSample* s){ n++; px=*(DWORD*)&s->buf[0]; return S_OK; } };
+const int W=64, H=32;
+const DWORD PX=0x00806040;
+int main(){
+ // the input and an output for each level are registered
+ CHECK(sudVideoPyramid.nPins==1+PYRAMID_LEVELS);
+ CHECK(!sudVideoPyramid.lpPin[0].bOutput);
+ for(int i=1;i<=PYRAMID_LEVELS;i++){ CHECK(sudVideoPyramid.lpPin[i].bOutput); CHECK(!sudVideoPyramid.lpPin[i].bMany); CHECK(sudVideoPyramid.lpPin[i].bZero==(i>1)); }
+
+ IMemAllocator a1, a2; Sink sink[PYRAMID_LEVELS];
+ HRESULT hr; CVideoPyramid* f=(CVideoPyramid*)CVideoPyramid::CreateInstance(0,&hr); CHECK(hr==S_OK);
+ for(int i=0;i<PYRAMID_LEVELS;i++) CHECK(f->SetLevelSize(i,W>>(i+1),H>>(i+1))==S_OK);
+ f->GetPin(0);
+ CHECK(f->m_pInput->MockConnectType(MakeType(W,H))==S_OK); f->m_pInput->NotifyAllocator(&a1,FALSE);
+ CMediaType omt; CHECK(f->GetMediaType(0,&omt)==S_OK);
+ CHECK(f->m_pOutput->MockConnectAlloc(omt,&a2)==S_OK); f->m_pOutput->m_pSink=&sink[0];
+ CVideoPyramidOutputPin* pins[PYRAMID_LEVELS]={0};
+ for(int i=1;i<PYRAMID_LEVELS;i++){
+  pins[i]=(CVideoPyramidOutputPin*)f->GetPin(i+1); CHECK(pins[i]!=0);
+  CMediaType mt; CHECK(pins[i]->GetMediaType(0,&mt)==S_OK); CHECK(HEADER(mt.Format())->biWidth==W>>(i+1));
+  CHECK(pins[i]->MockConnectAlloc(mt)==S_OK); CHECK(pins[i]->m_cbOut==(size_t)((W>>(i+1))*4*(H>>(i+1)))); pins[i]->m_pSink=&sink[i];
+ }
+ CHECK(f->Pause()==S_OK);
+ FakeSample s(W*4*H); s.actual=W*4*H; for(int k=0;k<W*H;k++) ((DWORD*)&s.buf[0])[k]=PX;
+ // all the levels
+ CHECK(f->m_pInput->Receive(&s)==S_OK);
+ for(int i=0;i<PYRAMID_LEVELS;i++){ CHECK(sink[i].n==1); CHECK(sink[i].px==PX); }
+ // level 1 without a buffer: level 2 is scaled from level 0 or the input
+ pins[1]->m_hrBuffer=E_OUTOFMEMORY; sink[2].px=0;
+ CHECK(f->m_pInput->Receive(&s)==S_OK);
+ CHECK(sink[0].n==2); CHECK(sink[1].n==1); CHECK(sink[2].n==2 && sink[2].px==PX);
+ // level 1 failing to transform
+ pins[1]->m_hrBuffer=S_OK; pins[1]->m_hrPointer=E_FAIL; sink[2].px=0;
+ CHECK(f->m_pInput->Receive(&s)==S_OK);
+ CHECK(sink[0].n==3); CHECK(sink[1].n==1); CHECK(sink[2].n==3 && sink[2].px==PX);
+ // the last level failing
+ pins[1]->m_hrPointer=S_OK; pins[2]->m_hrBuffer=E_OUTOFMEMORY;
+ CHECK(f->m_pInput->Receive(&s)==S_OK);
+ CHECK(sink[0].n==4); CHECK(sink[1].n==2); CHECK(sink[2].n==3);
+ // and recovering
+ pins[2]->m_hrBuffer=S_OK;
+ CHECK(f->m_pInput->Receive(&s)==S_OK);
+ for(int i=0;i<PYRAMID_LEVELS;i++) CHECK(sink[i].px==PX);
+ CHECK(sink[0].n==5); CHECK(sink[1].n==3); CHECK(sink[2].n==4);
+ CHECK(f->Stop()==S_OK);
+ for(int i=1;i<PYRAMID_LEVELS;i++) CHECK(pins[i]->m_nInactive==1);
+ delete f;
+ printf("fails %d\n",fails);
+ return fails!=0;
+}
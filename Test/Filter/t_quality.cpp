@@ -0,0 +1,96 @@
+#include "streams.h"
+#include "DSFiltersGuids.h"
+#define protected public
+#define private public
+#include "VideoResizer.h"
+#include "VideoResizeBase.h"
+#undef protected
+#undef private
+#include "sample.h"
+#include <stdio.h>
+// the quality levels lowered by the late messages of either type and raised
+// by the on-time ones, the levels of the same processing skipped, and the
+// frames dropped on the lowest level
+int fails=0;
+#define CHECK(c) do{ if(!(c)){ printf("FAIL %s:%d %s\n",__FILE__,__LINE__,#c); fails++; } }while(0)
+CMediaType MakeType(int w,int h){ CMediaType mt; mt.majortype=MEDIATYPE_Video; mt.subtype=MEDIASUBTYPE_RGB32; mt.formattype=FORMAT_VideoInfo;
+ VIDEOINFOHEADER* v=(VIDEOINFOHEADER*)mt.AllocFormatBuffer(sizeof(VIDEOINFOHEADER)); memset(v,0,sizeof(*v)); v->bmiHeader.biWidth=w; v->bmiHeader.biHeight=h; v->bmiHeader.biBitCount=32; v->bmiHeader.biPlanes=1; v->AvgTimePerFrame=UNITS/30; return mt; }
+struct Sink : OutSink { int n; Sink():n(0){} HRESULT Deliver(OutSample*){ n++; return S_OK; } };
+const int W=16, H=8;
+// of VideoResizer.cpp
+enum { QUALITY_FULL, QUALITY_BILINEAR, QUALITY_NEAREST, QUALITY_DROP };
+const int QUALITY_LATE_COUNT=4, QUALITY_ONTIME_COUNT=60;
+CVideoResizer* Make(Sink* sink, IMemAllocator* in, IMemAllocator* out, int al){
+ HRESULT hr; CVideoResizer* f=(CVideoResizer*)CVideoResizer::CreateInstance(0,&hr); CHECK(hr==S_OK);
+ CHECK(f->SetOutputSize(W,H)==S_OK); CHECK(f->SetAlgorithm(al)==S_OK); f->GetPin(0);
+ CHECK(f->m_pInput->MockConnectType(MakeType(W*4,H*4))==S_OK); f->m_pInput->NotifyAllocator(in,FALSE);
+ CMediaType omt; CHECK(f->GetMediaType(0,&omt)==S_OK);
+ CHECK(f->m_pOutput->MockConnectAlloc(omt,out)==S_OK); f->m_pOutput->m_pSink=sink;
+ return f;
+}
+Quality Q(QualityMessageType t, REFERENCE_TIME late){ Quality q; q.Type=t; q.Proportion=1000; q.Late=late; q.TimeStamp=0; return q; }
+const REFERENCE_TIME LATE=400000, ONTIME=0, BETWEEN=100000;
+// late messages until the level changes, S_OK for each
+int Lower(CVideoResizer* f, QualityMessageType t){ int l=f->m_nQualityLevel, n=0;
+ while(f->m_nQualityLevel==l && n<100){ CHECK(f->AlterQuality(Q(t,LATE))==S_OK); n++; } return n; }
+int Raise(CVideoResizer* f){ int l=f->m_nQualityLevel, n=0;
+ while(f->m_nQualityLevel==l && n<1000){ CHECK(f->AlterQuality(Q(Flood,ONTIME))==S_OK); n++; } return n; }
+int main(){
+ IMemAllocator a1, a2;
+ // lanczos: each level in turn, by Flood and Famine alike
+ { Sink sink; CVideoResizer* f=Make(&sink,&a1,&a2,RESIZE_LANCZOS3);
+  CHECK(f->Pause()==S_OK); CHECK(f->m_nQualityLevel==QUALITY_FULL);
+  // the messages in between reset the count
+  for(int i=0;i<QUALITY_LATE_COUNT-1;i++) CHECK(f->AlterQuality(Q(Flood,LATE))==S_OK);
+  CHECK(f->AlterQuality(Q(Flood,BETWEEN))==S_OK); CHECK(f->m_nQualityLevel==QUALITY_FULL);
+  CHECK(Lower(f,Famine)==QUALITY_LATE_COUNT); CHECK(f->m_nQualityLevel==QUALITY_BILINEAR);
+  CHECK(Lower(f,Flood)==QUALITY_LATE_COUNT); CHECK(f->m_nQualityLevel==QUALITY_NEAREST);
+  CHECK(Lower(f,Famine)==QUALITY_LATE_COUNT); CHECK(f->m_nQualityLevel==QUALITY_DROP);
+  // passed upstream only on the lowest level
+  CHECK(f->AlterQuality(Q(Famine,LATE))==S_FALSE); CHECK(f->AlterQuality(Q(Flood,LATE))==S_FALSE);
+  CHECK(f->m_nQualityLevel==QUALITY_DROP);
+  // every other frame is dropped
+  FakeSample s(W*4*4*H*4); s.actual=(long)s.buf.size();
+  for(int i=0;i<6;i++) CHECK(f->m_pInput->Receive(&s)==S_OK);
+  CHECK(sink.n==3); CHECK(f->m_bQualityChanged);
+  // a late message breaks the on-time run
+  for(int i=0;i<QUALITY_ONTIME_COUNT-1;i++) CHECK(f->AlterQuality(Q(Flood,ONTIME))==S_OK);
+  CHECK(f->AlterQuality(Q(Flood,LATE))==S_FALSE); CHECK(f->m_nQualityLevel==QUALITY_DROP);
+  CHECK(Raise(f)==QUALITY_ONTIME_COUNT); CHECK(f->m_nQualityLevel==QUALITY_NEAREST);
+  CHECK(f->m_pInput->Receive(&s)==S_OK); CHECK(sink.n==4);
+  CHECK(f->m_pResizer->m_nScaleMode==RESIZE_NEAREST && !f->m_pResizer->m_bAreaAverage);
+  CHECK(Raise(f)==QUALITY_ONTIME_COUNT); CHECK(f->m_nQualityLevel==QUALITY_BILINEAR);
+  CHECK(f->m_pInput->Receive(&s)==S_OK); CHECK(f->m_pResizer->m_bAreaAverage);
+  CHECK(Raise(f)==QUALITY_ONTIME_COUNT); CHECK(f->m_nQualityLevel==QUALITY_FULL);
+  CHECK(f->m_pInput->Receive(&s)==S_OK); CHECK(f->m_pResizer->m_nScaleMode==RESIZE_LANCZOS3);
+  // no further on the full level
+  for(int i=0;i<QUALITY_ONTIME_COUNT*2;i++) CHECK(f->AlterQuality(Q(Flood,ONTIME))==S_OK);
+  CHECK(f->m_nQualityLevel==QUALITY_FULL);
+  // restarting resets the level
+  Lower(f,Flood); CHECK(f->m_nQualityLevel==QUALITY_BILINEAR);
+  CHECK(f->Stop()==S_OK); CHECK(f->Pause()==S_OK); CHECK(f->m_nQualityLevel==QUALITY_FULL);
+  CHECK(f->Stop()==S_OK); delete f; }
+ // nearest: the area averaged levels are the same, the first step turns
+ // the area average off
+ { Sink sink; CVideoResizer* f=Make(&sink,&a1,&a2,RESIZE_NEAREST);
+  CHECK(f->Pause()==S_OK);
+  FakeSample s(W*4*4*H*4); s.actual=(long)s.buf.size();
+  CHECK(f->m_pInput->Receive(&s)==S_OK); CHECK(f->m_pResizer->m_bAreaAverage);
+  CHECK(Lower(f,Flood)==QUALITY_LATE_COUNT); CHECK(f->m_nQualityLevel==QUALITY_NEAREST);
+  CHECK(f->m_pInput->Receive(&s)==S_OK); CHECK(!f->m_pResizer->m_bAreaAverage);
+  CHECK(f->m_pResizer->m_nScaleMode==RESIZE_NEAREST);
+  CHECK(Lower(f,Flood)==QUALITY_LATE_COUNT); CHECK(f->m_nQualityLevel==QUALITY_DROP);
+  CHECK(Raise(f)==QUALITY_ONTIME_COUNT); CHECK(f->m_nQualityLevel==QUALITY_NEAREST);
+  CHECK(Raise(f)==QUALITY_ONTIME_COUNT); CHECK(f->m_nQualityLevel==QUALITY_FULL);
+  CHECK(f->m_pInput->Receive(&s)==S_OK); CHECK(f->m_pResizer->m_bAreaAverage);
+  CHECK(sink.n==3);
+  CHECK(f->Stop()==S_OK); delete f; }
+ // bilinear: the full and the bilinear levels are the same
+ { Sink sink; CVideoResizer* f=Make(&sink,&a1,&a2,RESIZE_BILINEAR);
+  CHECK(f->Pause()==S_OK);
+  CHECK(Lower(f,Famine)==QUALITY_LATE_COUNT); CHECK(f->m_nQualityLevel==QUALITY_NEAREST);
+  CHECK(Raise(f)==QUALITY_ONTIME_COUNT); CHECK(f->m_nQualityLevel==QUALITY_FULL);
+  CHECK(f->Stop()==S_OK); delete f; }
+ printf("fails %d\n",fails);
+ return fails!=0;
+}
@@ -0,0 +1,5 @@
+#pragma once
+class CDbgWnd;
+#define DECLARE_DBGWND
+#define DBGWND_CREATE
+#define DBGWND_DESTROY
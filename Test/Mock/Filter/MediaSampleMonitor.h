@@ -0,0 +1,2 @@
+#pragma once
+// shadows the monitor filter, which isn't built with the tests
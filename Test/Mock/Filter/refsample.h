@@ -0,0 +1,11 @@
+#pragma once
+// IMediaSample with a reference count, as an upstream allocator's sample
+struct RefSample : IMediaSample {
+ std::vector<BYTE> buf; long actual; volatile LONG ref;
+ RefSample(size_t n):buf(n),actual((long)n),ref(1),timed(false),t0(0){}
+ ULONG AddRef(){ return InterlockedIncrement(&ref); } ULONG Release(){ return InterlockedDecrement(&ref); }
+ HRESULT GetPointer(BYTE** pp){*pp=&buf[0];return S_OK;} long GetSize(){return (long)buf.size();}
+ long GetActualDataLength(){return actual;} HRESULT SetActualDataLength(long n){actual=n;return S_OK;}
+ bool timed; REFERENCE_TIME t0; void SetT(REFERENCE_TIME t){ timed=true; t0=t; }
+ HRESULT GetTime(REFERENCE_TIME* a, REFERENCE_TIME* b){ if(!timed) return (HRESULT)0x80040249; *a=t0; *b=t0+1; return S_OK; }
+};
@@ -0,0 +1,238 @@
+#pragma once
+// minimal DirectShow base class mock for the mux and resizer filters
+#include "../streams.h"
+#include <wchar.h>
+#include <stdio.h>
+#include <stdarg.h>
+typedef wchar_t WCHAR; typedef const wchar_t* LPCWSTR; typedef wchar_t* LPWSTR; typedef const char* LPCSTR;
+typedef long long LONGLONG_;
+#define HEADER(p) (&(((VIDEOINFOHEADER*)(p))->bmiHeader))
+#define VFW_E_NOT_FOUND ((HRESULT)0x80040216)
+#define VFW_E_TYPE_NOT_ACCEPTED ((HRESULT)0x8004022A)
+#define VFW_E_INVALIDMEDIATYPE ((HRESULT)0x80040200)
+#define VFW_E_NOT_STOPPED ((HRESULT)0x80040224)
+#define VFW_E_ALREADY_CONNECTED ((HRESULT)0x80040204)
+#define VFW_S_NO_MORE_ITEMS ((HRESULT)0x00040103)
+#define VFW_E_NOT_CONNECTED ((HRESULT)0x80040209)
+#define VFW_E_NO_ALLOCATOR ((HRESULT)0x8004020A)
+#define VFW_S_NO_STOP_TIME ((HRESULT)0x00040270)
+#define MERIT_DO_NOT_USE 0x200000
+#define NUMELMS(a) (sizeof(a)/sizeof((a)[0]))
+#define ValidateReadWritePtr(p,n)
+#define DECLARE_IUNKNOWN ULONG AddRef(){return 1;} ULONG Release(){return 1;}
+#define lstrcmpW wcscmp
+#define _wtoi(s) ((int)wcstol(s,0,10))
+#define DBGWND_RGB(r,g,b)
+#define DBGWND_TEXT(x,y,t)
+#define DBGWND_RESET_RGB
+#define DBGWND (*(CDbgWnd*)0)
+#define DbgSetModuleLevel(t,l)
+#define EC_COMPLETE 0x01
+#define EC_ERRORABORT 0x03
+#define EC_QUALITY_CHANGE 0x0B
+enum QualityMessageType { Famine, Flood };
+struct Quality { QualityMessageType Type; long Proportion; REFERENCE_TIME Late, TimeStamp; };
+inline HRESULT StringCchPrintfW(WCHAR* d, size_t n, const WCHAR* f, ...){ va_list a; va_start(a,f); vswprintf(d,n,f,a); va_end(a); return S_OK; }
+struct SIZE { LONG cx, cy; };
+struct RGBQUAD { BYTE rgbBlue, rgbGreen, rgbRed, rgbReserved; };
+struct BITMAPINFOHEADER { DWORD biSize; LONG biWidth, biHeight; WORD biPlanes, biBitCount; DWORD biCompression, biSizeImage; LONG biXPelsPerMeter, biYPelsPerMeter; DWORD biClrUsed, biClrImportant; };
+struct VIDEOINFOHEADER { RECT rcSource, rcTarget; DWORD dwBitRate, dwBitErrorRate; REFERENCE_TIME AvgTimePerFrame; BITMAPINFOHEADER bmiHeader; };
+#define PALETTE_ENTRIES(pv) (256)
+extern GUID MEDIATYPE_Video, FORMAT_VideoInfo, MEDIASUBTYPE_NULL;
+struct AM_MEDIA_TYPE { GUID majortype, subtype; BOOL bFixedSizeSamples, bTemporalCompression; ULONG lSampleSize; GUID formattype; IUnknown* pUnk; ULONG cbFormat; BYTE* pbFormat; };
+class CMediaType : public AM_MEDIA_TYPE { public:
+ CMediaType(){ memset((AM_MEDIA_TYPE*)this,0,sizeof(AM_MEDIA_TYPE)); }
+ CMediaType(const CMediaType& o){ *(AM_MEDIA_TYPE*)this=o; if(o.cbFormat){ pbFormat=new BYTE[o.cbFormat]; memcpy(pbFormat,o.pbFormat,o.cbFormat);} }
+ CMediaType& operator=(const CMediaType& o){ if(this!=&o){ delete[] pbFormat; *(AM_MEDIA_TYPE*)this=o; if(o.cbFormat){ pbFormat=new BYTE[o.cbFormat]; memcpy(pbFormat,o.pbFormat,o.cbFormat);} } return *this; }
+ ~CMediaType(){ delete[] pbFormat; }
+ const GUID* Subtype() const { return &subtype; } BYTE* Format() const { return pbFormat; } ULONG FormatLength() const { return cbFormat; }
+ void SetType(const GUID* g){ majortype=*g; } void SetSubtype(const GUID* g){ subtype=*g; } void SetFormatType(const GUID* g){ formattype=*g; }
+ void SetSampleSize(ULONG n){ lSampleSize=n; } void SetTemporalCompression(BOOL b){ bTemporalCompression=b; }
+ BYTE* AllocFormatBuffer(ULONG n){ delete[] pbFormat; pbFormat=new BYTE[n]; cbFormat=n; return pbFormat; }
+};
+inline void FreeMediaType(AM_MEDIA_TYPE& mt){ delete[] mt.pbFormat; mt.pbFormat=0; mt.cbFormat=0; }
+inline void CopyMediaType(AM_MEDIA_TYPE* d, const AM_MEDIA_TYPE* s){ *d=*s; if(s->cbFormat){ d->pbFormat=new BYTE[s->cbFormat]; memcpy(d->pbFormat,s->pbFormat,s->cbFormat); } }
+inline void DeleteMediaType(AM_MEDIA_TYPE* p){ if(p){ FreeMediaType(*p); delete p; } }
+struct ALLOCATOR_PROPERTIES { long cBuffers, cbBuffer, cbAlign, cbPrefix; };
+struct IMemAllocator { ALLOCATOR_PROPERTIES m_props; IMemAllocator(){ memset(&m_props,0,sizeof(m_props)); } virtual ~IMemAllocator(){}
+ ULONG AddRef(){ return 1; } ULONG Release(){ return 1; } virtual HRESULT SetProperties(ALLOCATOR_PROPERTIES* p, ALLOCATOR_PROPERTIES* a){ *a=*p; m_props=*p; return S_OK; } virtual HRESULT GetProperties(ALLOCATOR_PROPERTIES* p){ *p=m_props; return S_OK; } };
+struct IPin : IUnknown {};
+enum FILTER_STATE { State_Stopped, State_Paused, State_Running };
+enum PIN_DIRECTION { PINDIR_INPUT, PINDIR_OUTPUT };
+struct AMOVIESETUP_MEDIATYPE { const GUID* clsMajorType; const GUID* clsMinorType; };
+struct AMOVIESETUP_PIN { LPCWSTR strName; BOOL bRendered, bOutput, bZero, bMany; const GUID* clsConnectsToFilter; LPCWSTR strConnectsToPin; UINT nTypes; const AMOVIESETUP_MEDIATYPE* lpTypes; };
+struct AMOVIESETUP_FILTER { const GUID* clsID; LPCWSTR strName; DWORD dwMerit; UINT nPins; const AMOVIESETUP_PIN* lpPin; };
+inline HRESULT GetInterface(IUnknown* p, void** ppv){ *ppv=p; return S_OK; }
+class CTransformFilter;
+class CBasePin : public IPin { public:
+ WCHAR* m_pName; BOOL m_bConnected; CMediaType m_mt; CTransformFilter* m_pFilter; long m_nInactive; CCritSec m_csPin; CCritSec* m_pLock;
+ CBasePin(CTransformFilter* f, LPCWSTR n):m_bConnected(FALSE),m_pFilter(f),m_nInactive(0),m_pLock(&m_csPin){ m_pName=new WCHAR[wcslen(n)+1]; wcscpy(m_pName,n); }
+ virtual ~CBasePin(){ delete[] m_pName; }
+ ULONG AddRef(){return 1;} ULONG Release(){return 1;}
+ LPWSTR Name(){ return m_pName; } BOOL IsConnected(){ return m_bConnected; }
+ CMediaType& CurrentMediaType(){ return m_mt; }
+ HRESULT ConnectionMediaType(AM_MEDIA_TYPE* p){ if(!m_bConnected) return VFW_E_NOT_CONNECTED; CopyMediaType(p,&m_mt); return S_OK; }
+ virtual HRESULT Inactive(){ m_nInactive++; return S_OK; }
+ virtual HRESULT Active(){ return S_OK; }
+ virtual HRESULT CompleteConnect(IPin*){ return S_OK; }
+ virtual HRESULT CheckMediaType(const CMediaType*){ return S_OK; }
+ virtual HRESULT SetMediaType(const CMediaType* p){ m_mt=*p; return S_OK; }
+ virtual HRESULT GetMediaType(int, CMediaType*){ return VFW_S_NO_MORE_ITEMS; }
+ // test helper: connect with a media type
+ HRESULT MockConnect(const CMediaType& mt){ m_mt=mt; m_bConnected=TRUE; HRESULT hr=CompleteConnect(0); if(FAILED(hr)) m_bConnected=FALSE; return hr; }
+ // test helper: check and set the type like AttemptConnection, then connect
+ HRESULT MockConnectType(const CMediaType& mt){ HRESULT hr=CheckMediaType(&mt); if(hr!=S_OK) return FAILED(hr)? hr: VFW_E_TYPE_NOT_ACCEPTED; hr=SetMediaType(&mt); if(FAILED(hr)) return hr; return MockConnect(mt); }
+ void MockDisconnect(){ m_bConnected=FALSE; }
+};
+class CBaseInputPin : public CBasePin { public:
+ CBaseInputPin(CTransformFilter* f, LPCWSTR n):CBasePin(f,n),m_pAllocator(0){}
+ IMemAllocator* m_pAllocator;
+ virtual HRESULT Receive(IMediaSample*){ return S_OK; }
+ virtual HRESULT BeginFlush(){ return S_OK; } virtual HRESULT EndFlush(){ return S_OK; }
+ HRESULT CheckStreaming(){ return S_OK; }
+ HRESULT GetAllocator(IMemAllocator** pp){ if(!m_pAllocator) return VFW_E_NO_ALLOCATOR; *pp=m_pAllocator; m_pAllocator->AddRef(); return S_OK; }
+ virtual HRESULT NotifyAllocator(IMemAllocator* p, BOOL){ m_pAllocator=p; return S_OK; }
+ virtual HRESULT GetAllocatorRequirements(ALLOCATOR_PROPERTIES*){ return E_NOTIMPL; }
+};
+class CTransformInputPin : public CBaseInputPin { public:
+ CTransformInputPin(const char*, CTransformFilter* f, HRESULT*, LPCWSTR n):CBaseInputPin(f,n){}
+ HRESULT CompleteConnect(IPin* p);
+ HRESULT CheckMediaType(const CMediaType* p);
+ HRESULT SetMediaType(const CMediaType* p);
+ HRESULT Receive(IMediaSample* p);
+ HRESULT BeginFlush(); HRESULT EndFlush();
+};
+#include <time.h>
+inline long long shim_now_ns(){ timespec t; clock_gettime(CLOCK_MONOTONIC,&t); return t.tv_sec*1000000000LL+t.tv_nsec; }
+inline DWORD GetTickCount(){ extern long long g_tickOffsetMs; return (DWORD)(shim_now_ns()/1000000+g_tickOffsetMs); }
+inline void Sleep(DWORD ms){ usleep(ms*1000); }
+inline DWORD WaitForMultipleObjects(DWORD n, const HANDLE* h, BOOL, DWORD ms){
+ long long end=shim_now_ns()+(long long)ms*1000000;
+ for(;;){ for(DWORD i=0;i<n;i++){ ShimEvent* e=(ShimEvent*)h[i]; pthread_mutex_lock(&e->m); bool s=e->sig; if(s&&!e->manual) e->sig=false; pthread_mutex_unlock(&e->m); if(s) return i; }
+  if(ms!=INFINITE && shim_now_ns()>=end) return WAIT_TIMEOUT; usleep(100); } }
+typedef DWORD_PTR HEVENT;
+#define VFW_E_NO_CLOCK ((HRESULT)0x80040213)
+#define LOG_TRACE 0
+// reference clock on the monotonic time; advises are polled by a thread
+struct IReferenceClock : IUnknown {
+ struct Adv { REFERENCE_TIME t; HANDLE h; DWORD_PTR id; };
+ CCritSec cs; std::vector<Adv> advs; DWORD_PTR next; volatile LONG ref; volatile bool quit; pthread_t th; volatile LONG nAdvise, nUnadvise;
+ IReferenceClock():next(1),ref(1),quit(false),nAdvise(0),nUnadvise(0){ pthread_create(&th,0,Main,this); }
+ ~IReferenceClock(){ quit=true; pthread_join(th,0); }
+ ULONG AddRef(){ return InterlockedIncrement(&ref); } ULONG Release(){ return InterlockedDecrement(&ref); }
+ HRESULT GetTime(REFERENCE_TIME* p){ *p=shim_now_ns()/100; return S_OK; }
+ HRESULT AdviseTime(REFERENCE_TIME base, REFERENCE_TIME off, HEVENT h, DWORD_PTR* pc){ CAutoLock l(&cs); Adv a={base+off,(HANDLE)h,next++}; advs.push_back(a); *pc=a.id; InterlockedIncrement(&nAdvise); return S_OK; }
+ HRESULT Unadvise(DWORD_PTR c){ CAutoLock l(&cs); InterlockedIncrement(&nUnadvise); for(size_t i=0;i<advs.size();i++) if(advs[i].id==c){ advs.erase(advs.begin()+i); return S_OK; } return S_FALSE; }
+ static void* Main(void* p){ IReferenceClock* c=(IReferenceClock*)p; while(!c->quit){ { CAutoLock l(&c->cs); REFERENCE_TIME t; c->GetTime(&t);
+  for(size_t i=0;i<c->advs.size();){ if(c->advs[i].t<=t){ SetEvent(c->advs[i].h); c->advs.erase(c->advs.begin()+i); } else i++; } } usleep(200); } return 0; }
+};
+// worker thread with the request handshake of the base classes
+class CAMThread { pthread_t m_t; bool m_bThread; HANDLE m_evReq, m_evReply; DWORD m_dwParam; DWORD m_dwReturn;
+ static void* Init(void* p){ ((CAMThread*)p)->ThreadProc(); return 0; }
+public: CCritSec m_AccessLock;
+ CAMThread():m_bThread(false),m_dwParam(0),m_dwReturn(0){ m_evReq=CreateEvent(0,TRUE,FALSE,0); m_evReply=CreateEvent(0,FALSE,FALSE,0); }
+ virtual ~CAMThread(){ Close(); CloseHandle(m_evReq); CloseHandle(m_evReply); }
+ virtual DWORD ThreadProc()=0;
+ BOOL Create(){ CAutoLock l(&m_AccessLock); if(m_bThread) return FALSE; m_bThread=true; pthread_create(&m_t,0,Init,this); return TRUE; }
+ DWORD CallWorker(DWORD d){ CAutoLock l(&m_AccessLock); if(!m_bThread) return (DWORD)E_FAIL; m_dwParam=d; SetEvent(m_evReq); WaitForSingleObject(m_evReply,INFINITE); return m_dwReturn; }
+ DWORD GetRequest(){ WaitForSingleObject(m_evReq,INFINITE); return m_dwParam; }
+ BOOL CheckRequest(DWORD* p){ ShimEvent* e=(ShimEvent*)m_evReq; pthread_mutex_lock(&e->m); bool s=e->sig; pthread_mutex_unlock(&e->m); if(!s) return FALSE; if(p) *p=m_dwParam; return TRUE; }
+ void Reply(DWORD d){ m_dwReturn=d; ResetEvent(m_evReq); SetEvent(m_evReply); }
+ BOOL ThreadExists(){ return m_bThread; }
+ void Close(){ if(m_bThread){ pthread_join(m_t,0); m_bThread=false; } }
+};
+// output pin delivering to a test sink; the allocator decommits on Inactive
+struct OutSample : IMediaSample {
+ std::vector<BYTE> buf; volatile LONG ref; bool timed; REFERENCE_TIME t0,t1; BOOL sync, disc; HRESULT hrPointer;
+ OutSample(size_t n):buf(n),ref(1),timed(false),t0(0),t1(0),sync(0),disc(0),hrPointer(S_OK){}
+ ULONG AddRef(){ return InterlockedIncrement(&ref); } ULONG Release(){ LONG r=InterlockedDecrement(&ref); if(!r) delete this; return r; }
+ HRESULT GetPointer(BYTE** pp){ if(FAILED(hrPointer)) return hrPointer; *pp=&buf[0];return S_OK;} long GetSize(){return (long)buf.size();}
+ long GetActualDataLength(){return (long)buf.size();} HRESULT SetActualDataLength(long){return S_OK;}
+ HRESULT SetTime(REFERENCE_TIME* a, REFERENCE_TIME* b){ timed=a!=0; if(a){t0=*a;t1=*b;} return S_OK; }
+ HRESULT SetSyncPoint(BOOL b){ sync=b; return S_OK; } HRESULT SetDiscontinuity(BOOL b){ disc=b; return S_OK; }
+};
+struct OutSink { virtual HRESULT Deliver(OutSample*)=0; virtual HRESULT EndOfStream(){ return S_OK; } virtual ~OutSink(){} };
+// m_hrBuffer fails GetDeliveryBuffer, m_hrPointer fails GetPointer of the samples
+class CBaseOutputPin : public CBasePin { public:
+ volatile bool m_bCommitted; OutSink* m_pSink; size_t m_cbOut; IMemAllocator m_alloc; HRESULT m_hrBuffer, m_hrPointer;
+ CBaseOutputPin(CTransformFilter* f, LPCWSTR n):CBasePin(f,n),m_bCommitted(false),m_pSink(0),m_cbOut(0),m_hrBuffer(S_OK),m_hrPointer(S_OK){}
+ virtual HRESULT DecideBufferSize(IMemAllocator*, ALLOCATOR_PROPERTIES*){ return S_OK; }
+ // test helper: connect and size the allocator like DecideAllocator, pAlloc shares one
+ HRESULT MockConnectAlloc(const CMediaType& mt, IMemAllocator* pAlloc=0){ HRESULT hr=MockConnectType(mt); if(FAILED(hr)) return hr;
+  if(!pAlloc) pAlloc=&m_alloc; ALLOCATOR_PROPERTIES p={0,0,0,0}; hr=DecideBufferSize(pAlloc,&p); if(SUCCEEDED(hr)) m_cbOut=pAlloc->m_props.cbBuffer; return hr; }
+ virtual HRESULT Active(){ m_bCommitted=true; return S_OK; }
+ virtual HRESULT Inactive(){ m_nInactive++; m_bCommitted=false; return S_OK; }
+ HRESULT GetDeliveryBuffer(IMediaSample** pp, REFERENCE_TIME*, REFERENCE_TIME*, DWORD){ if(!m_bCommitted) return VFW_E_WRONG_STATE; if(FAILED(m_hrBuffer)) return m_hrBuffer;
+  OutSample* s=new OutSample(m_cbOut); s->hrPointer=m_hrPointer; *pp=s; return S_OK; }
+ HRESULT Deliver(IMediaSample* p){ return m_pSink? m_pSink->Deliver((OutSample*)p): S_OK; }
+ HRESULT DeliverEndOfStream(){ return m_pSink? m_pSink->EndOfStream(): S_OK; }
+ HRESULT DeliverBeginFlush(){ return S_OK; } HRESULT DeliverEndFlush(){ return S_OK; }
+ HRESULT DeliverNewSegment(REFERENCE_TIME, REFERENCE_TIME, double){ return S_OK; }
+};
+class CTransformOutputPin : public CBaseOutputPin { public:
+ CTransformOutputPin(const char*, CTransformFilter* f, HRESULT*, LPCWSTR n):CBaseOutputPin(f,n){}
+ HRESULT DecideBufferSize(IMemAllocator* a, ALLOCATOR_PROPERTIES* p);
+ HRESULT CheckMediaType(const CMediaType* p);
+ HRESULT SetMediaType(const CMediaType* p);
+ HRESULT GetMediaType(int i, CMediaType* p);
+ HRESULT CompleteConnect(IPin* p);
+ virtual HRESULT Run(REFERENCE_TIME){ return S_OK; }
+};
+class CTransformFilter : public CUnknown { public:
+ CTransformInputPin* m_pInput; CTransformOutputPin* m_pOutput; CCritSec m_csFilter, m_csReceive;
+ FILTER_STATE m_State; BOOL m_bEOSDelivered; REFERENCE_TIME m_tStart; int m_nPinVersion; IReferenceClock* m_pClock; int m_nEOS;
+ CTransformFilter(const char* n, LPUNKNOWN u, REFCLSID):CUnknown(n,u),m_pInput(0),m_pOutput(0),m_State(State_Stopped),m_bEOSDelivered(FALSE),m_tStart(0),m_nPinVersion(0),m_pClock(0),m_nEOS(0),m_bSampleSkipped(FALSE),m_bQualityChanged(FALSE),m_nEvents(0),m_lastEvent(0),m_nReconnect(0){}
+ virtual ~CTransformFilter(){ delete m_pInput; delete m_pOutput; }
+ virtual int GetPinCount(){ return 2; } virtual CBasePin* GetPin(int n);
+ BOOL m_bSampleSkipped, m_bQualityChanged; long m_nEvents, m_lastEvent, m_nReconnect;
+ // the transform path of the base class
+ virtual HRESULT Receive(IMediaSample* p){ IMediaSample* o; HRESULT hr=m_pOutput->GetDeliveryBuffer(&o,0,0,0); if(FAILED(hr)) return hr;
+  hr=Transform(p,o); if(hr==S_OK) hr=m_pOutput->Deliver(o); else if(hr==S_FALSE){ m_bSampleSkipped=TRUE; hr=S_OK; } o->Release(); return hr; }
+ virtual HRESULT CompleteConnect(PIN_DIRECTION, IPin*){ return S_OK; }
+ virtual HRESULT BreakConnect(PIN_DIRECTION){ return S_OK; }
+ virtual HRESULT CheckInputType(const CMediaType*){ return S_OK; }
+ virtual HRESULT CheckTransform(const CMediaType*, const CMediaType*){ return S_OK; }
+ virtual HRESULT SetMediaType(PIN_DIRECTION, const CMediaType*){ return S_OK; }
+ virtual HRESULT GetMediaType(int, CMediaType*){ return VFW_S_NO_MORE_ITEMS; }
+ virtual HRESULT DecideBufferSize(IMemAllocator*, ALLOCATOR_PROPERTIES*){ return S_OK; }
+ virtual HRESULT AlterQuality(Quality){ return S_FALSE; }
+ virtual HRESULT BeginFlush(){ return S_OK; } virtual HRESULT EndFlush(){ return S_OK; }
+ virtual HRESULT NewSegment(REFERENCE_TIME, REFERENCE_TIME, double){ return S_OK; }
+ virtual HRESULT FindPin(LPCWSTR, IPin**){ return VFW_E_NOT_FOUND; }
+ HRESULT NotifyEvent(long ev, LONG_PTR, LONG_PTR){ m_nEvents++; m_lastEvent=ev; return S_OK; }
+ HRESULT ReconnectPin(IPin*, const AM_MEDIA_TYPE*){ m_nReconnect++; return S_OK; }
+ virtual HRESULT StopStreaming(){ return S_OK; }
+ virtual HRESULT StartStreaming(){ return S_OK; }
+ virtual HRESULT Stop(){ m_State=State_Stopped; return S_OK; }
+ virtual HRESULT Pause(){ CAutoLock l(&m_csFilter); if(m_State==State_Stopped && m_pOutput && m_pOutput->IsConnected()){ HRESULT hr=S_OK; if(m_pInput && m_pInput->IsConnected()) hr=StartStreaming(); if(SUCCEEDED(hr)) hr=m_pOutput->Active(); if(FAILED(hr)) return hr;
+  // the other outputs, as CBaseFilter::Pause activates every pin
+  for(int i=2;i<GetPinCount();i++){ CBasePin* p=GetPin(i); if(p && p->IsConnected()) p->Active(); } } m_State=State_Paused; return S_OK; }
+ virtual HRESULT Run(REFERENCE_TIME t){ CAutoLock l(&m_csFilter); if(m_State==State_Stopped){ HRESULT hr=Pause(); if(FAILED(hr)) return hr; } m_tStart=t; if(m_pOutput && m_pOutput->IsConnected()) m_pOutput->Run(t); m_State=State_Running; return S_OK; }
+ virtual HRESULT EndOfStream(){ m_nEOS++; return S_OK; }
+ virtual HRESULT NonDelegatingQueryInterface(REFIID, void**){ return E_NOTIMPL; }
+ void IncrementPinVersion(){ m_nPinVersion++; }
+ virtual HRESULT Transform(IMediaSample*, IMediaSample*){ return E_UNEXPECTED; }
+};
+inline CBasePin* CTransformFilter::GetPin(int n){ HRESULT hr=S_OK;
+ if(!m_pInput){ m_pInput=new CTransformInputPin("in",this,&hr,L"XForm In"); m_pOutput=new CTransformOutputPin("out",this,&hr,L"XForm Out"); }
+ return n==0? (CBasePin*)m_pInput: n==1? (CBasePin*)m_pOutput: 0; }
+inline HRESULT CTransformInputPin::CompleteConnect(IPin* p){ return m_pFilter->CompleteConnect(PINDIR_INPUT,p); }
+inline HRESULT CTransformInputPin::CheckMediaType(const CMediaType* p){ return m_pFilter->CheckInputType(p); }
+inline HRESULT CTransformInputPin::SetMediaType(const CMediaType* p){ m_mt=*p; return m_pFilter->SetMediaType(PINDIR_INPUT,p); }
+inline HRESULT CTransformInputPin::Receive(IMediaSample* p){ return m_pFilter->Receive(p); }
+inline HRESULT CTransformInputPin::BeginFlush(){ return m_pFilter->BeginFlush(); }
+inline HRESULT CTransformInputPin::EndFlush(){ return m_pFilter->EndFlush(); }
+inline HRESULT CTransformOutputPin::DecideBufferSize(IMemAllocator* a, ALLOCATOR_PROPERTIES* p){ return m_pFilter->DecideBufferSize(a,p); }
+inline HRESULT CTransformOutputPin::CheckMediaType(const CMediaType* p){ return m_pFilter->CheckTransform(&m_pFilter->m_pInput->CurrentMediaType(),p); }
+inline HRESULT CTransformOutputPin::SetMediaType(const CMediaType* p){ m_mt=*p; return m_pFilter->SetMediaType(PINDIR_OUTPUT,p); }
+inline HRESULT CTransformOutputPin::GetMediaType(int i, CMediaType* p){ return m_pFilter->GetMediaType(i,p); }
+inline HRESULT CTransformOutputPin::CompleteConnect(IPin* p){ return m_pFilter->CompleteConnect(PINDIR_OUTPUT,p); }
+inline BOOL EqualRect(const RECT* a, const RECT* b){ return !memcmp(a,b,sizeof(RECT)); }
+typedef void* PVOID;
+inline LONG InterlockedExchange(volatile LONG* p, LONG v){ return __atomic_exchange_n(p,v,__ATOMIC_SEQ_CST); }
+inline PVOID InterlockedExchangePointer(PVOID volatile* p, PVOID v){ return __atomic_exchange_n(p,v,__ATOMIC_SEQ_CST); }
+inline PVOID InterlockedCompareExchangePointer(PVOID volatile* p, PVOID v, PVOID c){ return __sync_val_compare_and_swap(p,c,v); }
+inline LONG InterlockedExchangeAdd(volatile LONG* p, LONG v){ return __sync_fetch_and_add(p,v); }
+#ifndef UNITS
+#define UNITS 10000000
+#endif
@@ -0,0 +1,10 @@
+#include "streams.h"
+#define G(n,i) GUID n={i,0,0,{0}};
+G(GUID_NULL,0) G(MEDIASUBTYPE_RGB8,1) G(MEDIASUBTYPE_RGB565,2) G(MEDIASUBTYPE_RGB555,3) G(MEDIASUBTYPE_ARGB1555,4)
+G(MEDIASUBTYPE_ARGB4444,5) G(MEDIASUBTYPE_RGB24,6) G(MEDIASUBTYPE_RGB32,7) G(MEDIASUBTYPE_ARGB32,8)
+G(MEDIASUBTYPE_A2R10G10B10,9) G(MEDIASUBTYPE_A2B10G10R10,10) G(MEDIASUBTYPE_YUY2,11) G(MEDIASUBTYPE_UYVY,12)
+G(MEDIASUBTYPE_NV12,13) G(MEDIASUBTYPE_YV12,14) G(MEDIASUBTYPE_IYUV,15) G(MEDIASUBTYPE_I420,16) G(MEDIASUBTYPE_RGB1,17) G(MEDIASUBTYPE_RGB4,18)
+G(MEDIATYPE_Video,100) G(FORMAT_VideoInfo,101) G(MEDIASUBTYPE_NULL,102)
+G(CLSID_VideoMux,200) G(IID_IVideoMuxConfig,201) G(IID_IVideoResizerConfig,202) G(CLSID_VideoResizer,203) G(CLSID_VideoPyramid,204) G(IID_IVideoPyramidConfig,205) G(CLSID_MediaSampleMonitor,206)
+int GetBmpBits(const GUID* p){ switch(p->a){case 1:return 8;case 2:case 3:case 4:case 5:return 16;case 6:return 24;case 7:case 8:case 9:case 10:return 32;} return -1;}
+long long g_tickOffsetMs = 0;
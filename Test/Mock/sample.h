@@ -0,0 +1,11 @@
+#pragma once
+#include <vector>
+struct FakeSample : IMediaSample {
+ std::vector<BYTE> buf; long actual;
+ FakeSample(size_t n):buf(n),actual(0),timed(false),t0(0){}
+ ULONG AddRef(){return 1;} ULONG Release(){return 1;}
+ HRESULT GetPointer(BYTE** pp){*pp=&buf[0];return S_OK;} long GetSize(){return (long)buf.size();}
+ long GetActualDataLength(){return actual;} HRESULT SetActualDataLength(long n){actual=n;return S_OK;}
+ bool timed; REFERENCE_TIME t0; void SetT(REFERENCE_TIME t){ timed=true; t0=t; }
+ HRESULT GetTime(REFERENCE_TIME* a, REFERENCE_TIME* b){ if(!timed) return (HRESULT)0x80040249; *a=t0; *b=t0+1; return S_OK; }
+};
@@ -0,0 +1,3 @@
+#include "streams.h"
+#include <stdlib.h>
+DWORD GetSimdFlags(){ const char* e=getenv("SIMD"); return e? strtoul(e,0,0) : 0xF; }
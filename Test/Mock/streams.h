@@ -0,0 +1,117 @@
+#pragma once
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+#include <vector>
+#include <algorithm>
+typedef uint8_t BYTE; typedef BYTE* LPBYTE; typedef uint16_t WORD; typedef uint32_t DWORD;
+typedef struct { BYTE rgbtBlue, rgbtGreen, rgbtRed; } RGBTRIPLE;
+typedef uint32_t ULONG; typedef long LONG; typedef int BOOL; typedef int32_t HRESULT;
+typedef int64_t LONGLONG; typedef int64_t REFERENCE_TIME; typedef uint64_t ULONGLONG;
+typedef int INT; typedef unsigned int UINT; typedef intptr_t INT_PTR; typedef uintptr_t UINT_PTR;
+typedef intptr_t LONG_PTR; typedef uintptr_t DWORD_PTR; typedef void* HANDLE; typedef void* LPVOID;
+typedef char TCHAR; typedef char* LPTSTR; class CMediaType; typedef const char* LPCTSTR; typedef short SHORT; typedef unsigned short USHORT;
+#define MAKEFOURCC(a,b,c,d) ((DWORD)(BYTE)(a) | ((DWORD)(BYTE)(b) << 8) | ((DWORD)(BYTE)(c) << 16) | ((DWORD)(BYTE)(d) << 24))
+#define BI_RGB 0L
+#define DEFINE_GUID(n, ...) extern GUID n
+#define TRUE 1
+#define FALSE 0
+#define S_OK 0
+#define S_FALSE 1
+#define NOERROR 0
+#define E_POINTER ((HRESULT)0x80004003)
+#define E_FAIL ((HRESULT)0x80004005)
+#define E_INVALIDARG ((HRESULT)0x80070057)
+#define E_OUTOFMEMORY ((HRESULT)0x8007000E)
+#define E_NOTIMPL ((HRESULT)0x80004001)
+#define E_UNEXPECTED ((HRESULT)0x8000FFFF)
+#define VFW_E_WRONG_STATE ((HRESULT)0x80040227)
+#define FAILED(h) ((HRESULT)(h) < 0)
+#define SUCCEEDED(h) ((HRESULT)(h) >= 0)
+#define STDMETHODIMP HRESULT
+#define STDMETHODIMP_(t) t
+#define STDMETHOD(m) virtual HRESULT m
+#define STDMETHOD_(t,m) virtual t m
+#define PURE =0
+#define WINAPI
+#define NAME(x) x
+#define TEXT(x) x
+#define ASSERT(x) assert(x)
+#define KASSERT(x) assert(x)
+#define CheckPointer(p,r) if(!(p)) return r
+#define DbgLog(x)
+#define UNREFERENCED_PARAMETER(x) (void)(x)
+#define CopyMemory(d,s,n) memcpy(d,s,n)
+#define ZeroMemory(d,n) memset(d,0,n)
+#define FillMemory(d,n,v) memset(d,v,n)
+#define __forceinline inline __attribute__((always_inline))
+#define __declspec(x)
+#ifndef min
+#define min(a,b) ((a)<(b)?(a):(b))
+#define max(a,b) ((a)>(b)?(a):(b))
+#endif
+struct GUID { uint32_t a; uint16_t b,c; uint8_t d[8];
+ bool operator==(const GUID& o) const { return memcmp(this,&o,sizeof(GUID))==0; }
+ bool operator!=(const GUID& o) const { return !(*this==o); } };
+typedef const GUID& REFGUID; typedef const GUID& REFIID; typedef const GUID& REFCLSID;
+extern GUID GUID_NULL, MEDIASUBTYPE_RGB8, MEDIASUBTYPE_RGB565, MEDIASUBTYPE_RGB555, MEDIASUBTYPE_ARGB1555,
+ MEDIASUBTYPE_ARGB4444, MEDIASUBTYPE_RGB24, MEDIASUBTYPE_RGB32, MEDIASUBTYPE_ARGB32, MEDIASUBTYPE_A2R10G10B10,
+ MEDIASUBTYPE_A2B10G10R10, MEDIASUBTYPE_YUY2, MEDIASUBTYPE_UYVY, MEDIASUBTYPE_NV12, MEDIASUBTYPE_YV12,
+ MEDIASUBTYPE_IYUV, MEDIASUBTYPE_I420, MEDIASUBTYPE_RGB1, MEDIASUBTYPE_RGB4;
+struct IUnknown { virtual ULONG AddRef()=0; virtual ULONG Release()=0; virtual ~IUnknown(){} };
+typedef IUnknown* LPUNKNOWN;
+#define DECLARE_INTERFACE_(i,b) struct i : public b
+#define THIS_
+#define THIS
+struct AM_MEDIA_TYPE;
+struct IMediaSample : IUnknown {
+ virtual HRESULT GetPointer(BYTE** pp)=0; virtual long GetSize()=0; virtual long GetActualDataLength()=0;
+ virtual HRESULT SetActualDataLength(long)=0;
+ virtual HRESULT GetTime(REFERENCE_TIME*, REFERENCE_TIME*){ return (HRESULT)0x80040249; }
+ virtual HRESULT SetTime(REFERENCE_TIME*, REFERENCE_TIME*){ return S_OK; }
+ virtual HRESULT SetSyncPoint(BOOL){ return S_OK; } virtual HRESULT SetDiscontinuity(BOOL){ return S_OK; }
+ virtual HRESULT IsSyncPoint(){ return S_OK; } virtual HRESULT GetMediaType(AM_MEDIA_TYPE** pp){ *pp=0; return S_FALSE; }
+ virtual HRESULT GetMediaTime(LONGLONG*, LONGLONG*){ return (HRESULT)0x80040251; } virtual HRESULT SetMediaTime(LONGLONG*, LONGLONG*){ return S_OK; }
+ virtual HRESULT IsPreroll(){ return S_FALSE; } virtual HRESULT SetPreroll(BOOL){ return S_OK; } virtual HRESULT IsDiscontinuity(){ return S_FALSE; } };
+class CUnknown { public: CUnknown(const char*, LPUNKNOWN){} virtual ~CUnknown(){}
+ ULONG NonDelegatingRelease(){ delete this; return 0;} };
+class CCritSec { pthread_mutex_t m; public: CCritSec(){pthread_mutexattr_t a; pthread_mutexattr_init(&a); pthread_mutexattr_settype(&a,PTHREAD_MUTEX_RECURSIVE); pthread_mutex_init(&m,&a);} ~CCritSec(){pthread_mutex_destroy(&m);}
+ void Lock(){pthread_mutex_lock(&m);} void Unlock(){pthread_mutex_unlock(&m);} };
+class CAutoLock { CCritSec* p; public: CAutoLock(CCritSec* c):p(c){p->Lock();} ~CAutoLock(){p->Unlock();} };
+class CDbgWnd; class CBaseFilter;
+#define UInt32x32To64(a, b) ((unsigned long long)(DWORD)(a) * (DWORD)(b))
+// --- win32 thread/event shim
+#ifndef SHIM_THREADS
+#define SHIM_THREADS
+#include <pthread.h>
+typedef void* HANDLE; typedef void* LPVOID;
+struct ShimEvent { pthread_mutex_t m; pthread_cond_t c; bool sig; bool manual; };
+struct ShimThread { pthread_t t; };
+typedef DWORD (*LPTHREAD_START_ROUTINE)(LPVOID);
+inline HANDLE CreateEvent(void*, BOOL manual, BOOL init, void*){ ShimEvent* e=new ShimEvent; pthread_mutex_init(&e->m,0); pthread_cond_init(&e->c,0); e->sig=init; e->manual=manual; return e; }
+inline BOOL SetEvent(HANDLE h){ ShimEvent* e=(ShimEvent*)h; pthread_mutex_lock(&e->m); e->sig=true; pthread_cond_broadcast(&e->c); pthread_mutex_unlock(&e->m); return TRUE; }
+inline BOOL ResetEvent(HANDLE h){ ShimEvent* e=(ShimEvent*)h; pthread_mutex_lock(&e->m); e->sig=false; pthread_mutex_unlock(&e->m); return TRUE; }
+struct ShimStart { LPTHREAD_START_ROUTINE f; LPVOID p; };
+inline void* shim_thread_main(void* a){ ShimStart s=*(ShimStart*)a; delete (ShimStart*)a; s.f(s.p); return 0; }
+inline HANDLE CreateThread(void*, size_t, LPTHREAD_START_ROUTINE f, LPVOID p, DWORD, DWORD*){ ShimThread* t=new ShimThread; ShimStart* s=new ShimStart; s->f=f; s->p=p; pthread_create(&t->t,0,shim_thread_main,s); return (HANDLE)((size_t)t|1); }
+#define INFINITE 0xFFFFFFFF
+#define WAIT_OBJECT_0 0
+#define WAIT_TIMEOUT 258
+// a timeout of 0 polls an event, the others wait without one
+inline DWORD WaitForSingleObject(HANDLE h, DWORD ms){ if((size_t)h&1){ ShimThread* t=(ShimThread*)((size_t)h&~(size_t)1); pthread_join(t->t,0); return 0;} ShimEvent* e=(ShimEvent*)h; pthread_mutex_lock(&e->m);
+ if(ms==0 && !e->sig){ pthread_mutex_unlock(&e->m); return WAIT_TIMEOUT; }
+ while(!e->sig) pthread_cond_wait(&e->c,&e->m); if(!e->manual) e->sig=false; pthread_mutex_unlock(&e->m); return WAIT_OBJECT_0; }
+inline BOOL CloseHandle(HANDLE h){ if((size_t)h&1) delete (ShimThread*)((size_t)h&~(size_t)1); else delete (ShimEvent*)h; return TRUE; }
+inline LONG InterlockedIncrement(volatile LONG* p){ return __sync_add_and_fetch(p,1); }
+inline LONG InterlockedDecrement(volatile LONG* p){ return __sync_sub_and_fetch(p,1); }
+struct SYSTEM_INFO { DWORD dwNumberOfProcessors; };
+#include <unistd.h>
+inline void GetSystemInfo(SYSTEM_INFO* s){ s->dwNumberOfProcessors=sysconf(_SC_NPROCESSORS_ONLN); }
+#endif
+struct RECT { LONG left, top, right, bottom; };
+inline BOOL SetRect(RECT* r, int l, int t, int rr, int b){ r->left=l; r->top=t; r->right=rr; r->bottom=b; return TRUE; }
+inline BOOL SetRectEmpty(RECT* r){ return SetRect(r,0,0,0,0); }
+inline BOOL IsRectEmpty(const RECT* r){ return r->right<=r->left || r->bottom<=r->top; }
+inline BOOL IntersectRect(RECT* d, const RECT* a, const RECT* b){ d->left=a->left>b->left?a->left:b->left; d->top=a->top>b->top?a->top:b->top; d->right=a->right<b->right?a->right:b->right; d->bottom=a->bottom<b->bottom?a->bottom:b->bottom; if(IsRectEmpty(d)){ SetRectEmpty(d); return FALSE;} return TRUE; }
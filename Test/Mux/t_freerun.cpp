@@ -0,0 +1,119 @@
+#include "streams.h"
+#include "DSFiltersGuids.h"
+#include "Utils.h"
+#define protected public
+#define private public
+#include "VideoMux.h"
+#undef protected
+#undef private
+#include "sample.h"
+#include "refsample.h"
+#include <stdio.h>
+// free-running compositor: output paced by the clock, master stalls, stale inputs striped
+int fails=0;
+#define CHECK(c) do{ if(!(c)){ printf("FAIL %s:%d %s\n",__FILE__,__LINE__,#c); fails++; } }while(0)
+CMediaType MakeType(int w,int h){ CMediaType mt; mt.majortype=MEDIATYPE_Video; mt.subtype=MEDIASUBTYPE_RGB32; mt.formattype=FORMAT_VideoInfo;
+ VIDEOINFOHEADER* v=(VIDEOINFOHEADER*)mt.AllocFormatBuffer(sizeof(VIDEOINFOHEADER)); memset(v,0,sizeof(*v)); v->bmiHeader.biWidth=w; v->bmiHeader.biHeight=h; v->bmiHeader.biBitCount=32; v->bmiHeader.biPlanes=1; return mt; }
+const int W=16, H=8;
+struct Frame { bool timed; REFERENCE_TIME t0, t1; BOOL disc; DWORD cell[4][2]; long long ns; };
+// cell c line y first pixel
+static DWORD Px(OutSample* s, int c, int y){ int row=1-c/2; return ((DWORD*)&s->buf[0])[(row*H+y)*W*2+(c%2)*W]; }
+struct Sink : OutSink { CCritSec cs; std::vector<Frame> f; volatile HRESULT ret; volatile LONG eos;
+ Sink():ret(S_OK),eos(0){}
+ HRESULT EndOfStream(){ InterlockedIncrement(&eos); return S_OK; }
+ HRESULT Deliver(OutSample* s){ Frame fr; fr.timed=s->timed; fr.t0=s->t0; fr.t1=s->t1; fr.disc=s->disc; fr.ns=shim_now_ns();
+  for(int c=0;c<4;c++){ fr.cell[c][0]=Px(s,c,0); fr.cell[c][1]=Px(s,c,1); }
+  CAutoLock l(&cs); f.push_back(fr); return ret; }
+ size_t n(){ CAutoLock l(&cs); return f.size(); }
+ Frame at(size_t i){ CAutoLock l(&cs); return f[i]; } };
+static void Fill(IMediaSample* s, DWORD v){ BYTE* p; s->GetPointer(&p); s->SetActualDataLength(W*4*H); for(int k=0;k<W*H;k++) ((DWORD*)p)[k]=v; }
+long long ms(){ return shim_now_ns()/1000000; }
+static CBaseMuxInputPin* Pin(CVideoMux* m, int i){ return i? m->GetSlaveInput(i-1): (CBaseMuxInputPin*)m->m_pInput; }
+CVideoMux* Make(Sink* sink, IMemAllocator* a){
+ HRESULT hr; CVideoMux* m=(CVideoMux*)CVideoMux::CreateInstance(0,&hr);
+ m->SetCellSize(W,H); m->SetGrid(2,2);
+ CHECK(m->SetFrameTime(1)==E_INVALIDARG); CHECK(m->SetFrameTime(UNITS*11)==E_INVALIDARG); CHECK(m->SetFrameTime(-1)==E_INVALIDARG);
+ CHECK(m->SetFrameTime(UNITS/50)==S_OK);
+ REFERENCE_TIME rt; CHECK(m->GetFrameTime(&rt)==S_OK && rt==UNITS/50);
+ CMediaType mt=MakeType(W,H); m->GetPinCount(); m->m_pInput->MockConnect(mt); m->m_pInput->NotifyAllocator(a,TRUE);
+ for(int i=0;i<2;i++){ m->GetSlaveInput(i)->MockConnect(mt); m->GetSlaveInput(i)->NotifyAllocator(a,TRUE); }
+ CMediaType omt; m->GetMediaType(0,&omt); CHECK(((VIDEOINFOHEADER*)omt.Format())->AvgTimePerFrame==UNITS/50);
+ m->m_pOutput->MockConnect(omt); m->m_pOutput->m_pSink=sink; m->m_pOutput->m_cbOut=W*4*H*4;
+ CHECK(m->SetFrameTime(UNITS/25)==VFW_E_ALREADY_CONNECTED);
+ return m;
+}
+int main(){ setvbuf(stdout,0,_IONBF,0);
+ IMemAllocator a1; ALLOCATOR_PROPERTIES p={1,0,1,0}, act; a1.SetProperties(&p,&act);
+ // --- with a clock
+ { Sink sink; IReferenceClock clock; CVideoMux* m=Make(&sink,&a1); m->m_pClock=&clock;
+  CHECK(m->Pause()==S_OK); CHECK(m->SetFrameTime(0)==VFW_E_NOT_STOPPED);
+  CVideoMuxOutputPin* op=(CVideoMuxOutputPin*)m->m_pOutput; CHECK(op->ThreadExists());
+  usleep(100000);
+  CHECK(sink.n()==1); if(sink.n()) CHECK(!sink.at(0).timed);  // one preroll frame while paused
+  FakeSample ms0(W*4*H), ss0(W*4*H), ss1(W*4*H);
+  Fill(&ms0,0x100); CHECK(m->m_pInput->Receive(&ms0)==S_OK);
+  Fill(&ss1,0x300); CHECK(m->GetSlaveInput(1)->Receive(&ss1)==S_OK);
+  CHECK(Pin(m,0)->EndOfStream()==S_OK); CHECK(m->m_nEOS==0);  // the master ending doesn't end the output
+  REFERENCE_TIME now; clock.GetTime(&now);
+  CHECK(m->Run(now)==S_OK);
+  long long t0=::ms(); DWORD v=0x200;
+  while(::ms()-t0<600){ Fill(&ss0,++v); m->GetSlaveInput(0)->Receive(&ss0); usleep(5000); }
+  BOOL b;
+  CHECK(m->IsInputStale(0,&b)==S_OK && b); CHECK(m->IsInputStale(1,&b)==S_OK && !b);
+  CHECK(m->IsInputStale(2,&b)==S_OK && b); CHECK(m->IsInputStale(3,&b)==S_OK && !b);  // unconnected
+  CHECK(m->IsInputStale(4,&b)==E_INVALIDARG); CHECK(m->IsInputStale(-1,&b)==E_INVALIDARG);
+  CHECK(m->Stop()==S_OK); CHECK(!op->ThreadExists());
+  size_t n=sink.n(); usleep(60000); CHECK(sink.n()==n);  // nothing after Stop
+  CHECK(m->IsInputStale(0,&b)==S_OK && !b);
+  // ~30 frames in 600ms, contiguous 20ms stamps, slave 0 updated with the master stalled
+  int timed=0, gaps=0, changes=0, late=0, striped=0, fresh=0; DWORD last=0;
+  for(size_t i=1;i<n;i++){ Frame f=sink.at(i); if(!f.timed) continue; timed++;
+   if(f.t1-f.t0!=UNITS/50) gaps++;
+   if(timed>1){ Frame g=sink.at(i-1); if(g.timed && f.t0!=g.t1 && !f.disc) gaps++; }
+   if(f.cell[1][0]!=last) changes++; last=f.cell[1][0];
+   long long due=now/10000+f.t0/10000; if(f.ns/1000000 < due-2) late++;  // never delivered before its time
+   if(f.cell[0][0]==0 && f.cell[0][1]==0x100 && f.cell[2][0]==0 && f.cell[2][1]==0x300) striped++;  // every other line from the bottom
+   if(f.cell[0][0]==0x100 && f.cell[0][1]==0x100 && f.cell[2][0]==0x300) fresh++;
+   if(f.cell[1][1]!=f.cell[1][0]) gaps+=100; }
+  printf("clock: frames %zu timed %d gaps %d slave changes %d early %d fresh %d striped %d advise %ld/%ld\n",n,timed,gaps,changes,late,fresh,striped,(long)clock.nAdvise,(long)clock.nUnadvise);
+  CHECK(timed>=26 && timed<=32); CHECK(gaps==0); CHECK(changes>=timed-2); CHECK(late==0);
+  CHECK(fresh>=1 && striped>=20); CHECK(clock.nAdvise==clock.nUnadvise);
+  // runs again after Stop
+  size_t n0=sink.n(); CHECK(m->Pause()==S_OK); clock.GetTime(&now); CHECK(m->Run(now)==S_OK); usleep(200000);
+  CHECK(m->Stop()==S_OK); CHECK(sink.n()-n0>=8);
+  CHECK(sink.eos==0);
+  // downstream S_FALSE doesn't stop the output, an error aborts it, Stop still joins
+  sink.ret=S_FALSE; n0=sink.n(); CHECK(m->Pause()==S_OK); clock.GetTime(&now); CHECK(m->Run(now)==S_OK); usleep(100000);
+  CHECK(sink.n()-n0>=3); CHECK(m->m_nEvents==0);
+  sink.ret=E_FAIL; usleep(60000); n0=sink.n(); usleep(60000);
+  CHECK(sink.n()==n0); CHECK(m->m_nEvents==1 && m->m_lastEvent==EC_ERRORABORT); CHECK(sink.eos==1);
+  CHECK(m->Stop()==S_OK); CHECK(!op->ThreadExists());
+  // the end of all the connected inputs ends the output once, a flush resumes it
+  sink.ret=S_OK; sink.eos=0; CHECK(m->Pause()==S_OK); clock.GetTime(&now); CHECK(m->Run(now)==S_OK); usleep(60000);
+  CHECK(Pin(m,0)->EndOfStream()==S_OK && Pin(m,1)->EndOfStream()==S_OK); usleep(60000); CHECK(sink.eos==0);
+  CHECK(Pin(m,2)->EndOfStream()==S_OK); usleep(60000); CHECK(sink.eos==1);
+  n0=sink.n(); usleep(60000); CHECK(sink.n()==n0); CHECK(m->m_nEOS==0);
+  for(int i=0;i<3;i++) CHECK(Pin(m,i)->BeginFlush()==S_OK);
+  CHECK(Pin(m,0)->EndFlush()==S_OK && Pin(m,1)->EndFlush()==S_OK); usleep(60000); CHECK(sink.n()==n0);  // until the last pin
+  CHECK(Pin(m,2)->EndFlush()==S_OK); usleep(100000); CHECK(sink.n()-n0>=3); CHECK(sink.eos==1);
+  if(sink.n()>n0) CHECK(sink.at(n0).disc);
+  CHECK(Pin(m,1)->EndOfStream()==S_OK); CHECK(m->Stop()==S_OK); CHECK(!op->ThreadExists());
+  CHECK(!Pin(m,0)->IsEndOfStream() && !Pin(m,1)->IsEndOfStream());  // Stop forgets the ends
+  m->m_pClock=0; delete m; }
+ // --- no clock: untimed frames at the frame time
+ { Sink sink; CVideoMux* m=Make(&sink,&a1);
+  CHECK(m->Run(0)==S_OK); usleep(400000); CHECK(m->Stop()==S_OK);
+  int untimed=0; for(size_t i=0;i<sink.n();i++) if(!sink.at(i).timed) untimed++;
+  printf("no clock: frames %zu untimed %d\n",sink.n(),untimed);
+  CHECK(untimed==(int)sink.n() && sink.n()>=14 && sink.n()<=22);
+  delete m; }
+ // --- frame time 0 keeps the master-driven output
+ { Sink sink; HRESULT hr; CVideoMux* m=(CVideoMux*)CVideoMux::CreateInstance(0,&hr); m->SetCellSize(W,H); m->SetGrid(2,2);
+  CMediaType mt=MakeType(W,H); m->GetPinCount(); m->m_pInput->MockConnect(mt); m->m_pInput->NotifyAllocator(&a1,TRUE);
+  CMediaType omt; m->GetMediaType(0,&omt); m->m_pOutput->MockConnect(omt); m->m_pOutput->m_pSink=&sink;
+  CHECK(m->Run(0)==S_OK); CHECK(!((CVideoMuxOutputPin*)m->m_pOutput)->ThreadExists());
+  CHECK(m->EndOfStream()==S_OK && m->m_nEOS==1);
+  usleep(50000); CHECK(sink.n()==0); CHECK(m->Stop()==S_OK); delete m; }
+ printf("fails %d\n",fails);
+ return fails!=0;
+}
@@ -0,0 +1,86 @@
+#include "streams.h"
+#include "DSFiltersGuids.h"
+#include "Utils.h"
+#define protected public
+#define private public
+#define class struct
+#include "VideoMux.h"
+#undef protected
+#undef private
+#undef class
+#include "sample.h"
+#include <stdio.h>
+int fails=0;
+#define CHECK(c) do{ if(!(c)){ printf("FAIL %s:%d %s\n",__FILE__,__LINE__,#c); fails++; } }while(0)
+CMediaType MakeType(int w,int h){ CMediaType mt; mt.majortype=MEDIATYPE_Video; mt.subtype=MEDIASUBTYPE_RGB32; mt.formattype=FORMAT_VideoInfo;
+ VIDEOINFOHEADER* v=(VIDEOINFOHEADER*)mt.AllocFormatBuffer(sizeof(VIDEOINFOHEADER)); memset(v,0,sizeof(*v)); v->bmiHeader.biWidth=w; v->bmiHeader.biHeight=h; v->bmiHeader.biBitCount=32; v->bmiHeader.biPlanes=1; return mt; }
+int main(){
+ for(int g=0; g<4; g++){
+  int cols[]={2,2,3,4}, rows[]={1,2,3,4};
+  int C=cols[g], R=rows[g], W=8, H=6;
+  HRESULT hr; CVideoMux* m=(CVideoMux*)CVideoMux::CreateInstance(0,&hr);
+  CHECK(m->SetCellSize(0,H)==E_INVALIDARG); CHECK(m->SetCellSize(W,H)==S_OK);
+  int cw=0, ch=0; CHECK(m->GetCellSize(&cw,&ch)==S_OK && cw==W && ch==H);
+  void* pv=0; CHECK(FAILED(m->NonDelegatingQueryInterface(IID_IVideoResizerConfig,&pv)) && !pv);
+  CHECK(m->SetGrid(C,R)==S_OK);
+  CHECK(m->GetPinCount()==3);
+  CMediaType mt=MakeType(W,H);
+  CHECK(m->CheckInputType(&mt)==S_OK);
+  m->m_pInput->MockConnect(mt);
+  CHECK(m->SetGrid(2,2)==VFW_E_ALREADY_CONNECTED); CHECK(m->SetCellSize(W*2,H)==VFW_E_ALREADY_CONNECTED);
+  // connect slaves; a pin is added until C*R-1
+  for(int i=0;i<C*R-1;i++){
+   CBaseMuxInputPin* p=m->GetSlaveInput(i); CHECK(p!=NULL); if(!p) break;
+   CHECK(m->GetPinCount()==2+i+1);
+   p->MockConnect(mt);
+  }
+  CHECK(m->GetSlaveCount()==C*R-1);
+  CHECK(m->GetPin(m->GetPinCount()-1)==m->m_pOutput);
+  IPin* pp=0; CHECK(m->FindPin(L"Out",&pp)==S_OK && pp==m->m_pOutput);
+  CHECK(m->FindPin(L"In2",&pp)==S_OK && pp==m->GetSlaveInput(0));
+  if(C*R>2){ CHECK(m->FindPin(L"Slave In 3",&pp)==S_OK && pp==m->GetSlaveInput(2)); }
+  CHECK(m->FindPin(L"In999",&pp)==VFW_E_NOT_FOUND);
+  CMediaType omt; CHECK(m->GetMediaType(0,&omt)==S_OK);
+  BITMAPINFOHEADER* ob=HEADER(omt.pbFormat); CHECK(ob->biWidth==W*C && ob->biHeight==H*R);
+  CHECK(m->CheckTransform(&mt,&omt)==S_OK);
+  // the buffers are made by connecting the output, not by the type
+  CHECK(m->m_pSlaveFrames==NULL);
+  m->m_pOutput->MockConnect(omt);
+  CHECK(m->m_pSlaveFrames!=NULL && m->m_nPixelPerBytes==4);
+  { void* pf=m->m_pSlaveFrames; CMediaType t; CHECK(m->GetMediaType(0,&t)==S_OK); CHECK(m->m_pSlaveFrames==pf); }
+  ALLOCATOR_PROPERTIES pr={1,0,1,0}; CHECK(m->DecideBufferSize(&omt,&pr)==S_OK);
+  int dstride=W*C*4;
+  CHECK(pr.cbBuffer==dstride*H*R);
+  // slaves with frames: pixel = cell index; the last slave without a frame
+  int ns=C*R-1;
+  for(int i=0;i<ns-1;i++){ FakeSample s(W*4*H); for(int k=0;k<W*H;k++) ((DWORD*)&s.buf[0])[k]=0x1000*(i+2)+k; s.actual=W*4*H; CHECK(m->GetSlaveInput(i)->Receive(&s)==S_OK); }
+  FakeSample src(W*4*H); for(int k=0;k<W*H;k++) ((DWORD*)&src.buf[0])[k]=0x1000+k;
+  FakeSample dst(pr.cbBuffer); memset(&dst.buf[0],0xcd,dst.buf.size());
+  CHECK(m->Transform(&src,&dst)==S_OK);
+  CHECK(dst.actual==pr.cbBuffer);
+  int bad=0;
+  for(int cell=0; cell<C*R; cell++) for(int y=0;y<H;y++) for(int x=0;x<W;x++){
+   // bottom-up: the top row of cells is at the end
+   int row=R-1-cell/C; DWORD v=((DWORD*)&dst.buf[0])[(row*H+y)*W*C + (cell%C)*W + x];
+   DWORD e = (cell==ns) ? 0 : 0x1000*(cell+1)+y*W+x;
+   if(v!=e) bad++;
+  }
+  CHECK(bad==0);
+  printf("grid %dx%d pins %d bad %d\n",C,R,m->GetPinCount(),bad);
+  CHECK(m->Stop()==S_OK);
+  delete m;
+ }
+ // grid changes trim the free pins
+ { HRESULT hr; CVideoMux* m=(CVideoMux*)CVideoMux::CreateInstance(0,&hr); m->SetGrid(3,3);
+   CMediaType mt=MakeType(320,240);
+   m->GetPinCount(); for(int i=0;i<4;i++) m->GetSlaveInput(i)->MockConnect(mt);
+   CHECK(m->GetSlaveCount()==5);
+   for(int i=0;i<4;i++) m->GetSlaveInput(i)->MockDisconnect();
+   CHECK(m->SetGrid(2,1)==S_OK); CHECK(m->GetSlaveCount()==1);
+   CHECK(m->SetGrid(1,1)==E_INVALIDARG); CHECK(m->SetGrid(1000,1)==E_INVALIDARG); CHECK(m->SetGrid(999,1)==S_OK);
+   CHECK(m->SetGrid(3,3)==S_OK); m->GetSlaveInput(0)->MockConnect(mt); CHECK(m->GetSlaveCount()==2);
+   m->GetSlaveInput(0)->MockDisconnect(); CHECK(m->SetGrid(4,4)==S_OK); CHECK(m->GetSlaveCount()==1);
+   delete m; }
+ printf("fails %d\n",fails);
+ return fails!=0;
+}
@@ -0,0 +1,57 @@
+#include "streams.h"
+#include "DSFiltersGuids.h"
+#include "Utils.h"
+#define protected public
+#define private public
+#include "VideoMux.h"
+#undef protected
+#undef private
+#include "sample.h"
+#include "refsample.h"
+#include <stdio.h>
+int fails=0;
+#define CHECK(c) do{ if(!(c)){ printf("FAIL %s:%d %s\n",__FILE__,__LINE__,#c); fails++; } }while(0)
+CMediaType MakeType(int w,int h){ CMediaType mt; mt.majortype=MEDIATYPE_Video; mt.subtype=MEDIASUBTYPE_RGB32; mt.formattype=FORMAT_VideoInfo;
+ VIDEOINFOHEADER* v=(VIDEOINFOHEADER*)mt.AllocFormatBuffer(sizeof(VIDEOINFOHEADER)); memset(v,0,sizeof(*v)); v->bmiHeader.biWidth=w; v->bmiHeader.biHeight=h; v->bmiHeader.biBitCount=32; v->bmiHeader.biPlanes=1; return mt; }
+int main(){
+ int W=16, H=8; HRESULT hr;
+ CVideoMux* m=(CVideoMux*)CVideoMux::CreateInstance(0,&hr);
+ m->SetCellSize(W,H); m->SetGrid(2,2);
+ CMediaType mt=MakeType(W,H);
+ m->GetPinCount(); m->m_pInput->MockConnect(mt);
+ IMemAllocator a3, a1; ALLOCATOR_PROPERTIES p={0,0,0,0}, act;
+ CHECK(m->GetSlaveInput(0)->GetAllocatorRequirements(&p)==S_OK && p.cBuffers==MUX_SLAVE_BUFFERS);
+ CHECK(((CBaseMuxInputPin*)m->m_pInput)->GetAllocatorRequirements(&p)==E_NOTIMPL);
+ p.cBuffers=3; a3.SetProperties(&p,&act); p.cBuffers=1; a1.SetProperties(&p,&act);
+ m->GetSlaveInput(0)->MockConnect(mt); m->GetSlaveInput(0)->NotifyAllocator(&a3,TRUE);
+ m->GetSlaveInput(1)->MockConnect(mt); m->GetSlaveInput(1)->NotifyAllocator(&a1,TRUE);
+ CMediaType omt; m->GetMediaType(0,&omt); m->m_pOutput->MockConnect(omt);
+ CHECK(m->GetSlaveInput(0)->CanHoldSample() && !m->GetSlaveInput(1)->CanHoldSample());
+ int cb=W*4*H;
+ RefSample s0(cb), s1(cb), t0(cb);
+ for(int k=0;k<W*H;k++){ ((DWORD*)&s0.buf[0])[k]=0xa0000+k; ((DWORD*)&s1.buf[0])[k]=0xb0000+k; ((DWORD*)&t0.buf[0])[k]=0xc0000+k; }
+ CHECK(m->GetSlaveInput(0)->Receive(&s0)==S_OK); CHECK(s0.ref==2);          // held
+ CHECK(m->GetSlaveInput(1)->Receive(&s1)==S_OK); CHECK(s1.ref==1);          // copied
+ FakeSample src(cb), dst(cb*4);
+ for(int k=0;k<W*H;k++) ((DWORD*)&src.buf[0])[k]=0x10000+k;
+ // the held sample is read in Transform, not a copy of it
+ for(int k=0;k<W*H;k++) ((DWORD*)&s0.buf[0])[k]=0xd0000+k;
+ CHECK(m->Transform(&src,&dst)==S_OK);
+ int bad=0; DWORD e[4]={0x10000,0xd0000,0xb0000,0};
+ for(int cell=0;cell<4;cell++) for(int y=0;y<H;y++) for(int x=0;x<W;x++){
+  int row=1-cell/2; DWORD v=((DWORD*)&dst.buf[0])[(row*H+y)*W*2+(cell%2)*W+x];
+  if(v!=(cell==3?0:e[cell]+y*W+x)) bad++; }
+ CHECK(bad==0);
+ // a newer sample releases the older
+ CHECK(m->GetSlaveInput(0)->Receive(&t0)==S_OK); CHECK(s0.ref==1 && t0.ref==2);
+ // a short sample is dropped
+ RefSample sh(cb/2); CHECK(m->GetSlaveInput(0)->Receive(&sh)==S_OK); CHECK(t0.ref==2 && sh.ref==1);
+ CHECK(m->GetSlaveInput(0)->Receive(&s0)==S_OK); CHECK(s0.ref==2 && t0.ref==1);
+ VIDEOMUX_SLAVE_STATS st; CHECK(m->GetSlaveStats(0,&st)==S_OK && st.nReceived==4 && st.nSlaveOverlaps==0);
+ CHECK(m->GetSlaveStats(2,&st)==S_OK && st.nReceived==0); CHECK(m->GetSlaveStats(3,&st)==E_INVALIDARG);
+ CHECK(m->Stop()==S_OK); CHECK(s0.ref==1);
+ CHECK(m->GetSlaveInput(0)->Receive(&s0)==S_OK); CHECK(s0.ref==2);
+ delete m; CHECK(s0.ref==1);
+ printf("fails %d\n",fails);
+ return fails!=0;
+}
@@ -0,0 +1,107 @@
+#include "streams.h"
+#include "DSFiltersGuids.h"
+#include "Utils.h"
+#define protected public
+#define private public
+#define class struct
+#include "VideoMux.h"
+#include "JitterBuffer.h"
+#include "RingBuffer.h"
+#undef protected
+#undef private
+#undef class
+#include "sample.h"
+#include "refsample.h"
+#include <stdio.h>
+int fails=0;
+#define CHECK(c) do{ if(!(c)){ printf("FAIL %s:%d %s\n",__FILE__,__LINE__,#c); fails++; } }while(0)
+CMediaType MakeType(int w,int h,REFERENCE_TIME avg){ CMediaType mt; mt.majortype=MEDIATYPE_Video; mt.subtype=MEDIASUBTYPE_RGB32; mt.formattype=FORMAT_VideoInfo;
+ VIDEOINFOHEADER* v=(VIDEOINFOHEADER*)mt.AllocFormatBuffer(sizeof(VIDEOINFOHEADER)); memset(v,0,sizeof(*v)); v->bmiHeader.biWidth=w; v->bmiHeader.biHeight=h; v->bmiHeader.biBitCount=32; v->bmiHeader.biPlanes=1; v->AvgTimePerFrame=avg; return mt; }
+const int W=16,H=8; const REFERENCE_TIME P=333333;
+struct Rig {
+ CVideoMux* m; IMemAllocator a; FakeSample src, dst; std::vector<RefSample*> pool; size_t next;
+ Rig(REFERENCE_TIME lat, REFERENCE_TIME slaveAvg, int cBuffers=3):src(W*4*H),dst(W*4*H*2),next(0){
+  HRESULT hr; m=(CVideoMux*)CVideoMux::CreateInstance(0,&hr); m->SetCellSize(W,H);
+  CHECK(m->SetMaxSlaveLatency(lat)==S_OK);
+  CMediaType mt=MakeType(W,H,P); m->GetPinCount(); m->m_pInput->MockConnect(mt);
+  ALLOCATOR_PROPERTIES p={cBuffers,0,1,0},act; a.SetProperties(&p,&act);
+  CMediaType smt=MakeType(W,H,slaveAvg); m->GetSlaveInput(0)->MockConnect(smt); m->GetSlaveInput(0)->NotifyAllocator(&a,TRUE);
+  CMediaType omt; m->GetMediaType(0,&omt); m->m_pOutput->MockConnect(omt);
+  CHECK(m->Pause()==S_OK);
+  for(int i=0;i<8;i++) pool.push_back(new RefSample(W*4*H));
+ }
+ ~Rig(){ m->Stop(); delete m; for(size_t i=0;i<pool.size();i++){ CHECK(pool[i]->ref==1); delete pool[i]; } }
+ void Slave(REFERENCE_TIME t, DWORD v, bool timed=true){ RefSample* s=pool[next++%pool.size()]; CHECK(s->ref==1);
+  DWORD* d=(DWORD*)&s->buf[0]; for(int k=0;k<W*H;k++) d[k]=v; s->timed=timed; s->t0=t; CHECK(m->GetSlaveInput(0)->Receive(s)==S_OK); }
+ DWORD Master(REFERENCE_TIME t, bool timed=true){ src.timed=timed; src.t0=t; CAutoLock l(&m->m_csReceive); m->Transform(&src,&dst); return ((DWORD*)&dst.buf[0])[W]; }
+ VIDEOMUX_SLAVE_STATS St(){ VIDEOMUX_SLAVE_STATS s; m->GetSlaveStats(0,&s); return s; }
+};
+int main(){
+ // ring buffer: the block count is the power of two, not the block size
+ { CRingBuffer r(12,4); CHECK(r.IsValid()); BYTE b[12]={0};
+   for(int i=0;i<4;i++){ b[0]=i; CHECK(r.Enqueue(b,12)); } CHECK(r.IsFull()); CHECK(!r.Enqueue(b,12));
+   BYTE* p; CHECK(r.Dequeue(&p) && p[0]==0); CHECK(r.GetDataIndex(0)==1 && r.GetDataIndex(2)==3 && r.GetDataIndex(3)==-1);
+   b[0]=9; CHECK(r.Enqueue(b,12)); CHECK(r.GetDataIndex(3)==0 && r.Peek()[0]==1); }
+ // the frame being read is not overwritten, nor waited for
+ { CJitterBuffer j(4,4); CHECK(j.IsValid()); BYTE b[4]={0}; int nd; BOOL rep;
+   for(int i=0;i<4;i++){ b[0]=i; CHECK(j.Write(b,4,TRUE,i*P,UNITS)==0); }
+   const BYTE* p=j.Select(TRUE,0,&nd,&rep); CHECK(p && p[0]==0 && nd==0 && !rep);
+   b[0]=4; CHECK(j.Write(b,4,TRUE,4*P,UNITS)==1); CHECK(p[0]==0);  // full: the front goes, the new frame has no block
+   j.EndRead(); b[0]=5; CHECK(j.Write(b,4,TRUE,5*P,UNITS)==0);
+   p=j.Select(TRUE,5*P,&nd,&rep); CHECK(p && p[0]==5 && nd==3); j.EndRead();
+   b[0]=6; CHECK(j.Write(b,4,FALSE,0,UNITS)==0); p=j.Select(FALSE,0,&nd,&rep); CHECK(p && p[0]==6); j.EndRead(); }
+ // config
+ { Rig r(0,P); CHECK(r.m->SetMaxSlaveLatency(1)==VFW_E_NOT_STOPPED); REFERENCE_TIME l; r.m->GetMaxSlaveLatency(&l); CHECK(l==0);
+   CHECK(r.m->m_pSlaveFrames[0].pJitter==NULL);
+   r.m->Stop(); CHECK(r.m->SetMaxSlaveLatency(-1)==E_INVALIDARG); CHECK(r.m->SetMaxSlaveLatency(UNITS+1)==E_INVALIDARG);
+   CHECK(r.m->SetMaxSlaveLatency(2*P)==S_OK); r.m->Pause(); CHECK(r.m->m_pSlaveFrames[0].pJitter!=NULL);
+   CHECK(r.m->m_pSlaveFrames[0].pJitter->m_pRing->GetBlockCount()==4); }
+ { Rig r(UNITS,0); CHECK(r.m->m_pSlaveFrames[0].pJitter->m_pRing->GetBlockCount()==64); }
+ // slave 3 frames ahead of the master: with 200ms the slave waits for the master
+ { Rig r(2000000,P); int bad=0;
+   for(int k=0;k<3;k++) r.Slave(k*P,100+k);
+   for(int k=0;k<100;k++){ r.Slave((k+3)*P,100+k+3); if(r.Master(k*P)!=(DWORD)(100+k)) bad++; }
+   VIDEOMUX_SLAVE_STATS s=r.St(); printf("ahead: bad %d rep %ld drop %ld\n",bad,(long)s.nRepeated,(long)s.nDropped);
+   CHECK(bad==0 && s.nRepeated==0 && s.nDropped==0 && s.nReceived==103); }
+ // jitter on the slave timestamps, still nearest
+ { Rig r(2000000,P); int bad=0;
+   for(int k=0;k<3;k++) r.Slave(k*P,100+k);
+   for(int k=0;k<100;k++){ r.Slave((k+3)*P+((k*7)%5-2)*30000,100+k+3); if(r.Master(k*P)!=(DWORD)(100+k)) bad++; }
+   CHECK(bad==0); }
+ // 50ms is not enough for 100ms ahead: the oldest frame within the latency
+ { Rig r(500000,P); int bad=0;
+   for(int k=0;k<3;k++) r.Slave(k*P,100+k);
+   for(int k=0;k<50;k++){ r.Slave((k+3)*P,100+k+3); if(r.Master(k*P)!=(DWORD)(100+k+2)) bad++; }
+   VIDEOMUX_SLAVE_STATS s=r.St(); printf("short latency: bad %d rep %ld drop %ld\n",bad,(long)s.nRepeated,(long)s.nDropped);
+   CHECK(bad==0 && s.nRepeated==0 && s.nDropped==2); }
+ // 60fps slave: every other frame dropped
+ { Rig r(2000000,P/2); int bad=0;
+   for(int k=0;k<100;k++){ r.Slave(k*P,200+2*k); r.Slave(k*P+P/2,201+2*k); if(r.Master(k*P)!=(DWORD)(200+2*k)) bad++; }
+   VIDEOMUX_SLAVE_STATS s=r.St(); printf("60fps: bad %d rep %ld drop %ld\n",bad,(long)s.nRepeated,(long)s.nDropped);
+   CHECK(bad==0 && s.nRepeated==0 && s.nDropped==99); }
+ // 15fps slave: every other frame repeated
+ { Rig r(2000000,2*P); int bad=0;
+   for(int k=0;k<100;k++){ if(k%2==0) r.Slave(k*P,300+k/2); if(r.Master(k*P)!=(DWORD)(300+k/2)) bad++; }
+   VIDEOMUX_SLAVE_STATS s=r.St(); printf("15fps: bad %d rep %ld drop %ld\n",bad,(long)s.nRepeated,(long)s.nDropped);
+   CHECK(bad==0 && s.nRepeated==50 && s.nDropped==0); }
+ // latest frame mode counts too
+ { Rig r(0,P/2); int bad=0;
+   for(int k=0;k<100;k++){ r.Slave(k*P,200+2*k); r.Slave(k*P+P/2,201+2*k); if(r.Master(k*P)!=(DWORD)(201+2*k)) bad++; }
+   for(int k=0;k<3;k++) r.Master((100+k)*P);
+   VIDEOMUX_SLAVE_STATS s=r.St(); printf("latest 60fps: bad %d rep %ld drop %ld\n",bad,(long)s.nRepeated,(long)s.nDropped);
+   CHECK(bad==0 && s.nRepeated==3 && s.nDropped==100); }
+ { Rig r(0,P,1); for(int k=0;k<10;k++){ r.Slave(k*P,1); r.Slave(k*P,2); r.Master(k*P); } r.Master(0);
+   VIDEOMUX_SLAVE_STATS s=r.St(); CHECK(s.nRepeated==1 && s.nDropped==10); }
+ // timestamps going back (a seek) flush, untimed samples are the latest
+ { Rig r(2000000,P);
+   for(int k=0;k<3;k++) r.Slave(100*P+k*P,500+k);
+   CHECK(r.Master(100*P)==500);
+   r.Slave(0,600); r.Slave(P,601); CHECK(r.Master(0)==600); CHECK(r.Master(P)==601);
+   r.Slave(0,700,false); CHECK(r.Master(2*P)==700);
+   r.Slave(3*P,701); r.Slave(4*P,702); CHECK(r.Master(0,false)==702);
+   VIDEOMUX_SLAVE_STATS s=r.St(); printf("flush: rep %ld drop %ld\n",(long)s.nRepeated,(long)s.nDropped);
+   CHECK(s.nDropped==3 && s.nRepeated==0); }
+ // stop clears, pause restarts the stats
+ { Rig r(2000000,P); r.Slave(0,5); CHECK(r.Master(0)==5); r.m->Stop(); CHECK(r.Master(0)==0); r.m->Pause(); CHECK(r.St().nReceived==0); }
+ printf("fails %d\n",fails); return fails!=0;
+}
@@ -0,0 +1,70 @@
+#include "streams.h"
+#include "DSFiltersGuids.h"
+#include "Utils.h"
+#define protected public
+#define private public
+#include "VideoMux.h"
+#undef protected
+#undef private
+#include "sample.h"
+#include "refsample.h"
+#include <stdio.h>
+#include <time.h>
+// master Transform and 3 slaves run concurrently: slaves 0,1 are held (3 sample pool),
+// slave 2 is copied (1 sample). a slave refills a sample only when the mux released it,
+// so a torn tile means the handoff let the master read a sample being refilled.
+int fails=0;
+#define CHECK(c) do{ if(!(c)){ printf("FAIL %s:%d %s\n",__FILE__,__LINE__,#c); fails++; } }while(0)
+CMediaType MakeType(int w,int h){ CMediaType mt; mt.majortype=MEDIATYPE_Video; mt.subtype=MEDIASUBTYPE_RGB32; mt.formattype=FORMAT_VideoInfo;
+ VIDEOINFOHEADER* v=(VIDEOINFOHEADER*)mt.AllocFormatBuffer(sizeof(VIDEOINFOHEADER)); memset(v,0,sizeof(*v)); v->bmiHeader.biWidth=w; v->bmiHeader.biHeight=h; v->bmiHeader.biBitCount=32; v->bmiHeader.biPlanes=1; return mt; }
+const int W=320, H=240, N=20000;
+CVideoMux* g_m; volatile LONG g_stop=0;
+struct Arg { int slave; int pool; long long waitns; };
+static long long now(){ timespec t; clock_gettime(CLOCK_MONOTONIC,&t); return t.tv_sec*1000000000LL+t.tv_nsec; }
+DWORD SlaveProc(LPVOID p){
+ Arg* a=(Arg*)p; std::vector<RefSample*> pool; for(int i=0;i<a->pool;i++) pool.push_back(new RefSample(W*4*H));
+ long long maxns=0;
+ for(DWORD f=1; f<=(DWORD)N; f++){
+  RefSample* s=0; while(!s){ for(size_t i=0;i<pool.size();i++) if(pool[i]->ref==1){ s=pool[i]; break; } if(!s) sched_yield(); }
+  DWORD v=(a->slave<<24)|f; DWORD* d=(DWORD*)&s->buf[0]; for(int k=0;k<W*H;k++) d[k]=v;
+  long long t0=now(); g_m->GetSlaveInput(a->slave)->Receive(s); long long dt=now()-t0; if(dt>maxns) maxns=dt;
+ }
+ a->waitns=maxns;
+ while(1){ bool all=true; for(size_t i=0;i<pool.size();i++) if(pool[i]->ref!=1) all=false; if(all||g_stop) break; sched_yield(); }
+ for(size_t i=0;i<pool.size();i++) delete pool[i];
+ return 0;
+}
+int main(){
+ HRESULT hr; CVideoMux* m=(CVideoMux*)CVideoMux::CreateInstance(0,&hr); g_m=m;
+ m->SetCellSize(W,H); m->SetGrid(2,2);
+ CMediaType mt=MakeType(W,H); m->GetPinCount(); m->m_pInput->MockConnect(mt);
+ IMemAllocator a3, a1; ALLOCATOR_PROPERTIES p={3,0,1,0}, act; a3.SetProperties(&p,&act); p.cBuffers=1; a1.SetProperties(&p,&act);
+ for(int i=0;i<3;i++){ m->GetSlaveInput(i)->MockConnect(mt); m->GetSlaveInput(i)->NotifyAllocator(i<2?&a3:&a1,TRUE); }
+ CMediaType omt; m->GetMediaType(0,&omt); m->m_pOutput->MockConnect(omt);
+ m->Pause();
+ Arg args[3]={{0,3,0},{1,3,0},{2,1,0}}; HANDLE th[3];
+ for(int i=0;i<3;i++) th[i]=CreateThread(0,0,SlaveProc,&args[i],0,0);
+ FakeSample src(W*4*H), dst(W*4*H*4);
+ int torn=0, frames=0; DWORD last[3]={0,0,0}; int back=0;
+ long long t0=now();
+ while(frames<4000 || (args[0].waitns==0||args[1].waitns==0||args[2].waitns==0)){
+  { CAutoLock l(&m->m_csReceive); m->Transform(&src,&dst); }
+  frames++;
+  for(int s=0;s<3;s++){ int cell=s+1, row=1-cell/2; DWORD* t=(DWORD*)&dst.buf[0]+(row*H)*W*2+(cell%2)*W;
+   DWORD v=t[0]; for(int y=0;y<H;y++) for(int x=0;x<W;x++) if(t[y*W*2+x]!=v){ torn++; y=H; break; }
+   if(v && (v>>24)!=(DWORD)s) torn++;
+   if(v && (v&0xffffff)<(last[s]&0xffffff)) back++; if(v) last[s]=v; }
+  if(now()-t0>60000000000LL) break;
+ }
+ VIDEOMUX_SLAVE_STATS st[3];
+ while(args[0].waitns==0||args[1].waitns==0||args[2].waitns==0) sched_yield();
+ for(int i=0;i<3;i++) m->GetSlaveStats(i,&st[i]);
+ m->Stop(); g_stop=1;
+ for(int i=0;i<3;i++){ WaitForSingleObject(th[i],INFINITE); CloseHandle(th[i]); }
+ printf("frames %d torn %d backwards %d\n",frames,torn,back);
+ for(int i=0;i<3;i++) printf("slave %d received %ld slaveOverlaps %ld masterOverlaps %ld max Receive %.1f us\n",i,(long)st[i].nReceived,(long)st[i].nSlaveOverlaps,(long)st[i].nMasterOverlaps,args[i].waitns/1000.0);
+ CHECK(torn==0); CHECK(back==0); for(int i=0;i<3;i++) CHECK(st[i].nReceived==N);
+ delete m;
+ printf("fails %d\n",fails);
+ return fails!=0;
+}
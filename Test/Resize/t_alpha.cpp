@@ -0,0 +1,93 @@
+#include "streams.h"
+#define private public
+#include "VideoResizeBase.h"
+#undef private
+#include "sample.h"
+#include "Utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+GUID* subs[]={&MEDIASUBTYPE_ARGB32,&MEDIASUBTYPE_ARGB1555,&MEDIASUBTYPE_ARGB4444};
+const char* names[]={"ARGB32","ARGB1555","ARGB4444"};
+int bpp[]={4,2,2};
+int main(){
+ int fails=0;
+ // line functions: SIMD == C, premultiply exact, roundtrip of opaque
+ for(int f=0;f<3;f++){
+  PFN_CONVERT_LINE pc,uc,ps,us;
+  if(GetPremultiplyLine(subs[f],0,&pc,&uc)!=S_OK||GetPremultiplyLine(subs[f],GetSimdFlags(),&ps,&us)!=S_OK){printf("get fail\n");return 1;}
+  for(int n=1;n<70;n++) for(int it=0;it<50;it++){
+   std::vector<BYTE> src(n*bpp[f]), p1(n*4), p2(n*4), u1(n*bpp[f]), u2(n*bpp[f]), q(n*4);
+   for(size_t i=0;i<src.size();i++) src[i]=rand();
+   pc(&p1[0],&src[0],n); ps(&p2[0],&src[0],n);
+   if(p1!=p2){printf("%s premul simd!=c n=%d\n",names[f],n);fails++;break;}
+   for(size_t i=0;i<q.size();i++) q[i]=rand();   // not premultiplied, c > a too
+   uc(&u1[0],&q[0],n); us(&u2[0],&q[0],n);
+   if(u1!=u2){printf("%s unpremul simd!=c n=%d\n",names[f],n);fails++;break;}
+  }
+  // exhaustive pixels
+  if(f==0){
+   int bad=0, maxd=0;
+   for(int a=0;a<256;a++) for(int c=0;c<256;c++){
+    BYTE s[4]={(BYTE)c,(BYTE)c,(BYTE)c,(BYTE)a}, p[4], u[4];
+    pc(p,s,1); if(p[0]!=(int)floor(c*a/255.0+0.5)) bad++;
+    uc(u,p,1); if(a==255 && u[0]!=c) bad++;
+    if(a>0){ BYTE pp[4]={(BYTE)min(c,a),0,0,(BYTE)a}; uc(u,pp,1); int e=(int)floor(min(c,a)*255.0/a+0.5); if(e>255)e=255; int d=abs(u[0]-e); if(d>maxd)maxd=d; }
+   }
+   printf("ARGB32 exhaustive bad=%d unpremul maxd=%d\n",bad,maxd); if(bad||maxd>1) fails++;
+  } else {
+   int bad=0;
+   for(int v=0;v<65536;v++){ WORD s=(WORD)v, u; BYTE p[4]; pc(p,(BYTE*)&s,1); uc((BYTE*)&u,p,1);
+    bool opaque = f==1 ? (v&0x8000)!=0 : (v>>12)==15;
+    if(opaque && u!=s) bad++;
+    if(f==1 && !(v&0x8000) && (p[0]|p[1]|p[2]|p[3])) bad++;
+   }
+   printf("%s exhaustive bad=%d\n",names[f],bad); if(bad) fails++;
+  }
+ }
+ // resizer == premultiply, RGB32 resize, unpremultiply
+ int sizes[][4]={{64,48,32,24},{64,48,100,70},{1920,1080,1280,720},{33,17,7,5},{5,3,40,30},{640,480,160,120},{300,200,299,201},{3840,64,1920,32}};
+ CWorkerPool pool; pool.SetThreadCount(4);
+ RECT rois[]={{0,0,0,0},{3,5,41,30},{10,0,30,40}};
+ for(int f=0;f<3;f++) for(int al=0;al<=4;al++) for(int si=0;si<8;si++) for(int o=0;o<2;o++) for(int ri=0;ri<3;ri++){
+  int sw=sizes[si][0], sh=sizes[si][1], dw=sizes[si][2], dh=sizes[si][3];
+  if(ri && (sw<41||sh<40)) continue;
+  int nh = o ? -sh : sh;
+  HRESULT hr; CVideoResizeBase* r=new CVideoResizeBase(dw,dh,&hr); CVideoResizeBase* r0=new CVideoResizeBase(dw,dh,&hr);
+  r->SetMediaSubType(subs[f]); r->SetAlgorithm(al); r0->SetMediaSubType(&MEDIASUBTYPE_RGB32); r0->SetAlgorithm(al);
+  r->SetSourceRect(&rois[ri]); r0->SetSourceRect(&rois[ri]);
+  if(si==2||si==5){ r->SetWorkerPool(&pool); r0->SetWorkerPool(&pool); }
+  // premultiplied on load by tile
+  if(si==7){ r->SetTiling(RESIZE_TILING_TILES); r0->SetTiling(RESIZE_TILING_TILES); r->SetWorkerPool(&pool); r0->SetWorkerPool(&pool); }
+  int ss=r->CalcStride(sw), ds=r->CalcStride(dw);
+  FakeSample src(ss*sh), dst(r->GetSize()), psrc(sw*4*sh), pdst(r0->GetSize());
+  for(size_t i=0;i<src.buf.size();i++) src.buf[i]=(BYTE)rand();
+  // transparent blocks
+  for(int y=0;y<sh;y++) for(int x=0;x<sw;x++) if(((x/4)+(y/4))%3==0){ BYTE* p=&src.buf[y*ss+x*bpp[f]]; if(f==0)p[3]=0; else p[1]&=0x0f&(f==1?0x7f:0x0f); }
+  PFN_CONVERT_LINE pc,uc; GetPremultiplyLine(subs[f],0,&pc,&uc);
+  for(int y=0;y<sh;y++) pc(&psrc.buf[y*sw*4],&src.buf[y*ss],sw);
+  HRESULT h1=r->Transform(&src,sw,nh,&dst), h2=r0->Transform(&psrc,sw,nh,&pdst);
+  std::vector<BYTE> line(ds);
+  int bad=0;
+  for(int y=0;y<dh;y++){ uc(&line[0],&pdst.buf[y*dw*4],dw); if(memcmp(&line[0],&dst.buf[y*ds],dw*bpp[f])) bad++; }
+  bool same = sw==dw && sh==dh && ri==0;
+  if(si==7 && ri==0 && al>=2 && r->m_nTileWidth>=dw){ printf("%s al%d not tiled FAIL\n",names[f],al); fails++; }
+  bool ok=h1==S_OK&&h2==S_OK&&(bad==0||same||!r->m_bPremultiply)&&(same || r->m_bPremultiply==(al!=0||r->m_bAreaAverage));
+  if(!ok) fails++;
+  if(!ok||(si==0&&o==0&&ri==0)) printf("%s al%d %dx%d->%dx%d o%d roi%d bad=%d pm=%d area=%d %s\n",names[f],al,sw,sh,dw,dh,o,ri,bad,r->m_bPremultiply,r->m_bAreaAverage,ok?"ok":"FAIL");
+  delete r; delete r0;
+ }
+ // no bleed: transparent red next to opaque green
+ for(int al=1;al<=4;al++){
+  HRESULT hr; CVideoResizeBase* r=new CVideoResizeBase(37,29,&hr); r->SetMediaSubType(&MEDIASUBTYPE_ARGB32); r->SetAlgorithm(al);
+  FakeSample src(64*4*48), dst(r->GetSize());
+  for(int y=0;y<48;y++) for(int x=0;x<64;x++){ DWORD* p=(DWORD*)&src.buf[(y*64+x)*4]; *p = ((x/8+y/8)&1) ? 0x00ff0000 : 0xff00ff00; }
+  r->Transform(&src,64,48,&dst);
+  int red=0; for(int i=0;i<37*29;i++){ BYTE* p=&dst.buf[i*4]; if(p[3] && p[2]) red++; }
+  printf("bleed al%d red=%d\n",al,red); if(red) fails++;
+  delete r;
+ }
+ pool.SetThreadCount(2);
+ printf("fails %d\n",fails);
+ return fails;
+}
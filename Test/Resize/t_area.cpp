@@ -0,0 +1,35 @@
+#include "streams.h"
+#define private public
+#include "VideoResizeBase.h"
+#undef private
+#include "sample.h"
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+GUID* subs[]={&MEDIASUBTYPE_RGB24,&MEDIASUBTYPE_RGB32};
+int main(){
+ int sizes[][4]={{1920,1080,320,240},{3840,2160,320,240},{640,480,320,240},{641,481,320,240},{1000,600,7,5},{3000,700,2,2},{639,479,320,240},{1920,1080,960,540}};
+ int fails=0;
+ for(int al=0; al<=1; al++)
+ for(int si=0;si<8;si++) for(int b=0;b<2;b++){
+  int sw=sizes[si][0], sh=sizes[si][1], dw=sizes[si][2], dh=sizes[si][3];
+  HRESULT hr; CVideoResizeBase* r=new CVideoResizeBase(dw,dh,&hr);
+  r->SetMediaSubType(subs[b]); r->SetAlgorithm(al);
+  int bpp=r->m_nBytesPerPixel; int ss=r->CalcStride(sw);
+  FakeSample src(ss*sh), d1(r->GetSize()), d2(r->GetSize());
+  for(size_t i=0;i<src.buf.size();i++) src.buf[i]=(BYTE)rand();
+  hr=r->Transform(&src,sw,sh,&d1);
+  GetResizeKernels(subs[b],0,&r->m_Kernels);
+  r->Transform(&src,sw,sh,&d2);
+  int ds=r->CalcStride(dw); int maxerr=0;
+  if(r->m_bAreaAverage) for(int y=0;y<dh;y++) for(int x=0;x<dw;x++) for(int c=0;c<bpp;c++){
+    int x0=(long long)sw*x/dw,x1=(long long)sw*(x+1)/dw,y0=(long long)sh*y/dh,y1=(long long)sh*(y+1)/dh; double s=0;
+    for(int yy=y0;yy<y1;yy++)for(int xx=x0;xx<x1;xx++) s+=src.buf[yy*ss+xx*bpp+c];
+    int e=abs((int)lround(s/((x1-x0)*(y1-y0)))-d1.buf[y*ds+x*bpp+c]); if(e>maxerr)maxerr=e; }
+  bool ok = hr==S_OK && d1.buf==d2.buf && maxerr<=1;
+  if(!ok) fails++;
+  printf("al%d %dx%d->%dx%d bpp%d area=%d maxerr=%d %s\n",al,sw,sh,dw,dh,bpp,r->m_bAreaAverage,maxerr, ok?"ok":"FAIL");
+  delete r;
+ }
+ return fails;
+}
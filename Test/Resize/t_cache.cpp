@@ -0,0 +1,53 @@
+#include "streams.h"
+#define private public
+#include "VideoResizeBase.h"
+#undef private
+#include "sample.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ScaleTable.cpp"
+GUID* subs[]={&MEDIASUBTYPE_RGB8,&MEDIASUBTYPE_RGB565,&MEDIASUBTYPE_RGB24,&MEDIASUBTYPE_RGB32};
+int fails=0;
+// NN reference: pixel floor(x*sw/dw), line floor(y*sh/dh)
+void nnref(){
+ int sizes[][4]={{640,480,320,240},{1000,500,320,240},{100,50,320,240},{33,17,320,240},{1280,720,1920,1080},{7,3,5,2},{1,1,9,9}};
+ for(int si=0;si<7;si++) for(int b=0;b<4;b++){
+  int sw=sizes[si][0], sh=sizes[si][1], dw=sizes[si][2], dh=sizes[si][3];
+  HRESULT hr; CVideoResizeBase* r=new CVideoResizeBase(dw,dh,&hr);
+  r->SetMediaSubType(subs[b]); r->SetAlgorithm(RESIZE_NEAREST);
+  int bpp=r->m_nBytesPerPixel, ss=r->CalcStride(sw), ds=r->CalcStride(dw);
+  if(bpp>=3 && sw>=dw*2 && sh>=dh*2){delete r; continue;} // area average
+  FakeSample src(ss*sh), d(r->GetSize());
+  for(size_t i=0;i<src.buf.size();i++) src.buf[i]=(BYTE)rand();
+  r->Transform(&src,sw,sh,&d);
+  bool ok=true;
+  for(int y=0;y<dh&&ok;y++) for(int x=0;x<dw&&ok;x++){
+   long long sx=(long long)x*sw/dw, sy=(long long)y*sh/dh;
+   if(memcmp(&d.buf[y*ds+x*bpp],&src.buf[sy*ss+sx*bpp],bpp)) ok=false;
+  }
+  if(!ok){fails++; printf("nn FAIL %dx%d->%dx%d bpp%d\n",sw,sh,dw,dh,bpp);}
+  delete r;
+ }
+}
+int main(){
+ nnref();
+ // same geometry shares a table; it's kept after release
+ HRESULT hr;
+ CVideoResizeBase* a=new CVideoResizeBase(320,240,&hr);
+ CVideoResizeBase* b=new CVideoResizeBase(320,240,&hr);
+ a->SetMediaSubType(&MEDIASUBTYPE_RGB32); b->SetMediaSubType(&MEDIASUBTYPE_RGB32);
+ a->SetAlgorithm(RESIZE_LANCZOS3); b->SetAlgorithm(RESIZE_LANCZOS3);
+ FakeSample src(640*4*480), d1(a->GetSize()), d2(b->GetSize());
+ a->Transform(&src,640,480,&d1); b->Transform(&src,640,-480,&d2);
+ if(a->m_pTable!=b->m_pTable || a->m_pTable->m_cRef!=2){fails++; printf("share FAIL\n");}
+ CScaleTable* t=a->m_pTable;
+ delete a; if(t->m_cRef!=1){fails++; printf("ref FAIL\n");}
+ delete b; if(t->m_cRef!=0||g_pScaleTables!=t){fails++; printf("keep FAIL\n");}
+ // the cache trims to SCALE_TABLE_CACHE unused
+ for(int i=0;i<20;i++){ CVideoResizeBase* c=new CVideoResizeBase(320,240,&hr); c->SetMediaSubType(&MEDIASUBTYPE_RGB24); FakeSample s((100+i)*3*(100+i)+400), d(c->GetSize()); c->Transform(&s,100+i,100+i,&d); delete c; }
+ int n=0; for(CScaleTable* p=g_pScaleTables;p;p=p->m_pNext) n++;
+ if(n!=SCALE_TABLE_CACHE){fails++; printf("trim FAIL %d\n",n);}
+ printf("%s\n",fails?"FAIL":"ok");
+ return fails;
+}
@@ -0,0 +1,60 @@
+#include "streams.h"
+#define private public
+#include "VideoResizeBase.h"
+#undef private
+#include "sample.h"
+#include "Utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+GUID* subs[]={&MEDIASUBTYPE_RGB24,&MEDIASUBTYPE_YUY2,&MEDIASUBTYPE_UYVY};
+const char* names[]={"RGB24","YUY2","UYVY"};
+int clampi(double v){ int n=(int)floor(v+0.5); return n<0?0:n>255?255:n; }
+int main(){
+ int fails=0;
+ // SIMD == C, and close to the float formula
+ for(int b=0;b<3;b++){
+  PFN_CONVERT_LINE c,s; GetConvertLine(subs[b],&MEDIASUBTYPE_RGB32,0,&c); GetConvertLine(subs[b],&MEDIASUBTYPE_RGB32,GetSimdFlags(),&s);
+  for(int n=2;n<300;n+=2){
+   std::vector<BYTE> src(n*3+1), d1(n*4), d2(n*4);
+   for(size_t i=0;i<src.size();i++) src[i]=rand();
+   if(n==298) for(size_t i=0;i<src.size();i++) src[i]=(i&1)?255:0;
+   c(&d1[0],&src[0],n); s(&d2[0],&src[0],n);
+   int maxd=0;
+   if(b>0) for(int x=0;x<n;x++){ int lo=b-1; const BYTE* p=&src[(x/2)*4];
+    double Y=p[(x&1)*2+lo]-16, U=p[1-lo]-128, V=p[3-lo]-128;
+    int rgb[3]={clampi(1.164383*Y+2.017232*U), clampi(1.164383*Y-0.391762*U-0.812968*V), clampi(1.164383*Y+1.596027*V)};
+    for(int k=0;k<3;k++) {int dd=abs(rgb[k]-d1[x*4+k]); if(dd>maxd) maxd=dd;}; }
+   if(d1!=d2 || maxd>1){ printf("%s n=%d simd!=c or maxd=%d\n",names[b],n,maxd); fails++; }
+  }
+ }
+ int sizes[][4]={{640,480,320,240},{640,480,1280,720},{1920,1080,1280,720},{2,2,8,6},{4,4,2,2},{100,50,36,70},{320,240,320,240},{6,4,200,100}};
+ CWorkerPool pool; pool.SetThreadCount(4);
+ for(int al=0; al<=4; al++) for(int si=0;si<8;si++) for(int b=0;b<3;b++) for(int o=0;o<4;o++){
+  int sw=sizes[si][0], sh=sizes[si][1], dw=sizes[si][2], dh=sizes[si][3];
+  bool yuv=b>0; bool srcTD = (o&1) || yuv; int nh = (o&1)&&!yuv ? -sh : sh; bool dstTD = (o&2)!=0;
+  HRESULT hr; CVideoResizeBase* r=new CVideoResizeBase(dw,dh,&hr);
+  r->SetMediaSubType(subs[b]); r->SetAlgorithm(al);
+  if(r->SetOutputSubType(&MEDIASUBTYPE_RGB32)!=S_OK){ printf("set fail\n"); fails++; continue; }
+  r->SetTopDown(dstTD);
+  if(si==2) r->SetWorkerPool(&pool);
+  CVideoResizeBase* r0=new CVideoResizeBase(dw,dh,&hr);
+  r0->SetMediaSubType(subs[b]); r0->SetAlgorithm(al); r0->SetTopDown(yuv?FALSE:srcTD);
+  int ss=r->CalcStride(sw), ds0=r0->CalcStride(dw), ds=r->CalcOutputStride(dw);
+  FakeSample src(ss*sh), dst(r->GetSize()), ref(r0->GetSize());
+  for(size_t i=0;i<src.buf.size();i++) src.buf[i]=(BYTE)rand();
+  HRESULT h1=r->Transform(&src,sw,nh,&dst);
+  HRESULT h2=r0->Transform(&src,sw,nh,&ref);
+  PFN_CONVERT_LINE c; GetConvertLine(subs[b],&MEDIASUBTYPE_RGB32,0,&c);
+  std::vector<BYTE> line(dw*4);
+  int bad=0;
+  for(int y=0;y<dh;y++){ int ry = (srcTD!=dstTD) ? dh-1-y : y; c(&line[0],&ref.buf[ry*ds0],dw);
+   if(memcmp(&line[0],&dst.buf[y*ds],dw*4)) bad++; }
+  bool ok = h1==S_OK && h2==S_OK && bad==0 && dst.actual==ds*dh && r->GetSize()==dw*4*dh;
+  if(!ok) fails++;
+  if(!ok || (o==0&&si<3)) printf("al%d %s %dx%d->%dx%d o%d bad=%d inline=%d %s\n",al,names[b],sw,sh,dw,dh,o,bad,r->m_bInline,ok?"ok":"FAIL");
+  delete r; delete r0;
+ }
+ pool.SetThreadCount(2);
+ return fails;
+}
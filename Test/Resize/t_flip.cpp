@@ -0,0 +1,33 @@
+#include "streams.h"
+#define private public
+#include "VideoResizeBase.h"
+#undef private
+#include "sample.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+GUID* subs[]={&MEDIASUBTYPE_RGB8,&MEDIASUBTYPE_RGB565,&MEDIASUBTYPE_RGB24,&MEDIASUBTYPE_RGB32};
+// flipped output equals the lines of the unflipped output upside down
+int main(){
+ int fails=0; CWorkerPool pool; pool.SetThreadCount(3);
+ int sizes[][4]={{640,480,320,240},{1920,1080,320,240},{320,240,320,240},{100,50,320,240},{1280,720,1920,1080}};
+ for(int al=0; al<=4; al++) for(int si=0;si<5;si++) for(int b=0;b<4;b++) for(int pl=0;pl<2;pl++){
+  int sw=sizes[si][0], sh=sizes[si][1], dw=sizes[si][2], dh=sizes[si][3];
+  if(sw!=dw && sw*dh!=sh*dw) {} 
+
+  HRESULT hr; CVideoResizeBase* r=new CVideoResizeBase(dw,dh,&hr);
+  r->SetMediaSubType(subs[b]); r->SetAlgorithm(al); if(pl) r->SetWorkerPool(&pool);
+  int ss=r->CalcStride(sw), ds=r->CalcStride(dw);
+  FakeSample src(ss*sh), d1(r->GetSize()), d2(r->GetSize()), d3(r->GetSize());
+  for(size_t i=0;i<src.buf.size();i++) src.buf[i]=(BYTE)rand();
+  r->SetTopDown(FALSE); HRESULT h1=r->Transform(&src,sw,sh,&d1);
+  r->SetTopDown(TRUE);  HRESULT h2=r->Transform(&src,sw,sh,&d2);
+  HRESULT h3=r->Transform(&src,sw,-sh,&d3); // top-down in, top-down out
+  bool ok=h1==S_OK&&h2==S_OK&&h3==S_OK&&d2.actual==r->GetSize();
+  for(int y=0;y<dh&&ok;y++) ok = !memcmp(&d1.buf[y*ds],&d2.buf[(dh-1-y)*ds],dw*r->m_nBytesPerPixel) && !memcmp(&d1.buf[y*ds],&d3.buf[y*ds],dw*r->m_nBytesPerPixel);
+  if(!ok){fails++; printf("FAIL al%d %dx%d->%dx%d b%d pool%d\n",al,sw,sh,dw,dh,b,pl);}
+  delete r;
+ }
+ printf("%s\n", fails?"FAIL":"ok");
+ return fails;
+}
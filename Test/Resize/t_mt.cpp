@@ -0,0 +1,20 @@
+#include "streams.h"
+#define private public
+#include "VideoResizeBase.h"
+#undef private
+#include "sample.h"
+#include <stdio.h>
+#include <pthread.h>
+// resizers on several threads share the cache
+void* run(void* p){
+ long id=(long)p; HRESULT hr;
+ for(int i=0;i<60;i++){
+  CVideoResizeBase* r=new CVideoResizeBase(64+(i%3)*16,48,&hr);
+  r->SetMediaSubType(&MEDIASUBTYPE_RGB32); r->SetAlgorithm((i+id)%5);
+  int sw=100+(i*7+id)%13*10, sh=80;
+  FakeSample s(sw*4*sh), d(r->GetSize());
+  r->Transform(&s,sw,sh,&d); delete r;
+ }
+ return 0;
+}
+int main(){ pthread_t t[4]; for(long i=0;i<4;i++) pthread_create(&t[i],0,run,(void*)i); for(int i=0;i<4;i++) pthread_join(t[i],0); printf("ok\n"); return 0;}
@@ -0,0 +1,27 @@
+#include "streams.h"
+#define private public
+#include "VideoResizeBase.h"
+#undef private
+#include "sample.h"
+#include <stdio.h>
+GUID* subs[]={&MEDIASUBTYPE_RGB8,&MEDIASUBTYPE_RGB565,&MEDIASUBTYPE_RGB24,&MEDIASUBTYPE_RGB32};
+int main(){
+ int sizes[][4]={{1920,1080,320,240},{640,480,320,240},{1000,500,320,240},{1280,720,320,240},{3840,2160,320,240},{1920,1080,320,240}};
+ int fails=0;
+ for(int si=0;si<6;si++) for(int b=0;b<4;b++){
+  int sw=sizes[si][0], sh=sizes[si][1];
+  HRESULT hr; CVideoResizeBase* r=new CVideoResizeBase(sizes[si][2],sizes[si][3],&hr);
+  r->SetMediaSubType(subs[b]);
+  int bpp=r->m_nBytesPerPixel;
+  FakeSample src(r->CalcStride(sw)*sh), d1(r->GetSize()), d2(r->GetSize());
+  for(size_t i=0;i<src.buf.size();i++) src.buf[i]=rand();
+  r->Transform(&src,sw,sh,&d1);
+  PFN_SCALE_LINE f=r->m_Kernels.pfnScaleLine; r->m_Kernels.pfnScaleLine=NULL;
+  r->Transform(&src,sw,sh,&d2);
+  bool ok = d1.buf==d2.buf && f!=NULL;
+  if(!ok) fails++;
+  printf("%dx%d bpp%d simd=%d %s\n",sw,sh,bpp,r->m_pTable->m_nSimdCount, ok?"ok":"FAIL");
+  delete r;
+ }
+ return fails;
+}
@@ -0,0 +1,78 @@
+#include "streams.h"
+#define private public
+#include "VideoResizeBase.h"
+#undef private
+#include "sample.h"
+#include "Utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+// 10 bit kernels: SIMD == C; resize of b*4+(b>>6) ~ RGB32 resize of b
+int main(){
+ int fails=0;
+ GUID* subs[]={&MEDIASUBTYPE_A2R10G10B10,&MEDIASUBTYPE_A2B10G10R10};
+ RESIZE_KERNELS kc, ks; GetResizeKernels(subs[0],0,&kc); GetResizeKernels(subs[0],GetSimdFlags(),&ks);
+ if(!kc.pfnPolyphaseHC||!kc.pfnAreaOut||kc.nAreaMaxLines!=64){printf("kernels FAIL\n");return 1;}
+ for(int it=0;it<3000;it++){
+  int n=1+rand()%40, sw=n*3+8;
+  std::vector<BYTE> src(sw*4+64); for(size_t i=0;i<src.size();i++) src[i]=rand();
+  std::vector<ULONG> ws(n), ww(n); for(int i=0;i<n;i++){ ws[i]=(rand()%(sw-1))*4; ww[i]=rand()&0xffff; }
+  std::vector<short> a(n*4+8), b(n*4+8);
+  kc.pfnBilinearHC(&a[0],&src[0],&ws[0],&ww[0],4,n); if(ks.pfnBilinearH) ks.pfnBilinearH(&b[0],&src[0],&ws[0],&ww[0],4,n); else b=a;
+  if(a!=b){printf("bilinear H FAIL n=%d\n",n);fails++;break;}
+  for(int i=0;i<n*4;i++) if(a[i]<0||a[i]>1023*16){printf("bilinear H range FAIL\n");fails++;break;}
+  std::vector<short> r0(n*4), r1(n*4); for(int i=0;i<n*4;i++){ r0[i]=rand()%(1023*16+1); r1[i]=rand()%(1023*16+1); }
+  std::vector<BYTE> d1(n*4), d2(n*4); ULONG w=rand()&0xffff;
+  kc.pfnBilinearV(&d1[0],&r0[0],&r1[0],w,n*4); ks.pfnBilinearV(&d2[0],&r0[0],&r1[0],w,n*4);
+  if(d1!=d2){printf("bilinear V FAIL n=%d\n",n);fails++;break;}
+  int taps=2+2*(rand()%4); std::vector<short> coef(n*taps); std::vector<ULONG> st(n);
+  for(int i=0;i<n;i++){ st[i]=(rand()%(sw-taps))*4; int s=0; for(int t=0;t<taps;t++){ coef[i*taps+t]=(short)(rand()%3000-600); s+=coef[i*taps+t]; } coef[i*taps]+=16384-s; }
+  // coefficient sums of 1.0 keep the range; clip extreme taps
+  kc.pfnPolyphaseHC(&a[0],&src[0],&st[0],&coef[0],taps,n); if(ks.pfnPolyphaseH) ks.pfnPolyphaseH(&b[0],&src[0],&st[0],&coef[0],taps,n); else b=a;
+  if(!std::equal(a.begin(),a.begin()+n*4,b.begin())){printf("poly H FAIL n=%d taps=%d\n",n,taps);fails++;break;}
+  int vt=1+rand()%7; std::vector<std::vector<short> > rows(vt,std::vector<short>(n*4)); std::vector<const short*> pr(vt); std::vector<short> hc(vt);
+  int s=0; for(int t=0;t<vt;t++){ for(int i=0;i<n*4;i++) rows[t][i]=rand()%(1023*16+1)-100; pr[t]=&rows[t][0]; hc[t]=(short)(rand()%8000-2000); s+=hc[t]; } hc[0]+=16384-s;
+  kc.pfnPolyphaseV(&d1[0],&pr[0],&hc[0],vt,n*4); ks.pfnPolyphaseV(&d2[0],&pr[0],&hc[0],vt,n*4);
+  if(d1!=d2){printf("poly V FAIL n=%d taps=%d\n",n,vt);fails++;break;}
+  std::vector<WORD> acc1(n*4+4), acc2; for(size_t i=0;i<acc1.size();i++) acc1[i]=rand()%1000; acc2=acc1;
+  kc.pfnAreaV(&acc1[0],&src[0],n*4); ks.pfnAreaV(&acc2[0],&src[0],n*4);
+  if(acc1!=acc2){printf("area V FAIL n=%d\n",n);fails++;break;}
+ }
+ // pack/unpack of the values: a 1 pixel identity bilinear
+ for(int v=0;v<4;v++){ DWORD p=0x3ff|(0x155<<10)|(0x2aa<<20)|((DWORD)v<<30), q; ULONG o=0, wt=0; short row[8];
+  kc.pfnBilinearHC(row,(BYTE*)&p,&o,&wt,0,1); kc.pfnBilinearV((BYTE*)&q,row,row,0,4);
+  if(p!=q){printf("identity FAIL %08x %08x\n",p,q);fails++;} }
+ // resize ~ RGB32 resize
+ int sizes[][4]={{64,48,32,24},{64,48,100,70},{1920,1080,1280,720},{33,17,7,5},{5,3,40,30},{640,480,160,120},{300,200,299,201},{1280,720,100,40}};
+ CWorkerPool pool; pool.SetThreadCount(4);
+ for(int f=0;f<2;f++) for(int al=0;al<=4;al++) for(int si=0;si<8;si++) for(int o=0;o<2;o++){
+  int sw=sizes[si][0], sh=sizes[si][1], dw=sizes[si][2], dh=sizes[si][3];
+  int nh = o ? -sh : sh;
+  HRESULT hr; CVideoResizeBase* r=new CVideoResizeBase(dw,dh,&hr); CVideoResizeBase* r0=new CVideoResizeBase(dw,dh,&hr);
+  r->SetMediaSubType(subs[f]); r->SetAlgorithm(al); r0->SetMediaSubType(&MEDIASUBTYPE_RGB32); r0->SetAlgorithm(al);
+  if(si==2||si==5){ r->SetWorkerPool(&pool); r0->SetWorkerPool(&pool); }
+  int ss=r->CalcStride(sw), ds=r->CalcStride(dw);
+  FakeSample src(ss*sh), dst(r->GetSize()), s8(sw*4*sh), d8(r0->GetSize());
+  for(int y=0;y<sh;y++) for(int x=0;x<sw;x++){
+   BYTE* p8=&s8.buf[(y*sw+x)*4]; int sm=((x/7)+(y/5))%2;
+   for(int c=0;c<3;c++) p8[c]=sm ? (BYTE)(x*3+y*c) : (BYTE)rand();
+   int a2 = rand()%4; p8[3]=(BYTE)(a2*85);
+   DWORD v=0; for(int c=0;c<3;c++) v|=(DWORD)(p8[c]*4+(p8[c]>>6))<<(c*10); v|=(DWORD)a2<<30;
+   *(DWORD*)&src.buf[y*ss+x*4]=v;
+  }
+  HRESULT h1=r->Transform(&src,sw,nh,&dst), h2=r0->Transform(&s8,sw,nh,&d8);
+  int maxd=0, maxa=0;
+  for(int y=0;y<dh;y++) for(int x=0;x<dw;x++){
+   DWORD v=*(DWORD*)&dst.buf[y*ds+x*4]; BYTE* p8=&d8.buf[(y*dw+x)*4];
+   for(int c=0;c<3;c++){ int d=abs((int)((v>>(c*10))&0x3ff) - (p8[c]*4+(p8[c]>>6))); if(d>maxd) maxd=d; }
+   int da=abs((int)(v>>30)*85 - p8[3]); if(da>maxa) maxa=da;
+  }
+  // 8 bit reference rounds to 4 steps of 10 bit, alpha within a step
+  bool interp = al!=0 || r->m_bAreaAverage;
+  bool ok=h1==S_OK&&h2==S_OK&&maxd<=(interp?5:0)&&maxa<=(interp?43:0)&&r->m_nScaleMode==r0->m_nScaleMode&&r->m_bAreaAverage==r0->m_bAreaAverage;
+  if(!ok) fails++;
+  if(!ok||(si==0&&o==0)||si==7) printf("f%d al%d %dx%d->%dx%d o%d maxd=%d maxa=%d mode=%d area=%d %s\n",f,al,sw,sh,dw,dh,o,maxd,maxa,r->m_nScaleMode,r->m_bAreaAverage,ok?"ok":"FAIL");
+  delete r; delete r0;
+ }
+ printf("fails %d\n",fails);
+ return fails!=0;
+}
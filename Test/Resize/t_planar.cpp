@@ -0,0 +1,42 @@
+#include "streams.h"
+#define private public
+#include "VideoResizeBase.h"
+#undef private
+#include "sample.h"
+#include <stdio.h>
+#include <stdlib.h>
+// planar resize == per-plane RGB32 resizes; pooled == inline
+static void plane(CVideoResizeBase* r, int al, const BYTE* s, int sp, int sw, int sh, int bpp, BYTE* d, int dp, int dw, int dh, int* bad){
+ HRESULT hr; CVideoResizeBase* q=new CVideoResizeBase(dw,dh,&hr); q->SetMediaSubType(&MEDIASUBTYPE_RGB32); q->SetAlgorithm(al);
+ FakeSample a(sw*4*sh), b(dw*4*dh);
+ for(int y=0;y<sh;y++) for(int x=0;x<sw;x++) for(int c=0;c<4;c++) a.buf[(y*sw+x)*4+c]=s[y*sp+x*bpp+(c%bpp)];
+ q->Transform(&a,sw,sh,&b);
+ for(int y=0;y<dh;y++) for(int x=0;x<dw;x++) for(int c=0;c<bpp;c++) if(d[y*dp+x*bpp+c]!=b.buf[(y*dw+x)*4+c]) (*bad)++;
+ delete q;
+}
+int main(){
+ GUID* subs[]={&MEDIASUBTYPE_NV12,&MEDIASUBTYPE_I420,&MEDIASUBTYPE_YV12,&MEDIASUBTYPE_IYUV};
+ int sizes[][4]={{1920,1080,1280,720},{640,480,1280,720},{1280,720,320,180},{100,50,36,70},{2,2,8,6},{1920,1080,640,360}};
+ int fails=0; CWorkerPool pool; pool.SetThreadCount(4);
+ for(int al=0; al<=4; al++) for(int si=0;si<6;si++) for(int f=0;f<4;f++){
+  int sw=sizes[si][0], sh=sizes[si][1], dw=sizes[si][2], dh=sizes[si][3];
+  HRESULT hr; CVideoResizeBase* r=new CVideoResizeBase(dw,dh,&hr);
+  r->SetMediaSubType(subs[f]); r->SetAlgorithm(al);
+  int ss=r->CalcStride(sw), ds=r->CalcStride(dw);
+  int srcSize=ss*sh*3/2;
+  FakeSample src(srcSize), d1(r->GetSize()), d2(r->GetSize());
+  for(size_t i=0;i<src.buf.size();i++) src.buf[i]=(BYTE)rand();
+  HRESULT h1=r->Transform(&src,sw,sh,&d1);
+  r->SetWorkerPool(&pool);
+  HRESULT h2=r->Transform(&src,sw,sh,&d2);
+  int bad=0, cb=r->m_Kernels.nChromaBytes, np=r->m_Kernels.nPlanes;
+  plane(r,al,&src.buf[0],ss,sw,sh,1,&d1.buf[0],ds,dw,dh,&bad);
+  for(int p=0;p<np-1;p++) plane(r,al,&src.buf[ss*sh+ss/2*cb*(sh/2)*p],ss/2*cb,sw/2,sh/2,cb,&d1.buf[ds*dh+ds/2*cb*(dh/2)*p],ds/2*cb,dw/2,dh/2,&bad);
+  bool ok = h1==S_OK && h2==S_OK && d1.buf==d2.buf && bad==0 && (int)d1.buf.size()==dw*dh*3/2;
+  if(!ok) fails++;
+  printf("al%d f%d %dx%d->%dx%d bad=%d inline=%d %s\n",al,f,sw,sh,dw,dh,bad,r->m_bInline,ok?"ok":"FAIL");
+  delete r;
+ }
+ pool.SetThreadCount(2);
+ return fails;
+}
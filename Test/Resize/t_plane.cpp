@@ -0,0 +1,29 @@
+#include "streams.h"
+#include "ResizeKernels.h"
+#include "Utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+// plane kernels of 1 and 2 bytes: SIMD == C, nothing read or written past the exact buffers
+int main(){
+ int fails=0;
+ for(int bpp=1;bpp<=2;bpp++){
+  RESIZE_KERNELS kc, ks; GetPlaneKernels(bpp,0,&kc); GetPlaneKernels(bpp,GetSimdFlags(),&ks);
+  if(GetSimdFlags()&SIMD_SSSE3) if(!ks.pfnBilinearH||!ks.pfnPolyphaseH){printf("bpp%d simd kernels FAIL\n",bpp);fails++;}
+  for(int it=0;it<5000;it++){
+   int n=1+rand()%41, sw=2+rand()%60;
+   std::vector<BYTE> src(sw*bpp); for(size_t i=0;i<src.size();i++) src[i]=rand();
+   std::vector<ULONG> ws(n), ww(n); for(int i=0;i<n;i++){ ws[i]=(rand()%(sw-1))*bpp; ww[i]=(it&1)? rand()&0xffff : 0x10000; }
+   std::vector<short> a(n*bpp), b(n*bpp);
+   kc.pfnBilinearHC(&a[0],&src[0],&ws[0],&ww[0],bpp,n); if(ks.pfnBilinearH) ks.pfnBilinearH(&b[0],&src[0],&ws[0],&ww[0],bpp,n); else b=a;
+   if(a!=b){printf("bpp%d bilinear H FAIL n=%d\n",bpp,n);fails++;break;}
+   int taps=2+2*(rand()%8); if(taps>sw) continue;
+   std::vector<short> coef(n*taps); std::vector<ULONG> st(n);
+   for(int i=0;i<n;i++){ st[i]=(rand()%(sw-taps+1))*bpp; int s=0; for(int t=0;t<taps;t++){ coef[i*taps+t]=(short)(rand()%3000-600); s+=coef[i*taps+t]; } coef[i*taps]+=256-s; }
+   kc.pfnPolyphaseHC(&a[0],&src[0],&st[0],&coef[0],taps,n); if(ks.pfnPolyphaseH) ks.pfnPolyphaseH(&b[0],&src[0],&st[0],&coef[0],taps,n); else b=a;
+   if(a!=b){printf("bpp%d poly H FAIL n=%d taps=%d\n",bpp,n,taps);fails++;break;}
+  }
+  printf("bpp%d bilinear %s polyphase %s\n",bpp,ks.pfnBilinearH?"simd":"C",ks.pfnPolyphaseH?"simd":"C");
+ }
+ printf("fails %d\n",fails);
+ return fails!=0;
+}
@@ -0,0 +1,36 @@
+#include "streams.h"
+#define private public
+#include "VideoResizeBase.h"
+#undef private
+#include "sample.h"
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+GUID* subs[]={&MEDIASUBTYPE_RGB24,&MEDIASUBTYPE_RGB32};
+int main(){
+ int sizes[][4]={{1920,1080,320,240},{640,480,320,240},{100,50,320,240},{37,19,320,240},{321,241,320,240},{1,1,320,240},{2,1,7,5},{1920,1080,1280,720},{3,3,16,16},{5,4,3,2}};
+ int fails=0;
+ for(int al=RESIZE_BICUBIC; al<=RESIZE_LANCZOS3; al++)
+ for(int si=0;si<10;si++) for(int b=0;b<2;b++){
+  int sw=sizes[si][0], sh=sizes[si][1], dw=sizes[si][2], dh=sizes[si][3];
+  HRESULT hr; CVideoResizeBase* r=new CVideoResizeBase(dw,dh,&hr);
+  r->SetMediaSubType(subs[b]); r->SetAlgorithm(al);
+  int bpp=r->m_nBytesPerPixel; int ss=r->CalcStride(sw);
+  FakeSample src(ss*sh), d1(r->GetSize()), d2(r->GetSize()), d3(r->GetSize());
+  for(int y=0;y<sh;y++) for(int x=0;x<sw;x++) for(int c=0;c<bpp;c++) src.buf[y*ss+x*bpp+c]=(BYTE)rand();
+  hr=r->Transform(&src,sw,sh,&d1);
+  CPolyphaseFilter& p=r->m_Polyphase;
+  RESIZE_KERNELS k; GetResizeKernels(subs[b],0,&k); p.m_pfnH=NULL; p.m_pfnV=k.pfnPolyphaseV;
+  r->Transform(&src,sw,sh,&d2);
+  // constant image stays constant
+  for(size_t i=0;i<src.buf.size();i++) src.buf[i]=77;
+  r->Transform(&src,sw,sh,&d3);
+  int ds=r->CalcStride(dw); bool cst=true;
+  for(int y=0;y<dh;y++) for(int x=0;x<dw*bpp;x++) if(d3.buf[y*ds+x]!=77) cst=false;
+  bool ok = hr==S_OK && d1.buf==d2.buf && r->m_nScaleMode==al && cst;
+  if(!ok) fails++;
+  printf("al%d %dx%d->%dx%d bpp%d taps=%d/%d simd=%d %s%s\n",al,sw,sh,dw,dh,bpp,p.m_pTable->m_nWTaps,p.m_pTable->m_nHTaps,p.m_pTable->m_nSimdCount, ok?"ok":"FAIL", cst?"":" nonconst");
+  delete r;
+ }
+ return fails;
+}
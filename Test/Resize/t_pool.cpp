@@ -0,0 +1,31 @@
+#include "streams.h"
+#define private public
+#include "VideoResizeBase.h"
+#undef private
+#include "sample.h"
+#include <stdio.h>
+#include <stdlib.h>
+GUID* subs[]={&MEDIASUBTYPE_RGB8,&MEDIASUBTYPE_RGB565,&MEDIASUBTYPE_RGB24,&MEDIASUBTYPE_RGB32};
+int main(){
+ int sizes[][4]={{1920,1080,320,240},{3840,2160,320,240},{640,480,320,240},{100,50,320,240},{1280,720,1920,1080},{33,17,320,240}};
+ int fails=0; CWorkerPool pool; pool.SetThreadCount(5);
+ for(int al=0; al<=4; al++) for(int si=0;si<6;si++) for(int b=0;b<4;b++){
+  int sw=sizes[si][0], sh=sizes[si][1], dw=sizes[si][2], dh=sizes[si][3];
+
+  HRESULT hr; CVideoResizeBase* r=new CVideoResizeBase(dw,dh,&hr);
+  r->SetMediaSubType(subs[b]); r->SetAlgorithm(al);
+  int ss=r->CalcStride(sw);
+  FakeSample src(ss*sh), d1(r->GetSize()), d2(r->GetSize());
+  for(size_t i=0;i<src.buf.size();i++) src.buf[i]=(BYTE)rand();
+  HRESULT h1=r->Transform(&src,sw,sh,&d1);
+  r->SetWorkerPool(&pool);
+  HRESULT h2=r->Transform(&src,sw,sh,&d2);
+  HRESULT h3=r->Transform(&src,sw,sh,&d2);
+  bool ok = h1==S_OK && h2==S_OK && h3==S_OK && d1.buf==d2.buf;
+  if(!ok) fails++;
+  if(!ok || b==3) printf("al%d %dx%d->%dx%d bpp%d workers=%d inline=%d band=%d %s\n",al,sw,sh,dw,dh,r->m_nBytesPerPixel,r->m_nWorkers,r->m_bInline,r->m_nBandLines, ok?"ok":"FAIL");
+  delete r;
+ }
+ pool.SetThreadCount(2);
+ return fails;
+}
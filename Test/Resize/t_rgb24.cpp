@@ -0,0 +1,40 @@
+#include "streams.h"
+#define private public
+#include "VideoResizeBase.h"
+#undef private
+#include "sample.h"
+#include "Utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+// RGB24 bilinear H: SIMD == C and no more than one value written past the row,
+// for every width including the multiples of 4 the SSSE3 blocks end at
+int main(){
+ int fails=0;
+ RESIZE_KERNELS kc, ks; GetResizeKernels(&MEDIASUBTYPE_RGB24,0,&kc); GetResizeKernels(&MEDIASUBTYPE_RGB24,GetSimdFlags(),&ks);
+ if(!ks.pfnBilinearH){printf("no simd kernel\n");return 0;}
+ for(int n=1;n<=67;n++) for(int it=0;it<20;it++){
+  int sw=2+rand()%80;
+  std::vector<BYTE> src(sw*3+8); for(size_t i=0;i<src.size();i++) src[i]=rand();
+  std::vector<ULONG> ws(n), ww(n); for(int i=0;i<n;i++){ ws[i]=(rand()%(sw-1))*3; ww[i]=rand()&0xffff; }
+  // exact row plus the one value of the contract
+  std::vector<short> a(n*3+1), b(n*3+1);
+  kc.pfnBilinearHC(&a[0],&src[0],&ws[0],&ww[0],3,n); ks.pfnBilinearH(&b[0],&src[0],&ws[0],&ww[0],3,n);
+  if(!std::equal(a.begin(),a.begin()+n*3,b.begin())){printf("bilinear H FAIL n=%d\n",n);fails++;break;}
+ }
+ // odd widths through the resizer: RGB24 == RGB32 with the 4th byte dropped
+ int sizes[][4]={{7,5,13,9},{9,3,5,7},{33,17,17,11},{640,480,321,241}};
+ for(int si=0;si<4;si++){
+  int sw=sizes[si][0], sh=sizes[si][1], dw=sizes[si][2], dh=sizes[si][3];
+  HRESULT hr; CVideoResizeBase r24(dw,dh,&hr), r32(dw,dh,&hr);
+  r24.SetMediaSubType(&MEDIASUBTYPE_RGB24); r24.SetAlgorithm(RESIZE_BILINEAR);
+  r32.SetMediaSubType(&MEDIASUBTYPE_RGB32); r32.SetAlgorithm(RESIZE_BILINEAR);
+  int ss=r24.CalcStride(sw), ds=r24.CalcStride(dw);
+  FakeSample s24(ss*sh), s32(sw*4*sh), d24(r24.GetSize()), d32(r32.GetSize());
+  for(int y=0;y<sh;y++) for(int x=0;x<sw;x++) for(int c=0;c<3;c++) s24.buf[y*ss+x*3+c]=s32.buf[(y*sw+x)*4+c]=(BYTE)rand();
+  r24.Transform(&s24,sw,sh,&d24); r32.Transform(&s32,sw,sh,&d32);
+  int bad=0; for(int y=0;y<dh;y++) for(int x=0;x<dw;x++) for(int c=0;c<3;c++) if(d24.buf[y*ds+x*3+c]!=d32.buf[(y*dw+x)*4+c]) bad++;
+  printf("%dx%d->%dx%d bad=%d %s\n",sw,sh,dw,dh,bad,bad?"FAIL":"ok"); if(bad) fails++;
+ }
+ printf("fails %d\n",fails);
+ return fails!=0;
+}
@@ -0,0 +1,33 @@
+#include "streams.h"
+#define private public
+#include "VideoResizeBase.h"
+#undef private
+#include "sample.h"
+#include <stdio.h>
+#include <stdlib.h>
+GUID* subs[]={&MEDIASUBTYPE_RGB565,&MEDIASUBTYPE_RGB24,&MEDIASUBTYPE_RGB32};
+// changing the output size matches a new instance of that size
+int main(){
+ int fails=0; CWorkerPool pool; pool.SetThreadCount(3);
+ int outs[][2]={{320,240},{1280,720},{64,48},{640,480}};
+ for(int al=0; al<=4; al++) for(int b=0;b<3;b++){
+
+  HRESULT hr; CVideoResizeBase* r=new CVideoResizeBase(320,240,&hr);
+  r->SetMediaSubType(subs[b]); r->SetAlgorithm(al); r->SetWorkerPool(&pool);
+  int sw=640, sh=480; int ss=r->CalcStride(sw);
+  FakeSample src(ss*sh); for(size_t i=0;i<src.buf.size();i++) src.buf[i]=(BYTE)rand();
+  for(int o=0;o<4;o++){
+   if(r->SetOutputSize(outs[o][0],outs[o][1])!=S_OK) fails++;
+   FakeSample d1(r->GetSize()); r->Transform(&src,sw,sh,&d1);
+   CVideoResizeBase* q=new CVideoResizeBase(outs[o][0],outs[o][1],&hr);
+   q->SetMediaSubType(subs[b]); q->SetAlgorithm(al);
+   FakeSample d2(q->GetSize()); q->Transform(&src,sw,sh,&d2);
+   if(d1.buf!=d2.buf){fails++; printf("FAIL al%d b%d %dx%d\n",al,b,outs[o][0],outs[o][1]);}
+   delete q;
+  }
+  if(r->SetOutputSize(0,10)!=E_INVALIDARG) fails++;
+  delete r;
+ }
+ printf("%s\n", fails?"FAIL":"ok");
+ return fails;
+}
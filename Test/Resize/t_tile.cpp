@@ -0,0 +1,51 @@
+#include "streams.h"
+#define private public
+#include "VideoResizeBase.h"
+#undef private
+#include "sample.h"
+#include <stdio.h>
+#include <stdlib.h>
+// every tiling mode == row order
+GUID* subs[]={&MEDIASUBTYPE_RGB24,&MEDIASUBTYPE_RGB32,&MEDIASUBTYPE_YUY2,&MEDIASUBTYPE_NV12,&MEDIASUBTYPE_RGB565};
+const char* names[]={"RGB24","RGB32","YUY2","NV12","RGB565"};
+int main(int argc, char** argv){
+ int sizes[][4]={{3840,2160,1920,1080},{1280,720,3840,2160},{640,480,2000,300},{4096,64,100,50},{200,100,6000,40},{2,2,512,4}};
+ int fails=0; CWorkerPool pool; pool.SetThreadCount(4);
+ for(int al=0; al<=4; al++) for(int si=0;si<6;si++) for(int b=0;b<6;b++){
+  int sw=sizes[si][0], sh=sizes[si][1], dw=sizes[si][2], dh=sizes[si][3];
+  int bi = b<5?b:2; bool conv = b==5;
+  HRESULT hr; CVideoResizeBase* r[4];
+  FakeSample* d[4]; HRESULT h[4];
+  int ss=0; FakeSample* src=NULL;
+  for(int m=0;m<4;m++){
+   r[m]=new CVideoResizeBase(dw,dh,&hr); r[m]->SetMediaSubType(subs[bi]); r[m]->SetAlgorithm(al);
+   if(conv) r[m]->SetOutputSubType(&MEDIASUBTYPE_RGB32);
+   r[m]->SetTiling(m==0?RESIZE_TILING_ROWS:m==1?RESIZE_TILING_TILES:m==2?RESIZE_TILING_STREAM:RESIZE_TILING_AUTO);
+   if(si<2) r[m]->SetWorkerPool(&pool);
+   if(!src){ ss=r[m]->CalcStride(sw); int n=r[m]->m_Kernels.nPlanes>1? ss*sh*3/2 : ss*sh; src=new FakeSample(n); for(int i=0;i<n;i++) src->buf[i]=rand(); }
+   d[m]=new FakeSample(r[m]->GetSize());
+   h[m]=r[m]->Transform(src,sw,sh,d[m]);
+  }
+  bool ok=true; for(int m=1;m<4;m++) ok = ok && h[m]==S_OK && d[m]->buf==d[0]->buf;
+  ok = ok && h[0]==S_OK;
+  if(!ok) fails++;
+  printf("al%d %s%s %dx%d->%dx%d tiled=%d tile=%d stream=%d auto:%d/%d/%d %s\n",al,names[bi],conv?">RGB32":"",sw,sh,dw,dh,r[1]->m_bTiled,r[1]->m_nTileWidth,r[2]->m_bStreamStores,r[3]->m_bTiled,r[3]->m_nTileWidth,r[3]->m_bStreamStores,ok?"ok":"FAIL");
+  for(int m=0;m<4;m++){ delete r[m]; delete d[m]; } delete src;
+ }
+ // planar: the tiling and the pool set before the subtype reach the chroma planes
+ GUID* planar[]={&MEDIASUBTYPE_NV12,&MEDIASUBTYPE_I420,&MEDIASUBTYPE_YV12};
+ for(int pi=0;pi<3;pi++) for(int t=RESIZE_TILING_TILES;t<=RESIZE_TILING_STREAM;t++){
+  HRESULT hr; CVideoResizeBase rows(1920,1080,&hr), tiled(1920,1080,&hr);
+  tiled.SetTiling(t); tiled.SetWorkerPool(&pool); tiled.SetAlgorithm(RESIZE_LANCZOS3);
+  tiled.SetMediaSubType(planar[pi]); rows.SetMediaSubType(planar[pi]); rows.SetAlgorithm(RESIZE_LANCZOS3); rows.SetWorkerPool(&pool);
+  int ss=rows.CalcStride(3840), n=ss*2160*3/2; FakeSample src(n); for(int i=0;i<n;i++) src.buf[i]=rand();
+  FakeSample d0(rows.GetSize()), d1(tiled.GetSize());
+  bool ok = rows.Transform(&src,3840,2160,&d0)==S_OK && tiled.Transform(&src,3840,2160,&d1)==S_OK && d0.buf==d1.buf;
+  for(int i=0;i<tiled.m_Kernels.nPlanes-1;i++){ CVideoResizeBase* p=tiled.m_pPlanes[i];
+   ok = ok && p->m_nTiling==t && p->m_pWorkerPool==&pool && p->m_nWorkers==tiled.m_nWorkers && p->m_bTiled && rows.m_pPlanes[i]->m_nTiling==RESIZE_TILING_ROWS && !rows.m_pPlanes[i]->m_bTiled; }
+  if(!ok) fails++;
+  printf("planar %d tiling %d planes %d %s\n",pi,t,tiled.m_Kernels.nPlanes,ok?"ok":"FAIL");
+ }
+ pool.SetThreadCount(2);
+ return fails;
+}
@@ -0,0 +1,40 @@
+#include "streams.h"
+#define private public
+#include "VideoResizeBase.h"
+#undef private
+#include "sample.h"
+#include <stdio.h>
+#include <stdlib.h>
+// YUY2/UYVY resize == resize of luma / chroma as RGB32 planes
+int main(){
+ int sizes[][4]={{640,480,320,240},{640,480,1280,720},{1920,1080,1280,720},{2,2,8,6},{4,3,2,2},{10,6,2,4},{100,50,36,70},{1280,720,640,360},{6,4,200,100}};
+ int fails=0;
+ for(int al=0; al<=4; al++) for(int si=0;si<9;si++) for(int f=0;f<2;f++){
+  int sw=sizes[si][0], sh=sizes[si][1], dw=sizes[si][2], dh=sizes[si][3];
+  int lo = f; // luma offset
+  HRESULT hr; CVideoResizeBase* r=new CVideoResizeBase(dw,dh,&hr);
+  r->SetMediaSubType(f?&MEDIASUBTYPE_UYVY:&MEDIASUBTYPE_YUY2); r->SetAlgorithm(al);
+  int ss=r->CalcStride(sw), ds=r->CalcStride(dw);
+  FakeSample src(ss*sh), dst(r->GetSize());
+  for(size_t i=0;i<src.buf.size();i++) src.buf[i]=(BYTE)rand();
+  hr=r->Transform(&src,sw,sh,&dst);
+  // planes
+  CVideoResizeBase* ry=new CVideoResizeBase(dw,dh,&hr); ry->SetMediaSubType(&MEDIASUBTYPE_RGB32); ry->SetAlgorithm(al);
+  CVideoResizeBase* rc=new CVideoResizeBase(dw/2,dh,&hr); rc->SetMediaSubType(&MEDIASUBTYPE_RGB32); rc->SetAlgorithm(al);
+  FakeSample ys(sw*4*sh), yd(dw*4*dh), cs(sw/2*4*sh), cd(dw/2*4*dh);
+  for(int y=0;y<sh;y++){ for(int x=0;x<sw;x++) for(int c=0;c<4;c++) ys.buf[(y*sw+x)*4+c]=src.buf[y*ss+x*2+lo];
+   for(int x=0;x<sw/2;x++) for(int c=0;c<4;c++) cs.buf[(y*sw/2+x)*4+c]=src.buf[y*ss+x*4+(1-lo)+(c&1)*2]; }
+  ry->Transform(&ys,sw,sh,&yd); rc->Transform(&cs,sw/2,sh,&cd);
+  bool area = ry->m_bAreaAverage || rc->m_bAreaAverage;
+  int bad=0;
+  if(!area) for(int y=0;y<dh;y++){ for(int x=0;x<dw;x++) if(dst.buf[y*ds+x*2+lo]!=yd.buf[(y*dw+x)*4]) bad++;
+   for(int x=0;x<dw/2;x++) for(int c=0;c<2;c++) if(dst.buf[y*ds+x*4+(1-lo)+c*2]!=cd.buf[(y*dw/2+x)*4+c]) bad++; }
+  // the luma and the chroma have the taps of their own planes
+  bool ok = hr==S_OK && r->m_nScaleMode==al && bad==0;
+  if(al>=2 && (r->m_pTable->m_nWTaps!=ry->m_pTable->m_nWTaps || r->m_pTable->m_nWChromaTaps!=rc->m_pTable->m_nWTaps)) ok=false;
+  if(!ok) fails++;
+  printf("al%d %s %dx%d->%dx%d bad=%d%s %s\n",al,f?"UYVY":"YUY2",sw,sh,dw,dh,bad,area?" (area skipped)":"",ok?"ok":"FAIL");
+  delete r; delete ry; delete rc;
+ }
+ return fails;
+}
@@ -0,0 +1,87 @@
+#!/bin/sh
+# Builds the tests against mocks of the DirectShow base classes with g++
+# and runs them. The filters themselves are built with Visual Studio.
+#
+#   run.sh                  run all the tests in Resize, Mux and Filter
+#   run.sh Mux/t_grid ...   run the given tests
+#   run.sh Bench/b_tile     build and run a benchmark
+#
+# The tests run under ASan, or TSan for the worker pool test.
+# OUT sets the build directory.
+
+cd "$(dirname "$0")" || exit 1
+TEST=$(pwd)
+SRC=$(cd ../Src && pwd)
+OUT=${OUT:-/tmp/dsfilters-test}
+
+RESIZE_SRCS="VideoResizeBase.cpp ResizeKernels.cpp PolyphaseFilter.cpp
+	WorkerPool.cpp ColorConvert.cpp ScaleTable.cpp"
+MUX_SRCS="BaseMux.cpp VideoMux.cpp TripleBuffer.cpp JitterBuffer.cpp
+	RingBuffer.cpp"
+FILTER_SRCS="$RESIZE_SRCS VideoResizer.cpp VideoPyramid.cpp"
+
+if [ $# -eq 0 ]; then
+	set -- $(ls Resize/t_*.cpp Mux/t_*.cpp Filter/t_*.cpp | sed 's/\.cpp$//')
+fi
+
+fails=0
+for t in "$@"; do
+	t=${t%.cpp}
+	name=$(basename "$t")
+	dir=$OUT/$name
+	rm -rf "$dir"; mkdir -p "$dir"
+	# the mock DbgWnd.h has to shadow the one next to the sources
+	cp "$SRC"/*.h "$SRC"/*.cpp "$dir"/
+	cp Mock/DbgWnd.h "$dir"/
+
+	case $t in
+	Mux/*)
+		srcs=$MUX_SRCS
+		inc="-I$TEST/Mock/Filter -I$TEST/Mock"
+		opt="-O1 -D_DEBUG"
+		;;
+	Filter/*)
+		srcs=$FILTER_SRCS
+		inc="-I$TEST/Mock/Filter -I$TEST/Mock"
+		opt="-O1 -mavx2 -mssse3 -msse4.1 $TEST/Mock/simdflags.cpp"
+		# the monitor filter isn't built with the tests
+		cp Mock/Filter/MediaSampleMonitor.h "$dir"/
+		;;
+	*)
+		srcs=$RESIZE_SRCS
+		inc="-I$TEST/Mock"
+		opt="-O2 -mavx2 -mssse3 -msse4.1 $TEST/Mock/simdflags.cpp"
+		# t_cache includes ScaleTable.cpp itself
+		[ "$name" = t_cache ] && srcs=$(echo $srcs | sed 's/ScaleTable.cpp//')
+		;;
+	esac
+
+	case $t in
+	Bench/*) san="" ;;
+	*/t_mt) san="-fsanitize=thread" ;;
+	*) san="-fsanitize=address" ;;
+	esac
+
+	files=""
+	for s in $srcs; do files="$files $dir/$s"; done
+	if ! g++ -std=c++03 $opt $san -g -fno-strict-aliasing -Wno-multichar \
+			-I"$dir" $inc -o "$dir/test" "$TEST/$t.cpp" $files \
+			"$TEST/Mock/guids.cpp" -lpthread > "$dir/build.log" 2>&1; then
+		echo "$t: build failed, see $dir/build.log"
+		fails=$((fails + 1))
+		continue
+	fi
+
+	case $t in
+	Bench/*) "$dir/test"; continue ;;
+	esac
+
+	if timeout 300 "$dir/test" > "$dir/test.log" 2>&1; then
+		echo "$t: ok"
+	else
+		echo "$t: FAILED, see $dir/test.log"
+		fails=$((fails + 1))
+	fi
+done
+
+[ $fails -eq 0 ]